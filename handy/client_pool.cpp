@@ -0,0 +1,400 @@
+#include "client_pool.h"
+#include "logger.h"
+#include "metrics.h"
+#include <algorithm>
+#include <climits>
+#include <random>
+#include <string.h>
+#include <tuple>
+
+namespace handy
+{
+    namespace
+    {
+        // 连接池的进程级指标（注册到默认注册表，由StatServer导出）
+        struct ClientPoolMetrics
+        {
+            Counter& requests;      // 发出的请求数
+            Counter& failures;      // 失败（超时、连接断开）的请求数
+            Counter& reconnects;    // 重连次数
+        };
+
+        ClientPoolMetrics& clientPoolMetrics()
+        {
+            static ClientPoolMetrics metrics{
+                MetricsRegistry::instance().counter("handy_client_requests_total", "Requests sent through client pools"),
+                MetricsRegistry::instance().counter("handy_client_request_failures_total",
+                                                    "Client pool requests that timed out or lost their connection"),
+                MetricsRegistry::instance().counter("handy_client_reconnects_total", "Client pool reconnect attempts"),
+            };
+            return metrics;
+        }
+
+        // get()使用的注册表：(事件循环集合, 主机, 端口) -> 连接池
+        using PoolKey = std::tuple<EventBases*, std::string, unsigned short>;
+        std::mutex g_poolsMutex;
+        std::map<PoolKey, std::weak_ptr<TcpClientPool>> g_pools;
+    } // namespace
+
+    TcpClientPool::Ptr TcpClientPool::get(EventBases* bases, const std::string& host, unsigned short port,
+                                            const Options& opts)
+    {
+        std::lock_guard<std::mutex> lock(g_poolsMutex);
+        std::weak_ptr<TcpClientPool>& wp = g_pools[PoolKey(bases, host, port)];
+        Ptr pool = wp.lock();
+        if(!pool || pool->m_closed)
+        {
+            pool = create(bases, host, port, opts);
+            wp = pool;
+        }
+        return pool;
+    }
+
+    TcpClientPool::Ptr TcpClientPool::create(EventBases* bases, const std::string& host, unsigned short port,
+                                                const Options& opts)
+    {
+        Ptr pool(new TcpClientPool(host, port, opts));
+        std::weak_ptr<TcpClientPool> wp = pool;
+        for(auto& slot : pool->m_slots)
+        {
+            slot->base = bases->allocBase();
+            Slot* s = slot.get();
+            s->base->safeCall([wp, s]{
+                if(Ptr p = wp.lock())
+                    p->_connect(s);
+            });
+        }
+        return pool;
+    }
+
+    TcpClientPool::TcpClientPool(const std::string& host, unsigned short port, const Options& opts) :
+        m_host(host),
+        m_port(port),
+        m_opts(opts),
+        m_nextId(1),
+        m_rotate(0),
+        m_closed(false)
+    {
+        int n = std::max(m_opts.connections, 1);
+        m_slots.reserve(n);
+        for(int i = 0; i < n; ++i)
+        {
+            m_slots.emplace_back(new Slot());
+            m_slots.back()->idx = i;
+        }
+    }
+
+    TcpClientPool::~TcpClientPool()
+    {
+        // 连接的回调只持有弱引用，此后不会再访问连接池
+        for(auto& slot : m_slots)
+        {
+            if(slot->conn)
+                slot->conn->close();
+        }
+    }
+
+    void TcpClientPool::request(const Slice& body, ResponseCallBack cb)
+    {
+        if(m_closed)
+        {
+            cb(false, Slice());
+            return;
+        }
+
+        Slot* slot = _select();
+        slot->inflight.fetch_add(1, std::memory_order_relaxed);
+        clientPoolMetrics().requests.add();
+
+        uint64_t id = m_nextId.fetch_add(1, std::memory_order_relaxed);
+        Request req;
+        req.cb = std::move(cb);
+        req.frame = makeFrame(id, body);
+        std::weak_ptr<TcpClientPool> wp = shared_from_this();
+        slot->base->safeCall([wp, slot, id, req = std::move(req)]() mutable {
+            if(Ptr p = wp.lock())
+                p->_send(slot, id, std::move(req));
+        });
+    }
+
+    void TcpClientPool::close()
+    {
+        if(m_closed.exchange(true))
+            return;
+
+        // 只持有弱引用：任务若随事件循环退出被丢弃，释放它不能触发析构（析构中会再调用safeCall）
+        std::weak_ptr<TcpClientPool> wp = shared_from_this();
+        for(auto& slot : m_slots)
+        {
+            Slot* s = slot.get();
+            s->base->safeCall([wp, s]{
+                Ptr p = wp.lock();
+                if(!p)
+                    return;
+                while(!s->pending.empty())
+                    p->_finish(s, s->pending.begin()->first, false, Slice());
+                // 状态回调看到m_closed后不再重连
+                if(s->conn)
+                    s->conn->close();
+            });
+        }
+    }
+
+    int TcpClientPool::getConnected() const
+    {
+        int n = 0;
+        for(auto& slot : m_slots)
+            n += slot->connected.load(std::memory_order_relaxed) ? 1 : 0;
+        return n;
+    }
+
+    int TcpClientPool::getInflight() const
+    {
+        int n = 0;
+        for(auto& slot : m_slots)
+            n += slot->inflight.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    std::string TcpClientPool::makeFrame(uint64_t id, const Slice& body)
+    {
+        std::string frame;
+        frame.reserve(kIdLen + body.size());
+        uint64_t netId = Net::hton(id);
+        frame.append(reinterpret_cast<const char*>(&netId), kIdLen);
+        frame.append(body.data(), body.size());
+        return frame;
+    }
+
+    bool TcpClientPool::parseFrame(const Slice& msg, uint64_t& id, Slice& body)
+    {
+        if(msg.size() < kIdLen)
+            return false;
+
+        uint64_t netId = 0;
+        memcpy(&netId, msg.data(), kIdLen);
+        id = Net::ntoh(netId);
+        body = Slice(msg.data() + kIdLen, msg.size() - kIdLen);
+        return true;
+    }
+
+    TcpClientPool::Slot* TcpClientPool::_select()
+    {
+        // 已连接的优先，其次未完成请求数少的；从轮换的下标开始比较，相同时不会总是选中第一条
+        size_t n = m_slots.size();
+        size_t start = m_rotate.fetch_add(1, std::memory_order_relaxed);
+        Slot* best = nullptr;
+        bool bestConnected = false;
+        int bestLoad = INT_MAX;
+        for(size_t i = 0; i < n; ++i)
+        {
+            Slot* s = m_slots[(start + i) % n].get();
+            bool connected = s->connected.load(std::memory_order_relaxed);
+            int load = s->inflight.load(std::memory_order_relaxed);
+            if((connected && !bestConnected) || (connected == bestConnected && load < bestLoad))
+            {
+                best = s;
+                bestConnected = connected;
+                bestLoad = load;
+            }
+        }
+        return best;
+    }
+
+    void TcpClientPool::_connect(Slot* slot)
+    {
+        if(m_closed)
+            return;
+
+        std::weak_ptr<TcpClientPool> wp = shared_from_this();
+        std::unique_ptr<LengthCodec> codec(new LengthCodec());
+        codec->setMaxMsgLen(m_opts.maxMsgLen);
+
+        TcpConnPtr conn = TcpConn::createConnection(slot->base, m_host, m_port, m_opts.connectTimeout_ms);
+        slot->conn = conn;
+        conn->onState([wp, slot](const TcpConnPtr& c){
+            if(Ptr p = wp.lock())
+                p->_handleState(slot, c);
+        });
+        conn->onMsg(std::move(codec), [wp, slot](const TcpConnPtr&, const Slice& msg){
+            if(Ptr p = wp.lock())
+                p->_handleMsg(slot, msg);
+        });
+    }
+
+    void TcpClientPool::_handleState(Slot* slot, const TcpConnPtr& conn)
+    {
+        // 已被替换的连接
+        if(conn != slot->conn)
+            return;
+
+        TcpConn::State state = conn->getState();
+        if(state == TcpConn::State::CONNECTED)
+        {
+            slot->connected = true;
+            slot->failures = 0;
+            if(m_opts.healthCheck_s > 0)
+            {
+                std::weak_ptr<TcpClientPool> wp = shared_from_this();
+                conn->addIdleCB(m_opts.healthCheck_s, [wp, slot](const TcpConnPtr&){
+                    if(Ptr p = wp.lock())
+                        p->_healthCheck(slot);
+                });
+            }
+
+            // 发出连接建立之前排队的请求
+            for(auto& [id, req] : slot->pending)
+            {
+                if(req.sent)
+                    continue;
+                conn->sendMsg(req.frame);
+                req.sent = true;
+                std::string().swap(req.frame);
+            }
+            return;
+        }
+
+        if(state != TcpConn::State::CLOSED && state != TcpConn::State::FAILED)
+            return;
+
+        bool wasConnected = slot->connected.exchange(false);
+        slot->conn.reset();
+
+        // 已发出的请求可能已被处理，不能在新连接上重发
+        std::vector<uint64_t> lost;
+        for(auto& [id, req] : slot->pending)
+        {
+            if(req.sent)
+                lost.push_back(id);
+        }
+        for(uint64_t id : lost)
+            _finish(slot, id, false, Slice());
+
+        if(m_closed)
+            return;
+
+        int delay = _backoff(slot);
+        ++slot->failures;
+        clientPoolMetrics().reconnects.add();
+        if(wasConnected)
+            WARN("Client pool connection to %s:%d lost, reconnecting in %d ms", m_host.c_str(), m_port, delay);
+        else
+            WARN("Client pool connect to %s:%d failed (%d times), retrying in %d ms",
+                    m_host.c_str(), m_port, slot->failures, delay);
+
+        std::weak_ptr<TcpClientPool> wp = shared_from_this();
+        slot->base->runAfter(delay, [wp, slot]{
+            if(Ptr p = wp.lock())
+                p->_connect(slot);
+        });
+    }
+
+    void TcpClientPool::_handleMsg(Slot* slot, const Slice& msg)
+    {
+        uint64_t id = 0;
+        Slice body;
+        if(!parseFrame(msg, id, body))
+        {
+            ERROR("Client pool received a malformed frame from %s:%d (%zu bytes), closing connection",
+                    m_host.c_str(), m_port, msg.size());
+            if(slot->conn)
+                slot->conn->close();
+            return;
+        }
+        // 找不到的请求已经超时
+        _finish(slot, id, true, body);
+    }
+
+    void TcpClientPool::_send(Slot* slot, uint64_t id, Request&& req)
+    {
+        if(m_closed)
+        {
+            if(req.cb)
+            {
+                slot->inflight.fetch_sub(1, std::memory_order_relaxed);
+                clientPoolMetrics().failures.add();
+                req.cb(false, Slice());
+            }
+            return;
+        }
+
+        int timeout_ms = req.cb ? m_opts.requestTimeout_ms : m_opts.healthTimeout_ms;
+        if(timeout_ms > 0)
+        {
+            std::weak_ptr<TcpClientPool> wp = shared_from_this();
+            req.timer = slot->base->runAfter(timeout_ms, [wp, slot, id]{
+                Ptr p = wp.lock();
+                if(!p)
+                    return;
+                auto it = slot->pending.find(id);
+                if(it == slot->pending.end())
+                    return;
+                bool probe = !it->second.cb;
+                it->second.timer = TimerId();
+                p->_finish(slot, id, false, Slice());
+                // 探测超时：连接已不可用，关闭后按退避重连
+                if(probe && slot->conn)
+                {
+                    WARN("Client pool health check to %s:%d timed out, closing connection", p->m_host.c_str(), p->m_port);
+                    slot->conn->close();
+                }
+            });
+        }
+
+        Request& r = slot->pending.emplace(id, std::move(req)).first->second;
+        if(slot->connected && slot->conn)
+        {
+            slot->conn->sendMsg(r.frame);
+            r.sent = true;
+            std::string().swap(r.frame);
+        }
+    }
+
+    void TcpClientPool::_finish(Slot* slot, uint64_t id, bool ok, const Slice& response)
+    {
+        auto it = slot->pending.find(id);
+        if(it == slot->pending.end())
+            return;
+
+        Request req = std::move(it->second);
+        slot->pending.erase(it);
+        if(req.timer != TimerId())
+            slot->base->cancel(req.timer);
+
+        if(!req.cb)
+        {
+            slot->probing = false;
+            return;
+        }
+
+        slot->inflight.fetch_sub(1, std::memory_order_relaxed);
+        if(!ok)
+            clientPoolMetrics().failures.add();
+        req.cb(ok, response);
+    }
+
+    void TcpClientPool::_healthCheck(Slot* slot)
+    {
+        if(slot->probing || !slot->connected || m_closed)
+            return;
+
+        slot->probing = true;
+        uint64_t id = m_nextId.fetch_add(1, std::memory_order_relaxed);
+        Request req;
+        req.frame = makeFrame(id, Slice());
+        _send(slot, id, std::move(req));
+    }
+
+    int TcpClientPool::_backoff(Slot* slot) const
+    {
+        int64_t delay = std::max(m_opts.backoffBase_ms, 1);
+        for(int i = 0; i < slot->failures && delay < m_opts.backoffMax_ms; ++i)
+            delay *= 2;
+        delay = std::min<int64_t>(delay, std::max(m_opts.backoffMax_ms, 1));
+
+        // 抖动：在[一半, 全部]之间随机，避免大量连接在服务端恢复时同时重连
+        static thread_local std::mt19937 rng(std::random_device{}());
+        std::uniform_int_distribution<int64_t> dist(delay / 2, delay);
+        return static_cast<int>(dist(rng));
+    }
+}   // namespace handy
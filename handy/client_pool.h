@@ -0,0 +1,218 @@
+/**
+ * @file client_pool.h
+ * @brief 客户端连接池：到同一(host, port)的多条持久连接，请求在连接上流水线复用，按请求ID匹配响应
+*/
+#pragma once
+#include "conn.h"
+#include "codec.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace handy
+{
+    /**
+     * @brief 连接池参数
+    */
+    struct ClientPoolOptions
+    {
+        int connections = 4;            // 连接数
+        int connectTimeout_ms = 3000;   // 连接超时时间（0表示不超时）
+        int requestTimeout_ms = 5000;   // 请求超时时间（0表示不超时）
+        int healthCheck_s = 30;         // 连接空闲多久后发送探测请求（秒，0表示不探测）
+        int healthTimeout_ms = 3000;    // 探测请求的超时时间
+        int backoffBase_ms = 100;       // 重连退避的初始时间
+        int backoffMax_ms = 30000;      // 重连退避的最长时间
+        size_t maxMsgLen = LengthCodec::kDefaultMaxMsgLen;  // 消息的最大长度
+    };
+
+    /**
+     * @class TcpClientPool
+     * @brief 到同一服务端的客户端连接池
+     * @details 1. 维护N条持久连接，创建时通过EventBases::allocBase()分散到各个事件循环（如MultiBase的各个线程）
+     *          2. 请求选择当前未完成请求数最少的已连接连接发送，不等待前一个请求的响应（流水线）；
+     *             没有可用连接时排队到某条正在连接的连接上，连上后发出
+     *          3. 帧格式：LengthCodec消息体 = 8字节请求ID（网络字节序）+ 请求/响应内容，
+     *             服务端需原样带回请求ID（可用parseFrame()/makeFrame()），响应顺序不限
+     *          4. 连接空闲超过healthCheck_s秒时发送内容为空的探测请求，探测超时则关闭连接重连
+     *          5. 连接断开或连接失败后按带随机抖动的指数退避重连，连接成功后退避时间复位
+     * @note 1. request()、close()线程安全；响应回调在该请求所用连接的事件循环线程中执行
+     * @note 2. 连接断开时，已经发出、尚未收到响应的请求以失败回调结束（请求可能已被服务端处理）
+    */
+    class TcpClientPool : public std::enable_shared_from_this<TcpClientPool>, private NonCopyAble
+    {
+        public:
+            using Ptr = std::shared_ptr<TcpClientPool>;                                 // TcpClientPool智能指针类型定义
+            using ResponseCallBack = std::function<void(bool ok, const Slice& response)>;   // 响应回调函数类型定义
+
+            using Options = ClientPoolOptions;                                          // 连接池参数类型定义
+
+            // 帧头部（请求ID）长度
+            static constexpr size_t kIdLen = sizeof(uint64_t);
+
+
+            /**
+             * @brief 获取到(host, port)的连接池，不存在（或已被释放）时创建
+             * @param bases 连接所在的事件循环集合（如MultiBase，也可以是单个EventBase）
+             * @param host 服务端主机名或IP地址
+             * @param port 服务端端口
+             * @param opts 连接池参数（只在创建时使用）
+             * @return Ptr 连接池的智能指针（线程安全）
+            */
+            static Ptr get(EventBases* bases, const std::string& host, unsigned short port,
+                            const Options& opts = Options());
+
+            /**
+             * @brief 创建一个新的连接池并开始连接（不加入get()使用的注册表）
+             * @param bases 连接所在的事件循环集合
+             * @param host 服务端主机名或IP地址
+             * @param port 服务端端口
+             * @param opts 连接池参数
+             * @return Ptr 连接池的智能指针
+            */
+            static Ptr create(EventBases* bases, const std::string& host, unsigned short port,
+                                const Options& opts = Options());
+
+            /**
+             * @brief 析构函数，关闭所有连接（不再回调未完成的请求，需要时先调用close()）
+            */
+            ~TcpClientPool();
+
+            /**
+             * @brief 发送请求（线程安全）
+             * @param body 请求内容
+             * @param cb 响应回调：ok为true时response为响应内容；超时、连接断开、连接池已关闭时ok为false
+             * @note 连接池已关闭时在当前线程中立即回调失败
+            */
+            void request(const Slice& body, ResponseCallBack cb);
+
+            /**
+             * @brief 关闭连接池：关闭所有连接，未完成的请求以失败回调结束（线程安全）
+            */
+            void close();
+
+            /**
+             * @brief 获取已建立的连接数（线程安全）
+            */
+            int getConnected() const;
+
+            /**
+             * @brief 获取未完成的请求数（线程安全）
+            */
+            int getInflight() const;
+
+            /**
+             * @brief 获取连接数
+            */
+            size_t size() const { return m_slots.size(); }
+
+            /**
+             * @brief 获取主机名
+            */
+            const std::string& getHost() const { return m_host; }
+
+            /**
+             * @brief 获取端口
+            */
+            unsigned short getPort() const { return m_port; }
+
+            /**
+             * @brief 生成一帧：请求ID + 内容（服务端用于回复响应）
+             * @param id 请求ID
+             * @param body 内容
+             * @return std::string 帧（交给LengthCodec编码后发送）
+            */
+            static std::string makeFrame(uint64_t id, const Slice& body);
+
+            /**
+             * @brief 解析一帧
+             * @param msg LengthCodec解码得到的消息
+             * @param id 输出请求ID
+             * @param body 输出内容
+             * @return bool true：成功，false：消息短于请求ID
+            */
+            static bool parseFrame(const Slice& msg, uint64_t& id, Slice& body);
+
+        private:
+            // 一个未完成的请求
+            struct Request
+            {
+                ResponseCallBack cb;            // 响应回调（空表示健康探测）
+                std::string frame;              // 请求帧（发出之前保存）
+                TimerId timer;                  // 超时定时器
+                bool sent = false;              // 是否已经发出
+            };
+
+            // 一条连接（除原子成员外只在其事件循环线程中访问）
+            struct Slot
+            {
+                size_t idx = 0;                         // 下标
+                EventBase* base = nullptr;              // 所在的事件循环
+                TcpConnPtr conn;                        // 当前连接（重连时替换）
+                std::atomic<bool> connected{false};     // 是否已连接
+                std::atomic<int> inflight{0};           // 未完成的请求数（不含健康探测）
+                int failures = 0;                       // 连续失败次数（决定退避时间）
+                bool probing = false;                   // 是否有健康探测正在进行
+                std::map<uint64_t, Request> pending;    // 未完成的请求（按请求ID，发送时保持顺序）
+            };
+
+            std::string m_host;                         // 服务端主机名
+            unsigned short m_port;                      // 服务端端口
+            Options m_opts;                             // 连接池参数
+            std::vector<std::unique_ptr<Slot>> m_slots; // 连接
+            std::atomic<uint64_t> m_nextId;             // 下一个请求ID
+            std::atomic<size_t> m_rotate;               // 选择连接的起始下标（未完成请求数相同时轮流选择）
+            std::atomic<bool> m_closed;                 // 是否已关闭
+
+            /**
+             * @brief 构造函数（通过create()创建）
+            */
+            TcpClientPool(const std::string& host, unsigned short port, const Options& opts);
+
+            /**
+             * @brief 选择未完成请求数最少的连接（优先已连接的）
+            */
+            Slot* _select();
+
+            /**
+             * @brief 发起连接（事件循环线程）
+            */
+            void _connect(Slot* slot);
+
+            /**
+             * @brief 处理连接状态变化（事件循环线程）
+            */
+            void _handleState(Slot* slot, const TcpConnPtr& conn);
+
+            /**
+             * @brief 处理响应（事件循环线程）
+            */
+            void _handleMsg(Slot* slot, const Slice& msg);
+
+            /**
+             * @brief 登记请求，已连接时立即发出（事件循环线程）
+            */
+            void _send(Slot* slot, uint64_t id, Request&& req);
+
+            /**
+             * @brief 结束一个请求（事件循环线程）
+             * @param ok 是否成功
+             * @param response 响应内容
+            */
+            void _finish(Slot* slot, uint64_t id, bool ok, const Slice& response);
+
+            /**
+             * @brief 连接空闲时发送健康探测（事件循环线程）
+            */
+            void _healthCheck(Slot* slot);
+
+            /**
+             * @brief 计算下一次重连的退避时间：min(最长时间, 初始时间 * 2^失败次数)，在[一半, 全部]之间随机
+            */
+            int _backoff(Slot* slot) const;
+    };
+}   // namespace handy
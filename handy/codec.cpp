@@ -21,21 +21,14 @@ namespace handy
         }
 
         // 寻找换行符(\r\n或\n)
-        for(size_t i = 0; i < data.size(); ++i)
+        const size_t i = data.find('\n');
+        if(i != Slice::npos)
         {
-            if(data[i] == '\n')
-            {
-                if(i > 0 && data[i - 1] == '\r')
-                {
-                    msg = Slice(data.data(), i - 1);
-                    return static_cast<int>(i + 1); // 包含\r\n
-                }
-                else
-                {
-                    msg = Slice(data.data(), i);
-                    return static_cast<int>(i + 1); // 仅包含\n
-                }
-            }
+            if(i > 0 && data.data()[i - 1] == '\r')
+                msg = Slice(data.data(), i - 1);   // 包含\r\n
+            else
+                msg = Slice(data.data(), i);       // 仅包含\n
+            return static_cast<int>(i + 1);
         }
 
         return 0;
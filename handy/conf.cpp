@@ -1,9 +1,18 @@
 #include "conf.h"
+#include "event_base.h"
+#include "logger.h"
 #include <algorithm>
+#include <cerrno>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 #include "slice.h"
 #include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
 
 using std::string;
 using std::list;
@@ -77,22 +86,26 @@ namespace handy
 
     /**
      * @brief 内部辅助结构体，用于逐行扫描和解析INI文件内容
-     * @details 封装了字符串扫描、空格跳过、字符匹配等功能，简化parse()函数逻辑
+     * @details 封装了字符串扫描、空格跳过、字符匹配等功能，简化parse()函数逻辑；
+     *          扫描范围为一行（不含换行符），提取的内容是指向原数据的Slice
      */
     namespace
     {
         struct LineScanner
         { 
             // 当前扫描位置指针
-            char *p;
+            const char *p;
+            // 行末尾
+            const char *end;
             // 错误标志（0：无错误，1：解析错误）
             int err;
 
             /**
-             * @brief 构造函数，初始化扫描位置
-             * @param ln 待扫描的行字符串
+             * @brief 构造函数，初始化扫描范围
+             * @param b 行起始位置
+             * @param e 行结束位置（不含换行符）
             */
-            LineScanner(char *ln) : p(ln), err(0) {}
+            LineScanner(const char *b, const char *e) : p(b), end(e), err(0) {}
 
             /**
              * @brief 跳过当前位置的所有空格字符
@@ -100,9 +113,7 @@ namespace handy
             */
             LineScanner& skipSpace() 
             {
-                while (*p && isspace(static_cast<unsigned char>(*p))) {
-                    p++;
-                }
+                p = simd::skipSpace(p, end);
                 return *this;
             }
 
@@ -112,11 +123,9 @@ namespace handy
              * @param e 字符串结束指针（初始为末尾）
              * @return 去除尾部空格后的字符串
             */
-            static string rstrip(const char* s, const char* e)
+            static Slice rstrip(const char* s, const char* e)
             {
-                while(e > s && isspace(static_cast<unsigned char>(*e -1)))
-                    e--;
-                return string(s, e);
+                return Slice(s, simd::rskipSpace(s, e));
             }
 
             /**
@@ -126,7 +135,7 @@ namespace handy
             int peekChar()
             {
                 skipSpace();
-                return *p;
+                return p < end ? *p : 0;
             }
 
             /**
@@ -149,7 +158,9 @@ namespace handy
             LineScanner& match(char c)
             {
                 skipSpace();
-                err = (*p++ != c);
+                err = !(p < end && *p == c);
+                if(p < end)
+                    p++;
                 return *this;
             }
 
@@ -159,39 +170,51 @@ namespace handy
              * @return 提取的字符串（不含终止字符，去除尾部空格）
              * @note 若未找到终止字符，设置err = 1并返回空字符串
             */
-            string consumeTill(char c)
+            Slice consumeTill(char c)
             {
                 skipSpace();
-                char *e = p;
+                const char *e = p;
                 // 移动到终止字符位置
-                while (!err && *e && *e != c)
+                while (!err && e < end && *e != c)
                 {
                     e++;
                 }
                 // 检查是否找到终止符
-                if(*e != c)
+                if(e >= end || *e != c)
                 {
                     err = 1;
-                    return "";
+                    return Slice();
                 }
                 // 提取并修剪字符串
-                char *s = p;
+                const char *s = p;
                 p = e;
                 return rstrip(s, e);
             }
 
+            /**
+             * @brief 提取当前位置到行尾的全部内容
+             * @return 提取的字符串（去除尾部空格）
+            */
+            Slice consumeRest()
+            {
+                skipSpace();
+                const char *s = p;
+                p = end;
+                return rstrip(s, end);
+            }
+
             /**
              * @brief 从当前位置提取字符，直到行尾或注释符
              * @return 提取的字符串（去除尾部空格，不含注释符）
              * @note 注释符为';'或'#'，遇到空格后再出现的非空格字符视为值结束
             */
-            string consumeTillEnd()
+            Slice consumeTillEnd()
             {
                 skipSpace();
-                char *e = p;
+                const char *e = p;
                 // 标记是否已经遇到空格
                 int wasSpace = 0;
-                while (!err && *e && *e != ';' && *e != '#')
+                while (!err && e < end && *e != ';' && *e != '#')
                 {
                     if(wasSpace)
                         break;
@@ -199,95 +222,483 @@ namespace handy
                     e++;
                 }
                 
-                char *s = p;
+                const char *s = p;
                 p = e;
                 return rstrip(s, e);
             }
         };
+
+        /**
+         * @brief 解析INI内容（Conf与ConfSnapshot共用）
+         * @param data 内容起始位置
+         * @param size 内容长度
+         * @param onValue 每解析出一个值时的回调：onValue(节名, 键名, 值)，参数均指向data
+         * @return int 0：成功，正数：解析错误的行号
+        */
+        template <typename OnValue>
+        int parseIni(const char* data, size_t size, OnValue&& onValue)
+        {
+            const char* p = data;
+            const char* fileEnd = data + size;
+            int curLine = 0; // 当前行号
+            Slice section;  // 当前解析的节名称
+            Slice key;      // 当前解析的键名称
+            int err = 0;    // 错误标志
+
+            // 逐行解析
+            while(!err && p < fileEnd)
+            {
+                const char* lineEnd = static_cast<const char*>(memchr(p, '\n', fileEnd - p));
+                if(!lineEnd)
+                    lineEnd = fileEnd;
+                const char* lineBegin = p;
+                p = lineEnd < fileEnd ? lineEnd + 1 : fileEnd;
+                curLine++;
+                // 初始化行扫描器
+                LineScanner scanner(lineBegin, lineEnd);
+                // 获取行首的第一个非空格字符
+                int firstChar = scanner.peekChar();
+
+                // 处理注释行或空行（跳过）
+                if(firstChar == ';' || firstChar == '#' || firstChar == '\0')
+                    continue;
+                // 处理节定义，如：[section]
+                else if(firstChar == '[')
+                {
+                    section = scanner.skip(1).consumeTill(']');
+                    err = scanner.match(']').err;
+                    // 新节开始，重置当前键名
+                    key.clear();
+                }
+                // 处理续行（以空格开头，说明属于上一个键的值）
+                else if (isspace(static_cast<unsigned char>(*lineBegin)))
+                {
+                    if(!key.empty())
+                    {
+                        // 将续行的内容添加到上一个键的值列表中
+                        Slice val = scanner.consumeRest();
+                        val.trimSpace();
+                        onValue(section, key, val);
+                    }
+                    else
+                        err = 1;
+                }
+                // 处理键值对（如key = value或key::value）
+                else
+                {
+                    // 备份扫描器状态（用于兼容:分隔符）
+                    LineScanner backUp = scanner;
+                    // 尝试以'='分隔键和值
+                    key = scanner.consumeTill('=');
+                    key.trimSpace();
+
+                    if(scanner.peekChar() == '=')
+                        scanner.skip(1);
+                    else
+                    {
+                        scanner = backUp;
+                        key = scanner.consumeTill(':');
+                        err = scanner.match(':').err;
+                    }
+                    scanner.skipSpace();
+                    // 提取键值对并存储
+                    Slice val = scanner.consumeTillEnd();
+                    val.trimSpace();
+                    onValue(section, key, val);
+                }
+            }
+
+            return err ? curLine : 0;
+        }
+
+        /**
+         * @brief 用read()读取整个文件
+         * @details 不依赖st_size：procfs、FIFO、/dev/stdin等报告大小为0的文件也能读到全部内容，
+         *          读取期间文件被截断也只是读到较少的数据（mmap在这种情况下会SIGBUS）
+         * @param fileName 文件名
+         * @param content 输出文件内容
+         * @return bool true：成功，false：打开或读取失败
+        */
+        bool readFile(const string& fileName, string& content)
+        {
+            int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+            if(fd < 0)
+                return false;
+            struct stat st;
+            if(fstat(fd, &st) == 0 && st.st_size > 0)
+                content.reserve(static_cast<size_t>(st.st_size));
+
+            char buf[16 * 1024];
+            for(;;)
+            {
+                ssize_t n = read(fd, buf, sizeof(buf));
+                if(n > 0)
+                    content.append(buf, static_cast<size_t>(n));
+                else if(n == 0)
+                    break;
+                else if(errno != EINTR)
+                {
+                    close(fd);
+                    return false;
+                }
+            }
+            close(fd);
+            return true;
+        }
+
+        /**
+         * @brief 只读映射整个文件
+         * @param fileName 文件名
+         * @param data 输出映射的内容（空文件时为nullptr）
+         * @param size 输出文件大小
+         * @return bool true：成功，false：打开或映射失败
+        */
+        bool mapFile(const string& fileName, const char*& data, size_t& size)
+        {
+            int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+            if(fd < 0)
+                return false;
+            struct stat st;
+            if(fstat(fd, &st) != 0)
+            {
+                close(fd);
+                return false;
+            }
+            size = static_cast<size_t>(st.st_size);
+            data = nullptr;
+            if(size > 0)
+            {
+                void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(p == MAP_FAILED)
+                {
+                    close(fd);
+                    return false;
+                }
+                data = static_cast<const char*>(p);
+            }
+            close(fd);
+            return true;
+        }
+
+        /**
+         * @brief 解除mapFile()的映射
+        */
+        void unmapFile(const char* data, size_t size)
+        {
+            if(data)
+                munmap(const_cast<char*>(data), size);
+        }
+
+        /**
+         * @brief 不区分大小写地比较两个Slice
+        */
+        bool equalsNoCase(const Slice& a, const Slice& b)
+        {
+            return a.equalsNoCase(b);
+        }
+
+        /**
+         * @brief 不区分大小写的FNV-1a哈希
+        */
+        size_t hashNoCase(const Slice& s, size_t h)
+        {
+            for(size_t i = 0; i < s.size(); ++i)
+            {
+                h ^= static_cast<size_t>(tolower(static_cast<unsigned char>(s[i])));
+                h *= 1099511628211ULL;
+            }
+            return h;
+        }
     } // namespace
 
     int Conf::parse(const std::string& fileName)
     {
         // 记录当前解析的文件名
         m_fileName = fileName;
-        // 以只读模式打开
-        FILE *file = fopen(m_fileName.c_str(), "r");
-        if(!file)
+        // 读取整个文件（值在解析时拷贝，不需要保留映射；mmap见ConfSnapshot）
+        string content;
+        if(!readFile(m_fileName, content))
             return -1;
 
-        // 使用智能指针自动关闭文件（避免资源泄露）
-        auto autoClose = std::shared_ptr<FILE>(file, fclose);
+        return parseIni(content.data(), content.size(), [this](const Slice& section, const Slice& key, const Slice& val) {
+            m_values[makeKey(section, key)].push_back(val);
+        });
+    }
 
-        // 最大行长度（16KB）
-        static const int MAX_LINE = 16 * 1024;
-        // 行缓冲区,智能指针自动释放缓冲区
-        auto lineBuf = std::make_unique<char[]>(MAX_LINE);
+    ConfSnapshot::Ptr ConfSnapshot::load(const std::string& fileName, int* err)
+    {
+        std::shared_ptr<ConfSnapshot> snap(new ConfSnapshot());
+        snap->m_fileName = fileName;
+        if(!mapFile(fileName, snap->m_data, snap->m_size))
+        {
+            if(err)
+                *err = -1;
+            return nullptr;
+        }
 
-        int curLine = 0; // 当前行号
-        string section; // 当前解析的节名称
-        Slice key;     // 当前解析的键名称
-        int err = 0;    // 错误标志
+        int r = parseIni(snap->m_data, snap->m_size, [&snap](const Slice& section, const Slice& key, const Slice& val) {
+            snap->m_index[Key{section, key}].values.push_back(val);
+        });
+        if(err)
+            *err = r;
+        if(r != 0)
+            return nullptr;
 
-        // 逐行读取文件
-        while(!err && fgets(lineBuf.get(), MAX_LINE, file) != nullptr)
+        // 预先解析每个键最后一个值的类型值
+        std::string buf;
+        for(auto& kv : snap->m_index)
         {
-            curLine++;
-            // 初始化行扫描器
-            LineScanner scanner(lineBuf.get());
-            // 获取行首的第一个非空格字符
-            int firstChar = scanner.peekChar();
-
-            // 处理注释行或空行（跳过）
-            if(firstChar == ';' || firstChar == '#' || firstChar == '\0')
-                continue;
-            // 处理节定义，如：[section]
-            else if(firstChar == '[')
+            Entry& e = kv.second;
+            const Slice& v = e.values.back();
+            buf.assign(v.data(), v.size());
+            const char* val = buf.c_str();
+            char* end;
+            e.integer = strtol(val, &end, 0);
+            e.hasInteger = end > val;
+            e.real = strtod(val, &end);
+            e.hasReal = end > val;
+            if(equalsNoCase(v, "true") || equalsNoCase(v, "yes") || equalsNoCase(v, "on") || v == "1")
+                e.boolean = 1;
+            else if(equalsNoCase(v, "false") || equalsNoCase(v, "no") || equalsNoCase(v, "off") || v == "0")
+                e.boolean = 0;
+        }
+        return snap;
+    }
+
+    ConfSnapshot::~ConfSnapshot()
+    {
+        unmapFile(m_data, m_size);
+    }
+
+    size_t ConfSnapshot::KeyHash::operator()(const Key& k) const
+    {
+        size_t h = hashNoCase(k.section, 14695981039346656037ULL);
+        h = (h ^ '.') * 1099511628211ULL;
+        return hashNoCase(k.name, h);
+    }
+
+    bool ConfSnapshot::KeyEqual::operator()(const Key& a, const Key& b) const
+    {
+        return equalsNoCase(a.section, b.section) && equalsNoCase(a.name, b.name);
+    }
+
+    const ConfSnapshot::Entry* ConfSnapshot::_find(const Slice& section, const Slice& name) const
+    {
+        auto p = m_index.find(Key{section, name});
+        return p == m_index.end() ? nullptr : &p->second;
+    }
+
+    Slice ConfSnapshot::get(const Slice& section, const Slice& name, const Slice& defaultValue) const
+    {
+        const Entry* e = _find(section, name);
+        return e ? e->values.back() : defaultValue;
+    }
+
+    long ConfSnapshot::getInteger(const Slice& section, const Slice& name, long defaultValue) const
+    {
+        const Entry* e = _find(section, name);
+        return e && e->hasInteger ? e->integer : defaultValue;
+    }
+
+    double ConfSnapshot::getReal(const Slice& section, const Slice& name, double defaultValue) const
+    {
+        const Entry* e = _find(section, name);
+        return e && e->hasReal ? e->real : defaultValue;
+    }
+
+    bool ConfSnapshot::getBoolean(const Slice& section, const Slice& name, bool defaultValue) const
+    {
+        const Entry* e = _find(section, name);
+        return e && e->boolean >= 0 ? e->boolean == 1 : defaultValue;
+    }
+
+    const std::vector<Slice>& ConfSnapshot::getStrings(const Slice& section, const Slice& name) const
+    {
+        static const std::vector<Slice> kEmpty;
+        const Entry* e = _find(section, name);
+        return e ? e->values : kEmpty;
+    }
+
+    MappedConf::MappedConf() : m_state(std::make_shared<State>()), m_watchChannel(nullptr) {}
+
+    MappedConf::~MappedConf()
+    {
+        unwatch();
+    }
+
+    int MappedConf::load(const std::string& fileName)
+    {
+        int err = 0;
+        ConfSnapshot::Ptr snap = ConfSnapshot::load(fileName, &err);
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->fileName = fileName;
+        if(!snap)
+        {
+            WARN("MappedConf: failed to load %s (%d), keeping version %llu", fileName.c_str(), err,
+                    (unsigned long long)m_state->version.load());
+            return err;
+        }
+        m_state->snap = std::move(snap);
+        m_state->version.fetch_add(1, std::memory_order_release);
+        INFO("MappedConf: loaded %s, %zu keys, version %llu", fileName.c_str(), m_state->snap->size(),
+                (unsigned long long)m_state->version.load());
+        return 0;
+    }
+
+    int MappedConf::reload()
+    {
+        std::string fileName;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            fileName = m_state->fileName;
+        }
+        return fileName.empty() ? -1 : load(fileName);
+    }
+
+    const ConfSnapshot::Ptr& MappedConf::_current() const
+    {
+        // 每个线程缓存各个MappedConf的快照引用；owner失效说明MappedConf已析构，顺便释放其快照
+        struct CacheEntry
+        {
+            std::weak_ptr<State> owner;     // 所属的MappedConf的发布状态
+            const State* state;             // 用于查找（owner未失效时地址不会被复用）
+            uint64_t version;               // 缓存的快照版本
+            ConfSnapshot::Ptr snap;         // 缓存的快照
+        };
+        thread_local std::vector<CacheEntry> cache;
+
+        State* st = m_state.get();
+        uint64_t version = st->version.load(std::memory_order_acquire);
+        for(size_t i = 0; i < cache.size(); )
+        {
+            CacheEntry& c = cache[i];
+            if(c.owner.expired())
             {
-                section = scanner.skip(1).consumeTill(']');
-                err = scanner.match(']').err;
-                // 新节开始，重置当前键名
-                key.clear();
+                c = std::move(cache.back());
+                cache.pop_back();
+                continue;
             }
-            // 处理续行（以空格开头，说明属于上一个键的值）
-            else if (isspace(static_cast<unsigned char>(lineBuf[0])))
+            if(c.state == st)
             {
-                if(!key.empty())
+                // 版本变化（重新加载过）：加锁更新一次缓存
+                if(c.version != version)
                 {
-                    // 将续行的内容添加到上一个键的值列表中
-                    Slice val = scanner.consumeTill('\0');
-                    val.trimSpace();
-                    m_values[makeKey(section, key)].push_back(val);
+                    std::lock_guard<std::mutex> lock(st->mutex);
+                    c.snap = st->snap;
+                    c.version = st->version.load(std::memory_order_relaxed);
                 }
-                else
-                    err = 1;
+                return c.snap;
             }
-            // 处理键值对（如key = value或key::value）
-            else
-            {
-                // 备份扫描器状态（用于兼容:分隔符）
-                LineScanner backUp = scanner;
-                // 尝试以'='分隔键和值
-                key = scanner.consumeTill('=');
-                key.trimSpace();
-                
-                if(scanner.peekChar() == '=')
-                    scanner.skip(1);
-                else
-                {
-                    scanner = backUp;
-                    key = scanner.consumeTill(':');
-                    err = scanner.match(':').err;
-                }
-                scanner.skipSpace();
-                // 提取键值对并存储
-                Slice val = scanner.consumeTillEnd();
-                val.trimSpace();
-                m_values[makeKey(section, key)].push_back(val);
+            ++i;
+        }
+        std::lock_guard<std::mutex> lock(st->mutex);
+        cache.push_back(CacheEntry{m_state, st, st->version.load(std::memory_order_relaxed), st->snap});
+        return cache.back().snap;
+    }
 
-                // std::cout << section << ": " << "-" << key.toString() << "- = -" << val.toString() << "-" << std::endl;
-            }
+    ConfSnapshot::Ptr MappedConf::snapshot() const
+    {
+        return _current();
+    }
+
+    std::string MappedConf::get(const Slice& section, const Slice& name, const std::string& defaultValue) const
+    {
+        const ConfSnapshot* snap = _current().get();
+        return snap ? snap->get(section, name, defaultValue).toString() : defaultValue;
+    }
+
+    long MappedConf::getInteger(const Slice& section, const Slice& name, long defaultValue) const
+    {
+        const ConfSnapshot* snap = _current().get();
+        return snap ? snap->getInteger(section, name, defaultValue) : defaultValue;
+    }
+
+    double MappedConf::getReal(const Slice& section, const Slice& name, double defaultValue) const
+    {
+        const ConfSnapshot* snap = _current().get();
+        return snap ? snap->getReal(section, name, defaultValue) : defaultValue;
+    }
+
+    bool MappedConf::getBoolean(const Slice& section, const Slice& name, bool defaultValue) const
+    {
+        const ConfSnapshot* snap = _current().get();
+        return snap ? snap->getBoolean(section, name, defaultValue) : defaultValue;
+    }
+
+    list<string> MappedConf::getStrings(const Slice& section, const Slice& name) const
+    {
+        list<string> values;
+        const ConfSnapshot* snap = _current().get();
+        if(snap)
+        {
+            for(const Slice& v : snap->getStrings(section, name))
+                values.push_back(v.toString());
+        }
+        return values;
+    }
+
+    bool MappedConf::watch(EventBase* base, const ReloadCallBack& cb)
+    {
+        std::string fileName;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            fileName = m_state->fileName;
+        }
+        if(fileName.empty())
+            return false;
+        unwatch();
+
+        // 监视文件所在的目录：rename替换时原文件的inode不再变化，只有目录会收到IN_MOVED_TO
+        size_t slash = fileName.rfind('/');
+        std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : fileName.substr(0, slash));
+        m_watchName = slash == std::string::npos ? fileName : fileName.substr(slash + 1);
+
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(fd < 0)
+        {
+            ERROR("MappedConf: inotify_init1 failed: %s", strerror(errno));
+            return false;
+        }
+        if(inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            ERROR("MappedConf: inotify_add_watch %s failed: %s", dir.c_str(), strerror(errno));
+            close(fd);
+            return false;
         }
+        m_reloadCB = cb;
+        m_watchChannel = new Channel(base, fd, kReadEvent);
+        m_watchChannel->onRead([this] { _handleWatch(); });
+        return true;
+    }
+
+    void MappedConf::unwatch()
+    {
+        delete m_watchChannel;
+        m_watchChannel = nullptr;
+    }
 
-        return err ? curLine : 0;
+    void MappedConf::_handleWatch()
+    {
+        // 一次读出所有事件，多个事件涉及同一文件时只重新加载一次
+        alignas(struct inotify_event) char buf[4096];
+        bool changed = false;
+        for(;;)
+        {
+            ssize_t n = read(m_watchChannel->getFd(), buf, sizeof(buf));
+            if(n <= 0)
+                break;
+            for(char* p = buf; p < buf + n; )
+            {
+                struct inotify_event* ev = reinterpret_cast<struct inotify_event*>(p);
+                if(ev->len > 0 && m_watchName == ev->name)
+                    changed = true;
+                p += sizeof(struct inotify_event) + ev->len;
+            }
+        }
+        if(!changed)
+            return;
+        int r = reload();
+        if(m_reloadCB)
+            m_reloadCB(r);
     }
 } // namespace handy
\ No newline at end of file
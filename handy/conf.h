@@ -1,11 +1,21 @@
 #pragma once
 #include "non_copy_able.h"
+#include "slice.h"
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
 
 namespace handy
 {
+    class EventBase;
+    class Channel;
+
     /**
      * @brief INI配置文件解析器，支持读取字符串、整数、浮点数、布尔值等类型配置
      * @details 功能特点
@@ -93,4 +103,219 @@ namespace handy
             */
             std::string makeKey(const std::string& section, const std::string& name) const;
     };
+
+    /**
+     * @class ConfSnapshot
+     * @brief 只读的配置快照：mmap映射INI文件，键与值都是指向映射内存的Slice（零拷贝）
+     * @details 1. 语法与Conf::parse()相同（节名、键名大小写不敏感，支持续行与重复键）
+     *          2. 加载时建立按(节名, 键名)的哈希索引，并预先解析每个键最后一个值的整数、浮点数、布尔值
+     *          3. 加载后不再修改，可以在多个线程中同时读取（不加锁）
+     * @note 返回的Slice在快照存活期间有效；文件应通过"写临时文件 + rename"替换，
+     *       原地截断或改写已映射的文件会改变（甚至使SIGBUS）正在使用的快照
+    */
+    class ConfSnapshot : private NonCopyAble
+    {
+        public:
+            using Ptr = std::shared_ptr<const ConfSnapshot>;    // ConfSnapshot智能指针类型定义
+
+            /**
+             * @brief 映射并解析INI文件
+             * @param fileName INI文件路径
+             * @param err 输出解析结果（可以为nullptr）：0：成功，-1：文件打开或映射失败，正数：解析错误的行号
+             * @return Ptr 快照，失败时为nullptr
+            */
+            static Ptr load(const std::string& fileName, int* err = nullptr);
+
+            /**
+             * @brief 析构函数，解除映射
+            */
+            ~ConfSnapshot();
+
+            /**
+             * @brief 获取字符串类型配置值（最后一个值）
+             * @return Slice 指向映射内存的值，未找到时返回defaultValue
+            */
+            Slice get(const Slice& section, const Slice& name, const Slice& defaultValue = Slice()) const;
+
+            /**
+             * @brief 获取整数类型配置值（加载时已解析）
+             * @return long 解析后的整数值，未找到或解析失败时返回defaultValue
+            */
+            long getInteger(const Slice& section, const Slice& name, long defaultValue) const;
+
+            /**
+             * @brief 获取浮点类型配置值（加载时已解析）
+             * @return double 解析后的浮点数值，未找到或解析失败时返回defaultValue
+            */
+            double getReal(const Slice& section, const Slice& name, double defaultValue) const;
+
+            /**
+             * @brief 获取布尔类型配置值（加载时已解析）
+             * @return bool 解析后的布尔值，未找到或解析失败时返回defaultValue
+            */
+            bool getBoolean(const Slice& section, const Slice& name, bool defaultValue) const;
+
+            /**
+             * @brief 获取多值配置（续行与重复键的所有值）
+             * @return const std::vector<Slice>& 值列表，未找到时为空
+            */
+            const std::vector<Slice>& getStrings(const Slice& section, const Slice& name) const;
+
+            /**
+             * @brief 获取键的数量
+            */
+            size_t size() const { return m_index.size(); }
+
+            /**
+             * @brief 获取文件名
+            */
+            const std::string& getFileName() const { return m_fileName; }
+
+        private:
+            // 索引键：指向映射内存的节名与键名（比较时不区分大小写）
+            struct Key
+            {
+                Slice section;
+                Slice name;
+            };
+
+            struct KeyHash
+            {
+                size_t operator()(const Key& k) const;
+            };
+
+            struct KeyEqual
+            {
+                bool operator()(const Key& a, const Key& b) const;
+            };
+
+            // 一个键的所有值与预先解析的类型值
+            struct Entry
+            {
+                std::vector<Slice> values;  // 所有值（最后一个为get()的结果）
+                long integer = 0;           // 整数值
+                double real = 0;            // 浮点数值
+                bool hasInteger = false;    // 整数解析是否成功
+                bool hasReal = false;       // 浮点数解析是否成功
+                int8_t boolean = -1;        // 布尔值（-1：解析失败）
+            };
+
+            std::string m_fileName;                                     // 文件名
+            const char* m_data = nullptr;                               // 映射的文件内容
+            size_t m_size = 0;                                          // 文件大小
+            std::unordered_map<Key, Entry, KeyHash, KeyEqual> m_index;  // 哈希索引
+
+            ConfSnapshot() = default;
+
+            /**
+             * @brief 查找键
+            */
+            const Entry* _find(const Slice& section, const Slice& name) const;
+    };
+
+    /**
+     * @class MappedConf
+     * @brief 可热加载的配置：持有当前的ConfSnapshot，重新加载时原子替换（RCU风格）
+     * @details 1. 读取时使用当前快照，读线程不加锁：每个线程缓存一份快照引用与版本号，
+     *             版本号未变化时只有原子读取；重新加载后每个线程的第一次读取加锁更新一次缓存
+     *          2. 重新加载在新快照完整建立后才替换，失败时保留旧快照
+     *          3. watch()用inotify监视文件所在目录，文件被写入关闭或rename替换时在事件循环中重新加载
+     * @note 1. load()/reload()线程安全；watch()/unwatch()/析构需在事件循环启动前或事件循环线程中调用
+     * @note 2. 线程缓存的旧快照在该线程下一次读取或MappedConf析构后的下一次读取时释放
+    */
+    class MappedConf : private NonCopyAble
+    {
+        public:
+            using ReloadCallBack = std::function<void(int result)>;     // 重新加载回调函数类型定义（参数同load()返回值）
+
+            MappedConf();
+            ~MappedConf();
+
+            /**
+             * @brief 加载配置文件并发布为当前快照
+             * @param fileName INI文件路径
+             * @return int 0：成功，-1：文件打开或映射失败，正数：解析错误的行号（失败时保留原快照）
+            */
+            int load(const std::string& fileName);
+
+            /**
+             * @brief 重新加载load()指定的文件
+             * @return int 同load()
+            */
+            int reload();
+
+            /**
+             * @brief 监视配置文件，变化时在事件循环中自动重新加载
+             * @param base 事件循环
+             * @param cb 每次重新加载后的回调（可以为空）
+             * @return bool true：成功，false：尚未load()或inotify失败
+            */
+            bool watch(EventBase* base, const ReloadCallBack& cb = nullptr);
+
+            /**
+             * @brief 停止监视
+            */
+            void unwatch();
+
+            /**
+             * @brief 获取当前快照（未加载时为nullptr）
+             * @note 读线程不加锁（见类说明），持有返回的快照期间其中的Slice有效
+            */
+            ConfSnapshot::Ptr snapshot() const;
+
+            /**
+             * @brief 获取当前快照的版本号（每次成功加载加1，未加载时为0）
+            */
+            uint64_t getVersion() const { return m_state->version.load(std::memory_order_acquire); }
+
+            /**
+             * @brief 获取字符串类型配置值（从当前快照复制）
+            */
+            std::string get(const Slice& section, const Slice& name, const std::string& defaultValue) const;
+
+            /**
+             * @brief 获取整数类型配置值
+            */
+            long getInteger(const Slice& section, const Slice& name, long defaultValue) const;
+
+            /**
+             * @brief 获取浮点类型配置值
+            */
+            double getReal(const Slice& section, const Slice& name, double defaultValue) const;
+
+            /**
+             * @brief 获取布尔类型配置值
+            */
+            bool getBoolean(const Slice& section, const Slice& name, bool defaultValue) const;
+
+            /**
+             * @brief 获取多值配置（从当前快照复制）
+            */
+            std::list<std::string> getStrings(const Slice& section, const Slice& name) const;
+
+        private:
+            // 发布状态（线程缓存通过weak_ptr判断MappedConf是否已析构）
+            struct State
+            {
+                std::mutex mutex;                       // 保护snap与fileName
+                ConfSnapshot::Ptr snap;                 // 当前快照
+                std::string fileName;                   // 文件名
+                std::atomic<uint64_t> version{0};       // 版本号
+            };
+
+            std::shared_ptr<State> m_state;             // 发布状态
+            Channel* m_watchChannel;                    // inotify通道
+            std::string m_watchName;                    // 监视的文件名（不含目录）
+            ReloadCallBack m_reloadCB;                  // 重新加载回调
+
+            /**
+             * @brief 获取当前线程缓存的快照（版本变化时更新缓存）
+            */
+            const ConfSnapshot::Ptr& _current() const;
+
+            /**
+             * @brief 处理inotify事件（事件循环线程）
+            */
+            void _handleWatch();
+    };
 } // namespace handy
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "utils.h"
 #include "thread_pool.h"
 #include "poller.h"
+#include "resolver.h"
+#include "daemon.h"
+#include "current_os.h"
 #include <fcntl.h>
 
 // TCP连接请求的最大等待队列长度
@@ -10,69 +13,124 @@
 
 namespace handy
 {
+    namespace
+    {
+        // TCP连接的进程级指标（注册到默认注册表，由StatServer导出）
+        struct TcpMetrics
+        {
+            Counter& bytesIn;       // 接收字节数
+            Counter& bytesOut;      // 发送字节数
+            Counter& established;   // 累计建立的连接数
+            Gauge& connections;     // 当前连接数
+            Gauge& outputBuffered;  // 输出缓冲区中等待对端读取的字节数
+            Counter& outputOverflows;   // 因输出缓冲区超过上限而关闭的连接数
+        };
+
+        TcpMetrics& tcpMetrics()
+        {
+            static TcpMetrics metrics{
+                MetricsRegistry::instance().counter("handy_tcp_received_bytes_total", "Bytes received on TCP connections"),
+                MetricsRegistry::instance().counter("handy_tcp_sent_bytes_total", "Bytes sent on TCP connections"),
+                MetricsRegistry::instance().counter("handy_tcp_connections_total", "TCP connections established"),
+                MetricsRegistry::instance().gauge("handy_tcp_connections", "TCP connections currently established"),
+                MetricsRegistry::instance().gauge("handy_tcp_output_buffered_bytes",
+                                                    "Bytes queued in TCP output buffers waiting for the peer"),
+                MetricsRegistry::instance().counter("handy_tcp_output_overflows_total",
+                                                    "TCP connections closed because the output buffer exceeded its limit"),
+            };
+            return metrics;
+        }
+
+        /**
+         * @brief 接受一个连接，新fd带有FD_CLOEXEC
+         * @details Linux上用accept4原子地设置：accept之后再设置的话，其他线程在这之间fork/exec的子进程会继承该fd
+        */
+        int acceptCloexec(int listenFd, struct sockaddr_in* addr, socklen_t* addrLen)
+        {
+#ifdef OS_LINUX
+            return accept4(listenFd, reinterpret_cast<struct sockaddr*>(addr), addrLen, SOCK_CLOEXEC);
+#else
+            int fd = accept(listenFd, reinterpret_cast<struct sockaddr*>(addr), addrLen);
+            if(fd >= 0 && utils::addFdFlag(fd, FD_CLOEXEC) != 0)
+                ERROR("Failed to set FD_CLOEXEC flag: errno=%d, msg=%s", errno, strerror(errno));
+            return fd;
+#endif
+        }
+
+        Ipv4Addr makeAddr(const struct in_addr& ip, unsigned short port)
+        {
+            struct sockaddr_in addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            addr.sin_addr = ip;
+            return Ipv4Addr(addr);
+        }
+    } // namespace
+
     TcpConn::TcpConn() :
         m_base(nullptr),
         m_channel(nullptr),
         m_state(State::INVALID),
+        m_highWater(0),
+        m_lowWater(0),
+        m_outputLimit(0),
+        m_reportedOutput(0),
+        m_pauseReadOnHigh(false),
+        m_aboveHighWater(false),
+        m_readPaused(false),
+        m_outputOverflow(false),
+        m_callBackDepth(0),
+        m_releaseCallBacks(false),
         m_destPort(-1),
         m_connectTimeout_ms(0),
         m_reconnectInterval_ms(-1),
-        m_connectedTime_ms(0) {}
+        m_connectedTime_ms(0),
+        m_connectSeq(0),
+        m_loadBase(nullptr) {}
 
     TcpConn::~TcpConn()
     {
         closeNow();
+        if(m_serverLive)
+            m_serverLive->fetch_sub(1, std::memory_order_relaxed);
         TRACE("TcpConn destroyed: %s -> %s", m_local.toString().c_str(), m_peer.toString().c_str());
     }
 
     void TcpConn::attach(EventBase* base, int fd, const Ipv4Addr& localIp, const Ipv4Addr& peerIp)
     {
-        {
-            std::lock_guard<std::mutex> lock(m_stateMutex);
-            // 服务器端被动接受的连接或客户端主动发起的连接
-            FATAL_IF((m_destPort <= 0 && m_state != State::INVALID) ||
-                        (m_destPort >=0 && m_state != State::HAND_SHAKING),
-                        "Invalid state for attach. Current state: %d", static_cast<int>(m_state));
-        }
+        // 服务器端被动接受的连接或客户端主动发起的连接
+        State state = getState();
+        FATAL_IF((m_destPort <= 0 && state != State::INVALID) ||
+                    (m_destPort >=0 && state != State::HAND_SHAKING),
+                    "Invalid state for attach. Current state: %d", static_cast<int>(state));
 
         m_base = base;
-
-        {
-            std::lock_guard<std::mutex> lock(m_stateMutex);
-            m_state = State::HAND_SHAKING;
-        }
-
+        m_state.store(State::HAND_SHAKING, std::memory_order_release);
         m_local = localIp;
         m_peer = peerIp;
-        
-        {
-            std::lock_guard<std::mutex> lock(m_ChannelMutex);
-            delete m_channel;
-            m_channel = new Channel(base, fd, kReadEvent | kWriteEvent);
-        }
+        handleUpdateConnections(m_loadBase, -1);
+        handleUpdateConnections(base, 1);
+        m_loadBase = base;
+
+        delete m_channel;
+        m_channel = new (base) Channel(base, fd, kReadEvent | kWriteEvent);
 
         TRACE("TcpConn attached: %s -> %s, fd: %d",
                 m_local.toString().c_str(), m_peer.toString().c_str(), fd);
 
+        // 先复制一份智能指针：处理过程中Channel（连同这里的lambda）可能被cleanup释放
         TcpConnPtr conn = shared_from_this();
-        {
-            std::lock_guard<std::mutex> lock(m_ChannelMutex);
-            if(m_channel)
-            {
-                m_channel->onRead([=]{ conn->_handleRead(conn); });
-                m_channel->onWrite([=]{ conn->_handleWrite(conn); });
-            }
-        }
+        m_channel->onRead([=]{ TcpConnPtr c = conn; c->_handleRead(c); });
+        m_channel->onWrite([=]{ TcpConnPtr c = conn; c->_handleWrite(c); });
     }
 
     void TcpConn::_connect(EventBase* base, const std::string& peerHost, unsigned short peerPort, 
                             int timeout_ms, const std::string& localIp)
     {
-        {
-            std::lock_guard<std::mutex> lock(m_stateMutex);
-            FATAL_IF(m_state != State::INVALID && m_state != State::CLOSED && m_state != State::FAILED,
-                        "Invalid state for connect. Current state: %d", static_cast<int>(m_state));
-        }
+        State state = getState();
+        FATAL_IF(state != State::INVALID && state != State::CLOSED && state != State::FAILED,
+                    "Invalid state for connect. Current state: %d", static_cast<int>(state));
 
         m_destHost = peerHost;
         m_destPort = peerPort;
@@ -80,7 +138,49 @@ namespace handy
         m_connectTimeout_ms = timeout_ms;
         m_localIp = localIp;
 
-        Ipv4Addr addr(peerHost, peerPort);
+        m_base = base;
+        m_state.store(State::HAND_SHAKING, std::memory_order_release);
+        uint64_t seq = ++m_connectSeq;
+        TcpConnPtr conn = shared_from_this();
+
+        // 超时同时覆盖名字解析与TCP握手
+        if(timeout_ms > 0)
+        {
+            m_timeoutId = base->runAfter(timeout_ms, [conn](){
+                if(conn->getState() != TcpConn::State::HAND_SHAKING)
+                    return;
+                if(conn->m_channel)
+                    conn->m_channel->close();
+                else
+                    conn->cleanup(conn);    // 仍在解析名字
+            });
+        }
+
+        // IP地址字面量或缓存命中时直接连接，否则交给解析线程，事件循环不阻塞在名字查询上
+        struct in_addr ip;
+        if(Resolver::instance().lookupCached(peerHost, ip))
+        {
+            _connectTo(makeAddr(ip, peerPort));
+            return;
+        }
+
+        Resolver::instance().resolve(base, peerHost, [conn, seq](bool ok, const struct in_addr& ip)
+        {
+            // 解析期间连接可能已经超时、被关闭或发起了新一轮连接
+            if(seq != conn->m_connectSeq || conn->getState() != TcpConn::State::HAND_SHAKING || conn->m_channel)
+                return;
+            if(!ok)
+            {
+                ERROR("Connect to %s:%d failed: cannot resolve host", conn->m_destHost.c_str(), conn->m_destPort);
+                conn->cleanup(conn);
+                return;
+            }
+            conn->_connectTo(makeAddr(ip, static_cast<unsigned short>(conn->m_destPort)));
+        });
+    }
+
+    void TcpConn::_connectTo(const Ipv4Addr& addr)
+    {
         int fd = socket(AF_INET, SOCK_STREAM, 0);
         FATAL_IF(fd < 0, "socket creation failed: errno=%d, msg=%s", errno, strerror(errno));
 
@@ -88,6 +188,9 @@ namespace handy
         int t = utils::addFdFlag(fd, FD_CLOEXEC);
         FATAL_IF(t < 0, "addFdFlag FD_CLOEXEC failed: errno=%d, msg=%s", errno, strerror(errno));
 
+        // 缓冲区大小与TCP Fast Open需在connect()之前设置
+        m_sockOpts.apply(fd, SocketOptions::Role::CONNECT);
+
         int r = 0;
         if(!m_localIp.empty())
         {
@@ -102,9 +205,14 @@ namespace handy
             r = ::connect(fd, (struct sockaddr*)&addr.getAddr(), sizeof(struct sockaddr_in));
             if(r != 0 && errno != EINPROGRESS)
                 ERROR("Connect to %s failed: errno=%d, msg=%s", addr.toString().c_str(), errno, strerror(errno));
+            // 非阻塞connect正在进行中，本地地址已分配
+            else if(r != 0)
+                r = 0;
         }
 
         sockaddr_in local;
+        memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
         socklen_t localLen = sizeof(local);
         if(r == 0)
         {
@@ -114,54 +222,150 @@ namespace handy
                 ERROR("getsockname failed: errno=%d, msg=%s", errno, strerror(errno));
         }
 
+        attach(m_base, fd, Ipv4Addr(local), addr);
+    }
+
+    void TcpConn::close()
+    {
+        if(!m_base)
+            return;
+
+        // m_channel只在事件循环线程中访问，因此无论在哪个线程调用都转交给事件循环处理
+        // Channel::close()会回调_handleRead并进入cleanup
+        TcpConnPtr conn = shared_from_this();
+        m_base->safeCall([conn]()
         {
-            std::lock_guard<std::mutex> lock(m_stateMutex);
-            m_state = State::HAND_SHAKING;
-        }
-        attach(base, fd, Ipv4Addr(local), addr);
+            // 任务执行前连接可能已经迁移到其他事件循环
+            if(!conn->m_base->isInLoopThread())
+                conn->close();
+            else if(conn->m_channel)
+                conn->m_channel->close();
+            // 仍在解析名字：直接结束本次连接
+            else if(conn->getState() == TcpConn::State::HAND_SHAKING)
+                conn->cleanup(conn);
+        });
+    }
 
-        if(timeout_ms > 0)
+    void TcpConn::_touchIdle()
+    {
+        if(m_idleNode.list)
+            handleUpdateIdle(m_base, &m_idleNode);
+        for(auto& node : m_extraIdleNodes)
+            handleUpdateIdle(m_base, &node);
+    }
+
+    void TcpConn::_runCallBack(const TcpCallBack& cb, const CallSite& site, const char* kind, const TcpConnPtr& conn)
+    {
+        // 回调返回（或抛出异常）时减少层数，最外层返回后再释放被推迟的回调
+        struct DepthGuard
         {
-            TcpConnPtr conn = shared_from_this();
-            m_timeoutId = base->runAfter(timeout_ms, [conn](){
-                if(conn->getState() == TcpConn::State::HAND_SHAKING)
-                    conn->m_channel->close();
-            });
+            TcpConn* self;
+            ~DepthGuard()
+            {
+                if(--self->m_callBackDepth == 0 && self->m_releaseCallBacks)
+                    self->_releaseCallBacks();
+            }
+        };
+
+        // 回调中连接可能被迁移到其他事件循环，计时以开始时所在的事件循环为准
+        EventBase* base = m_base;
+        CallbackStamp stamp = handleCallbackStart(base);
+        {
+            ++m_callBackDepth;
+            DepthGuard guard{this};
+            cb(conn);
         }
+        handleCallbackDone(base, stamp, site, kind);
     }
 
-    void TcpConn::close()
+    void TcpConn::_releaseCallBacks()
+    {
+        m_releaseCallBacks = false;
+        m_readCB = nullptr;
+        m_writeCB = nullptr;
+        m_stateCB = nullptr;
+        m_highWaterCB = nullptr;
+        m_lowWaterCB = nullptr;
+    }
+
+    void TcpConn::_checkOutput()
     {
-        std::lock_guard<std::mutex> lock(m_ChannelMutex);
-        if(m_channel)
+        size_t size = m_outputBuffer.size();
+        tcpMetrics().outputBuffered.add(static_cast<int64_t>(size) - static_cast<int64_t>(m_reportedOutput));
+        m_reportedOutput = size;
+
+        // 超过上限：丢弃缓冲的数据，停止读写并关闭连接（数据已不完整，不能再继续发送）
+        if(m_outputLimit > 0 && size > m_outputLimit)
         {
-            TcpConnPtr conn = shared_from_this();
-            getBase()->safeCall([conn]()
+            WARN("Output buffer overflow: %s -> %s, %zu bytes buffered (limit %zu), closing connection",
+                    m_local.toString().c_str(), m_peer.toString().c_str(), size, m_outputLimit);
+            tcpMetrics().outputOverflows.add();
+            tcpMetrics().outputBuffered.add(-static_cast<int64_t>(size));
+            m_reportedOutput = 0;
+            m_outputBuffer.clear();
+            m_outputOverflow = true;
+            // close()要等事件循环处理任务时才关闭通道，在此之前立即关闭写方向，之后发送的数据全部丢弃
+            if(m_channel)
             {
-                std::lock_guard<std::mutex> lock(conn->m_ChannelMutex);
-                if(conn->m_channel)
-                    conn->m_channel->close();
-            });
+                m_channel->enableRead(false);
+                m_channel->enableWrite(false);
+                ::shutdown(m_channel->getFd(), SHUT_WR);
+            }
+            close();
+            return;
+        }
+
+        if(m_highWater == 0)
+            return;
+
+        if(!m_aboveHighWater && size >= m_highWater)
+        {
+            m_aboveHighWater = true;
+            if(m_pauseReadOnHigh && m_channel)
+            {
+                m_channel->enableRead(false);
+                m_readPaused = true;
+            }
+            if(m_highWaterCB)
+                _runCallBack(m_highWaterCB, m_highWaterSite, "high-water", shared_from_this());
+        }
+        else if(m_aboveHighWater && size <= m_lowWater)
+        {
+            m_aboveHighWater = false;
+            if(m_readPaused)
+            {
+                m_readPaused = false;
+                if(m_channel)
+                    m_channel->enableRead(true);
+            }
+            if(m_lowWaterCB)
+                _runCallBack(m_lowWaterCB, m_lowWaterSite, "low-water", shared_from_this());
         }
     }
 
     void TcpConn::cleanup(const TcpConnPtr& conn)
     {   
-        // 处理剩余的输入数据
-        {
-            std::lock_guard<std::mutex> lock(m_callBacksMutex);
-            if(m_readCB && m_inputBuffer.size() > 0)
-                m_readCB(conn);
-        }
+        // 处理剩余的输入数据（回调中可以再操作连接）
+        if(m_readCB && m_inputBuffer.size() > 0)
+            _runCallBack(m_readCB, m_readSite, "readable", conn);
 
         // 更新状态
+        State state = getState();
+        if(state == State::CONNECTED)
+            tcpMetrics().connections.add(-1);
+        m_state.store(state == State::HAND_SHAKING ? State::FAILED : State::CLOSED, std::memory_order_release);
+        handleUpdateConnections(m_loadBase, -1);
+        m_loadBase = nullptr;
+        if(m_serverLive)
         {
-            std::lock_guard<std::mutex> lock(m_stateMutex);
-            if(m_state == State::HAND_SHAKING)
-                m_state = State::FAILED;
-            else
-                m_state = State::CLOSED;
+            m_serverLive->fetch_sub(1, std::memory_order_relaxed);
+            m_serverLive.reset();
         }
+        tcpMetrics().outputBuffered.add(-static_cast<int64_t>(m_reportedOutput));
+        m_reportedOutput = 0;
+        m_aboveHighWater = false;
+        m_readPaused = false;
+        m_outputOverflow = false;
         
         TRACE("TcpConn closing: %s -> %s, fd: %d. errno: %d, msg: %s",
                 m_local.toString().c_str(), m_peer.toString().c_str(),
@@ -172,45 +376,32 @@ namespace handy
             m_base->cancel(m_timeoutId);
 
         // 触发状态回调函数
-        {
-            std::lock_guard<std::mutex> lock(m_callBacksMutex);
-            if(m_stateCB)
-                m_stateCB(conn);
-        }
+        if(m_stateCB)
+            _runCallBack(m_stateCB, m_stateSite, "state", conn);
 
         // 处理重连
-        int interval_ms;
-        {
-            std::lock_guard<std::mutex> lock(m_intervalMutex);
-            interval_ms = m_reconnectInterval_ms;
-        }
-        if(interval_ms >= 0 && m_base && !m_base->exited())
+        if(m_reconnectInterval_ms.load(std::memory_order_relaxed) >= 0 && m_base && !m_base->exited())
         {
             _reconnect();
             return;
         }
 
         // 注销空闲回调
-        for(const auto& idleId : m_idleIds)
-        {
-            if(m_base)
-                handleUnregisterIdle(m_base, idleId);
-        }
-        m_idleIds.clear();
+        handleUnregisterIdle(m_base, &m_idleNode);
+        m_idleNode.cb = nullptr;
+        for(auto& node : m_extraIdleNodes)
+            handleUnregisterIdle(m_base, &node);
+        m_extraIdleNodes.clear();
+
+        // 释放回调：若cleanup是由某个回调触发的（如在回调中调用closeNow），推迟到该回调返回后再释放
+        if(m_callBackDepth > 0)
+            m_releaseCallBacks = true;
+        else
+            _releaseCallBacks();
 
         // 清理通道
-        {
-            std::lock_guard<std::mutex> lock(m_callBacksMutex);
-            m_readCB == nullptr;
-            m_writeCB == nullptr;
-            m_stateCB == nullptr;
-        }
-        Channel* ch = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(m_ChannelMutex);
-            ch = m_channel;
-            m_channel = nullptr;
-        }
+        Channel* ch = m_channel;
+        m_channel = nullptr;
         delete ch;
     }
 
@@ -221,6 +412,9 @@ namespace handy
         {
             if(_handleHandshake(conn) != 0)
                 return;
+            // 状态回调中可能暂停了读取（如代理等待上游连接建立），此时不再读取
+            if(m_channel && !m_channel->isReadEnabled())
+                return;
         }
 
         // 处理已连接状态的读事件
@@ -229,13 +423,7 @@ namespace handy
         {
             m_inputBuffer.makeRoom();
             int rd = 0;
-            int fd = -1;
-
-            {
-                std::lock_guard<std::mutex> lock(m_ChannelMutex);
-                if(m_channel)
-                    fd = m_channel->getFd();
-            }
+            int fd = m_channel ? m_channel->getFd() : -1;
 
             if(fd >= 0)
             {
@@ -243,20 +431,16 @@ namespace handy
                 TRACE("Channel  %lld, fd %d, read %d bytes",
                         (long long)m_channel->getId(), fd, rd);
             }
+
             // 若被信号中断，继续读取
-            else if(rd == -1 && errno == EINTR)
+            if(fd >= 0 && rd == -1 && errno == EINTR)
                 continue;
             // 若没有数据可读，则结束循环
-            else if(rd == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            else if(fd >= 0 && rd == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
             {
-                for(const auto& idleId : m_idleIds)
-                    handleUpdateIdle(m_base, idleId);
-
-                {
-                    std::lock_guard<std::mutex> lock(m_callBacksMutex);
-                    if(m_readCB && m_inputBuffer.size() > 0)
-                        m_readCB(conn);
-                }
+                _touchIdle();
+                if(m_readCB && m_inputBuffer.size() > 0)
+                    _runCallBack(m_readCB, m_readSite, "readable", conn);
                 break;
             }
             // 若连接关闭或出错
@@ -269,6 +453,7 @@ namespace handy
             else
             {
                 m_inputBuffer.addSize(rd);
+                tcpMetrics().bytesIn.add(rd);
             }
         }
     }
@@ -279,13 +464,7 @@ namespace handy
                     "handleHandShake called when state is not HandShaking, current state is %d",
                     static_cast<int>(getState()));
         
-        int fd = -1;
-        {
-            std::lock_guard<std::mutex> lock(m_ChannelMutex);
-            if(m_channel)
-                fd = m_channel->getFd();
-        }
-
+        int fd = m_channel ? m_channel->getFd() : -1;
         if(fd < 0)
         {
             cleanup(conn);
@@ -301,26 +480,17 @@ namespace handy
         // 若检测到可写事件
         if(r == 1 && pFd.revents == POLLOUT)
         {
-            {
-                std::lock_guard<std::mutex> lock(m_ChannelMutex);
-                if(m_channel)
-                    m_channel->enableReadWrite(true, false);
-            }
-
-            {
-                std::lock_guard<std::mutex> lock(m_stateMutex);
-                m_state = State::CONNECTED;
-            }
+            m_channel->enableReadWrite(true, false);
+            m_state.store(State::CONNECTED, std::memory_order_release);
+            tcpMetrics().established.add();
+            tcpMetrics().connections.add(1);
 
             m_connectedTime_ms = utils::timeMilli();
             TRACE("TcpConn connected: %s -> %s, fd: %d",
                     m_local.toString().c_str(), m_peer.toString().c_str(), fd);
 
-            {
-                std::lock_guard<std::mutex> lock(m_stateMutex);
-                if(m_stateCB)
-                    m_stateCB(conn);
-            }
+            if(m_stateCB)
+                _runCallBack(m_stateCB, m_stateSite, "state", conn);
         }
         else
         {
@@ -338,34 +508,23 @@ namespace handy
 
         if(currentState == State::HAND_SHAKING)
             _handleHandshake(conn);
+        else if(m_outputOverflow)
+        {
+            // 输出缓冲区超过上限后连接正在关闭，同一轮事件中已就绪的写事件不再发送
+            return;
+        }
         else if(currentState == State::CONNECTED)
         {
             ssize_t sended = _send(m_outputBuffer.begin(), m_outputBuffer.size());
             m_outputBuffer.consume(sended);
+            _updateOutput();
 
-            {
-                std::lock_guard<std::mutex> lock(m_callBacksMutex);
-                if(m_outputBuffer.empty() && m_writeCB)
-                    m_writeCB(conn);
-            }
-
-            bool isWritable = false;
-            {
-                std::lock_guard<std::mutex> lock(m_ChannelMutex);
-                if(m_channel)
-                    isWritable = m_channel->isWritable();
-            }
+            if(m_outputBuffer.empty() && m_writeCB)
+                _runCallBack(m_writeCB, m_writeSite, "writable", conn);
 
-            if(m_outputBuffer.empty() && isWritable)
-            {
-                // 写回调可能已经写入新的数据，因此需要检查是否仍然为空
-                if(m_outputBuffer.empty())
-                {
-                    std::lock_guard<std::mutex> lock(m_ChannelMutex);
-                    if(m_channel)
-                        m_channel->enableWrite(false);
-                }
-            }
+            // 写回调可能已经写入新的数据，也可能关闭了连接，因此需要重新检查
+            if(m_outputBuffer.empty() && m_channel && m_channel->isWritable())
+                m_channel->enableWrite(false);
         }
         else
         {
@@ -375,18 +534,11 @@ namespace handy
 
     ssize_t TcpConn::_send(const char* buf, size_t len)
     {
-        if(len == 0)
+        if(len == 0 || !m_channel)
             return 0;
 
         size_t sended = 0;
-        int fd = -1;
-
-        {
-            std::lock_guard<std::mutex> lock(m_ChannelMutex);
-            if(m_channel)
-                fd = m_channel->getFd();
-        }
-
+        int fd = m_channel->getFd();
         if(fd < 0)
             return 0;
 
@@ -409,11 +561,8 @@ namespace handy
             // 暂时无法写入，启用写事件监听
             else if(curWrited == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
             {
-                {
-                    std::lock_guard<std::mutex> lock(m_ChannelMutex);
-                    if(m_channel && !m_channel->isWritable())
-                        m_channel->enableWrite(true);
-                }
+                if(!m_channel->isWritable())
+                    m_channel->enableWrite(true);
                 break;
             }
             // 写入错误
@@ -425,6 +574,8 @@ namespace handy
             }
         }
 
+        if(sended > 0)
+            tcpMetrics().bytesOut.add(static_cast<int64_t>(sended));
         return sended;
     }
 
@@ -433,27 +584,30 @@ namespace handy
         if(buf.empty())
             return;
 
-        bool isChannelValid = false;
+        // 不在事件循环线程中：拷贝数据后转交给事件循环线程发送
+        if(m_base && !m_base->isInLoopThread())
         {
-            std::lock_guard<std::mutex> lock(m_ChannelMutex);
-            isChannelValid = (m_channel != nullptr);
+            std::string data(buf.peek(), buf.size());
+            buf.consume(data.size());
+            send(data);
+            return;
         }
 
-        if(!isChannelValid)
+        // 输出缓冲区超过上限后连接正在关闭：丢弃数据，避免对端在缺失的数据之后收到后续数据
+        if(m_outputOverflow)
         {
-            WARN("Sending data to a closed connection: %s -> %s, %lu bytes lost",
-                    m_local.toString().c_str(), m_peer.toString().c_str(), buf.size());
+            buf.clear();
             return;
         }
 
-        bool isWritable = false;
+        if(!m_channel)
         {
-            std::lock_guard<std::mutex> lock(m_ChannelMutex);
-            if(m_channel)
-                isWritable = m_channel->isWritable();
+            WARN("Sending data to a closed connection: %s -> %s, %lu bytes lost",
+                    m_local.toString().c_str(), m_peer.toString().c_str(), buf.size());
+            return;
         }
 
-        if(isWritable)
+        if(m_channel->isWritable())
         {
             // 若通道启用写事件，则将数据追加到输出缓冲区中
             m_outputBuffer.absorb(buf);
@@ -468,28 +622,33 @@ namespace handy
             if(buf.size() > 0)
             {
                 m_outputBuffer.absorb(buf);
-
-                {
-                    std::lock_guard<std::mutex> lock(m_ChannelMutex);
-                    if(m_channel && !m_channel->isWritable())
-                        m_channel->enableWrite(true);
-                }
+                if(m_channel && !m_channel->isWritable())
+                    m_channel->enableWrite(true);
             }
         }
+        _updateOutput();
     }
 
     void TcpConn::send(const char* buf, size_t len)
     {
         if(len == 0)
             return;
-        
-        bool isChannelValid = false;
+
+        // 不在事件循环线程中：拷贝数据后转交给事件循环线程发送
+        if(m_base && !m_base->isInLoopThread())
         {
-            std::lock_guard<std::mutex> lock(m_ChannelMutex);
-            isChannelValid = (m_channel != nullptr);
+            TcpConnPtr conn = shared_from_this();
+            m_base->safeCall([conn, data = std::string(buf, len)]()
+            {
+                conn->send(data.data(), data.size());
+            });
+            return;
         }
 
-        if(!isChannelValid)
+        if(m_outputOverflow)
+            return;
+
+        if(!m_channel)
         {
             WARN("Sending data to a closed connection: %s -> %s, %lu bytes lost",
                     m_local.toString().c_str(), m_peer.toString().c_str(), len);
@@ -508,15 +667,16 @@ namespace handy
         if(len > 0)
         {
             m_outputBuffer.append(buf, len);
+            _updateOutput();
         }
     }
 
-    void TcpConn::onMsg(std::unique_ptr<CodecBase> codec, const MsgCallBack& cb)
+    void TcpConn::onMsg(std::unique_ptr<CodecBase> codec, const MsgCallBack& cb, CallSite site)
     {
-        std::lock_guard<std::mutex> lock(m_callBacksMutex);
         FATAL_IF(m_readCB, "onMsg and onReadable are mutually exclusive");
 
         m_codec = std::move(codec);
+        m_readSite = site;
         m_readCB = [cb](const TcpConnPtr& conn)
         {
             int r = 1;
@@ -527,7 +687,7 @@ namespace handy
                 // 若解码错误，关闭连接
                 if(r < 0)
                 {
-                    conn->m_channel->close();
+                    conn->close();
                     break;
                 }
                 else if(r > 0)
@@ -543,23 +703,29 @@ namespace handy
 
     void TcpConn::sendMsg(const Slice& msg)
     {
-        if(m_codec)
+        if(!m_codec)
         {
-            m_codec->encode(msg, getOutputBuffer());
-            sendOutputBuffer();
-        }
-        else
             ERROR("sendMsg called without codec");
+            return;
+        }
+
+        // 不在事件循环线程中：编码到临时缓冲区，避免与事件循环线程同时修改输出缓冲区
+        if(m_base && !m_base->isInLoopThread())
+        {
+            Buffer buf;
+            m_codec->encode(msg, buf);
+            send(buf);
+            return;
+        }
+
+        m_codec->encode(msg, getOutputBuffer());
+        sendOutputBuffer();
     }
 
     void TcpConn::closeNow()
     {
-        Channel* ch = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(m_ChannelMutex);
-            ch = m_channel;
-            m_channel = nullptr;
-        }
+        Channel* ch = m_channel;
+        m_channel = nullptr;
         if(ch)
         {
             ch->close();
@@ -567,10 +733,57 @@ namespace handy
         }
     }
 
+    bool TcpConn::migrate(EventBase* target)
+    {
+        if(!target || target == m_base || !m_channel || getState() != State::CONNECTED || !m_outputBuffer.empty() ||
+            m_outputOverflow)
+            return false;
+
+        // 注销原事件循环中的空闲回调（超时时间记录在节点中，由目标事件循环重新注册）
+        handleUnregisterIdle(m_base, &m_idleNode);
+        for(auto& node : m_extraIdleNodes)
+            handleUnregisterIdle(m_base, &node);
+
+        // Channel的回调持有连接的引用，释放Channel前先持有一份
+        TcpConnPtr conn = shared_from_this();
+        int fd = m_channel->releaseFd();
+        delete m_channel;
+        m_channel = nullptr;
+        handleUpdateConnections(m_loadBase, -1);
+        m_loadBase = nullptr;
+
+        TRACE("TcpConn migrating: %s -> %s, fd: %d",
+                m_local.toString().c_str(), m_peer.toString().c_str(), fd);
+        m_base = target;
+        target->safeCall([conn, fd]() { conn->_adopt(fd); });
+        return true;
+    }
+
+    void TcpConn::_adopt(int fd)
+    {
+        m_channel = new (m_base) Channel(m_base, fd, kReadEvent);
+        TcpConnPtr conn = shared_from_this();
+        m_channel->onRead([=]{ TcpConnPtr c = conn; c->_handleRead(c); });
+        m_channel->onWrite([=]{ TcpConnPtr c = conn; c->_handleWrite(c); });
+        if(!m_outputBuffer.empty())
+            m_channel->enableWrite(true);
+
+        handleUpdateConnections(m_base, 1);
+        m_loadBase = m_base;
+        if(m_idleNode.cb)
+            handleRegisterIdle(m_base, m_idleNode.idle_s, &m_idleNode);
+        for(auto& node : m_extraIdleNodes)
+            handleRegisterIdle(m_base, node.idle_s, &node);
+
+        TRACE("TcpConn migrated: %s -> %s, fd: %d",
+                m_local.toString().c_str(), m_peer.toString().c_str(), fd);
+    }
+
     TcpServer::TcpServer(EventBases* bases) :
         m_bases(bases),
         m_listenChannel(nullptr),
-        m_createCB([](){ return TcpConnPtr(new TcpConn); })
+        m_createCB([](EventBase* base){ return TcpConn::create(base); }),
+        m_live(std::make_shared<std::atomic<int>>(0))
         {
             m_base = bases->allocBase();
             FATAL_IF(!m_base, "Failed to allocate event base");
@@ -578,15 +791,38 @@ namespace handy
 
     TcpServer::~TcpServer()
     {
-        std::lock_guard<std::mutex> lock(m_ChannelMutex);
-        delete m_listenChannel;
+        _closeListen();
+    }
+
+    void TcpServer::_closeListen()
+    {
+        // Channel析构时会回调_handleAccept，不能在持有m_ChannelMutex时释放
+        Channel* ch = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_ChannelMutex);
+            ch = m_listenChannel;
+            m_listenChannel = nullptr;
+        }
+        if(ch)
+            Daemon::removeListenFd(ch->getFd());
+        delete ch;
     }
 
     int TcpServer::bind(const std::string& host, unsigned short port, bool isReusePort)
     {
         m_addr = Ipv4Addr(host, port);
+        const std::string key = "tcp:" + m_addr.toString();
 
-        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        // 平滑重启：优先使用上一个进程交接过来的监听Socket
+        int fd = Daemon::takeInheritedFd(key);
+        if(fd >= 0)
+        {
+            INFO("Adopt inherited listen fd %d at %s", fd, m_addr.toString().c_str());
+            _listen(fd, key);
+            return 0;
+        }
+
+        fd = socket(AF_INET, SOCK_STREAM, 0);
         FATAL_IF(fd < 0, "socket creation failed: errno=%d, msg=%s", errno, strerror(errno));
 
         // 设置地址重用
@@ -604,6 +840,9 @@ namespace handy
         r = utils::addFdFlag(fd, FD_CLOEXEC);
         FATAL_IF(r, "Failed to set FD_CLOEXEC: errno=%d, msg=%s", errno, strerror(errno));
 
+        // 调优选项（缓冲区大小需在listen()之前设置才能影响窗口扩大因子）
+        m_sockOpts.apply(fd, SocketOptions::Role::LISTEN);
+
         // 绑定地址
         r = ::bind(fd, (struct sockaddr*)&m_addr.getAddr(), sizeof(struct sockaddr));
         if(r != 0)
@@ -618,7 +857,12 @@ namespace handy
         FATAL_IF(r, "Listen failed: errno=%d, msg=%s", errno, strerror(errno));
 
         INFO("Listening on fd %d at %s", fd, m_addr.toString().c_str());
+        _listen(fd, key);
+        return 0;
+    }
 
+    void TcpServer::_listen(int fd, const std::string& key)
+    {
         // 创建监听通道
         {
             std::lock_guard<std::mutex> lock(m_ChannelMutex);
@@ -627,8 +871,32 @@ namespace handy
                 this->_handleAccept();
             });
         }
+        // 登记为可交接的监听fd
+        Daemon::addListenFd(key, fd);
+    }
 
-        return 0;
+    void TcpServer::drain(int timeout_ms, const std::function<void()>& cb)
+    {
+        m_base->safeCall([this, timeout_ms, cb]() {
+            _closeListen();
+            INFO("TcpServer at %s draining %d connections", m_addr.toString().c_str(), liveConnections());
+            _checkDrained(utils::timeMilli() + timeout_ms, cb);
+        });
+    }
+
+    void TcpServer::_checkDrained(int64_t deadline_ms, const std::function<void()>& cb)
+    {
+        int live = liveConnections();
+        if(live > 0 && utils::timeMilli() < deadline_ms)
+        {
+            m_base->runAfter(10, [this, deadline_ms, cb]() { _checkDrained(deadline_ms, cb); });
+            return;
+        }
+
+        if(live > 0)
+            WARN("TcpServer at %s drain timed out, %d connections left", m_addr.toString().c_str(), live);
+        if(cb)
+            cb();
     }
 
     TcpServer::Ptr TcpServer::startServer(EventBases* bases, const std::string& host,
@@ -658,7 +926,7 @@ namespace handy
         int curFd;
 
         // 处理所有待接受的连接
-        while((curFd = accept(listenFd, (struct sockaddr*)&remoteAddr, &remoteSize)) >= 0)
+        while((curFd = acceptCloexec(listenFd, &remoteAddr, &remoteSize)) >= 0)
         {
             // 获取对端地址
             sockaddr_in local, peer;
@@ -680,18 +948,21 @@ namespace handy
                 continue;
             }
 
-            // 设置FD_CLOEXEC标志
-            r = utils::addFdFlag(curFd, FD_CLOEXEC);
-            if(r != 0)
+            // 失败通常是权限不足，之后的连接同样会失败：只告警一次，不再尝试
+            int busyPoll_us = m_busyPoll_us.load(std::memory_order_relaxed);
+            if(busyPoll_us > 0 && !Net::setBusyPoll(curFd, busyPoll_us) &&
+                m_busyPoll_us.compare_exchange_strong(busyPoll_us, 0, std::memory_order_relaxed))
             {
-                close(curFd);
-                ERROR("Failed to set FD_CLOEXEC flag: errno=%d, msg=%s", errno, strerror(errno));
-                continue;
+                WARN("Failed to enable SO_BUSY_POLL on %s, accepted connections continue without it",
+                        m_addr.toString().c_str());
             }
+            m_sockOpts.apply(curFd, SocketOptions::Role::ACCEPTED);
 
-            // 从事件循环组中分配一个事件循环
+            // 从事件循环组中分配一个事件循环，并立即预占一个连接计数：
+            // attach在目标循环中稍后才执行，不预占的话同一批接受的连接看到的都是旧的计数，按连接数分配的策略会全部选中同一个循环
             EventBase* base = m_bases->allocBase();
             FATAL_IF(!base, "Failed to allocate EventBase");
+            handleUpdateConnections(base, 1);
 
             // 创建连接并初始化
             auto addConn = [=]()
@@ -699,28 +970,33 @@ namespace handy
                 TcpConnPtr conn;
                 {
                     std::lock_guard<std::mutex> lock(m_callBacksMutex);
-                    conn = m_createCB();
+                    conn = m_createCB(base);
                 }
 
                 if(conn)
                 {
+                    // attach会计入连接数，撤销预占的计数
                     conn->attach(base, curFd, Ipv4Addr(local), Ipv4Addr(peer));
+                    handleUpdateConnections(base, -1);
+                    m_live->fetch_add(1, std::memory_order_relaxed);
+                    conn->m_serverLive = m_live;
 
                     {
                         std::lock_guard<std::mutex> lock(m_callBacksMutex);
                         if(m_stateCB)
-                            conn->onState(m_stateCB);
+                            conn->onState(m_stateCB, m_stateSite);
                         if(m_readCB)
-                            conn->onReadable(m_readCB);
+                            conn->onReadable(m_readCB, m_readSite);
                         if(m_msgCB && m_codec)
                         {
                             handy::CodecBase* clonedRaw = m_codec->clone();
-                            conn->onMsg(std::unique_ptr<handy::CodecBase>(clonedRaw), m_msgCB);
+                            conn->onMsg(std::unique_ptr<handy::CodecBase>(clonedRaw), m_msgCB, m_readSite);
                         }
                     }
                 }
                 else
                 {
+                    handleUpdateConnections(base, -1);
                     close(curFd);
                     ERROR("Failed to accept new connection");
                 }
@@ -9,13 +9,14 @@
 #include "net.h"
 #include "thread_pool.h"
 #include <assert.h>
+#include <atomic>
 
 namespace handy
 {
     // TCP连接的智能指针类型
     using TcpConnPtr = std::shared_ptr<TcpConn>;
     // TCP回调函数类型定义
-    using TcpCallBack = std::function<void(const TcpConnPtr&)>;
+    using TcpCallBack = InlineFunction<void(const TcpConnPtr&), 48, true>;
     // 带返回值的消息回调函数类型定义
     using RetMsgCallBack = std::function<std::string(const TcpConnPtr&, const std::string&)>;
 
@@ -24,9 +25,17 @@ namespace handy
      * @brief TCP连接类，封装TCP连接的创建、读写、状态管理等功能
      * @note 1. 继承自std::enable_shared_from_this<TcpConn>，因此TcpConn对象可被std::shared_ptr管理,以便在成员函数中安全地获取自身的shared_ptr
      * @note 2. 继承自NonCopyAble，因此TcpConn对象不可被拷贝构造和赋值
+     * @note 3. 连接的读写与状态迁移只在所属事件循环线程中进行，热路径上不加锁：
+     *          状态为原子变量，回调在连接开始处理事件前设置好后不再变化；
+     *          其他线程调用send()/close()时通过safeCall()转交给事件循环线程执行
     */
     class TcpConn : public std::enable_shared_from_this<TcpConn>, private NonCopyAble
     {
+        // TcpRelay接管连接的读写事件，需要直接使用连接的发送与空闲检测
+        friend class TcpRelay;
+        // TcpServer为被动接受的连接登记存活计数（drain()等待计数归零）
+        friend class TcpServer;
+
         public:
             // TCP连接状态枚举
             enum class State
@@ -54,15 +63,20 @@ namespace handy
              * @param base 事件循环对象
              * @param destHost 目标主机名或IP地址
              * @param destPort 目标端口号
-             * @param timeout_ms 连接超时时间，默认为0表示不超时
+             * @param timeout_ms 连接超时时间（包含名字解析），默认为0表示不超时
              * @param localIp 本地IP地址，默认为空表示使用自动选择
+             * @param opts Socket调优选项（在connect()之前应用，重连时同样应用）
              * @return TcpConnPtr 创建的连接对象的智能指针
+             * @note 主机名由Resolver在解析线程中查询（结果按TTL缓存），不阻塞事件循环；
+             *       解析失败时连接进入FAILED状态
             */
             template <class C = TcpConn>
             static TcpConnPtr createConnection(EventBase* base, const std::string& destHost, unsigned short destPort,
-                                                int timeout_ms = 0, const std::string& localIp = "")
+                                                int timeout_ms = 0, const std::string& localIp = "",
+                                                const SocketOptions& opts = SocketOptions())
             {
-                TcpConnPtr conn(std::make_shared<C>());
+                TcpConnPtr conn(create<C>(base));
+                conn->m_sockOpts = opts;
                 conn->_connect(base, destHost, destPort, timeout_ms, localIp);
                 return conn;
             }
@@ -79,11 +93,26 @@ namespace handy
             template <class C = TcpConn>
             static TcpConnPtr createConnection(EventBase* base, int fd, const Ipv4Addr& local, const Ipv4Addr& peer)
             {
-                TcpConnPtr conn(std::make_shared<C>());
+                TcpConnPtr conn(create<C>(base));
                 conn->attach(base, fd, local, peer);
                 return conn;
             }
 
+            /**
+             * @brief 创建一个尚未关联fd的连接对象
+             * @details 在事件循环线程中调用时，连接对象与shared_ptr控制块一起从该事件循环的对象池中分配，
+             *          连接销毁后内存块归还对象池，供后续连接复用；其他线程中调用时使用全局堆
+             * @tparam C 连接类型，需继承自TcpConn
+             * @param base 连接将要使用的事件循环（可以为nullptr）
+             * @return TcpConnPtr 创建的连接对象的智能指针
+            */
+            template <class C = TcpConn>
+            static TcpConnPtr create(EventBase* base)
+            {
+                static_assert(std::is_base_of<TcpConn, C>::value, "C must derive from TcpConn");
+                return std::allocate_shared<C>(PoolAllocator<C>(base ? base->getLocalPool() : nullptr));
+            }
+
             /**
              * @brief 判断当前连接是否为客户端连接
              * @return bool true:客户端连接，false:服务端连接
@@ -91,17 +120,29 @@ namespace handy
             bool isClient() const { return m_destPort > 0; }
 
             /**
-             * @brief 获取与当前连接关联的上下文
+             * @brief 获取与当前连接关联的上下文（每种类型各一个，首次获取时创建）
              * @tparam T 上下文类型
              * @return T& 上下文对象引用
+             * @note 已创建时不加锁，可以在每次消息回调中调用
             */
             template <typename T>
             T& getContext()
             {
-                std::lock_guard<std::mutex> lock(m_ctxMutex);
                 return m_ctx.context<T>();
             }
 
+            /**
+             * @brief 获取库内部模块（如HTTP）使用的上下文，与getContext()互不干扰
+             * @tparam T 上下文类型
+             * @return T& 上下文对象引用
+             * @note AutoContext自身是线程安全的，这里不再额外加锁
+            */
+            template <typename T>
+            T& getInternalContext()
+            {
+                return m_internalCtx.context<T>();
+            }
+
             /**
              * @brief 获取当前连接所属的事件循环
              * @return EventBase* 事件循环对象指针
@@ -109,14 +150,10 @@ namespace handy
             EventBase* getBase() const {return m_base; }
 
             /**
-             * @brief 获取当前连接状态
+             * @brief 获取当前连接状态（线程安全）
              * @return State 当前连接状态
             */
-            State getState() const
-            {
-                std::lock_guard<std::mutex> lock(m_stateMutex);
-                return m_state;
-            }
+            State getState() const { return m_state.load(std::memory_order_acquire); }
 
             /**
              * @brief 获取输入缓冲区
@@ -137,14 +174,10 @@ namespace handy
             Channel* getChannel() const {return m_channel; }
 
             /**
-             * @brief 判断当前连接是否可写
+             * @brief 判断当前连接是否在等待可写事件（需在事件循环线程中调用）
              * @return bool true: 可写, false: 不可写
             */
-            bool isWritable() const
-            {
-                std::lock_guard<std::mutex> lk(m_ChannelMutex);
-                return m_channel ? m_channel->isWritable() : false;
-            }
+            bool isWritable() const { return m_channel ? m_channel->isWritable() : false; }
 
             /**
              * @brief 发送输出缓冲区中的数据
@@ -154,6 +187,7 @@ namespace handy
             /**
              * @brief 发送缓冲区中的数据
              * @param msg 待发送的缓冲区
+             * @note 在其他线程中调用时，数据被拷贝后转交给事件循环线程发送，下同
             */
             void send(Buffer& msg);
 
@@ -180,56 +214,126 @@ namespace handy
             /**
              * @brief 设置数据到达(TCP缓冲区可写)时的回调函数
              * @param cb 回调函数
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
+             * @note 回调不加锁保护，需在连接开始处理事件前（事件循环启动前或在事件循环线程中）设置，
+             *       且不能在该回调执行期间替换它自身，onWritable()/onState()同理
             */
-            void onReadable(const TcpCallBack& cb)
+            void onReadable(const TcpCallBack& cb, CallSite site = CallSite::current())
             {
-                std::lock_guard<std::mutex> lock(m_callBacksMutex);
                 // 断言当前没有已注册的读回调（m_readcb 为空），防止重复注册
                 assert(!m_readCB);
                 m_readCB = cb;
+                m_readSite = site;
             }
 
             /**
              * @brief 设置TCP缓冲区可写时的回调函数
              * @param cb 回调函数
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
             */
-            void onWritable(const TcpCallBack& cb)
+            void onWritable(const TcpCallBack& cb, CallSite site = CallSite::current())
             {
-                std::lock_guard<std::mutex> lock(m_callBacksMutex);
                 if(m_writeCB)
                 {
                     WARN("OnWritable callback is being overwritten");
                 }
                 m_writeCB = cb;
+                m_writeSite = site;
             }
 
             /**
              * @brief 设置TCP状态改变时的回调函数
              * @param cb 回调函数
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
             */
-            void onState(const TcpCallBack& cb)
+            void onState(const TcpCallBack& cb, CallSite site = CallSite::current())
             {
-                std::lock_guard<std::mutex> lock(m_callBacksMutex);
                 if(m_stateCB)
                 {
                     WARN("OnState callback is being overwritten");
                 }
                 m_stateCB = cb;
+                m_stateSite = site;
+            }
+
+            /**
+             * @brief 设置输出缓冲区的高、低水位（需在事件循环线程中调用，或在连接开始处理事件前设置）
+             * @details 1. 输出缓冲区中待发送的数据增长到高水位时触发onHighWater回调，
+             *             之后回落到低水位及以下时触发onLowWater回调（每次穿越只触发一次）
+             *          2. pauseRead为true时，超过高水位期间暂停读取该连接，回落到低水位后恢复，
+             *             用于代理类应用把下游的慢速传导给上游（数据留在内核缓冲区中，由TCP流量控制限速）
+             * @param high 高水位（字节，0表示关闭水位检查）
+             * @param low 低水位（字节，应小于high）
+             * @param pauseRead 超过高水位时是否暂停读取
+            */
+            void setWaterMarks(size_t high, size_t low, bool pauseRead = false)
+            {
+                m_highWater = high;
+                m_lowWater = low < high ? low : high;
+                m_pauseReadOnHigh = pauseRead;
+            }
+
+            /**
+             * @brief 设置输出缓冲区达到高水位时的回调函数
+             * @param cb 回调函数
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
+            */
+            void onHighWater(const TcpCallBack& cb, CallSite site = CallSite::current())
+            {
+                m_highWaterCB = cb;
+                m_highWaterSite = site;
+            }
+
+            /**
+             * @brief 设置输出缓冲区从高水位回落到低水位时的回调函数
+             * @param cb 回调函数
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
+            */
+            void onLowWater(const TcpCallBack& cb, CallSite site = CallSite::current())
+            {
+                m_lowWaterCB = cb;
+                m_lowWaterSite = site;
             }
 
             /**
-             * @brief 添加空闲回调函数
-             * @param idle_ms 空闲时间（毫秒）
+             * @brief 设置输出缓冲区的上限（需在事件循环线程中调用，或在连接开始处理事件前设置）
+             * @details 对端长时间不读取、待发送的数据超过上限时，丢弃缓冲的数据、立即关闭写方向并关闭连接，
+             *          记录告警并计入handy_tcp_output_overflows_total；之后到连接关闭前发送的数据全部丢弃
+             * @param limit 上限（字节，0表示不限制，默认不限制）
+            */
+            void setOutputLimit(size_t limit) { m_outputLimit = limit; }
+
+            /**
+             * @brief 输入缓冲区改用环形模式（需在事件循环线程中调用，通常在连接建立时设置）
+             * @details 持续缓冲几KB不完整消息的连接上，普通缓冲区每次读取前都要memmove未读数据，
+             *          环形模式下读取与消费都不移动数据，见Buffer::enableRing
+             * @param cap 初始容量（字节，0表示按输入缓冲区的期望增长大小）
+             * @return bool 成功返回true，平台不支持或映射失败时返回false（继续使用普通缓冲区）
+            */
+            bool setRingInput(size_t cap = 0) { return m_inputBuffer.enableRing(cap); }
+
+            /**
+             * @brief 开启/关闭TCP_CORK（需在事件循环线程中调用）
+             * @details 在多段send()之前开启、之后关闭，多段数据被合并成尽量少的报文段；关闭时立即发出积攒的数据
+             * @param on true：开启，false：关闭
+             * @return bool 设置成功返回true，连接已关闭或设置失败返回false
+            */
+            bool setCork(bool on) { return m_channel && m_channel->getFd() >= 0 && Net::setCork(m_channel->getFd(), on); }
+
+            /**
+             * @brief 添加空闲回调函数（需在事件循环线程中调用）
+             * @param idle_s 空闲时间（秒）
              * @param cb 回调函数
             */
-            void addIdleCB(int idle_ms, const TcpCallBack& cb);
+            void addIdleCB(int idle_s, const TcpCallBack& cb);
 
             /**
              * @brief 设置消息回调函数，与onReadable回调冲突，只能调用一个
              * @param codec 编解码器，所有权将转移给当前对象
              * @param cb 消息回调函数
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
             */
-            void onMsg(std::unique_ptr<CodecBase> codec, const MsgCallBack& cb);
+            void onMsg(std::unique_ptr<CodecBase> codec, const MsgCallBack& cb, CallSite site = CallSite::current());
 
             /**
              * @brief 发送消息（通过编解码器编码后发送）
@@ -238,7 +342,7 @@ namespace handy
             void sendMsg(const Slice& msg);
 
             /**
-             * @brief 关闭连接（在下一个事件循环中处理）
+             * @brief 关闭连接（线程安全，总是通过safeCall()在事件循环线程中处理）
             */
             void close();
 
@@ -248,12 +352,11 @@ namespace handy
             */
             void setReconnectInterval(int intervalTime_ms)
             {
-                std::lock_guard<std::mutex> lock(m_intervalMutex);
-                m_reconnectInterval_ms = intervalTime_ms;
+                m_reconnectInterval_ms.store(intervalTime_ms, std::memory_order_relaxed);
             }
 
             /**
-             * @brief 立即关闭连接，清理相关资源
+             * @brief 立即关闭连接，清理相关资源（需在事件循环线程中调用）
              * @note 慎用，可能导致该连接的引用计数变为0，从而使得连接被析构
             */
             void closeNow();
@@ -264,6 +367,16 @@ namespace handy
             */
             void cleanup(const TcpConnPtr& conn);
 
+            /**
+             * @brief 把空闲的连接迁移到另一个事件循环（需在当前事件循环线程中调用）
+             * @details fd从当前Poller中移除后，由目标事件循环在其线程中重新注册，空闲回调随之迁移；
+             *          迁移期间到达的数据留在内核缓冲区中，注册完成后照常读取
+             * @param target 目标事件循环
+             * @return bool true：已开始迁移；false：连接未处于已连接状态、输出缓冲区非空或目标无效
+             * @note 迁移期间不能有其他线程调用该连接的send()/close()
+            */
+            bool migrate(EventBase* target);
+
             /**
              * @brief 获取远程地址的字符串表示
              * @return std::string 远程地址字符串
@@ -281,30 +394,47 @@ namespace handy
 
         private:
             EventBase* m_base;                      // 所属的事件循环
-            Channel* m_channel;                     // 关联的事件通道
-            mutable std::mutex m_ChannelMutex;      // 保护m_channel的互斥锁
+            Channel* m_channel;                     // 关联的事件通道（只在事件循环线程中访问）
             Buffer m_inputBuffer;                   // 输入缓冲区
             Buffer m_outputBuffer;                  // 输出缓冲区
             Ipv4Addr m_local = Ipv4Addr(0);                       // 本地地址
             Ipv4Addr m_peer = Ipv4Addr(0);                        // 对端地址
-            State m_state;                          // 连接状态
-            mutable std::mutex m_stateMutex;        // 保护m_state的互斥锁
+            std::atomic<State> m_state;             // 连接状态（只在事件循环线程中修改，其他线程可以读取）
             TcpCallBack m_readCB;                   // 读回调函数
             TcpCallBack m_writeCB;                  // 写回调函数
             TcpCallBack m_stateCB;                  // 状态变更回调函数
-            mutable std::mutex m_callBacksMutex;    // 保护回调函数的互斥锁
-            std::list<IdleId> m_idleIds;            // 空闲回调ID列表
+            TcpCallBack m_highWaterCB;              // 输出缓冲区达到高水位的回调函数
+            TcpCallBack m_lowWaterCB;               // 输出缓冲区回落到低水位的回调函数
+            CallSite m_readSite;                    // 读回调（或消息回调）的注册位置
+            CallSite m_writeSite;                   // 写回调的注册位置
+            CallSite m_stateSite;                   // 状态变更回调的注册位置
+            CallSite m_highWaterSite;               // 高水位回调的注册位置
+            CallSite m_lowWaterSite;                // 低水位回调的注册位置
+            size_t m_highWater;                     // 输出缓冲区高水位（字节，0表示不检查）
+            size_t m_lowWater;                      // 输出缓冲区低水位（字节）
+            size_t m_outputLimit;                   // 输出缓冲区上限（字节，0表示不限制）
+            size_t m_reportedOutput;                // 已计入handy_tcp_output_buffered_bytes的字节数
+            bool m_pauseReadOnHigh;                 // 超过高水位时暂停读取
+            bool m_aboveHighWater;                  // 输出缓冲区处于高水位之上（尚未回落到低水位）
+            bool m_readPaused;                      // 因超过高水位而暂停了读取
+            bool m_outputOverflow;                  // 输出缓冲区超过上限，连接正在关闭（之后发送的数据全部丢弃）
+            int m_callBackDepth;                    // 正在执行的回调层数（回调中可能再次触发回调）
+            bool m_releaseCallBacks;                // 回调执行期间连接被清理，待最外层回调返回后释放回调
+            IdleNode m_idleNode;                    // 空闲链表节点（第一个空闲回调，内嵌避免额外分配）
+            std::list<IdleNode> m_extraIdleNodes;   // 其余空闲回调的链表节点
             TimerId m_timeoutId;                    // 超时ID
             AutoContext m_ctx;                      // 上下文对象
             AutoContext m_internalCtx;              // 内部上下文对象
-            mutable std::mutex m_ctxMutex;          // 保护上下文对象的互斥锁
             std::string m_destHost;                 // 目标主机地址
             std::string m_localIp;                  // 本地IP地址
             int m_destPort;                         // 目标端口
+            SocketOptions m_sockOpts;               // 客户端连接的Socket调优选项
             int m_connectTimeout_ms;                   // 连接超时时间
-            int m_reconnectInterval_ms;                // 重连间隔时间
-            mutable std::mutex m_intervalMutex;     // 重连间隔的互斥锁
+            std::atomic<int> m_reconnectInterval_ms;   // 重连间隔时间
             int64_t m_connectedTime_ms;                // 连接建立时间
+            uint64_t m_connectSeq;                  // 发起连接的轮次（丢弃过期的名字解析结果）
+            EventBase* m_loadBase;                  // 计入了该连接的事件循环（LoopStats::connections）
+            std::shared_ptr<std::atomic<int>> m_serverLive; // 所属TcpServer的存活连接计数（仅被动连接，关闭时减一）
             std::unique_ptr<CodecBase> m_codec;     // 编解码器
 
             /**
@@ -319,6 +449,42 @@ namespace handy
             */
             void _handleWrite(const TcpConnPtr& conn);
 
+            /**
+             * @brief 读到数据后刷新空闲回调的计时
+            */
+            void _touchIdle();
+
+            /**
+             * @brief 执行回调函数
+             * @details 1. 回调直接在原对象上执行，不做拷贝；回调期间连接被清理时，
+             *             回调对象的释放推迟到最外层回调返回之后
+             *          2. 回调单独计时，执行过慢时按用户的注册位置告警
+             * @param cb 回调函数（非空）
+             * @param site 回调的注册位置
+             * @param kind 回调类型（用于慢回调告警）
+             * @param conn 当前连接的智能指针
+            */
+            void _runCallBack(const TcpCallBack& cb, const CallSite& site, const char* kind, const TcpConnPtr& conn);
+
+            /**
+             * @brief 释放读、写、状态回调函数
+            */
+            void _releaseCallBacks();
+
+            /**
+             * @brief 输出缓冲区的大小变化后调用：更新统计，检查上限与高、低水位
+            */
+            void _updateOutput()
+            {
+                if(m_outputBuffer.size() != m_reportedOutput)
+                    _checkOutput();
+            }
+
+            /**
+             * @brief _updateOutput()的实现（输出缓冲区大小有变化时才调用）
+            */
+            void _checkOutput();
+
             /**
              * @brief 发送数据的内部实现
              * @param buf 数据缓冲区指针
@@ -329,6 +495,7 @@ namespace handy
 
             /**
              * @brief 主动连接到指定的主机和端口
+             * @details 主机名经Resolver异步解析（IP地址字面量与缓存命中除外），解析期间连接处于HAND_SHAKING状态
              * @param base 事件循环
              * @param peerHost 目标主机名或IP地址
              * @param peerPort 目标端口号
@@ -338,11 +505,23 @@ namespace handy
             void _connect(EventBase* base, const std::string& peerHost, unsigned short peerPort, 
                             int timeout_ms, const std::string& localIp);
 
+            /**
+             * @brief 创建socket并向已解析的地址发起非阻塞连接
+             * @param addr 目标地址
+            */
+            void _connectTo(const Ipv4Addr& addr);
+
             /**
              * @brief 重连
             */
             void _reconnect();
 
+            /**
+             * @brief 迁移的后半部分：在目标事件循环线程中接管fd
+             * @param fd 从原事件循环交出的fd
+            */
+            void _adopt(int fd);
+
             /**
              * @brief 读取数据的内部实现
              * @param fd 文件描述符
@@ -395,6 +574,8 @@ namespace handy
              * @param port 端口号
              * @param isReusePort 是否启用端口复用
              * @return int 0：成功，<0：失败
+             * @note 平滑重启时优先使用上一个进程通过Daemon::handoff()交接过来的同地址监听Socket，
+             *       监听Socket会登记到Daemon，以便再交给下一个进程
             */
             int bind(const std::string& host, unsigned short port, bool isReusePort = false);
 
@@ -421,11 +602,37 @@ namespace handy
             */
             EventBase* getBase() const { return m_base; }
 
+            /**
+             * @brief 为之后接受的连接开启SO_BUSY_POLL（驱动层忙轮询，降低接收延迟）
+             * @param busyPoll_us 忙轮询时间（微秒，0表示不设置）
+             * @note 通常与EventBase::setBusyPoll()配合使用；设置失败（如缺少CAP_NET_ADMIN权限）时记录一次警告，
+             *       之后接受的连接不再尝试，再次调用本函数后重新尝试
+            */
+            void setBusyPoll(int busyPoll_us) { m_busyPoll_us = busyPoll_us; }
+
+            /**
+             * @brief 设置Socket调优选项：监听Socket适用的选项在bind()中应用，其余的应用到之后接受的每个连接
+             * @param opts 调优选项
+             * @note 需在bind()之前调用
+            */
+            void setSocketOptions(const SocketOptions& opts) { m_sockOpts = opts; }
+
             /**
              * @brief 设置连接创建时的回调函数
              * @param cb 回调函数，返回新创建的连接
+             * @note 默认使用TcpConn::create()，从连接所属事件循环的对象池中分配
             */
             void onConnCreate(const std::function<TcpConnPtr()>& cb)
+            {
+                std::lock_guard<std::mutex> lock(m_callBacksMutex);
+                m_createCB = [cb](EventBase*) { return cb(); };
+            }
+
+            /**
+             * @brief 设置连接创建时的回调函数（回调参数为连接将要使用的事件循环，在该事件循环线程中调用）
+             * @param cb 回调函数，返回新创建的连接（可以用TcpConn::create<C>(base)从对象池中分配）
+            */
+            void onConnCreate(const std::function<TcpConnPtr(EventBase*)>& cb)
             {
                 std::lock_guard<std::mutex> lock(m_callBacksMutex);
                 m_createCB = cb;
@@ -434,37 +641,57 @@ namespace handy
             /**
              * @brief 设置连接状态改变时的回调函数
              * @param cb 回调函数
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
             */
-            void onConnState(const TcpCallBack& cb)
+            void onConnState(const TcpCallBack& cb, CallSite site = CallSite::current())
             {
                 std::lock_guard<std::mutex> lock(m_callBacksMutex);
                 m_stateCB = cb;
+                m_stateSite = site;
             }
 
             /**
              * @brief 设置连接可读时的回调函数
              * @param cb 回调函数
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
              * @note 与onConnMsg冲突，只能调用一个
             */
-            void onConnRead(const TcpCallBack& cb)
+            void onConnRead(const TcpCallBack& cb, CallSite site = CallSite::current())
             {
                 std::lock_guard<std::mutex> lock(m_callBacksMutex);
                 m_readCB = cb;
+                m_readSite = site;
             }
 
             /**
              * @brief 设置消息处理的回调函数
              * @param codec 消息编解码器，所有权转移给TcpServer
              * @param cb 回调函数
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
              * @note 与onConnRead冲突，只能调用一个
             */
-            void onConnMsg(std::unique_ptr<CodecBase> codec, const MsgCallBack& cb)
+            void onConnMsg(std::unique_ptr<CodecBase> codec, const MsgCallBack& cb, CallSite site = CallSite::current())
             {
                 std::lock_guard<std::mutex> lock(m_callBacksMutex);
                 m_codec = std::move(codec);
                 m_msgCB = cb;
+                m_readSite = site;
                 assert(!m_readCB);
             }
+
+            /**
+             * @brief 停止接受新连接，等待已接受的连接全部关闭后调用cb（平滑重启时旧进程调用）
+             * @param timeout_ms 最长等待时间（毫秒），超时后不再等待，直接调用cb
+             * @param cb 回调函数（在监听事件循环线程中调用，通常在其中退出事件循环）
+             * @note 1. 监听Socket已通过Daemon::handoff()交给新进程时，排队中和之后的连接由新进程接受
+             * @note 2. 已有连接照常收发数据，由对端或业务逻辑关闭；TcpServer需存活到cb被调用
+            */
+            void drain(int timeout_ms, const std::function<void()>& cb);
+
+            /**
+             * @brief 获取当前存活的被动连接数
+            */
+            int liveConnections() const { return m_live->load(std::memory_order_relaxed); }
         private:
             EventBase* m_base;                      // 事件循环对象
             EventBases* m_bases;                    // 事件循环对象组
@@ -474,14 +701,38 @@ namespace handy
             TcpCallBack m_stateCB;                  // 连接状态回调函数
             TcpCallBack m_readCB;                   // 读事件回调函数
             MsgCallBack m_msgCB;                    // 消息回调函数
-            std::function<TcpConnPtr()> m_createCB; // 连接创建回调函数
+            CallSite m_stateSite;                   // 连接状态回调的注册位置
+            CallSite m_readSite;                    // 读事件回调（或消息回调）的注册位置
+            std::function<TcpConnPtr(EventBase*)> m_createCB;   // 连接创建回调函数
             std::unique_ptr<CodecBase> m_codec;     // 编解码器
             mutable std::mutex m_callBacksMutex;    // 回调函数的互斥锁
+            std::atomic<int> m_busyPoll_us{0};      // 接受的连接的SO_BUSY_POLL时间（微秒，0表示不设置）
+            SocketOptions m_sockOpts;               // Socket调优选项（bind()之后只读）
+            std::shared_ptr<std::atomic<int>> m_live;   // 存活的被动连接数（连接可能比服务器存活得久，共享所有权）
 
             /**
              * @brief 处理接受连接事件
             */
             void _handleAccept();
+
+            /**
+             * @brief 为监听fd创建监听通道，并登记为可交接的监听fd
+             * @param fd 监听fd
+             * @param key 监听地址（如"tcp:127.0.0.1:8080"）
+            */
+            void _listen(int fd, const std::string& key);
+
+            /**
+             * @brief 关闭监听通道并注销可交接的监听fd
+            */
+            void _closeListen();
+
+            /**
+             * @brief 检查连接是否已全部关闭，未关闭且未超时则10ms后再检查
+             * @param deadline_ms 截止时间（毫秒时间戳）
+             * @param cb 全部关闭或超时后调用的回调函数
+            */
+            void _checkDrained(int64_t deadline_ms, const std::function<void()>& cb);
     };
 
     /**
@@ -0,0 +1,567 @@
+/**
+ * @file coro.h
+ * @brief 基于C++20协程的可等待接口（可选）：在EventBase与TcpConn之上用co_await代替嵌套回调
+ * @details 1. 库本身仍按C++17编译，只有包含本头文件的代码需要-std=c++20；本文件只有头文件，不需要额外链接
+ *          2. 协程由连接的回调与定时器直接恢复（读回调、可写回调、状态回调、runAfter），不经过safeCall队列
+ *          3. 协程帧从事件循环的对象池（BlockPool）中分配：协程参数中有EventBase*、TcpConnPtr或co::Conn，
+ *             且在该事件循环线程中创建时使用其对象池，否则使用全局堆
+ * @note 所有接口都需要在连接所属的事件循环线程中使用；事件循环退出后，仍在等待的协程不会再被恢复
+*/
+#pragma once
+#if __cplusplus < 202002L || !defined(__cpp_impl_coroutine)
+#error "coro.h requires C++20 coroutines (compile with -std=c++20)"
+#endif
+
+#include "conn.h"
+#include "logger.h"
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+// GCC会把协程帧的带参数operator new与promise的operator delete误报为不匹配（-Wmismatched-new-delete），
+// 告警位置在使用者的协程函数中，只能对包含本文件的编译单元整体关闭
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace handy
+{
+    namespace co
+    {
+        class Conn;
+
+        namespace detail
+        {
+            // 协程帧头部：记录分配来源（对象池或全局堆）与大小，释放时据此归还
+            struct alignas(std::max_align_t) FrameHeader
+            {
+                BlockPool* pool;
+                size_t size;
+            };
+
+            inline EventBase* baseOf(EventBase* base) { return base; }
+            inline EventBase* baseOf(EventBase& base) { return &base; }
+            inline EventBase* baseOf(const TcpConnPtr& conn) { return conn ? conn->getBase() : nullptr; }
+            EventBase* baseOf(const Conn& conn);
+            template <typename T>
+            EventBase* baseOf(const T&) { return nullptr; }
+
+            // 取第一个能确定事件循环的协程参数
+            inline EventBase* findBase() { return nullptr; }
+            template <typename First, typename... Rest>
+            EventBase* findBase(First& first, Rest&... rest)
+            {
+                EventBase* base = baseOf(first);
+                return base ? base : findBase(rest...);
+            }
+
+            /**
+             * @brief 各种协程promise的公共部分：帧分配
+            */
+            struct PromiseBase
+            {
+                template <typename... Args>
+                static void* operator new(size_t size, Args&... args)
+                {
+                    EventBase* base = findBase(args...);
+                    BlockPool* pool = base ? base->getLocalPool() : nullptr;
+                    size_t total = size + sizeof(FrameHeader);
+                    void* p = pool ? pool->allocate(total) : ::operator new(total);
+                    FrameHeader* header = ::new (p) FrameHeader{pool, total};
+                    return header + 1;
+                }
+
+                static void operator delete(void* p) noexcept
+                {
+                    FrameHeader* header = static_cast<FrameHeader*>(p) - 1;
+                    if(header->pool)
+                        header->pool->deallocate(header, header->size);
+                    else
+                        ::operator delete(header);
+                }
+
+                // 与带参数的operator new配对（协程帧构造抛出异常时使用）
+                template <typename... Args>
+                static void operator delete(void* p, Args&...) noexcept
+                {
+                    operator delete(p);
+                }
+            };
+        }   // namespace detail
+
+        /**
+         * @class Task
+         * @brief 协程任务：创建后不立即执行，被co_await（或交给spawn()）时开始执行
+         * @tparam T 返回值类型
+         * @note 异常在co_await处重新抛出；交给spawn()的任务中未捕获的异常记录错误日志后丢弃
+        */
+        template <typename T = void>
+        class [[nodiscard]] Task
+        {
+            public:
+                struct promise_type;
+                using Handle = std::coroutine_handle<promise_type>;
+
+                // 结束时把控制权交回等待者（对称转移，不增加调用栈深度）；分离的任务直接销毁自身
+                struct FinalAwaiter
+                {
+                    bool await_ready() const noexcept { return false; }
+                    std::coroutine_handle<> await_suspend(Handle h) noexcept
+                    {
+                        promise_type& p = h.promise();
+                        if(p.detached)
+                        {
+                            h.destroy();
+                            return std::noop_coroutine();
+                        }
+                        return p.continuation ? p.continuation : std::noop_coroutine();
+                    }
+                    void await_resume() const noexcept {}
+                };
+
+                struct PromiseCommon : detail::PromiseBase
+                {
+                    std::coroutine_handle<> continuation;   // 等待该任务的协程
+                    std::exception_ptr error;               // 未捕获的异常
+                    bool detached = false;                  // 是否由spawn()启动（结束时自行销毁）
+
+                    std::suspend_always initial_suspend() noexcept { return {}; }
+                    FinalAwaiter final_suspend() noexcept { return {}; }
+                    void unhandled_exception()
+                    {
+                        if(!detached)
+                        {
+                            error = std::current_exception();
+                            return;
+                        }
+                        try
+                        {
+                            throw;
+                        }
+                        catch(const std::exception& e)
+                        {
+                            ERROR("Detached coroutine exited with exception: %s", e.what());
+                        }
+                        catch(...)
+                        {
+                            ERROR("Detached coroutine exited with unknown exception");
+                        }
+                    }
+                };
+
+                struct ValuePromise : PromiseCommon
+                {
+                    std::optional<T> value;
+                    template <typename U>
+                    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+                };
+
+                struct VoidPromise : PromiseCommon
+                {
+                    void return_void() noexcept {}
+                };
+
+                struct promise_type : std::conditional_t<std::is_void_v<T>, VoidPromise, ValuePromise>
+                {
+                    Task get_return_object() { return Task(Handle::from_promise(*this)); }
+                };
+
+                Task() = default;
+                explicit Task(Handle h) : m_handle(h) {}
+                Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+                Task& operator=(Task&& other) noexcept
+                {
+                    if(this != &other)
+                    {
+                        if(m_handle)
+                            m_handle.destroy();
+                        m_handle = std::exchange(other.m_handle, nullptr);
+                    }
+                    return *this;
+                }
+                Task(const Task&) = delete;
+                Task& operator=(const Task&) = delete;
+                ~Task()
+                {
+                    if(m_handle)
+                        m_handle.destroy();
+                }
+
+                bool await_ready() const noexcept { return !m_handle || m_handle.done(); }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+                {
+                    m_handle.promise().continuation = caller;
+                    return m_handle;
+                }
+
+                T await_resume()
+                {
+                    promise_type& p = m_handle.promise();
+                    if(p.error)
+                        std::rethrow_exception(p.error);
+                    if constexpr(!std::is_void_v<T>)
+                        return std::move(*p.value);
+                }
+
+                /**
+                 * @brief 交出协程句柄（之后由调用者负责销毁）
+                */
+                Handle release() noexcept { return std::exchange(m_handle, nullptr); }
+
+            private:
+                Handle m_handle;
+        };
+
+        /**
+         * @brief 立即开始执行任务，不等待它结束（任务结束时自行释放）
+         * @param task 要执行的任务
+        */
+        inline void spawn(Task<void>&& task)
+        {
+            Task<void>::Handle h = task.release();
+            if(!h)
+                return;
+            h.promise().detached = true;
+            h.resume();
+        }
+
+        /**
+         * @brief 等待指定时间（由定时器直接恢复）
+         * @param base 当前协程所在的事件循环
+         * @param ms 等待时间（毫秒）
+        */
+        inline auto sleep(EventBase* base, int64_t ms)
+        {
+            struct Awaiter
+            {
+                EventBase* base;
+                int64_t ms;
+                bool await_ready() const noexcept { return ms <= 0; }
+                void await_suspend(std::coroutine_handle<> h) { base->runAfter(ms, [h]{ h.resume(); }); }
+                void await_resume() const noexcept {}
+            };
+            return Awaiter{base, ms};
+        }
+
+        /**
+         * @class Conn
+         * @brief TcpConn的协程封装：read()/readMsg()/write()等待连接事件，由连接的回调直接恢复
+         * @details 1. 封装接管连接的读、可写与状态回调（在连接创建时一次性设置，之后不再替换）
+         *          2. 同一时刻每个方向只能有一个协程在等待（一个读者、一个写者）
+         *          3. 析构时关闭连接（可以先release()交出连接）
+        */
+        class Conn
+        {
+            public:
+                Conn() = default;
+                Conn(Conn&&) noexcept = default;
+                Conn& operator=(Conn&& other) noexcept
+                {
+                    if(this != &other)
+                    {
+                        close();
+                        m_conn = std::move(other.m_conn);
+                        m_state = std::move(other.m_state);
+                    }
+                    return *this;
+                }
+                Conn(const Conn&) = delete;
+                Conn& operator=(const Conn&) = delete;
+                ~Conn() { close(); }
+
+                /**
+                 * @brief 获取底层连接
+                */
+                const TcpConnPtr& get() const { return m_conn; }
+                TcpConn* operator->() const { return m_conn.get(); }
+
+                /**
+                 * @brief 获取连接所属的事件循环
+                */
+                EventBase* getBase() const { return m_conn ? m_conn->getBase() : nullptr; }
+
+                /**
+                 * @brief 连接是否已建立且未关闭
+                */
+                bool connected() const { return m_conn && m_conn->getState() == TcpConn::State::CONNECTED; }
+
+                /**
+                 * @brief 关闭连接（仍在等待的协程以"连接已关闭"的结果恢复）
+                */
+                void close()
+                {
+                    if(m_conn && m_conn->getState() != TcpConn::State::CLOSED && m_conn->getState() != TcpConn::State::FAILED)
+                        m_conn->close();
+                }
+
+                /**
+                 * @brief 交出底层连接（之后析构不再关闭它，回调仍由本封装接管）
+                */
+                TcpConnPtr release()
+                {
+                    m_state.reset();
+                    return std::move(m_conn);
+                }
+
+                /**
+                 * @brief 等待新数据到达
+                 * @return size_t 输入缓冲区中的字节数（数据留在get()->getInputBuffer()中，由调用者消费），
+                 *                0表示连接已关闭
+                 * @note 上一次等待之后已经到达的数据不需要再等待
+                */
+                auto read()
+                {
+                    struct Awaiter
+                    {
+                        State* st;
+                        TcpConn* conn;
+                        bool await_ready()
+                        {
+                            st->consumeMsg(conn);
+                            return st->readable || st->closed;
+                        }
+                        void await_suspend(std::coroutine_handle<> h) { st->reader = h; }
+                        size_t await_resume()
+                        {
+                            st->readable = false;
+                            return st->closed && conn->getInputBuffer().empty() ? 0 : conn->getInputBuffer().size();
+                        }
+                    };
+                    return Awaiter{m_state.get(), m_conn.get()};
+                }
+
+                /**
+                 * @brief 等待并解码一条完整的消息
+                 * @param codec 编解码器（只用于解码，需在等待期间保持有效）
+                 * @return std::optional<Slice> 消息内容（指向输入缓冲区，下一次read()/readMsg()之前有效），
+                 *                              连接已关闭或解码出错（连接随之关闭）时为空
+                */
+                auto readMsg(CodecBase& codec)
+                {
+                    struct Awaiter
+                    {
+                        State* st;
+                        TcpConn* conn;
+                        CodecBase* codec;
+                        bool await_ready()
+                        {
+                            st->consumeMsg(conn);
+                            st->msg.reset();
+                            return st->decode(conn, codec) || st->closed;
+                        }
+                        void await_suspend(std::coroutine_handle<> h)
+                        {
+                            st->codec = codec;
+                            st->reader = h;
+                        }
+                        std::optional<Slice> await_resume()
+                        {
+                            st->codec = nullptr;
+                            st->readable = false;
+                            return st->msg;
+                        }
+                    };
+                    return Awaiter{m_state.get(), m_conn.get(), &codec};
+                }
+
+                /**
+                 * @brief 发送数据，等待数据全部写入内核（输出缓冲区清空）
+                 * @param data 要发送的数据（立即复制到输出缓冲区）
+                 * @return bool true：已全部写入内核，false：连接已关闭
+                */
+                auto write(Slice data)
+                {
+                    struct Awaiter
+                    {
+                        State* st;
+                        TcpConn* conn;
+                        Slice data;
+                        bool await_ready()
+                        {
+                            if(st->closed)
+                                return true;
+                            conn->send(data.data(), data.size());
+                            return conn->getOutputBuffer().empty();
+                        }
+                        void await_suspend(std::coroutine_handle<> h) { st->writer = h; }
+                        bool await_resume() const { return !st->closed; }
+                    };
+                    return Awaiter{m_state.get(), m_conn.get(), data};
+                }
+
+                /**
+                 * @brief 编码并发送一条消息，等待数据全部写入内核
+                 * @param codec 编解码器
+                 * @param msg 消息内容
+                 * @return bool true：已全部写入内核，false：连接已关闭
+                */
+                auto writeMsg(CodecBase& codec, Slice msg)
+                {
+                    Buffer buf;
+                    codec.encode(msg, buf);
+                    m_state->encoded = std::string(buf.peek(), buf.size());
+                    return write(m_state->encoded);
+                }
+
+                /**
+                 * @brief 发起连接，等待连接建立或失败
+                 * @param base 当前协程所在的事件循环
+                 * @param host 目标主机名或IP地址
+                 * @param port 目标端口
+                 * @param timeout_ms 连接超时时间（0表示不超时）
+                 * @return Conn 连接（用connected()判断是否成功）
+                */
+                static auto connect(EventBase* base, const std::string& host, unsigned short port, int timeout_ms = 0)
+                {
+                    struct Awaiter
+                    {
+                        EventBase* base;
+                        std::string host;
+                        unsigned short port;
+                        int timeout_ms;
+                        Conn conn;
+                        bool await_ready() const noexcept { return false; }
+                        bool await_suspend(std::coroutine_handle<> h)
+                        {
+                            conn = Conn(TcpConn::createConnection(base, host, port, timeout_ms));
+                            TcpConn::State s = conn->getState();
+                            if(s == TcpConn::State::HAND_SHAKING)
+                            {
+                                conn.m_state->connector = h;
+                                return true;
+                            }
+                            // 创建时已经失败（状态回调设置之前）
+                            conn.m_state->closed = s != TcpConn::State::CONNECTED;
+                            return false;
+                        }
+                        Conn await_resume() { return std::move(conn); }
+                    };
+                    return Awaiter{base, host, port, timeout_ms, Conn()};
+                }
+
+                /**
+                 * @brief 让服务器的每个连接都由一个协程处理
+                 * @param server 服务器
+                 * @param handler 处理函数：连接建立时调用，返回的协程交给spawn()执行
+                 * @note 会替换服务器的onConnCreate回调，不能再设置onConnState/onConnRead/onConnMsg
+                */
+                template <typename Handler>
+                static void serve(const TcpServer::Ptr& server, Handler handler)
+                {
+                    server->onConnCreate([handler](EventBase* base) {
+                        TcpConnPtr conn = TcpConn::create(base);
+                        std::shared_ptr<State> st = _attach(conn);
+                        st->onConnected = [handler](const TcpConnPtr& c) { spawn(handler(Conn(c, false))); };
+                        return conn;
+                    });
+                }
+
+                /**
+                 * @brief 封装一个刚创建、尚未开始处理事件的连接（接管它的回调）
+                 * @param conn 连接
+                */
+                explicit Conn(const TcpConnPtr& conn) : m_conn(conn), m_state(_attach(conn)) {}
+
+            private:
+                // 等待中的协程与读写状态（由连接的回调共享）
+                struct State
+                {
+                    std::coroutine_handle<> reader;     // 等待读的协程
+                    std::coroutine_handle<> writer;     // 等待输出缓冲区清空的协程
+                    std::coroutine_handle<> connector;  // 等待连接建立的协程
+                    CodecBase* codec = nullptr;         // readMsg()使用的编解码器
+                    std::optional<Slice> msg;           // 最近解码出的消息
+                    size_t consume = 0;                 // 下一次读取前需要从输入缓冲区消费的字节数（上一条消息）
+                    bool readable = false;              // 上一次读取之后有新数据到达
+                    bool closed = false;                // 连接已关闭（或连接失败）
+                    std::string encoded;                // writeMsg()编码后的数据
+                    TcpCallBack onConnected;            // 服务端连接建立时的回调（serve()）
+
+                    void consumeMsg(TcpConn* conn)
+                    {
+                        if(consume > 0)
+                        {
+                            conn->getInputBuffer().consume(consume);
+                            consume = 0;
+                        }
+                    }
+
+                    // 尝试解码一条消息：成功时记录到msg；解码出错时关闭连接
+                    bool decode(TcpConn* conn, CodecBase* c)
+                    {
+                        Slice m;
+                        int r = c->tryDecode(conn->getInputBuffer(), m);
+                        if(r > 0)
+                        {
+                            msg = m;
+                            consume = static_cast<size_t>(r);
+                            return true;
+                        }
+                        if(r < 0)
+                        {
+                            ERROR("Coroutine readMsg: decode error %d, closing connection", r);
+                            closed = true;
+                            conn->close();
+                            return true;
+                        }
+                        return false;
+                    }
+
+                    static void resume(std::coroutine_handle<>& h)
+                    {
+                        if(h)
+                            std::exchange(h, nullptr).resume();
+                    }
+                };
+
+                TcpConnPtr m_conn;
+                std::shared_ptr<State> m_state;
+
+                Conn(const TcpConnPtr& conn, bool) : m_conn(conn), m_state(conn->getInternalContext<std::shared_ptr<State>>()) {}
+
+                // 设置连接的回调（只设置一次），回调共享同一个State
+                static std::shared_ptr<State> _attach(const TcpConnPtr& conn)
+                {
+                    std::shared_ptr<State> st = std::make_shared<State>();
+                    conn->getInternalContext<std::shared_ptr<State>>() = st;
+                    conn->onReadable([st](const TcpConnPtr& c) {
+                        if(!st->reader)
+                        {
+                            st->readable = true;
+                            return;
+                        }
+                        // readMsg()在消息完整之后才恢复
+                        if(st->codec && !st->decode(c.get(), st->codec))
+                            return;
+                        State::resume(st->reader);
+                    });
+                    conn->onWritable([st](const TcpConnPtr&) { State::resume(st->writer); });
+                    conn->onState([st](const TcpConnPtr& c) {
+                        TcpConn::State s = c->getState();
+                        if(s == TcpConn::State::CONNECTED)
+                        {
+                            if(st->onConnected)
+                                st->onConnected(c);
+                            State::resume(st->connector);
+                            return;
+                        }
+                        if(s != TcpConn::State::CLOSED && s != TcpConn::State::FAILED)
+                            return;
+                        st->closed = true;
+                        st->onConnected = nullptr;
+                        c->getInternalContext<std::shared_ptr<State>>().reset();
+                        State::resume(st->connector);
+                        State::resume(st->reader);
+                        State::resume(st->writer);
+                    });
+                    return st;
+                }
+        };
+
+        inline EventBase* detail::baseOf(const Conn& conn) { return conn.getBase(); }
+    }   // namespace co
+}   // namespace handy
@@ -12,6 +12,9 @@
 #include <unistd.h>
 #include <map>
 #include <mutex>
+#include <vector>
+
+extern char** environ;
 
 namespace handy
 {
@@ -162,9 +165,15 @@ namespace handy
             return -1;
         }
 
-        // 检查是否已有守护进程正在运行
+        // 检查是否已有守护进程正在运行（平滑重启时PID文件中是交出监听Socket的旧进程，不算冲突）
         int pid = getPidFromFile(pidFilePath); 
-        if(pid > 0)
+        const char* handoffPid = getenv(kHandoffPidEnv);
+        const bool handingOff = pid > 0 && handoffPid && atoi(handoffPid) == pid;
+        if(handingOff)
+        {
+            unsetenv(kHandoffPidEnv);
+        }
+        else if(pid > 0)
         {
             // 检查进程是否真的存在
             if(kill(pid, 0) == 0 || errno == EPERM)
@@ -177,8 +186,8 @@ namespace handy
             fprintf(stderr, "Daemon is not running, but pid file(%s) exists, remove it\n", pidFilePath);
         }
 
-        // 检查当前是否已经是守护进程
-        if(getppid() == 1)
+        // 检查当前是否已经是守护进程（平滑重启时旧进程可能已经退出，新进程被init收养）
+        if(!handingOff && getppid() == 1)
         {
             fprintf(stderr, "Already running as a daemon, cannot start again\n");
             return -1; 
@@ -259,8 +268,13 @@ namespace handy
 
         fprintf(stderr, "Start daemon process, pid=%d\n", getpid());
 
-        // 注册进程退出时删除PID文件的清理函数
-        static ExitCaller del([pidFilePath]() { unlink(pidFilePath); fprintf(stderr, "Delete pid file(%s) when exit\n", pidFilePath); });
+        // 注册进程退出时删除PID文件的清理函数（平滑重启后PID文件属于新进程，不能删除）
+        static ExitCaller del([pidFilePath]() {
+            if(getPidFromFile(pidFilePath) != getpid())
+                return;
+            unlink(pidFilePath);
+            fprintf(stderr, "Delete pid file(%s) when exit\n", pidFilePath);
+        });
 
         // while (true) {
         //     sleep(3600);  // 阻塞进程，避免退出
@@ -369,6 +383,38 @@ namespace handy
         return start(pidFilePath);
     }
 
+    int Daemon::gracefulRestart(const char* pidFilePath, int timeout_ms)
+    {
+        int pid = getPidFromFile(pidFilePath);
+        if(pid <= 0 || kill(pid, 0) < 0)
+        {
+            fprintf(stderr, "Daemon is not running, pid file(%s), cannot restart gracefully\n", pidFilePath);
+            return -1;
+        }
+
+        // 通知旧进程启动新程序并交出监听Socket
+        if(kill(pid, SIGUSR2) < 0)
+        {
+            fprintf(stderr, "Send SIGUSR2 to daemon process(pid=%d) failed: errno=%d, msg=%s\n", pid, errno, strerror(errno));
+            return -1;
+        }
+
+        // 等待新进程写入PID文件
+        for(int waited = 0; waited < timeout_ms; waited += 10)
+        {
+            usleep(10 * 1000);  // 10ms
+            int newPid = getPidFromFile(pidFilePath);
+            if(newPid > 0 && newPid != pid && kill(newPid, 0) == 0)
+            {
+                fprintf(stderr, "Daemon process(pid=%d) handed off to pid=%d\n", pid, newPid);
+                return 0;
+            }
+        }
+
+        fprintf(stderr, "Graceful restart of daemon process(pid=%d) timed out after %d ms\n", pid, timeout_ms);
+        return -1;
+    }
+
     void Daemon::process(const char* cmd, const char* pidFilePath)
     {
         if(!pidFilePath || strlen(pidFilePath) == 0) 
@@ -395,6 +441,21 @@ namespace handy
         {
             ret = restart(pidFilePath);
         }
+        else if(strcasecmp(cmd, "graceful-restart") == 0)
+        {
+            // 守护进程未运行时直接启动
+            int pid = getPidFromFile(pidFilePath);
+            if(pid > 0 && kill(pid, 0) == 0)
+            {
+                ret = gracefulRestart(pidFilePath);
+                if(ret == 0)
+                    exit(0);
+            }
+            else
+            {
+                ret = start(pidFilePath);
+            }
+        }
         else
         {
             fprintf(stderr, "Invalid daemon command: %s\n", cmd);
@@ -450,6 +511,163 @@ namespace handy
         _exit(1);
     }
 
+    namespace
+    {
+        // 本进程登记的可交接监听fd（地址 -> fd）
+        std::multimap<std::string, int> listenFds;
+        // 从上一个进程继承、尚未被取走的监听fd
+        std::multimap<std::string, int> inheritedFds;
+        // 是否已解析过继承的fd列表
+        bool inheritedParsed = false;
+        // 保护上面三者的互斥锁
+        std::mutex listenFdsMutex;
+
+        /**
+         * @brief 解析kListenFdsEnv（"key=fd;key=fd"），调用前需先加锁
+        */
+        void parseInheritedFds()
+        {
+            inheritedParsed = true;
+            const char* env = getenv(Daemon::kListenFdsEnv);
+            if(!env)
+                return;
+
+            std::string list(env);
+            // 清除环境变量，避免之后启动的子进程误用这些fd编号
+            unsetenv(Daemon::kListenFdsEnv);
+            size_t b = 0;
+            while(b < list.size())
+            {
+                size_t e = list.find(';', b);
+                if(e == std::string::npos)
+                    e = list.size();
+                size_t eq = list.rfind('=', e);
+                if(eq != std::string::npos && eq > b)
+                {
+                    int fd = atoi(list.c_str() + eq + 1);
+                    // 立即设置FD_CLOEXEC：没有被取走的fd也不会泄漏给之后exec的子进程
+                    if(fd > STDERR_FILENO && fcntl(fd, F_GETFD) >= 0)
+                    {
+                        utils::addFdFlag(fd, FD_CLOEXEC);
+                        inheritedFds.emplace(list.substr(b, eq - b), fd);
+                    }
+                }
+                b = e + 1;
+            }
+        }
+    } // namespace
+
+    pid_t Daemon::handoff(const char* argv[])
+    {
+        if(!argv || !argv[0])
+        {
+            fprintf(stderr, "Invalid arguments for handoff()\n");
+            return -1;
+        }
+
+        // fork之前准备好fd列表与环境变量，子进程中只调用异步信号安全的函数
+        std::string fdsEnv = std::string(kListenFdsEnv) + "=";
+        std::vector<int> fds;
+        {
+            std::lock_guard<std::mutex> lock(listenFdsMutex);
+            for(const auto& kv : listenFds)
+            {
+                if(!fds.empty())
+                    fdsEnv += ';';
+                fdsEnv += kv.first + "=" + std::to_string(kv.second);
+                fds.push_back(kv.second);
+            }
+        }
+        std::string pidEnv = std::string(kHandoffPidEnv) + "=" + std::to_string(getpid());
+
+        const size_t fdsNameLen = strlen(kListenFdsEnv);
+        const size_t pidNameLen = strlen(kHandoffPidEnv);
+        std::vector<char*> envp;
+        for(char** e = environ; e && *e; ++e)
+        {
+            if((strncmp(*e, kListenFdsEnv, fdsNameLen) == 0 && (*e)[fdsNameLen] == '=') ||
+                (strncmp(*e, kHandoffPidEnv, pidNameLen) == 0 && (*e)[pidNameLen] == '='))
+                continue;
+            envp.push_back(*e);
+        }
+        envp.push_back(&fdsEnv[0]);
+        envp.push_back(&pidEnv[0]);
+        envp.push_back(nullptr);
+
+        pid_t pid = fork();
+        if(pid < 0)
+        {
+            fprintf(stderr, "Fork failed: errno=%d, msg=%s\n", errno, strerror(errno));
+            return -1;
+        }
+        else if(pid > 0)
+        {
+            fprintf(stderr, "Handoff %zu listen fds to new process(pid=%d)\n", fds.size(), pid);
+            return pid;
+        }
+
+        // 子进程：让监听fd跨exec保留，然后执行新程序
+        for(int fd : fds)
+            fcntl(fd, F_SETFD, 0);
+        environ = envp.data();
+        execvp(argv[0], const_cast<char* const*>(argv));
+
+        // 若存在返回，说明执行失败
+        const char msg[] = "handoff: execute new program failed\n";
+        write(STDERR_FILENO, msg, sizeof(msg) - 1);
+        _exit(1);
+    }
+
+    void Daemon::addListenFd(const std::string& key, int fd)
+    {
+        std::lock_guard<std::mutex> lock(listenFdsMutex);
+        listenFds.emplace(key, fd);
+    }
+
+    void Daemon::removeListenFd(int fd)
+    {
+        std::lock_guard<std::mutex> lock(listenFdsMutex);
+        for(auto it = listenFds.begin(); it != listenFds.end(); ++it)
+        {
+            if(it->second == fd)
+            {
+                listenFds.erase(it);
+                return;
+            }
+        }
+    }
+
+    int Daemon::takeInheritedFd(const std::string& key)
+    {
+        std::lock_guard<std::mutex> lock(listenFdsMutex);
+        if(!inheritedParsed)
+            parseInheritedFds();
+
+        auto it = inheritedFds.find(key);
+        if(it == inheritedFds.end())
+            return -1;
+        int fd = it->second;
+        inheritedFds.erase(it);
+        return fd;
+    }
+
+    int Daemon::closeInheritedFds()
+    {
+        std::lock_guard<std::mutex> lock(listenFdsMutex);
+        if(!inheritedParsed)
+            parseInheritedFds();
+
+        int closed = 0;
+        for(const auto& kv : inheritedFds)
+        {
+            fprintf(stderr, "Close unclaimed inherited listen fd %d (%s)\n", kv.second, kv.first.c_str());
+            close(kv.second);
+            ++closed;
+        }
+        inheritedFds.clear();
+        return closed;
+    }
+
     namespace
     {
         // 存储信号处理函数的映射表
@@ -7,6 +7,7 @@
 #include <csignal>
 #include <functional>
 #include <string>
+#include <sys/types.h>
 
 namespace handy
 {
@@ -14,6 +15,11 @@ namespace handy
      * @class Daemon
      * @brief 守护进程管理类，负责守护进程的启动、停止、重启等操作
      * @note 提供了一套完整的守护进程管理接口，包括创建、停止、重启守护进程以及从PID文件中读取进程ID等功能
+     * @note 平滑重启（gracefulRestart）时旧进程把监听Socket交给新进程，重启期间不拒绝连接：
+     *       1. 控制进程向旧进程发送SIGUSR2
+     *       2. 旧进程调用handoff()启动新程序，登记过的监听fd被新进程继承，新进程的TcpServer/UdpServer::bind()直接使用它们
+     *       3. 旧进程调用TcpServer::drain()停止接受连接，已有连接全部关闭（或超时）后退出
+     *       信号处理函数中只应设置标志，在事件循环线程中（如定时器里）检查标志后再调用handoff()
     */
     class Daemon
     {
@@ -34,6 +40,15 @@ namespace handy
             */
             static int restart(const char* pidFilePath);
 
+            /**
+             * @brief 平滑重启守护进程（监听Socket交给新进程，不中断服务）
+             * @param pidFilePath PID文件路径
+             * @param timeout_ms 等待新进程写入PID文件的最长时间（毫秒）
+             * @return int 0: 新进程已启动，-1: 失败（守护进程未运行、发送信号失败或超时）
+             * @note 向旧进程发送SIGUSR2，旧进程需注册相应的处理（见类说明）
+            */
+            static int gracefulRestart(const char* pidFilePath, int timeout_ms = 10000);
+
             /**
              * @brief 停止当前运行的守护进程
              * @param pidFilePath PID文件路径
@@ -64,6 +79,55 @@ namespace handy
              * @note 可用于在程序内部实现重启功能
             */
             static void changeTo(const char* argv[]);
+
+            // -------------------------- 监听Socket交接 --------------------------
+            /**
+             * @brief 环境变量：交给新进程的监听fd列表（格式："tcp:127.0.0.1:8080=5;udp:0.0.0.0:53=6"）
+            */
+            static constexpr const char* kListenFdsEnv = "HANDY_LISTEN_FDS";
+
+            /**
+             * @brief 环境变量：交出监听Socket的旧进程PID（新进程的start()据此跳过“已在运行”检查）
+            */
+            static constexpr const char* kHandoffPidEnv = "HANDY_HANDOFF_PID";
+
+            /**
+             * @brief 启动新程序并把登记的监听fd交给它（旧进程在平滑重启时调用）
+             * @param argv 新程序路径与参数（以nullptr结尾）
+             * @return pid_t 新进程PID，-1: 失败
+             * @note 1. 登记的fd在新进程中保持打开（不设FD_CLOEXEC），fd列表通过kListenFdsEnv传递
+             * @note 2. 旧进程中的监听Socket仍然有效，两个进程都可以接受连接，直到旧进程调用TcpServer::drain()
+            */
+            static pid_t handoff(const char* argv[]);
+
+            /**
+             * @brief 登记可交接的监听fd（TcpServer/UdpServer在bind()成功后调用）
+             * @param key 监听地址（如"tcp:127.0.0.1:8080"）
+             * @param fd 监听fd
+            */
+            static void addListenFd(const std::string& key, int fd);
+
+            /**
+             * @brief 注销监听fd（关闭监听Socket前调用）
+             * @param fd 监听fd
+            */
+            static void removeListenFd(int fd);
+
+            /**
+             * @brief 取出从上一个进程继承的、地址为key的监听fd
+             * @param key 监听地址（同addListenFd）
+             * @return int 继承的fd（已设置FD_CLOEXEC），没有时返回-1
+             * @note 同一地址有多个fd（SO_REUSEPORT）时依次返回；首次调用时解析并清除kListenFdsEnv
+            */
+            static int takeInheritedFd(const std::string& key);
+
+            /**
+             * @brief 关闭从上一个进程继承、但没有被取走的监听fd
+             * @return int 关闭的fd数量
+             * @details 新版本不再监听的地址仍留在内核中接受连接，这些连接永远得不到处理；
+             *          所有服务器bind()完成后调用一次，之后takeInheritedFd()总是返回-1
+            */
+            static int closeInheritedFds();
         private:
             /**
              * @brief 将当前进程的PID写入指定的PID文件
@@ -3,34 +3,119 @@
 #include "logger.h"
 #include "poller.h"
 #include "thread_pool.h"
+#include "port_posix.h"
 #include "conn.h"
 #include <map>
 #include <set>
+#include <thread>
 #include <fcntl.h>
 #include <signal.h>
 
 namespace handy
 {
+    /**
+     * @brief 侵入式空闲链表（带哨兵的循环双向链表，节点嵌入在TcpConn中）
+    */
+    struct IdleList : private NonCopyAble
+    {
+        IdleNode head;      // 哨兵节点（head.next为最早超时的节点）
+
+        IdleList() { head.prev = head.next = &head; }
+
+        bool empty() const { return head.next == &head; }
+
+        IdleNode* front() { return head.next; }
+
+        void pushBack(IdleNode* node)
+        {
+            node->prev = head.prev;
+            node->next = &head;
+            head.prev->next = node;
+            head.prev = node;
+            node->list = this;
+        }
+
+        static void unlink(IdleNode* node)
+        {
+            node->prev->next = node->next;
+            node->next->prev = node->prev;
+            node->prev = node->next = nullptr;
+            node->list = nullptr;
+        }
+
+        void moveToBack(IdleNode* node)
+        {
+            if(node == head.prev)
+                return;
+            unlink(node);
+            pushBack(node);
+        }
+
+        /**
+         * @brief 摘除所有节点（链表销毁前调用，避免连接中残留悬空指针）
+        */
+        void clear()
+        {
+            while(!empty())
+                unlink(front());
+        }
+    };
+
     /**
      * @brief 事件派发器内部实现结构体（Pimpl模式，隐藏EventBase的具体逻辑）
     */
     struct EventsImp
     {
+        // 默认的慢回调阈值（微秒）
+        static constexpr int64_t kDefaultSlowThreshold_us = 50 * 1000;
+        // 发布繁忙程度（LoopStats::busyPermille）的统计窗口（微秒）
+        static constexpr int64_t kLoadWindow_us = 100 * 1000;
+
+        /**
+         * @brief 定时器任务（附带注册位置）
+        */
+        struct TimerTask
+        {
+            Task task;
+            CallSite site;
+        };
+
+        /**
+         * @brief 投递到任务队列中的任务（附带投递位置，用于慢任务告警）
+        */
+        struct SiteTask
+        {
+            Task task;
+            CallSite site;
+        };
+
         PollerBase* m_poller;       // I/O多路复用器（epoll/kqueue）
         EventBase* m_base;          // 关联的EventBase对象（非空）
         std::atomic<bool> m_exit; // 事件循环退出标志（原子操作，线程安全）
+        std::atomic<std::thread::id> m_loopThread;  // 正在执行loop()的线程（loop()未运行时为空）
+        BlockPool* m_pool;          // 连接、通道等对象的内存池（未归还的对象持有引用，可能晚于EventsImp释放）
         int m_wakeupFds[2];          // 唤醒事件循环的管道（0：读端，1：写端）
         int m_nextTimeout_ms;          // 下一个定时器的超时时间（毫秒，用于Poller等待）
-        SafeQueue<Task> m_tasks;    // 异步任务队列（线程安全，支持跨线程投递）
+        SafeQueue<SiteTask> m_tasks;    // 异步任务队列（线程安全，支持跨线程投递）
 
         std::map<TimerId, TimerRepeatable> m_timerReps;     // 可重复定时器映射
-        std::map<TimerId, Task> m_timers;                   // 一次性任务定时器映射
+        std::map<TimerId, TimerTask> m_timers;              // 一次性任务定时器映射
         std::atomic<int64_t> m_timerSeq;                    // 定时器序列号（用于生成定时器ID）
 
-        std::map<int, std::list<IdleNode>> m_idleConns;     // 空闲连接映射（key：空闲超时时间，单位:s；list按照最后活跃时间排序，最早超时的连接在前面）
+        std::map<int, IdleList> m_idleLists;                // 空闲连接链表（key：空闲超时时间，单位:s；链表按最后活跃时间排序，最早超时的连接在前面）
         std::set<TcpConnPtr> m_reconnectConns;              // 重连连接集合（需要互斥锁保护）
         bool m_idleEnabled;                                 // 空闲连接管理的启用标志
         std::mutex m_reconnectMutex;                        // 重连连接集合的互斥锁
+        LoopStats m_stats;                                  // 运行统计
+        int64_t m_slowThreshold_us;                         // 慢回调阈值（微秒，0表示关闭）
+        int64_t m_taskTime_us;                              // 本轮循环执行任务队列的耗时（微秒）
+        int64_t m_userTime_us;                              // 单独计时的用户回调的累计耗时（微秒，从外层回调的慢回调检查中扣除）
+        int64_t m_stamp_us;                                 // 上一个回调结束的时刻（微秒；-1：等待poll返回，0：不在循环中）
+        int64_t m_loadWindowStart_us;                       // 当前繁忙程度统计窗口的开始时刻（微秒，0：尚未开始）
+        int64_t m_loadWindowBusy_us;                        // 当前窗口内处理事件的累计耗时（微秒）
+        int64_t m_busyPoll_us;                              // 忙轮询模式下连续空转多久后退回阻塞等待（微秒，0表示关闭忙轮询）
+        std::atomic<bool> m_spinning;                       // 循环正在忙轮询（此时safeCall()不需要写唤醒管道）
+        std::atomic<int64_t> m_pendingTasks;                // 已入队、尚未取出的任务数（忙轮询时代替加锁的m_tasks.size()；出队可能先于计数，短暂为负）
 
         /**
          * @brief 构造函数：初始化时间派发器内部实现
@@ -42,9 +127,20 @@ namespace handy
             : m_poller(createPoller())
             , m_base(base)
             , m_exit(false)
+            , m_loopThread(std::thread::id())
+            , m_pool(BlockPool::create())
             , m_tasks(taskCap)
             , m_timerSeq(0)
             , m_idleEnabled(false)
+            , m_slowThreshold_us(kDefaultSlowThreshold_us)
+            , m_taskTime_us(0)
+            , m_userTime_us(0)
+            , m_stamp_us(0)
+            , m_loadWindowStart_us(0)
+            , m_loadWindowBusy_us(0)
+            , m_busyPoll_us(0)
+            , m_spinning(false)
+            , m_pendingTasks(0)
         {
             // 忽略 SIGPIPE：触发 SIGPIPE 时不退出，而是捕获错误并处理
             signal(SIGPIPE, SIG_IGN);
@@ -84,6 +180,8 @@ namespace handy
             std::lock_guard<std::mutex> lock(m_reconnectMutex);
             for(const auto& conn : m_reconnectConns)
                 conn->cleanup(conn);
+            clearIdles();
+            m_pool->release();
         }
 
         /**
@@ -100,21 +198,7 @@ namespace handy
                 // 读取唤醒管道数据（清空管道，避免重复唤醒)
                 ssize_t r = wakeupCh->getFd() >= 0 ? ::read(wakeupCh->getFd(), buf, sizeof(buf)) : 0;
                 if(r > 0)
-                {
-                    // 处理所有异步任务（捕获异常，避免单个任务崩溃影响循环）
-                    Task task;
-                    while (m_tasks.popWait(&task, 0))
-                    {
-                        try
-                        {
-                            task();
-                        }
-                        catch(const std::exception& e)
-                        {
-                            ERROR("async task execute failed: %s", e.what());
-                        }
-                    }
-                }
+                    runTasks();
                 // 管道写端关闭，删除Channel，避免野指针
                 else if(r == 0)
                 {
@@ -129,6 +213,51 @@ namespace handy
             });
         }
 
+        /**
+         * @brief 执行任务队列中的所有任务（捕获异常，避免单个任务崩溃影响循环）
+         * @details 相邻任务共用一次取时，每个任务只多一次时钟读取；耗时累计到m_taskTime_us
+        */
+        void runTasks()
+        {
+            SiteTask st;
+            int64_t begin_us = callbackStart();
+            if(begin_us == 0)
+                begin_us = utils::steadyMicro();
+            int64_t last_us = begin_us;
+            while (m_tasks.popWait(&st, 0))
+            {
+                m_pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+                int64_t userTime_us = m_userTime_us;
+                try
+                {
+                    st.task();
+                }
+                catch(const std::exception& e)
+                {
+                    ERROR("async task execute failed: %s", e.what());
+                }
+
+                int64_t now_us = utils::steadyMicro();
+                int64_t used_us = now_us - last_us - (m_userTime_us - userTime_us);
+                if(m_slowThreshold_us > 0 && used_us >= m_slowThreshold_us)
+                    reportSlow("task", st.site, used_us);
+                last_us = now_us;
+                if(m_stamp_us != 0)
+                    m_stamp_us = now_us;
+            }
+            m_taskTime_us += last_us - begin_us;
+        }
+
+        /**
+         * @brief 获取空闲管理使用的粗粒度时间（秒）
+         * @details 直接复用本轮poll返回时记录的时刻，热路径上不再读取时钟；循环尚未运行时才读一次时钟
+        */
+        int64_t idleNow_s() const
+        {
+            int64_t now_us = m_poller->getLastWaitEnd();
+            return (now_us > 0 ? now_us : utils::steadyMicro()) / 1000000;
+        }
+
         /**
          * @brief 定期见检查所有注册的空闲连接，处理空闲连接超时（遍历所有空闲连接，触发超时回调）
         */
@@ -137,30 +266,31 @@ namespace handy
             if(!m_idleEnabled)
                 return;
 
-            int64_t now_s = utils::timeMilli() / 1000;
-            for(auto& [idle_s, connList] : m_idleConns)
+            int64_t now_s = idleNow_s();
+            for(auto& [idle_s, idleList] : m_idleLists)
             {
-                while(!connList.empty())
+                while(!idleList.empty())
                 {
-                    IdleNode& node = connList.front();
+                    IdleNode* node = idleList.front();
                     // 若没超时，退出当前循环
-                    if(node.lastUpdatedTimestamp_s + idle_s > now_s)
+                    if(node->lastUpdatedTimestamp_s + idle_s > now_s)
                         break;
-                    
-                    // 更新节点时间并移动到列表末尾
-                    node.lastUpdatedTimestamp_s = now_s;
-                    connList.splice(connList.end(), connList, connList.begin());
 
-                    // 触发空闲回调
+                    // 更新节点时间并移动到链表末尾（回调中可能注销该节点，因此先移动再回调）
+                    node->lastUpdatedTimestamp_s = now_s;
+                    idleList.moveToBack(node);
+
+                    // 触发空闲回调（只在超时时才持有连接的引用）
                     try
                     {
-                        node.cb(node.conn);
+                        TcpConnPtr conn = node->conn ? node->conn->shared_from_this() : TcpConnPtr();
+                        TcpCallBack cb = node->cb;
+                        cb(conn);
                     }
                     catch(const std::exception& e)
                     {
                         ERROR("idle connection callback failed: %s", e.what());
                     }
-                    
                 }
             }
 
@@ -174,16 +304,14 @@ namespace handy
         /**
          * @brief 注册空闲连接（加入空闲连接管理）
          * @param idle_s 空闲超时时间（单位：秒）
-         * @param conn 要管理的TCP连接（非空）
-         * @param cb 空闲超时回调（非空）
-         * @return IdleId 空闲连接ID的智能指针（用于后续更新/注销）
+         * @param node 空闲链表节点（cb非空，且未注册）
         */
-        IdleId registerIdle(int idle_s, const TcpConnPtr& conn, const TcpCallBack& cb)
+        void registerIdle(int idle_s, IdleNode* node)
         {
-            if(idle_s <= 0 || !conn || !cb)
+            if(idle_s <= 0 || !node || !node->cb || node->list)
                 throw std::invalid_argument(
-                    "registerIdle: invalid parameter (idle_s <= 0 or conn/cb is null)");
-            
+                    "registerIdle: invalid parameter (idle_s <= 0, node/cb is null or node already registered)");
+
             // 首次注册时启用空闲连接管理（启动周期性检查）
             if(!m_idleEnabled)
             {
@@ -191,72 +319,91 @@ namespace handy
                 m_idleEnabled = true;
             }
 
-            // 添加空闲连接到对应列表
-            auto& connList = m_idleConns[idle_s];
-            connList.push_back({conn, utils::timeMilli() / 1000, cb});
-
+            // 添加到对应链表的末尾
+            node->idle_s = idle_s;
+            node->lastUpdatedTimestamp_s = idleNow_s();
+            m_idleLists[idle_s].pushBack(node);
             TRACE("Idle connection registered: idle_s=%d", idle_s);
-            return IdleId(new IdleIdImp(&connList, --connList.end()));
         }
 
         /**
          * @brief 注销空闲连接（从空闲管理中移除）
-         * @param idleIdPtr 要注销的空闲连接ID指针（非空）
+         * @param node 空闲链表节点（未注册时忽略）
         */
-        void unregisterIdle(const IdleId& idleIdPtr)
+        void unregisterIdle(IdleNode* node)
         {
-            if(!idleIdPtr)
+            if(!node->list)
                 return;
 
-            // 从当前连接列表中移除对应的空闲连接节点
-            idleIdPtr->m_lst->erase(idleIdPtr->m_iter);
+            IdleList::unlink(node);
             TRACE("Idle connection unregistered");
         }
 
         /**
          * @brief 更新空闲连接状态（重置最后活跃时间）
-         * @param idleIdPtr 要更新的空闲连接ID指针（非空）
-         * @note 更新后会将连接放入空闲连接列表的末尾
+         * @param node 空闲链表节点（未注册时忽略）
+         * @note 本秒内已更新过的节点已经位于同秒节点之中，链表顺序无需调整，直接返回
         */
-        void updateIdle(const IdleId& idleIdPtr)
+        void updateIdle(IdleNode* node)
         {
-            if(!idleIdPtr)
+            int64_t now_s = idleNow_s();
+            if(!node->list || node->lastUpdatedTimestamp_s == now_s)
                 return;
 
-            idleIdPtr->m_iter->lastUpdatedTimestamp_s = utils::timeMilli() / 1000;
-            idleIdPtr->m_lst->splice(idleIdPtr->m_lst->end(), *idleIdPtr->m_lst, idleIdPtr->m_iter);
+            node->lastUpdatedTimestamp_s = now_s;
+            node->list->moveToBack(node);
+        }
 
-            TRACE("Idle connection updated: updateTime=%lld", idleIdPtr->m_iter->lastUpdatedTimestamp_s);
+        /**
+         * @brief 清空所有空闲链表（节点从链表中摘除，连接本身不受影响）
+        */
+        void clearIdles()
+        {
+            for(auto& [idle_s, idleList] : m_idleLists)
+                idleList.clear();
+            m_idleLists.clear();
         }
 
         /**
          * @brief 处理定时器超时（执行所有已超时的定时器任务）
+         * @param start_us 开始处理的时刻（单调时钟，微秒）
+         * @return int64_t 处理完毕的时刻（没有定时器超时时返回start_us）
         */
-        void handleTimeoutTimers()
+        int64_t handleTimeoutTimers(int64_t start_us)
         {
             int64_t now_ms = utils::timeMilli();
             TimerId maxTimerId{now_ms, std::numeric_limits<int64_t>::max()};
 
             // 处理一次性定时器（按时间戳排序，遍历已超时的任务）
+            int64_t last_us = start_us;
             auto it = m_timers.begin();
             while(it != m_timers.end() && it->first < maxTimerId)
             {
-                Task task = std::move(it->second);
+                TimerTask timer = std::move(it->second);
                 m_timers.erase(it++);
+                int64_t userTime_us = m_userTime_us;
 
                 // 执行定时器任务
                 try
                 {
-                    task();
+                    timer.task();
                 }
                 catch(const std::exception& e)
                 {
                     ERROR("One-shot timer callback failed: %s", e.what());
                 }
+
+                int64_t now_us = utils::steadyMicro();
+                int64_t used_us = now_us - last_us - (m_userTime_us - userTime_us);
+                if(m_slowThreshold_us > 0 && used_us >= m_slowThreshold_us)
+                    reportSlow("timer", timer.site, used_us);
+                last_us = now_us;
+                m_stamp_us = now_us;
             }
 
             // 刷新下一个定时器的超时时间（用于Poller等待）
             refreshNearestTimer();
+            return last_us;
         }
 
         /**
@@ -289,15 +436,12 @@ namespace handy
             if(!tr)
                 return;
 
-            // 通过自定义ID检查定时器是否已被取消
-            auto repIt = m_timerReps.find({-tr->at, tr->timerIdPair.second});
-            if(repIt == m_timerReps.end())
-                return;
+            // 取消周期性定时器时会同时移除当前周期的一次性定时器，能执行到这里说明定时器仍然有效
 
             // 更新下一次超时时间并重新注册
             tr->at += tr->interval_ms;
             tr->timerIdPair = {tr->at, ++m_timerSeq};
-            m_timers[tr->timerIdPair] = [this, tr](){ repeatableTimeout(tr); };
+            m_timers[tr->timerIdPair] = TimerTask{[this, tr](){ repeatableTimeout(tr); }, tr->site};
 
             // 刷新下一个定时器时间
             refreshNearestTimer(&tr->timerIdPair);
@@ -350,9 +494,10 @@ namespace handy
          * @param timestamp_ms 定时器超时时间戳（毫秒）
          * @param task 定时器回调函数（非空）
          * @param interval_ms 定时器间隔时间戳（毫秒；0：一次性定时器，>0：周期性定时器）
+         * @param site 定时器的注册位置
          * @return TimerId 定时器ID（事件循环已退出时返回无效的定时器ID）
         */
-        TimerId runAt(int64_t timestamp_ms, Task&& task, int64_t interval_ms)
+        TimerId runAt(int64_t timestamp_ms, Task&& task, int64_t interval_ms, const CallSite& site)
         {
             // 已退出或任务为空，返回无效ID
             if(m_exit || !task)
@@ -365,13 +510,13 @@ namespace handy
                 TimerId rep{-timestamp_ms, ++m_timerSeq};
                 auto [it, inserted] = m_timerReps.emplace(
                     rep, TimerRepeatable{
-                        timestamp_ms, interval_ms, {timestamp_ms, ++m_timerSeq}, std::move(task)});
+                        timestamp_ms, interval_ms, {timestamp_ms, ++m_timerSeq}, std::move(task), site});
                 if(!inserted)
                     return TimerId();
 
                 TimerRepeatable* tr = &it->second;
                 // 注册当前周期的一次性定时器
-                m_timers[tr->timerIdPair] = [this, tr]() { repeatableTimeout(tr); };
+                m_timers[tr->timerIdPair] = TimerTask{[this, tr]() { repeatableTimeout(tr); }, site};
                 refreshNearestTimer(&tr->timerIdPair);
 
                 TRACE("Repeatable timer registered: repTimerIdPair={%lld, %lld}, interval=%lld ms",
@@ -380,7 +525,7 @@ namespace handy
             }
 
             TimerId tid{timestamp_ms, ++m_timerSeq};
-            m_timers.emplace(tid, std::move(task));
+            m_timers.emplace(tid, TimerTask{std::move(task), site});
             refreshNearestTimer(&tid);
 
             TRACE("One-shot timer registered: timerIdPair={%lld, %lld}",
@@ -394,34 +539,160 @@ namespace handy
         void loop()
         {
             TRACE("EventBase loop started: base=%p", m_base);
+            // exchange读取上一个循环线程退出时的写入：换一个线程再次loop()时，对象池的本地链表对新线程可见
+            m_loopThread.exchange(std::this_thread::get_id(), std::memory_order_acq_rel);
             // 每次最多等待10秒，避免永久阻塞
             while(!m_exit)
-                loopOnce(10000);
+            {
+                if(m_busyPoll_us > 0)
+                    busyPoll();
+                else
+                    loopOnce(10000);
+            }
             TRACE("EventBase loop exited: base=%p", m_base);
 
             // 清理资源
             m_timerReps.clear();
             m_timers.clear();
-            m_idleConns.clear();
+            clearIdles();
 
             // 执行最后一次循环，清理剩余连接
             loopOnce(0);
+            m_loopThread.store(std::thread::id(), std::memory_order_release);
+        }
+
+        /**
+         * @brief 忙轮询：以0超时反复轮询I/O、任务队列与定时器，连续空转超过m_busyPoll_us后阻塞等待一次
+         * @details 1. 自旋期间safeCall()不写唤醒管道，任务由循环直接从队列中取出，省去write与睡眠-唤醒的开销
+         *          2. 只有处理了事件的轮次计入统计，空转不计入繁忙时间
+        */
+        void busyPoll()
+        {
+            m_spinning.store(true);
+            int64_t idleStart_us = utils::steadyMicro();
+            while(!m_exit)
+            {
+                if(loopOnce(0))
+                    idleStart_us = utils::steadyMicro();
+                else if(utils::steadyMicro() - idleStart_us >= m_busyPoll_us)
+                    break;
+            }
+
+            // 停止自旋后投递的任务会写唤醒管道；停止之前入队、没有写唤醒管道的任务在阻塞前处理
+            // （与safeCall()中"先计数、再读m_spinning"的顺序配对，两边都是顺序一致的原子操作，不会漏掉任务）
+            m_spinning.store(false);
+            if(!m_exit)
+                loopOnce(m_pendingTasks.load() > 0 ? 0 : 10000);
         }
 
         /**
          * @brief 执行一次事件循环
          * @param waitTime_ms 最大等待时间（毫秒）
+         * @return bool 本轮是否处理了事件（I/O、任务或定时器）
         */
-        void loopOnce(int waitTime_ms)
+        bool loopOnce(int waitTime_ms)
         {
+            // 各阶段的耗时由相邻回调共用的时间戳链计算：每个回调结束时只读取一次时钟，
+            // 其结束时刻即下一个回调的开始时刻（第一个回调从poll返回时刻开始）
+            m_taskTime_us = 0;
+            m_stamp_us = -1;
+
             // 等待I/O事件（最多等待m_nextTimeout_ms，避免错过定时器）
+            // 任务队列在唤醒管道的读回调中执行，其耗时单独累计到m_taskTime_us
             int autualWaitTime_ms = std::min(waitTime_ms, m_nextTimeout_ms);
-            m_poller->loopOnce(autualWaitTime_ms);
+            int active = m_poller->loopOnce(autualWaitTime_ms);
+            int64_t waitEnd_us = m_poller->getLastWaitEnd();
+
+            // 忙轮询模式下，投递任务时可能没有写唤醒管道，直接检查任务计数（不加锁，不与投递任务的线程争用队列的互斥锁）
+            if(m_busyPoll_us > 0 && m_pendingTasks.load(std::memory_order_relaxed) > 0)
+                runTasks();
+            int64_t polled_us = m_stamp_us > 0 ? m_stamp_us : waitEnd_us;
 
             // 处理已超时的定时器
             TRACE("Ready to handle timeout timers");
-            handleTimeoutTimers();
+            int64_t end_us = handleTimeoutTimers(polled_us);
             TRACE("Timeout timers handled");
+            m_stamp_us = 0;
+
+            // 忙轮询的空转轮次不计入统计（否则直方图会被大量0耗时的样本淹没）
+            bool worked = active > 0 || m_taskTime_us > 0 || end_us != polled_us;
+            if(!worked && waitTime_ms == 0)
+                return false;
+
+            // 更新各阶段统计
+            int64_t io_us = polled_us - waitEnd_us - m_taskTime_us;
+            m_stats.pollWait_us.observeExclusive(static_cast<uint64_t>(m_poller->getLastWaitTime()));
+            m_stats.io_us.observeExclusive(static_cast<uint64_t>(std::max(io_us, int64_t{0})));
+            m_stats.tasks_us.observeExclusive(static_cast<uint64_t>(m_taskTime_us));
+            m_stats.timers_us.observeExclusive(static_cast<uint64_t>(end_us - polled_us));
+            int64_t busy_us = std::max(end_us - waitEnd_us, int64_t{0});
+            m_stats.busy_us.observeExclusive(static_cast<uint64_t>(busy_us));
+            m_stats.timers.store(static_cast<int64_t>(m_timers.size()), std::memory_order_relaxed);
+            m_stats.iterations.store(m_stats.iterations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            publishLoad(busy_us, end_us);
+            return worked;
+        }
+
+        /**
+         * @brief 累计繁忙时间，每个统计窗口结束时发布一次繁忙程度（与上一窗口取平均做平滑）
+         * @param busy_us 本轮循环处理事件的耗时（微秒）
+         * @param now_us 本轮循环结束的时刻（微秒）
+        */
+        void publishLoad(int64_t busy_us, int64_t now_us)
+        {
+            m_loadWindowBusy_us += busy_us;
+            if(m_loadWindowStart_us == 0)
+                m_loadWindowStart_us = now_us - busy_us;
+
+            int64_t window_us = now_us - m_loadWindowStart_us;
+            if(window_us < kLoadWindow_us)
+                return;
+
+            uint32_t cur = static_cast<uint32_t>(std::min<int64_t>(m_loadWindowBusy_us * 1000 / window_us, 1000));
+            uint32_t prev = m_stats.busyPermille.load(std::memory_order_relaxed);
+            m_stats.busyPermille.store((prev + cur) / 2, std::memory_order_relaxed);
+            m_stats.busyUpdated_us.store(now_us, std::memory_order_relaxed);
+            m_loadWindowStart_us = now_us;
+            m_loadWindowBusy_us = 0;
+        }
+
+        /**
+         * @brief 获取即将执行的I/O回调的开始时刻
+         * @return int64_t 开始时刻（微秒），不在事件循环中时返回0（不计时）
+        */
+        int64_t callbackStart() const
+        {
+            return m_stamp_us < 0 ? m_poller->getLastWaitEnd() : m_stamp_us;
+        }
+
+        /**
+         * @brief I/O回调执行完毕：推进时间戳链，超过慢回调阈值时计数并告警
+         * @param start_us callbackStart()返回的开始时刻
+         * @param taskTime_us 回调开始前的m_taskTime_us（回调中执行的任务另行计时，需要扣除）
+         * @param userTime_us 回调开始前的m_userTime_us（回调中单独计时的用户回调，需要扣除）
+         * @param site 回调的注册位置
+         * @param kind 回调类型（read/write）
+        */
+        void callbackDone(int64_t start_us, int64_t taskTime_us, int64_t userTime_us, const CallSite& site, const char* kind)
+        {
+            if(start_us == 0)
+                return;
+            int64_t now_us = utils::steadyMicro();
+            int64_t used_us = now_us - start_us - (m_taskTime_us - taskTime_us) - (m_userTime_us - userTime_us);
+            if(m_slowThreshold_us > 0 && used_us >= m_slowThreshold_us)
+                reportSlow(kind, site, used_us);
+            if(m_stamp_us != 0)
+                m_stamp_us = now_us;
+        }
+
+        /**
+         * @brief 记录一次慢回调
+        */
+        void reportSlow(const char* kind, const CallSite& site, int64_t used_us)
+        {
+            m_stats.slowCallbacks.fetch_add(1, std::memory_order_relaxed);
+            WARN("slow %s callback registered at %s:%d took %lld us (threshold %lld us)",
+                    kind, site.file, site.line, (long long)used_us, (long long)m_slowThreshold_us);
         }
 
         /**
@@ -431,13 +702,24 @@ namespace handy
         {
             char dummy = '\0';
             ssize_t r = ::write(m_wakeupFds[1], &dummy, 1);
-            if(r != 1)
+            // 管道已满说明已有未处理的唤醒，事件循环一定会被唤醒
+            if(r != 1 && errno != EAGAIN)
                 ERROR("write wakeup pipe error: r=%zd, errno=%d, msg=%s", r, errno, strerror(errno));
             TRACE("write wakeup pipe(fd=%d) success", m_wakeupFds[1]);
         }
     };
 
-    EventBase::EventBase(int taskCapacity)
+    bool BaseHandle::safeCall(Task&& task, CallSite site)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_base)
+            return false;
+        m_base->safeCall(std::move(task), site);
+        return true;
+    }
+
+    EventBase::EventBase(int taskCapacity) :
+        m_handle(std::make_shared<BaseHandle>(this))
     {
         try
         {
@@ -456,6 +738,11 @@ namespace handy
     EventBase::~EventBase()
     {
         TRACE("EventBase destroying: base=%p", this);
+        // 先让句柄失效：之后其他线程通过句柄投递的任务直接丢弃，正在投递的等待其完成
+        {
+            std::lock_guard<std::mutex> lock(m_handle->m_mutex);
+            m_handle->m_base = nullptr;
+        }
         // unique_ptr析构时会自动调用delete释放m_imp，无需手动处理
     }
 
@@ -476,9 +763,9 @@ namespace handy
         return m_imp ? m_imp->cancel(timerIdPair) : false;
     }
 
-    TimerId EventBase::runAt(int64_t timestamp_ms, Task&& task, int64_t interval_ms)
+    TimerId EventBase::runAt(int64_t timestamp_ms, Task&& task, int64_t interval_ms, CallSite site)
     {
-        return m_imp ? m_imp->runAt(timestamp_ms, std::move(task), interval_ms) : TimerId();
+        return m_imp ? m_imp->runAt(timestamp_ms, std::move(task), interval_ms, site) : TimerId();
     }
 
     EventBase& EventBase::exit()
@@ -496,29 +783,85 @@ namespace handy
         return m_imp ? m_imp->m_exit.load() : true;
     }
 
+    bool EventBase::isInLoopThread() const
+    {
+        if(!m_imp)
+            return true;
+        std::thread::id id = m_imp->m_loopThread.load(std::memory_order_acquire);
+        return id == std::thread::id() || id == std::this_thread::get_id();
+    }
+
     void EventBase::wakeup()
     {
         if(m_imp)
             m_imp->wakeup();
     }
 
-    void EventBase::safeCall(Task&& task)
+    void EventBase::safeCall(Task&& task, CallSite site)
     {
         if(m_imp && task)
         {
-            m_imp->m_tasks.push(std::move(task));
-            m_imp->wakeup();
+            if(!m_imp->m_tasks.push(EventsImp::SiteTask{std::move(task), site}))
+                return;
+            // 忙轮询的循环正在自旋时会直接检查任务计数，不需要写唤醒管道
+            m_imp->m_pendingTasks.fetch_add(1);
+            if(!m_imp->m_spinning.load())
+                m_imp->wakeup();
         }
     }
+
+    const LoopStats& EventBase::getStats() const
+    {
+        return m_imp->m_stats;
+    }
+
+    size_t EventBase::getPendingTasks() const
+    {
+        return m_imp ? m_imp->m_tasks.size() : 0;
+    }
+
+    double EventBase::getRecentBusy() const
+    {
+        if(!m_imp)
+            return 0;
+        const LoopStats& stats = m_imp->m_stats;
+        double busy = stats.busyPermille.load(std::memory_order_relaxed) / 1000.0;
+        int64_t since_us = utils::steadyMicro() - stats.busyUpdated_us.load(std::memory_order_relaxed);
+        if(since_us > EventsImp::kLoadWindow_us)
+            busy = busy * EventsImp::kLoadWindow_us / since_us;
+        return busy;
+    }
+
+    void EventBase::setSlowCallbackThreshold(int64_t threshold_us)
+    {
+        if(m_imp)
+            m_imp->m_slowThreshold_us = std::max(threshold_us, int64_t{0});
+    }
+
+    void EventBase::setBusyPoll(int64_t spin_us)
+    {
+        if(m_imp)
+            m_imp->m_busyPoll_us = std::max(spin_us, int64_t{0});
+    }
+
     PollerBase* EventBase::getPoller() const
     {
         return m_imp ? m_imp->m_poller : nullptr;
     }
 
+    BlockPool* EventBase::getLocalPool() const
+    {
+        // 不能用isInLoopThread()：loop()未运行时它对所有线程都返回true，而对象池只能由一个线程分配
+        return m_imp && m_imp->m_loopThread.load(std::memory_order_acquire) == std::this_thread::get_id()
+                ? m_imp->m_pool : nullptr;
+    }
+
     MultiBase::MultiBase(int sz)
         : m_id(0)
+        , m_policy(AllocPolicy::ROUND_ROBIN)
         , m_bases(sz > 0 ? sz : 1)
         , m_threads(m_bases.size() - 1) 
+        , m_threadName("handy-io")
     {
         if(sz <= 0)
             WARN("MultiBase size=%d is invalid, using default size=1", sz);
@@ -542,11 +885,15 @@ namespace handy
         {
             m_threads[i] = std::thread([this, i]()
             {
+                _setupThread(i);
                 m_bases[i].loop();
             });
         }
 
-        // 主线程运行最后一个EventBase
+        // 主线程运行最后一个EventBase（退出后恢复主线程原来的名称与CPU集合）
+        std::string oldName = port::getThreadName();
+        std::vector<int> oldCpus = port::getThreadAffinity();
+        _setupThread(m_bases.size() - 1);
         m_bases.back().loop();
 
         // 等待所有子线程退出
@@ -555,6 +902,28 @@ namespace handy
             if(th.joinable())
                 th.join();
         }
+
+        if(!m_cpuSets.empty() && !oldCpus.empty())
+            port::setThreadAffinity(oldCpus);
+        if(!oldName.empty())
+            port::setThreadName(oldName);
+    }
+
+    void MultiBase::_setupThread(size_t idx)
+    {
+        std::string name = m_threadName + "-" + std::to_string(idx);
+        port::setThreadName(name);
+        if(m_cpuSets.empty())
+            return;
+
+        const std::vector<int>& cpus = m_cpuSets[idx % m_cpuSets.size()];
+        if(!port::setThreadAffinity(cpus))
+        {
+            WARN("%s: failed to set cpu affinity, errno=%d, msg=%s", name.c_str(), errno, strerror(errno));
+            return;
+        }
+        INFO("%s: bound to %zu cpu(s), first cpu=%d, numa node=%d",
+            name.c_str(), cpus.size(), cpus.front(), port::getNumaNode(cpus.front()));
     }
 
     MultiBase& MultiBase::exit()
@@ -564,10 +933,80 @@ namespace handy
         return *this;
     }
 
+    namespace
+    {
+        /**
+         * @brief 线程私有的xorshift随机数（POWER_OF_TWO策略使用，不需要加锁）
+        */
+        uint64_t fastRandom()
+        {
+            thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+
+        int64_t connectionsOf(const EventBase& base)
+        {
+            return base.getStats().connections.load(std::memory_order_relaxed);
+        }
+    } // namespace
+
     EventBase* MultiBase::allocBase()
     {
-        // 轮询分配EventBase（原子操作保证线程安全）
-        int idx = m_id++ % m_bases.size();
+        if(m_allocCB)
+            return &m_bases[m_allocCB(*this) % m_bases.size()];
+
+        size_t n = m_bases.size();
+        size_t idx = 0;
+        switch(m_policy)
+        {
+            // 从轮转的起点开始比较：条件相同的循环之间按轮询分配，而不是总选第一个
+            case AllocPolicy::LEAST_CONNECTIONS:
+                idx = m_id++ % n;
+                for(size_t k = 1; k < n; ++k)
+                {
+                    size_t i = (idx + k) % n;
+                    if(connectionsOf(m_bases[i]) < connectionsOf(m_bases[idx]))
+                        idx = i;
+                }
+                break;
+
+            case AllocPolicy::LEAST_LOADED:
+            {
+                // 繁忙程度相差不到1%时视为相同，取连接数较少者
+                idx = m_id++ % n;
+                double best = m_bases[idx].getRecentBusy();
+                for(size_t k = 1; k < n; ++k)
+                {
+                    size_t i = (idx + k) % n;
+                    double busy = m_bases[i].getRecentBusy();
+                    if(busy < best - 0.01 ||
+                        (busy < best + 0.01 && connectionsOf(m_bases[i]) < connectionsOf(m_bases[idx])))
+                    {
+                        best = busy;
+                        idx = i;
+                    }
+                }
+                break;
+            }
+
+            case AllocPolicy::POWER_OF_TWO:
+                if(n > 1)
+                {
+                    size_t a = fastRandom() % n;
+                    size_t b = (a + 1 + fastRandom() % (n - 1)) % n;
+                    idx = connectionsOf(m_bases[b]) < connectionsOf(m_bases[a]) ? b : a;
+                }
+                break;
+
+            case AllocPolicy::ROUND_ROBIN:
+            default:
+                // 轮询分配EventBase（原子操作保证线程安全）
+                idx = m_id++ % n;
+                break;
+        }
         return &m_bases[idx];
     }
 
@@ -607,6 +1046,57 @@ namespace handy
         TRACE("Channel destroyed: id=%lld, fd=%d", m_id, m_fd); 
     }
 
+    namespace
+    {
+        // 池化Channel的内存块头部（保持对象按max_align_t对齐）
+        struct alignas(std::max_align_t) ChannelBlockHeader
+        {
+            BlockPool* pool;    // 所属的对象池（nullptr表示全局堆）
+            size_t size;        // 内存块大小（含头部）
+        };
+    } // namespace
+
+    void* Channel::operator new(size_t size, EventBase* base)
+    {
+        BlockPool* pool = base ? base->getLocalPool() : nullptr;
+        size_t total = size + sizeof(ChannelBlockHeader);
+        void* p = pool ? pool->allocate(total) : ::operator new(total);
+        ChannelBlockHeader* header = ::new (p) ChannelBlockHeader{pool, total};
+        return header + 1;
+    }
+
+    void Channel::operator delete(void* p, EventBase*) noexcept
+    {
+        Channel::operator delete(p);
+    }
+
+    void* Channel::operator new(size_t size)
+    {
+        return Channel::operator new(size, nullptr);
+    }
+
+    void Channel::operator delete(void* p) noexcept
+    {
+        if(!p)
+            return;
+        ChannelBlockHeader* header = static_cast<ChannelBlockHeader*>(p) - 1;
+        if(header->pool)
+            header->pool->deallocate(header, header->size);
+        else
+            ::operator delete(header);
+    }
+
+    int Channel::releaseFd()
+    {
+        if(m_fd < 0)
+            return -1;
+        m_poller->removeChannel(this);
+        int fd = m_fd;
+        m_fd = -1;
+        TRACE("Channel released fd: id=%lld, fd=%d", m_id, fd);
+        return fd;
+    }
+
     void Channel::close()
     {
         if(m_fd >= 0)
@@ -628,6 +1118,46 @@ namespace handy
         }
     }
 
+    void Channel::handleRead()
+    {
+        TRACE("Channel::handleRead: will call m_readCB");
+        if(!m_readCB)
+        {
+            WARN("Channel::handleRead: m_readCB is null");
+            return;
+        }
+
+        // 回调中可能释放Channel自身，先保存需要的成员
+        // 唤醒管道的读回调会执行任务队列，任务的耗时已单独检查，这里需要扣除
+        EventsImp* imp = m_base->getImp();
+        CallSite site = m_readSite;
+        int64_t taskTime_us = imp->m_taskTime_us;
+        int64_t userTime_us = imp->m_userTime_us;
+        int64_t start_us = imp->callbackStart();
+        m_readCB();
+        imp->callbackDone(start_us, taskTime_us, userTime_us, site, "read");
+        TRACE("Channel::handleRead: done call m_readCB");
+    }
+
+    void Channel::handleWrite()
+    {
+        TRACE("Channel::handleWrite: will call m_writeCB");
+        if(!m_writeCB)
+        {
+            WARN("Channel::handleWrite: m_writeCB is null");
+            return;
+        }
+
+        EventsImp* imp = m_base->getImp();
+        CallSite site = m_writeSite;
+        int64_t taskTime_us = imp->m_taskTime_us;
+        int64_t userTime_us = imp->m_userTime_us;
+        int64_t start_us = imp->callbackStart();
+        m_writeCB();
+        imp->callbackDone(start_us, taskTime_us, userTime_us, site, "write");
+        TRACE("Channel::handleWrite: done call m_writeCB");
+    }
+
     void Channel::enableRead(bool enable)
     {
         if(enable)
@@ -666,26 +1196,62 @@ namespace handy
         return m_events & kWriteEvent;
     }
 
-    void handleUnregisterIdle(EventBase* base, const IdleId& idleIdPtr)
+    void handleRegisterIdle(EventBase* base, int idle_s, IdleNode* node)
     {
-        if(base && idleIdPtr)
-            base->getImp()->unregisterIdle(idleIdPtr);
+        if(base)
+            base->getImp()->registerIdle(idle_s, node);
     }
 
-    void handleUpdateIdle(EventBase* base, const IdleId& idleIdPtr)
+    void handleUnregisterIdle(EventBase* base, IdleNode* node)
     {
-        if(base && idleIdPtr)
-            base->getImp()->updateIdle(idleIdPtr);
+        if(base && node)
+            base->getImp()->unregisterIdle(node);
     }
 
-    void TcpConn::addIdleCB(int idle_ms, const TcpCallBack& cb)
+    void handleUpdateIdle(EventBase* base, IdleNode* node)
+    {
+        if(base && node)
+            base->getImp()->updateIdle(node);
+    }
+
+    CallbackStamp handleCallbackStart(EventBase* base)
+    {
+        EventsImp* imp = base ? base->getImp() : nullptr;
+        if(!imp || imp->m_slowThreshold_us <= 0)
+            return CallbackStamp{};
+        return CallbackStamp{utils::steadyMicro(), imp->m_userTime_us};
+    }
+
+    void handleCallbackDone(EventBase* base, const CallbackStamp& stamp, const CallSite& site, const char* kind)
+    {
+        if(stamp.start_us == 0)
+            return;
+        // 嵌套的用户回调已单独计时，只统计本回调自身的耗时；外层回调扣除整个回调的耗时
+        EventsImp* imp = base->getImp();
+        int64_t used_us = utils::steadyMicro() - stamp.start_us - (imp->m_userTime_us - stamp.userTime_us);
+        if(used_us >= imp->m_slowThreshold_us)
+            imp->reportSlow(kind, site, used_us);
+        imp->m_userTime_us += used_us;
+    }
+
+    void handleUpdateConnections(EventBase* base, int delta)
+    {
+        if(base)
+            base->getImp()->m_stats.connections.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    void TcpConn::addIdleCB(int idle_s, const TcpCallBack& cb)
     {
         if(m_channel && getBase())
         {
-            m_idleIds.push_back(
-                getBase()->getImp()->registerIdle(idle_ms, shared_from_this(), cb)
-            );
-        }   
+            // 第一个空闲回调使用内嵌节点，其余的（不同超时时间）才额外分配
+            IdleNode* node = &m_idleNode;
+            if(m_idleNode.cb)
+                node = &m_extraIdleNodes.emplace_back();
+            node->conn = this;
+            node->cb = cb;
+            getBase()->getImp()->registerIdle(idle_s, node);
+        }
     }
 
     void TcpConn::_reconnect()
@@ -724,12 +1290,8 @@ namespace handy
         });
 
         // 清理当前的Channel
-        Channel* ch = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(m_ChannelMutex);
-            ch = m_channel;
-            m_channel = nullptr;
-        }
+        Channel* ch = m_channel;
+        m_channel = nullptr;
         delete ch;
     }
 }   // namespace handy
\ No newline at end of file
@@ -6,15 +6,32 @@
 #include "handy-imp.h"
 #include "poller.h"
 #include "utils.h"
+#include "metrics.h"
+#include "object_pool.h"
 
 namespace handy
 {
     typedef std::shared_ptr<TcpConn> TcpConnPtr;   // TCP连接指针
     typedef std::shared_ptr<TCPServer> TcpServerPtr; // TCP服务器指针（管理服务器生命周期）
-    typedef std::function<void(const TcpConnPtr&)> TcpCallBack; // TCP连接相关回调（如连接建立/关闭）
+    typedef InlineFunction<void(const TcpConnPtr&), 48, true> TcpCallBack; // TCP连接相关回调（如连接建立/关闭；服务器会把回调拷贝给每个连接，因此可拷贝）
     typedef std::function<void(const TcpConnPtr&, const Slice&)> MsgCallBack;  // 消息处理回调（接受连接与消息切片）
-    typedef std::function<void()> Task; // 通用任务回调（无参数无返回值，用于异步任务/事件处理
+    typedef InlineFunction<void()> Task; // 通用任务回调（无参数无返回值，用于异步任务/事件处理；只能移动）
     
+    /**
+     * @brief 回调的注册位置（文件名:行号），用于定位执行过慢的回调
+     * @details 作为默认参数使用时，current()在调用者处求值，记录的是调用者的位置
+    */
+    struct CallSite
+    {
+        const char* file = "";
+        int line = 0;
+
+        static constexpr CallSite current(const char* file = __builtin_FILE(), int line = __builtin_LINE()) noexcept
+        {
+            return CallSite{file, line};
+        }
+    };
+
     // 可重复定时器结构体（存储重读定时器的核心信息）
     struct TimerRepeatable
     {
@@ -22,34 +39,47 @@ namespace handy
         int64_t interval_ms;    // 定时器重复间隔（毫秒）
         TimerId timerIdPair;        // 当前周期的定时器ID（用于取消）
         Task task;              // 定时器触发时执行的任务（回调函数）
+        CallSite site;          // 定时器的注册位置
     };
 
-    // 空闲连接节点结构体（存储单个空闲连接的管理信息）
-    struct IdleNode
+    struct IdleList;
+
+    /**
+     * @brief 空闲连接链表节点（侵入式，嵌入在TcpConn中）
+     * @details 1. 同一超时时间的连接串成一条双向链表，按最后活跃时间排序，最早超时的在表头
+     *          2. 活跃时间以秒为粒度，同一秒内重复更新只比较时间戳，不改动链表，也不访问相邻节点
+     *          3. 链表只保存裸指针，连接关闭（cleanup）时负责把节点摘除
+    */
+    struct IdleNode : private NonCopyAble
     {
-        TcpConnPtr conn;        // 空闲连接的智能指针（需确保连接不被提前释放）
-        int64_t lastUpdatedTimestamp_s;  // 最后一次活跃时间戳（单位：秒）
-        TcpCallBack cb;         // 空闲超时触发的回调函数（如关闭连接/发送心跳）
+        IdleNode* prev = nullptr;           // 前驱节点
+        IdleNode* next = nullptr;           // 后继节点
+        IdleList* list = nullptr;           // 所在的空闲链表（nullptr：未注册）
+        int64_t lastUpdatedTimestamp_s = 0; // 最后一次活跃时间戳（单调时钟，单位：秒）
+        int idle_s = 0;                     // 空闲超时时间（秒，注册时记录，迁移连接时据此重新注册）
+        TcpConn* conn = nullptr;            // 所属连接
+        TcpCallBack cb;                     // 空闲超时触发的回调函数（如关闭连接/发送心跳）
+
+        IdleNode() = default;
     };
 
     /**
-     * @brief 空闲连接ID实现结构体（封装空闲连接的列表迭代器）
+     * @brief 事件循环运行统计
+     * @details 只由事件循环线程写入（relaxed原子操作），其他线程可以随时读取，用于监控导出
     */
-    struct IdleIdImp
+    struct LoopStats
     {
-        // 空闲连接列表迭代器类型
-        using Iter = std::list<IdleNode>::iterator;
-
-        /**
-         * @brief 构造函数，初始化空闲连接ID
-         * @param lst 空闲连接列表指针（非空，生命周期需长于IdleIdImp）
-         * @param iter 列表中的迭代器（指向具体的空闲连接节点）
-        */
-        IdleIdImp(std::list<IdleNode>* lst, Iter iter)
-            : m_lst(lst), m_iter(iter) {}
-
-        std::list<IdleNode>* m_lst;     // 空闲连接列表指针
-        Iter m_iter;                    // 列表迭代器(指向当前空闲的连接节点)
+        std::atomic<uint64_t> iterations{0};    // 循环次数
+        std::atomic<int64_t> timers{0};         // 当前注册的定时器数量
+        std::atomic<uint64_t> slowCallbacks{0}; // 超过慢回调阈值的回调次数
+        std::atomic<int64_t> connections{0};    // 当前关联的TCP连接数（负载均衡使用；含已分配到该循环、尚未attach的被动连接）
+        std::atomic<uint32_t> busyPermille{0};  // 最近一个统计窗口内处理事件的时间占比（千分比，与上一窗口平滑）
+        std::atomic<int64_t> busyUpdated_us{0}; // busyPermille的更新时刻（单调时钟，微秒）
+        Histogram busy_us;                      // 每轮循环处理事件的耗时（微秒，不含poll等待）
+        Histogram pollWait_us;                  // 每轮循环在poll中等待的时间（微秒）
+        Histogram io_us;                        // 每轮循环执行I/O回调的耗时（微秒，不含任务队列）
+        Histogram timers_us;                    // 每轮循环执行定时器的耗时（微秒）
+        Histogram tasks_us;                     // 每轮循环执行safeCall任务的耗时（微秒）
     };
 
     /**
@@ -67,6 +97,32 @@ namespace handy
             virtual ~EventBases() = default;
     };
 
+    /**
+     * @class BaseHandle
+     * @brief 事件循环的共享句柄，EventBase析构时失效
+     * @details 其他线程可能在事件循环析构之后才投递任务时（如阻塞在名字查询中的解析线程），
+     *          保存句柄而不是EventBase指针，通过句柄投递任务
+    */
+    class BaseHandle : private NonCopyAble
+    {
+        public:
+            explicit BaseHandle(EventBase* base) : m_base(base) {}
+
+            /**
+             * @brief 投递异步任务（线程安全）
+             * @param task 要投递的任务
+             * @param site 投递位置（默认为调用者位置，用于慢回调告警）
+             * @return bool true：已投递，false：事件循环已析构，任务被丢弃（在调用者线程中析构）
+            */
+            bool safeCall(Task&& task, CallSite site = CallSite::current());
+
+        private:
+            std::mutex m_mutex;     // 使投递与EventBase析构互斥
+            EventBase* m_base;      // 事件循环（析构后为nullptr）
+
+            friend class EventBase;
+    };
+
     /**
      * @class EventBase
      * @brief 单线程事件派发器，管理定时器、I/O事件、异步任务
@@ -108,46 +164,25 @@ namespace handy
             /**
              * @brief 在执行时间戳执行任务（支持周期性）
              * @param timestamp_ms 任务执行的时间戳（毫秒级，从epoch开始计算）
-             * @param task 要执行的任务（右值引用）
+             * @param task 要执行的任务（只能移动；需要复用同一个任务时请在外层包一层lambda）
              * @param interval_ms 任务重复执行间隔（毫秒级，0表示不重复）
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
              * @return TimerId 定时器ID（用于后续取消），事件循环已退出时返回无效ID
             */
-            TimerId runAt(int64_t timestamp_ms, Task&& task, int64_t interval_ms = 0);
-
-            /**
-             * @brief 在执行时间戳执行任务（支持周期性）
-             * @param timestamp_ms 任务执行的时间戳（毫秒级，从epoch开始计算）
-             * @param task 要执行的任务（左值引用）
-             * @param interval_ms 任务重复执行周期（毫秒级，00表示不重复执行）
-             * @return TimerId 定时器ID（用于后续取消），事件循环已退出时返回无效ID
-            */
-            TimerId runAt(int64_t timestamp_ms,const Task& task, int64_t interval_ms = 0)
-            {
-                return runAt(timestamp_ms, Task(task), interval_ms);
-            };
+            TimerId runAt(int64_t timestamp_ms, Task&& task, int64_t interval_ms = 0,
+                            CallSite site = CallSite::current());
 
             /**
              * @brief 在指定延迟后执行任务（支持周期性）
              * @param timestamp_ms 延迟时间（毫秒）
-             * @param task 要执行的任务(右值引用)
+             * @param task 要执行的任务
              * @param interval_ms 任务执行间隔（毫秒），为0则不执行周期性
              * @return TimerId 定时器ID（用于后续取消），事件循环已退出时返回无效ID
             */
-            TimerId runAfter(int64_t timestamp_ms, Task&& task, int64_t interval_ms = 0)
-            {
-                return runAt(utils::timeMilli() + timestamp_ms, std::move(task), interval_ms);
-            }
-
-            /**
-             * @brief 在指定延迟时间后执行任务（支持周期性）
-             * @param timestamp_ms 延迟时间（毫秒）
-             * @param task 任务（左值引用）
-             * @param interval_ms 周期性执行间隔（毫秒），为0则不执行周期性
-             * @return TimerId 定时器ID（用于后续取消），事件循环已退出时返回无效ID
-            */
-            TimerId runAfter(int64_t timestamp_ms, const Task& task, int64_t interval_ms = 0)
+            TimerId runAfter(int64_t timestamp_ms, Task&& task, int64_t interval_ms = 0,
+                                CallSite site = CallSite::current())
             {
-                return runAt(utils::timeMilli() + timestamp_ms, Task(task), interval_ms);
+                return runAt(utils::timeMilli() + timestamp_ms, std::move(task), interval_ms, site);
             }
 
             /**
@@ -163,6 +198,13 @@ namespace handy
             */
             bool exited();
 
+            /**
+             * @brief 判断调用者是否处于事件循环线程中（线程安全）
+             * @return bool true:调用者正在执行loop()，或loop()当前没有运行；false:其他线程
+             * @note 只识别loop()，由调用者自行驱动loopOnce()时总是返回true
+            */
+            bool isInLoopThread() const;
+
             /**
              * @brief 唤醒事件循环（线程安全）
              * @details 向唤醒管道写入数据，触发Poller返回，打破loopOnce()的阻塞
@@ -170,19 +212,19 @@ namespace handy
             void wakeup();
 
             /**
-             * @brief 投递异步任务（线程安全，右值引用）
+             * @brief 投递异步任务（线程安全）
              * @param task 要投递的任务（加入任务队列，由事件循环线程执行）
+             * @param site 投递位置（默认为调用者位置，用于慢回调告警）
              * @details 任务投递后唤醒事件循环，确保任务及时执行
             */
-            void safeCall(Task&& task);
+            void safeCall(Task&& task, CallSite site = CallSite::current());
 
             /**
-             * @brief 投递异步任务（线程安全，左值引用）
-             * @param task 要投递的任务（加入任务队列，由事件循环线程执行）
+             * @brief 获取事件循环的共享句柄（EventBase析构时失效，见BaseHandle）
             */
-            void safeCall(const Task& task)
+            const std::shared_ptr<BaseHandle>& getHandle() const
             {
-                safeCall(Task(task));
+                return m_handle;
             }
 
             /**
@@ -199,6 +241,49 @@ namespace handy
             */
             PollerBase* getPoller() const;
 
+            /**
+             * @brief 获取事件循环的对象池（用于连接、通道等频繁创建销毁的对象）
+             * @return BlockPool* 调用者正是执行loop()的线程时返回对象池，否则返回nullptr（应使用全局堆）
+             * @note loop()未运行时（启动前、退出后或由调用者驱动loopOnce()）总是返回nullptr：
+             *       对象池同一时刻只能由一个线程分配，此时无法确定该线程
+            */
+            BlockPool* getLocalPool() const;
+
+            /**
+             * @brief 获取事件循环运行统计（线程安全）
+            */
+            const LoopStats& getStats() const;
+
+            /**
+             * @brief 获取任务队列中等待执行的任务数量（线程安全）
+            */
+            size_t getPendingTasks() const;
+
+            /**
+             * @brief 获取事件循环最近的繁忙程度（线程安全）
+             * @details 由LoopStats::busyPermille换算；事件循环阻塞在poll中、尚未发布新窗口时，
+             *          按距上次发布的时长衰减，避免空闲下来的循环一直显示为繁忙
+             * @return double 处理事件的时间占比（0~1）
+            */
+            double getRecentBusy() const;
+
+            /**
+             * @brief 设置慢回调阈值：单个I/O回调、定时器或任务执行超过阈值时输出告警（含注册位置）
+             * @param threshold_us 阈值（微秒），0表示关闭告警
+             * @note 需在循环线程中调用，或在loop()启动前调用
+            */
+            void setSlowCallbackThreshold(int64_t threshold_us);
+
+            /**
+             * @brief 设置忙轮询模式（用于对延迟敏感、可以独占一个CPU核心的事件循环）
+             * @param spin_us 连续空转的预算（微秒）：循环以0超时反复轮询I/O、任务队列与定时器，
+             *                超过预算仍没有事件时退回阻塞等待一次，之后重新开始自旋；0表示关闭（默认）
+             * @details 自旋期间跨线程投递的任务不写唤醒管道，省去一次系统调用与睡眠-唤醒的切换；
+             *          建议同时将循环线程绑定到独占的CPU（见MultiBase::setCpuAffinity()）
+             * @note 需在循环线程中调用，或在loop()启动前调用
+            */
+            void setBusyPoll(int64_t spin_us);
+
             /**
              * @brief 获取EventsImp对象指针
             */
@@ -208,6 +293,7 @@ namespace handy
             }
         private:
             std::unique_ptr<EventsImp> m_imp; // 事件派发器内部实现对象
+            std::shared_ptr<BaseHandle> m_handle; // 共享句柄（析构时最先失效）
 
             friend struct EventsImp; // 允许Pimpl实现类访问主类私有成员，实现内部协作
             friend class TcpConn;   // 允许TCP连接类直接操作事件派发器内部状态，避免暴露底层接口
@@ -217,13 +303,29 @@ namespace handy
      * @class MultiBase
      * @brief 多线程事件派发器（管理多个EventBase，实现负载均衡）
      * @details 1. 内部维护多个EventBase实例，每个对应一个事件循环线程
-     *          2. 通过轮询算法分配EventBase，实现任务的负载均衡
+     *          2. 分配策略可选：轮询（默认）、最少连接、最近最空闲、随机两选一，也可以自定义
      *          3. 支持批量控制所有事件循环（如批量退出）
-     * @note 线程安全：allocBase()、ecit()为线程安全接口，loop()须在主线程调用
+     *          4. 事件循环线程按"前缀-下标"命名（默认handy-io-0、handy-io-1...），可以绑定到指定的CPU集合
+     * @note 线程安全：allocBase()、ecit()为线程安全接口，loop()须在主线程调用，
+     *       setAllocPolicy()、setThreadName()、setCpuAffinity()须在loop()之前调用
     */
     class MultiBase : public EventBases
     {
         public:
+            /**
+             * @brief EventBase分配策略
+            */
+            enum class AllocPolicy
+            {
+                ROUND_ROBIN,        // 轮询
+                LEAST_CONNECTIONS,  // 当前连接数最少（LoopStats::connections），相同时轮询
+                LEAST_LOADED,       // 最近处理事件的时间占比最低（getRecentBusy()），相同时取连接数少者
+                POWER_OF_TWO,       // 随机选取两个，取连接数较少者（避免大量连接同时涌向同一个循环）
+            };
+
+            // 自定义分配策略：返回要分配的EventBase下标（[0, size())）
+            using AllocCallBack = std::function<size_t(const MultiBase&)>;
+
             /**
              * @brief 初始化多线程事件派发器
              * @param sz EventBase数量（即事件循环线程数，sz <= 0时，sz = 1）
@@ -244,14 +346,72 @@ namespace handy
             MultiBase& exit();
 
             /**
-             * @brief 分配事件派发器（轮询方式，负载均衡）
+             * @brief 分配事件派发器（按当前的分配策略）
              * @return EventBase* 分配的EventBase指针（非空）
             */
             EventBase* allocBase() override;
+
+            /**
+             * @brief 设置分配策略
+            */
+            void setAllocPolicy(AllocPolicy policy)
+            {
+                m_policy = policy;
+                m_allocCB = nullptr;
+            }
+
+            /**
+             * @brief 设置自定义的分配策略
+             * @param cb 分配函数（在调用allocBase()的线程中执行，需自行保证线程安全）
+            */
+            void setAllocPolicy(const AllocCallBack& cb) { m_allocCB = cb; }
+
+            /**
+             * @brief 设置事件循环线程的名称前缀（线程名为"前缀-下标"，默认前缀为handy-io）
+            */
+            MultiBase& setThreadName(const std::string& prefix)
+            {
+                m_threadName = prefix;
+                return *this;
+            }
+
+            /**
+             * @brief 设置事件循环线程绑定的CPU集合
+             * @param cpuSets 第i个事件循环绑定到cpuSets[i % cpuSets.size()]（为空时不绑定）
+             * @details 1. 最后一个事件循环运行在调用loop()的线程中，同样会被绑定，loop()返回前恢复该线程原来的名称与CPU集合
+             *          2. 连接的Buffer、对象池中的内存块都在事件循环线程中首次写入，
+             *             绑定后由内核按首次访问（first-touch）策略分配在该线程所在的NUMA节点上
+            */
+            MultiBase& setCpuAffinity(const std::vector<std::vector<int>>& cpuSets)
+            {
+                m_cpuSets = cpuSets;
+                return *this;
+            }
+
+            /**
+             * @brief 获取EventBase数量
+            */
+            size_t size() const { return m_bases.size(); }
+
+            /**
+             * @brief 获取指定下标的EventBase
+            */
+            EventBase* getBase(size_t idx) { return &m_bases[idx]; }
+            const EventBase* getBase(size_t idx) const { return &m_bases[idx]; }
+
         private:
+            /**
+             * @brief 设置第idx个事件循环线程的名称与CPU绑定（在该线程中调用）
+            */
+            void _setupThread(size_t idx);
+
             std::atomic<int> m_id;  // 计数器，用于轮询分配EventBase
+            AllocPolicy m_policy;   // 分配策略
+            AllocCallBack m_allocCB;    // 自定义分配策略（非空时优先使用）
             std::vector<EventBase> m_bases; // 存储所有EventBase对象
             std::vector<std::thread> m_threads; // 存储所有事件循环线程(大小为m_bases.size() - 1，主线程运行最后一个EventBase)
+            std::string m_threadName;   // 事件循环线程的名称前缀
+            std::vector<std::vector<int>> m_cpuSets;    // 事件循环线程绑定的CPU集合（为空时不绑定）
     };
 
     /**
@@ -280,6 +440,21 @@ namespace handy
             */
             ~Channel();
 
+            /**
+             * @brief 从事件循环的对象池中分配Channel（用法：new (base) Channel(base, fd, events)）
+             * @details 内存块头部记录所属的对象池，delete时据此归还；不在事件循环线程中时使用全局堆
+            */
+            static void* operator new(size_t size, EventBase* base);
+            static void operator delete(void* p, EventBase* base) noexcept;
+            static void* operator new(size_t size);
+            static void operator delete(void* p) noexcept;
+
+            /**
+             * @brief 从Poller中移除并交出fd（不关闭fd，之后Channel不再关联任何fd）
+             * @return int 交出的fd（已关闭时返回-1）
+            */
+            int releaseFd();
+
             /**
              * @brief 获取关联的事件派发器
              * @return EventBase* 关联的EventBase指针（非空）
@@ -322,39 +497,25 @@ namespace handy
             void close();
 
             /**
-             * @brief 注册读事件回调函数（右值引用）
+             * @brief 注册读事件回调函数
              * @param readcb 读事件触发时执行的回调（非空）
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
             */
-            void onRead(Task&& readcb)
+            void onRead(Task&& readcb, CallSite site = CallSite::current())
             {
                 m_readCB = std::move(readcb);
+                m_readSite = site;
             }
 
             /**
-             * @brief 注册读事件回调函数（左值引用）
-             * @param readcb 读事件触发时执行的回调（非空）
-            */
-            void onRead(const Task& readcb)
-            {
-                m_readCB = readcb;
-            }
-
-            /**
-             * @brief 注册写事件回调函数（右值引用）
+             * @brief 注册写事件回调函数
              * @param writecb 写事件触发时执行的回调（非空）
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
             */
-            void onWrite(Task&& writecb)
+            void onWrite(Task&& writecb, CallSite site = CallSite::current())
             {
                 m_writeCB = std::move(writecb);
-            }
-
-            /**
-             * @brief 注册写事件回调函数（左值引用）
-             * @param writecb 写事件触发时执行的回调（非空）
-            */
-            void onWrite(const Task& writecb)
-            {
-                m_writeCB = writecb;
+                m_writeSite = site;
             }
 
             /**
@@ -390,31 +551,17 @@ namespace handy
 
             /**
              * @brief 处理读事件（调用注册的读事件回调函数）
-             * @note 仅在Poller检测到可读事件时调用，需确保m_readcb非空
+             * @note 1. 仅在Poller检测到可读事件时调用，需确保m_readcb非空
+             * @note 2. 回调耗时超过慢回调阈值时输出告警
             */
-            void handleRead()
-            {
-                TRACE("Channel::handleRead: will call m_readCB");
-                if(m_readCB)
-                    m_readCB();
-                else
-                    WARN("Channel::handleRead: m_readCB is null");
-                TRACE("Channel::handleRead: done call m_readCB");
-            }
+            void handleRead();
 
             /**
              * @brief 处理写事件（调用注册的写事件回调函数）
-             * @note 仅在Poller检测到可写事件时调用，需确保m_writecb非空
+             * @note 1. 仅在Poller检测到可写事件时调用，需确保m_writecb非空
+             * @note 2. 回调耗时超过慢回调阈值时输出告警
             */
-            void handleWrite()
-            {
-                TRACE("Channel::handleRead: will call m_writeCB");
-                if(m_writeCB)
-                    m_writeCB();
-                else
-                    WARN("Channel::handleWrite: m_writeCB is null");
-                TRACE("Channel::handleWrite: done call m_writeCB");
-            }
+            void handleWrite();
 
         private:
             EventBase* m_base;      // 关联的事件派发器（非空）
@@ -425,23 +572,68 @@ namespace handy
             Task m_readCB;          // 读事件回调
             Task m_writeCB;         // 写事件回调
             Task m_errorcb;         // 错误事件回调
+            CallSite m_readSite;    // 读事件回调的注册位置
+            CallSite m_writeSite;   // 写事件回调的注册位置
 
             friend class PollerEpoll;
             friend class PollerKqueue;
     };
 
+    /**
+     * @brief 注册空闲连接（委托给EventBase实现，需在事件循环线程中调用）
+     * @param base 关联的事件派发器（非空）
+     * @param idle_s 空闲超时时间（单位：秒，大于0）
+     * @param node 空闲链表节点（node->cb非空，且未注册到其他链表）
+     * @throw std::invalid_argument 参数无效
+    */
+    void handleRegisterIdle(EventBase* base, int idle_s, IdleNode* node);
+
     /**
      * @brief 注销空闲连接（委托给EventBase实现）
      * @param base 关联的事件派发器（非空）
-     * @param idleIdPtr 要注销的空闲连接（非空）
+     * @param node 要注销的空闲链表节点（未注册时忽略）
     */
-    void handleUnregisterIdle(EventBase* base, const IdleId& idleIdPtr);
+    void handleUnregisterIdle(EventBase* base, IdleNode* node);
 
     /**
      * @brief 更新空闲连接状态（委托给EventBase实现）
      * @param base 关联的事件派发器（非空）
-     * @param idleId 要更新的空闲连接（非空）
-     * @details 重置空闲连接的最后活跃事件，避免被判定为超时
+     * @param node 要更新的空闲链表节点（未注册时忽略）
+     * @details 重置空闲连接的最后活跃时间，避免被判定为超时
+    */
+    void handleUpdateIdle(EventBase* base, IdleNode* node);
+
+    /**
+     * @brief 用户回调的计时起点（handleCallbackStart的返回值）
+    */
+    struct CallbackStamp
+    {
+        int64_t start_us = 0;       // 开始时刻（微秒，0表示不计时）
+        int64_t userTime_us = 0;    // 开始时已单独计时的用户回调累计耗时（微秒）
+    };
+
+    /**
+     * @brief 开始为上层模块（如TcpConn）转发的用户回调计时（需在事件循环线程中调用）
+     * @param base 关联的事件派发器（为空时不计时）
+     * @return CallbackStamp 计时起点（未开启慢回调检查时不计时）
+    */
+    CallbackStamp handleCallbackStart(EventBase* base);
+
+    /**
+     * @brief 用户回调执行完毕：超过慢回调阈值时按用户的注册位置告警
+     * @details 用户回调的耗时会从包含它的Channel回调、任务或定时器的慢回调检查中扣除，
+     *          因此慢回调只报告给真正执行缓慢的那一层
+     * @param base 关联的事件派发器（与handleCallbackStart一致）
+     * @param stamp handleCallbackStart()的返回值
+     * @param site 用户回调的注册位置
+     * @param kind 回调类型（如readable/state）
+    */
+    void handleCallbackDone(EventBase* base, const CallbackStamp& stamp, const CallSite& site, const char* kind);
+
+    /**
+     * @brief 调整事件循环关联的连接数（负载统计，线程安全）
+     * @param base 关联的事件派发器（为空时忽略）
+     * @param delta 变化量
     */
-    void handleUpdateIdle(EventBase* base, const IdleId& idleIdPtr);
+    void handleUpdateConnections(EventBase* base, int delta);
 } // namespace handy
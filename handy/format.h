@@ -0,0 +1,585 @@
+#pragma once
+#include "slice.h"
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief 编译期检查printf风格的格式字符串与参数类型是否匹配
+ * @param fmt 格式字符串（必须是字符串字面量）
+ * @param ... 格式化参数（不求值，只取类型）
+ * @note 日志宏（INFO/ERROR等）已经内置该检查，例如"%s"传入std::string以外的非字符串类型、参数个数不符都会编译失败
+*/
+#define HANDY_CHECK_FORMAT(fmt, ...)                                                                \
+    static_assert(handy::detail::checkFormat(fmt, decltype(handy::detail::formatTypes(__VA_ARGS__)){}), \
+                  "format string does not match the argument types")
+
+namespace handy
+{
+    /**
+     * @class ArraySink
+     * @brief 写入固定大小字符数组的格式化输出（超出部分丢弃，但继续统计总长度）
+     * @note 用于先在栈上缓冲区中格式化，只有放不下时才按size()分配内存再格式化一次
+    */
+    class ArraySink
+    {
+        public:
+            ArraySink(char* buf, size_t cap) noexcept : m_buf(buf), m_cap(cap), m_len(0) {}
+
+            /**
+             * @brief 追加数据
+            */
+            void append(const char* p, size_t n) noexcept
+            {
+                if(m_len < m_cap)
+                    std::memcpy(m_buf + m_len, p, n < m_cap - m_len ? n : m_cap - m_len);
+                m_len += n;
+            }
+
+            /**
+             * @brief 获取格式化结果的总长度（可能大于缓冲区大小）
+            */
+            size_t size() const noexcept { return m_len; }
+
+            /**
+             * @brief 是否有数据被丢弃
+            */
+            bool truncated() const noexcept { return m_len > m_cap; }
+
+        private:
+            char* m_buf;        // 缓冲区
+            size_t m_cap;       // 缓冲区大小
+            size_t m_len;       // 已写入（包括被丢弃）的长度
+    };
+
+    namespace detail
+    {
+        // 格式说明符（%[flags][width][.precision][length]conv）
+        struct FormatSpec
+        {
+            bool left = false;          // '-'：左对齐
+            bool plus = false;          // '+'：正数显示符号
+            bool space = false;         // ' '：正数前加空格
+            bool alt = false;           // '#'：0x前缀等替代形式
+            bool zero = false;          // '0'：用0填充宽度
+            bool widthStar = false;     // 宽度由参数指定
+            bool precisionStar = false; // 精度由参数指定
+            int width = 0;              // 最小宽度
+            int precision = -1;         // 精度（-1：未指定）
+            char conv = '\0';           // 转换字符
+        };
+
+        /**
+         * @brief 解析格式说明符
+         * @param p 指向'%'之后的字符
+         * @param spec 输出解析结果
+         * @return const char* 转换字符之后的位置（格式字符串意外结束时指向'\0'，spec.conv为'\0'）
+        */
+        constexpr const char* parseSpec(const char* p, FormatSpec& spec)
+        {
+            for(;; ++p)
+            {
+                if(*p == '-')
+                    spec.left = true;
+                else if(*p == '+')
+                    spec.plus = true;
+                else if(*p == ' ')
+                    spec.space = true;
+                else if(*p == '#')
+                    spec.alt = true;
+                else if(*p == '0')
+                    spec.zero = true;
+                else
+                    break;
+            }
+            if(*p == '*')
+            {
+                spec.widthStar = true;
+                ++p;
+            }
+            while(*p >= '0' && *p <= '9')
+                spec.width = spec.width * 10 + (*p++ - '0');
+            if(*p == '.')
+            {
+                ++p;
+                spec.precision = 0;
+                if(*p == '*')
+                {
+                    spec.precisionStar = true;
+                    ++p;
+                }
+                while(*p >= '0' && *p <= '9')
+                    spec.precision = spec.precision * 10 + (*p++ - '0');
+            }
+            // 长度修饰符只影响C可变参数的读取方式，这里按参数的实际类型格式化，直接跳过
+            while(*p == 'h' || *p == 'l' || *p == 'L' || *p == 'q' || *p == 'j' || *p == 'z' || *p == 't')
+                ++p;
+            spec.conv = *p;
+            return *p ? p + 1 : p;
+        }
+
+        constexpr bool isIntegerConv(char c)
+        {
+            return c == 'd' || c == 'i' || c == 'u' || c == 'o' || c == 'x' || c == 'X' || c == 'c';
+        }
+
+        constexpr bool isFloatConv(char c)
+        {
+            return c == 'f' || c == 'F' || c == 'e' || c == 'E' || c == 'g' || c == 'G' || c == 'a' || c == 'A';
+        }
+
+        // 参数类别
+        enum class ArgKind
+        {
+            NONE,
+            INTEGER,
+            FLOAT,
+            STRING,         // const char*、std::string、std::string_view、Slice
+            POINTER,
+            UNSUPPORTED
+        };
+
+        template <class T>
+        constexpr ArgKind argKind()
+        {
+            using D = std::decay_t<T>;
+            if constexpr (std::is_integral_v<D> || std::is_enum_v<D>)
+                return ArgKind::INTEGER;
+            else if constexpr (std::is_floating_point_v<D>)
+                return ArgKind::FLOAT;
+            else if constexpr (std::is_same_v<D, char*> || std::is_same_v<D, const char*> || std::is_same_v<D, std::string> ||
+                               std::is_same_v<D, std::string_view> || std::is_same_v<D, Slice>)
+                return ArgKind::STRING;
+            else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>)
+                return ArgKind::POINTER;
+            else
+                return ArgKind::UNSUPPORTED;
+        }
+
+        template <class... Args>
+        struct FormatTypes {};
+
+        // 只用于decltype，取得参数类型列表
+        template <class... Args>
+        FormatTypes<std::decay_t<Args>...> formatTypes(const Args&...);
+
+        constexpr bool matchConv(char conv, ArgKind kind)
+        {
+            if(isIntegerConv(conv))
+                return kind == ArgKind::INTEGER;
+            if(isFloatConv(conv))
+                return kind == ArgKind::FLOAT;
+            if(conv == 's')
+                return kind == ArgKind::STRING;
+            if(conv == 'p')
+                return kind == ArgKind::POINTER || kind == ArgKind::STRING;
+            return false;
+        }
+
+        /**
+         * @brief 检查格式字符串与参数类型（用于HANDY_CHECK_FORMAT）
+         * @return bool 每个说明符（含'*'宽度、精度）都有类型匹配的参数，且没有多余参数时为true
+        */
+        template <class... Args>
+        constexpr bool checkFormat(const char* fmt, FormatTypes<Args...>)
+        {
+            constexpr ArgKind kinds[] = {argKind<Args>()..., ArgKind::NONE};
+            constexpr size_t count = sizeof...(Args);
+            size_t i = 0;
+            for(const char* p = fmt; *p; )
+            {
+                if(*p++ != '%')
+                    continue;
+                if(*p == '%')
+                {
+                    ++p;
+                    continue;
+                }
+                FormatSpec spec;
+                p = parseSpec(p, spec);
+                if(spec.widthStar && (i >= count || kinds[i++] != ArgKind::INTEGER))
+                    return false;
+                if(spec.precisionStar && (i >= count || kinds[i++] != ArgKind::INTEGER))
+                    return false;
+                if(i >= count || !matchConv(spec.conv, kinds[i++]))
+                    return false;
+            }
+            return i == count;
+        }
+
+        template <class T>
+        struct DependentFalse : std::false_type {};
+
+        template <class Out>
+        void pad(Out& out, char c, size_t n)
+        {
+            char buf[32];
+            std::memset(buf, c, sizeof(buf));
+            while(n > 0)
+            {
+                size_t k = n < sizeof(buf) ? n : sizeof(buf);
+                out.append(buf, k);
+                n -= k;
+            }
+        }
+
+        /**
+         * @brief 按宽度与对齐方式输出：前缀（符号、0x）+ 内容
+         * @param zeroPad 是否允许用0填充（只对数字有效）
+        */
+        template <class Out>
+        void writePadded(Out& out, const FormatSpec& spec, bool zeroPad, const char* prefix, size_t prefixLen, const char* body, size_t len)
+        {
+            size_t total = prefixLen + len;
+            size_t fill = spec.width > 0 && static_cast<size_t>(spec.width) > total ? spec.width - total : 0;
+            if(spec.left)
+            {
+                out.append(prefix, prefixLen);
+                out.append(body, len);
+                pad(out, ' ', fill);
+            }
+            else if(zeroPad && spec.zero)
+            {
+                out.append(prefix, prefixLen);
+                pad(out, '0', fill);
+                out.append(body, len);
+            }
+            else
+            {
+                pad(out, ' ', fill);
+                out.append(prefix, prefixLen);
+                out.append(body, len);
+            }
+        }
+
+        template <class Out, class T>
+        void formatInteger(Out& out, const FormatSpec& spec, T value)
+        {
+            if(spec.conv == 'c')
+            {
+                char c = static_cast<char>(value);
+                writePadded(out, spec, false, "", 0, &c, 1);
+                return;
+            }
+
+            using U = std::make_unsigned_t<T>;
+            bool neg = false;
+            U u = static_cast<U>(value);
+            // %u/%x/%o与printf一致，按无符号解释
+            if constexpr (std::is_signed_v<T>)
+            {
+                if(spec.conv != 'u' && spec.conv != 'o' && spec.conv != 'x' && spec.conv != 'X' && value < 0)
+                {
+                    neg = true;
+                    u = static_cast<U>(U(0) - u);
+                }
+            }
+            int base = (spec.conv == 'x' || spec.conv == 'X') ? 16 : spec.conv == 'o' ? 8 : 10;
+
+            // 精度指定最少数字个数，不足时补0
+            char buf[192];
+            char* digits = buf + 128;
+            auto r = std::to_chars(digits, buf + sizeof(buf), static_cast<unsigned long long>(u), base);
+            size_t len = r.ptr - digits;
+            if(spec.conv == 'X')
+            {
+                for(char* p = digits; p < r.ptr; ++p)
+                    if(*p >= 'a' && *p <= 'f')
+                        *p -= 'a' - 'A';
+            }
+            if(spec.precision == 0 && u == 0)
+                len = 0;
+            else if(spec.precision > 0 && static_cast<size_t>(spec.precision) > len)
+            {
+                size_t zeros = static_cast<size_t>(spec.precision) - len;
+                if(zeros > 128)
+                    zeros = 128;
+                digits -= zeros;
+                std::memset(digits, '0', zeros);
+                len += zeros;
+            }
+
+            char prefix[3];
+            size_t prefixLen = 0;
+            if(neg)
+                prefix[prefixLen++] = '-';
+            else if(spec.plus && base == 10)
+                prefix[prefixLen++] = '+';
+            else if(spec.space && base == 10)
+                prefix[prefixLen++] = ' ';
+            if(spec.alt && base == 16 && u != 0)
+            {
+                prefix[prefixLen++] = '0';
+                prefix[prefixLen++] = spec.conv;
+            }
+            else if(spec.alt && base == 8 && (len == 0 || digits[0] != '0'))
+                prefix[prefixLen++] = '0';
+            writePadded(out, spec, spec.precision < 0, prefix, prefixLen, digits, len);
+        }
+
+        /**
+         * @brief to_chars无法处理的浮点格式（'#'标志、超大精度）交给snprintf
+        */
+        template <class Out, class T>
+        void formatFloatFallback(Out& out, const FormatSpec& spec, T value)
+        {
+            char fmt[32];
+            char* f = fmt;
+            *f++ = '%';
+            if(spec.left) *f++ = '-';
+            if(spec.plus) *f++ = '+';
+            if(spec.space) *f++ = ' ';
+            if(spec.alt) *f++ = '#';
+            if(spec.zero) *f++ = '0';
+            *f++ = '*';
+            *f++ = '.';
+            *f++ = '*';
+            if constexpr (std::is_same_v<T, long double>)
+                *f++ = 'L';
+            *f++ = spec.conv;
+            *f = '\0';
+
+            int precision = spec.precision < 0 ? 6 : spec.precision;
+            char buf[512];
+            int n = snprintf(buf, sizeof(buf), fmt, spec.width, precision, value);
+            if(n < 0)
+                return;
+            if(static_cast<size_t>(n) < sizeof(buf))
+            {
+                out.append(buf, n);
+                return;
+            }
+            std::unique_ptr<char[]> big(new (std::nothrow) char[n + 1]);
+            if(big)
+            {
+                snprintf(big.get(), n + 1, fmt, spec.width, precision, value);
+                out.append(big.get(), n);
+            }
+        }
+
+        template <class Out, class T>
+        void formatFloat(Out& out, FormatSpec spec, T value)
+        {
+            if(!isFloatConv(spec.conv))
+                spec.conv = 'g';
+            if(spec.alt || spec.precision > 128)
+                return formatFloatFallback(out, spec, value);
+
+            bool neg = std::signbit(value);
+            if(neg)
+                value = -value;
+            bool finite = std::isfinite(value);
+
+            char buf[512];
+            char* begin = buf;
+            std::to_chars_result r;
+            char lower = spec.conv | 0x20;
+            if(lower == 'a')
+            {
+                *begin++ = '0';
+                *begin++ = 'x';
+                r = spec.precision < 0 ? std::to_chars(begin, buf + sizeof(buf), value, std::chars_format::hex)
+                                       : std::to_chars(begin, buf + sizeof(buf), value, std::chars_format::hex, spec.precision);
+                if(!finite)
+                    begin = buf + 2;
+            }
+            else
+            {
+                std::chars_format f = lower == 'f' ? std::chars_format::fixed : lower == 'e' ? std::chars_format::scientific : std::chars_format::general;
+                r = std::to_chars(begin, buf + sizeof(buf), value, f, spec.precision < 0 ? 6 : spec.precision);
+            }
+            if(r.ec != std::errc())
+                return formatFloatFallback(out, spec, neg ? -value : value);
+
+            char* body = finite ? buf : begin;
+            if(spec.conv >= 'A' && spec.conv <= 'Z')
+            {
+                for(char* p = body; p < r.ptr; ++p)
+                    if(*p >= 'a' && *p <= 'z')
+                        *p -= 'a' - 'A';
+            }
+
+            char sign = neg ? '-' : spec.plus ? '+' : spec.space ? ' ' : '\0';
+            if(lower == 'a' && finite)
+            {
+                // "0x"属于前缀，宽度用0填充时0应位于"0x"之后
+                char prefix[3] = {sign, body[0], body[1]};
+                const char* p = sign ? prefix : prefix + 1;
+                writePadded(out, spec, true, p, sign ? 3 : 2, body + 2, r.ptr - body - 2);
+                return;
+            }
+            writePadded(out, spec, finite, &sign, sign ? 1 : 0, body, r.ptr - body);
+        }
+
+        template <class Out>
+        void formatString(Out& out, const FormatSpec& spec, const char* p, size_t len)
+        {
+            if(spec.precision >= 0 && static_cast<size_t>(spec.precision) < len)
+                len = spec.precision;
+            writePadded(out, spec, false, "", 0, p, len);
+        }
+
+        template <class Out>
+        void formatPointer(Out& out, const FormatSpec& spec, const void* ptr)
+        {
+            if(!ptr)
+            {
+                FormatSpec s = spec;
+                s.precision = -1;
+                return formatString(out, s, "(nil)", 5);
+            }
+            char buf[2 + sizeof(uintptr_t) * 2];
+            auto r = std::to_chars(buf, buf + sizeof(buf), reinterpret_cast<uintptr_t>(ptr), 16);
+            writePadded(out, spec, false, "0x", 2, buf, r.ptr - buf);
+        }
+
+        /**
+         * @brief 按参数的实际类型格式化一个参数（不会因类型与说明符不符而读取错误的内存）
+        */
+        template <class Out, class T>
+        void formatArg(Out& out, const FormatSpec& spec, const T& value)
+        {
+            using D = std::decay_t<T>;
+            if constexpr (std::is_enum_v<D>)
+                formatInteger(out, spec, static_cast<std::underlying_type_t<D>>(value));
+            else if constexpr (std::is_same_v<D, bool>)
+                formatInteger(out, spec, static_cast<int>(value));
+            else if constexpr (std::is_integral_v<D>)
+            {
+                if(isFloatConv(spec.conv))
+                    formatFloat(out, spec, static_cast<double>(value));
+                else
+                    formatInteger(out, spec, value);
+            }
+            else if constexpr (std::is_floating_point_v<D>)
+                formatFloat(out, spec, value);
+            else if constexpr (std::is_same_v<D, char*> || std::is_same_v<D, const char*>)
+            {
+                const char* s = value;
+                if(spec.conv == 'p')
+                    formatPointer(out, spec, s);
+                else if(!s)
+                    formatString(out, spec, "(null)", 6);
+                else
+                    formatString(out, spec, s, spec.precision >= 0 ? strnlen(s, spec.precision) : std::strlen(s));
+            }
+            else if constexpr (std::is_same_v<D, std::string> || std::is_same_v<D, std::string_view> || std::is_same_v<D, Slice>)
+                formatString(out, spec, value.data(), value.size());
+            else if constexpr (std::is_pointer_v<D>)
+                formatPointer(out, spec, reinterpret_cast<const void*>(value));
+            else if constexpr (std::is_null_pointer_v<D>)
+                formatPointer(out, spec, nullptr);
+            else
+                static_assert(DependentFalse<D>::value, "unsupported format argument type");
+        }
+
+        // 类型擦除的参数（避免每种参数组合都生成一份解析循环）
+        template <class Out>
+        struct FormatArg
+        {
+            const void* value;                                          // 参数地址
+            void (*format)(Out&, const FormatSpec&, const void*);       // 格式化函数
+            long long intValue;                                         // 整数参数的值（用于'*'宽度、精度）
+        };
+
+        template <class Out, class T>
+        FormatArg<Out> makeArg(const T& value)
+        {
+            long long intValue = 0;
+            if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+                intValue = static_cast<long long>(value);
+            return {&value, [](Out& out, const FormatSpec& spec, const void* p) { formatArg(out, spec, *static_cast<const T*>(p)); }, intValue};
+        }
+
+        template <class Out>
+        void vformatTo(Out& out, const char* fmt, const FormatArg<Out>* args, size_t count)
+        {
+            size_t next = 0;
+            const char* p = fmt;
+            while(*p)
+            {
+                // 输出普通文本
+                const char* text = p;
+                while(*p && *p != '%')
+                    ++p;
+                if(p > text)
+                    out.append(text, p - text);
+                if(!*p)
+                    break;
+
+                const char* start = p++;
+                if(*p == '%')
+                {
+                    out.append(p++, 1);
+                    continue;
+                }
+                FormatSpec spec;
+                p = parseSpec(p, spec);
+                if(spec.widthStar && next < count)
+                {
+                    long long w = args[next++].intValue;
+                    spec.left = spec.left || w < 0;
+                    spec.width = static_cast<int>(w < 0 ? -w : w);
+                }
+                if(spec.precisionStar && next < count)
+                {
+                    long long prec = args[next++].intValue;
+                    spec.precision = prec < 0 ? -1 : static_cast<int>(prec);
+                }
+                if(!isIntegerConv(spec.conv) && !isFloatConv(spec.conv) && spec.conv != 's' && spec.conv != 'p')
+                {
+                    // 不支持的说明符（含%n）原样输出，不消耗参数
+                    out.append(start, p - start);
+                    continue;
+                }
+                // 参数不足时丢弃说明符
+                if(next < count)
+                {
+                    const FormatArg<Out>& arg = args[next++];
+                    arg.format(out, spec, arg.value);
+                }
+            }
+        }
+    } // namespace detail
+
+    /**
+     * @brief 类型安全的printf风格格式化，结果直接追加到out
+     * @param out 输出对象，需提供append(const char*, size_t)（如std::string、Buffer、ArraySink）
+     * @param fmt 格式字符串，语法同printf（长度修饰符可省略，按参数的实际类型格式化）
+     * @param args 格式化参数：整数、枚举、浮点数、const char*、std::string、std::string_view、Slice、指针
+     * @details 1. 整数、浮点数使用std::to_chars，不经过vsnprintf与locale
+     *          2. 参数按实际类型格式化，std::string传给"%s"、int64_t传给"%d"都能得到正确结果
+     *          3. 不支持的参数类型编译失败；格式字符串的编译期检查见HANDY_CHECK_FORMAT
+    */
+    template <class Out, class... Args>
+    void formatTo(Out& out, const char* fmt, const Args&... args)
+    {
+        if(!fmt)
+            return;
+        const detail::FormatArg<Out> list[] = {detail::makeArg<Out>(args)..., {nullptr, nullptr, 0}};
+        detail::vformatTo(out, fmt, list, sizeof...(Args));
+    }
+
+    /**
+     * @brief 类型安全的snprintf
+     * @param buf 输出缓冲区（size > 0时总是以'\0'结尾）
+     * @param size 缓冲区大小
+     * @return size_t 完整结果的长度（不含'\0'），大于等于size表示结果被截断
+    */
+    template <class... Args>
+    size_t formatTo(char* buf, size_t size, const char* fmt, const Args&... args)
+    {
+        ArraySink sink(buf, size > 0 ? size - 1 : 0);
+        formatTo(sink, fmt, args...);
+        if(size > 0)
+            buf[sink.size() < size ? sink.size() : size - 1] = '\0';
+        return sink.size();
+    }
+} // namespace handy
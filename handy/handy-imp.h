@@ -6,6 +6,9 @@
 #include "thread_pool.h"
 #include "non_copy_able.h"
 #include <type_traits>  // 提供 std::is_default_constructible、std::is_abstract 等
+#include <atomic>
+#include <thread>
+#include <typeinfo>
 
 namespace handy
 {
@@ -13,26 +16,31 @@ namespace handy
     class TcpConn;    // TCP连接抽象类
     class TCPServer;        // TCP服务器抽象类
     class PollerBase;       // 事件轮询抽象类
-    struct IdleIdImp;        // 空闲资源ID实现结构体
+    struct IdleNode;        // 空闲连接链表节点
     struct EventsImp;        // 事件实现结构体
     class EventBase;        // 事件循环基类结构体
-    typedef std::unique_ptr<IdleIdImp> IdleId;      // 空闲资源ID的智能指针类型
     typedef std::pair<int64_t, int64_t> TimerId;    // 定时任务ID类型<超时时间戳，序列号（自增整数）>
 
     /**
      * @class AutoContext
-     * @brief 自动上下文管理器（线程安全）
-     * @details 1. 提供模板化的上下文创建、获取、与自动清理能力，支持任意类型的上下文存储
-     *          2. 基于原子操作与互斥锁保证线程安全，避免数据竞争与内存泄漏
-     *          3. 析构时自动清理上下文资源，也支持显式调用reset()主动释放
-     *          4. 采用“双重检查锁定”模式优化性能，减少锁的竞争开销
+     * @brief 自动上下文管理器（按类型存储，无锁）
+     * @details 1. 每种类型T各有一个上下文，首次调用context<T>()时创建，之后返回同一个对象
+     *          2. 类型标识是每种类型一个的静态变量地址（编译期确定），查找时只比较指针，不比较typeid
+     *          3. 不超过kInlineSize字节的上下文直接构造在对象内部的存储区中，更大的从堆上分配
+     *          4. 每个分片有kSlots个槽位，用完后链接一个新的分片；槽位通过CAS占用，读取与创建都不加锁
+     *             槽位只会按顺序被占用、不会重新变空（创建失败的槽位标记为kDead），因此第一个空槽位之前
+     *             没有找到T就说明T尚未创建
+     *          5. 析构时按创建的逆序销毁所有上下文，也支持显式调用reset()主动释放
      * @note 1. 上下文类型需支持默认构造（无参构造函数）
      * @note 2. 禁止拷贝与移动，确保上下文资源唯一管理
-     * @note 3. 清理函数在持有互斥锁的情况下执行，避免并发销毁导致的野指针
+     * @note 3. context<T>()可以在多个线程中并发调用（同一类型只创建一次）；reset()不能与context<T>()并发调用
     */
     class AutoContext : private NonCopyAble
     {
         public:
+            static constexpr size_t kSlots = 2;         // 每个分片的槽位数
+            static constexpr size_t kInlineSize = 48;   // 对象内部存储区大小（字节）
+
             /**
              * @brief 默认构造函数
             */
@@ -43,8 +51,8 @@ namespace handy
              * @tparam T 上下文类型（需满足：有默认构造函数、非抽象类）
              * @return T& 上下文对象的引用（确保返回有效对象，不会放回空引用）
              * @throw std::bad_alloc 当内存分配失败时抛出此异常（new操作失败触发）
-             * @note 1. 线程安全：支持多线程并发调用，不会导致重复创建或数据竞争
-             * @note 2. 类型安全：通过static_cast强制转换，确保返回正确类型的引用
+             * @note 1. 线程安全：支持多线程并发调用，同一类型不会重复创建
+             * @note 2. 已创建时只有几次原子读取与指针比较，不加锁
             */
             template<typename T>
             T& context()
@@ -55,82 +63,91 @@ namespace handy
                 // 获取或创建指定类型的上下文(避免创建抽象类实例)
                 static_assert(!std::is_abstract<T>::value, 
                                 "Context type T must not be an abstract class");
-                
-                // 第一重检查：无锁读取当前上下文指针（内存序：acquire，确保读取到最新值）
-                void* currentCtx = m_ctx.load(std::memory_order_acquire);
 
-                if(currentCtx == nullptr)
+                const void* key = _key<T>();
+                for(AutoContext* shard = this; ; shard = shard->_next())
                 {
-                    std::lock_guard<std::mutex> lock(m_ctxMutex);
-
-                    // 第二重检查：避免锁竞争期间其他线程已经初始化（内存序：relaxed，无需同步，仅本地检查）
-                    currentCtx = m_ctx.load(std::memory_order_relaxed);
-                    if(currentCtx == nullptr)
+                    for(Slot& slot : shard->m_slots)
                     {
-                        // 1. 分配上下文对象（若内存不足，new会爆出std::bad_alloc异常）
-                        T* newCtx = new T();
-
-                        // 2. 分配清理函数：捕获上下文指针，确保销毁时类型正确
-                        Task* newDel = new Task([newCtx](){
-                            // 销毁上下文对象（类型安全，因为捕获的是T*）
-                            delete newCtx;
-                        });
-
-                        // 3. 原子存储：先存储清理函数，再存储上下文指针（内存序：release，确保写操作可见）
-                        m_ctxDel.store(newDel, std::memory_order_release);
-                        m_ctx.store(newCtx, std::memory_order_release);
-
-                        // 更新当前上下文指针
-                        currentCtx = newCtx;
-
-                        // 日志：记录上下文初始化
-                        DEBUG("AutoContext::context(): Created context of type %s (address %p)",
-                                typeid(T).name(), static_cast<void*>(newCtx));
+                        const void* cur = slot.key.load(std::memory_order_acquire);
+                        // 空槽位：占用后创建（其他线程看到kBusy时等待创建完成）
+                        if(cur == nullptr && slot.key.compare_exchange_strong(cur, &kBusy, std::memory_order_acq_rel))
+                        {
+                            shard->_create<T>(slot);
+                            slot.key.store(key, std::memory_order_release);
+                            return *static_cast<T*>(slot.obj);
+                        }
+                        while(cur == &kBusy)
+                        {
+                            std::this_thread::yield();
+                            cur = slot.key.load(std::memory_order_acquire);
+                        }
+                        if(cur == key)
+                            return *static_cast<T*>(slot.obj);
                     }
                 }
+            }
 
-                // 类型强制转换：确保返回正确类型的引用（因m_ctx存储的是T*，强制转换安全）
-                return *static_cast<T*>(currentCtx);
+            /**
+             * @brief 模板方法：查找指定类型的上下文（不创建）
+             * @tparam T 上下文类型
+             * @return T* 上下文对象指针，尚未创建时为nullptr
+            */
+            template<typename T>
+            T* find() const
+            {
+                const void* key = _key<T>();
+                for(const AutoContext* shard = this; shard; shard = shard->m_next.load(std::memory_order_acquire))
+                {
+                    for(const Slot& slot : shard->m_slots)
+                    {
+                        // 正在创建或创建失败的槽位之后仍可能有已创建的上下文，继续查找
+                        if(slot.key.load(std::memory_order_acquire) == key)
+                            return static_cast<T*>(slot.obj);
+                    }
+                }
+                return nullptr;
             }
     
             /**
-             * @brief 显式重置上下文：释放资源并置空指针
-             * @details 1. 加锁：确保清理操作的线程安全，避免并发重置导致的双重释放
-             *          2. 原子交换：将m_ctx与m_ctxDel置空，同时获取旧值（内存序：acq_rel，确保同步）
-             *          3. 清理逻辑：先执行清理函数销毁上下文对象，再释放清理函数自身的内存
-             * @note 1. 幂等性：支持多次调用，第二次及以后调用无操作（因指针已置空）
-             *       2. 线程安全：多线程并发调用时，仅第一个调用会执行清理逻辑，其他调用无操作
+             * @brief 显式重置上下文：按创建的逆序销毁所有上下文
+             * @note 1. 幂等性：支持多次调用，第二次及以后调用无操作
+             *       2. 不能与context<T>()并发调用（通常在连接关闭或析构时调用）
             */
             void reset()
             {
-                std::lock_guard<std::mutex> lock(m_ctxMutex);
-
-                // 原子交换：获取旧的清理函数指针，并将m_ctxDel置空（内存序：acq_rel）
-                Task* currentDel = m_ctxDel.exchange(nullptr, std::memory_order_acq_rel);
-                // 原子交换：获取旧的上下文指针，并将m_ctx置空（内存序：acq_rel）
-                void* currentCtx = m_ctx.exchange(nullptr, std::memory_order_acq_rel);
-
-                if(currentDel != nullptr && currentCtx != nullptr)
+                AutoContext* next = m_next.exchange(nullptr, std::memory_order_acq_rel);
+                delete next;
+                for(size_t i = kSlots; i-- > 0; )
                 {
-                    // 执行清理函数，销毁上下文对象
-                    (*currentDel)();
-                    // 释放清理函数自身的内存
-                    delete currentDel;
-
-                    // 日志：记录上下文重置
-                    DEBUG("AutoContext::reset(): Reset context (address %p)", currentCtx);
+                    Slot& slot = m_slots[i];
+                    const void* cur = slot.key.exchange(nullptr, std::memory_order_acq_rel);
+                    if(cur != nullptr && cur != &kBusy && cur != &kDead)
+                    {
+                        slot.destroy(slot.obj);
+                        DEBUG("AutoContext::reset(): Reset context (address %p)", slot.obj);
+                    }
+                    slot.obj = nullptr;
+                    slot.destroy = nullptr;
                 }
+                m_inlineUsed.store(0, std::memory_order_relaxed);
             }
 
             /**
              * @brief 检查是否已创建上下文
-             * @return bool true: 已创建上下文，false: 未创建
-             * @details 无锁读取m_ctx指针，线程安全（内存序：acquire，确保读取到最新值）
+             * @return bool true: 已创建任意类型的上下文，false: 未创建
              * @note 线程安全：支持多线程并发调用，无锁开销，性能高效
             */
             bool hasContext() const
             {
-                return m_ctx.load(std::memory_order_acquire) != nullptr;
+                // 创建失败的槽位标记为kDead，已创建的上下文不一定在第一个槽位中
+                for(const Slot& slot : m_slots)
+                {
+                    const void* cur = slot.key.load(std::memory_order_acquire);
+                    if(cur != nullptr && cur != &kBusy && cur != &kDead)
+                        return true;
+                }
+                return m_next.load(std::memory_order_acquire) != nullptr;
             }
 
             /**
@@ -143,14 +160,100 @@ namespace handy
                 reset();
             }
         private:
-            // 上下文对象指针（原子操作确保多线程可见性）
-            std::atomic<void*> m_ctx{nullptr};
+            // 一个上下文槽位
+            struct Slot
+            {
+                std::atomic<const void*> key{nullptr};  // 类型标识（nullptr：空闲，&kBusy：正在创建，&kDead：创建失败）
+                void* obj = nullptr;                    // 上下文对象
+                void (*destroy)(void*) = nullptr;       // 销毁函数（内部存储只析构，堆上的还要释放）
+            };
+
+            // 每种类型一个的静态变量，其地址作为类型标识
+            // 不能是const：值相同的只读常量可能被编译器或链接器合并到同一地址，不同类型会得到相同的标识
+            template<typename T>
+            struct TypeTag
+            {
+                static inline char id;
+            };
+
+            // 正在创建的槽位标识（同样不能是const）
+            static inline char kBusy;
+
+            // 创建失败的槽位标识：槽位不再使用，也不会重新变空。若释放为nullptr，等待该槽位的其他线程
+            // 已经在后面的槽位创建了T，之后的context<T>()会在这个空槽位上再创建一个T
+            static inline char kDead;
 
-            // 互斥锁
-            mutable std::mutex m_ctxMutex;
+            Slot m_slots[kSlots];                           // 槽位
+            std::atomic<AutoContext*> m_next{nullptr};      // 下一个分片（槽位用完时创建）
+            std::atomic<size_t> m_inlineUsed{0};            // 内部存储区已使用的字节数
+            alignas(std::max_align_t) unsigned char m_inline[kInlineSize];  // 内部存储区
 
-            // 上下文清理函数指针
-            // 存储销毁上下文对象的任务，避免析构时类型信息丢失
-            std::atomic<Task*> m_ctxDel{nullptr};
+            template<typename T>
+            static const void* _key()
+            {
+                return &TypeTag<typename std::remove_cv<T>::type>::id;
+            }
+
+            /**
+             * @brief 在槽位中创建T：内部存储区放得下时原地构造，否则从堆上分配
+            */
+            template<typename T>
+            void _create(Slot& slot)
+            {
+                void* p = sizeof(T) <= kInlineSize && alignof(T) <= alignof(std::max_align_t)
+                            ? _allocInline(sizeof(T), alignof(T)) : nullptr;
+                try
+                {
+                    if(p)
+                    {
+                        slot.obj = ::new (p) T();
+                        slot.destroy = [](void* obj) { static_cast<T*>(obj)->~T(); };
+                    }
+                    else
+                    {
+                        slot.obj = new T();
+                        slot.destroy = [](void* obj) { delete static_cast<T*>(obj); };
+                    }
+                }
+                catch(...)
+                {
+                    // 创建失败：标记为kDead（不能释放为空，见kDead）
+                    slot.key.store(&kDead, std::memory_order_release);
+                    throw;
+                }
+                DEBUG("AutoContext::context(): Created context of type %s (address %p, %s)",
+                        typeid(T).name(), slot.obj, p ? "inline" : "heap");
+            }
+
+            /**
+             * @brief 从内部存储区分配（放不下时返回nullptr）
+            */
+            void* _allocInline(size_t size, size_t align)
+            {
+                size_t used = m_inlineUsed.load(std::memory_order_relaxed);
+                size_t off;
+                do
+                {
+                    off = (used + align - 1) / align * align;
+                    if(off + size > kInlineSize)
+                        return nullptr;
+                } while(!m_inlineUsed.compare_exchange_weak(used, off + size, std::memory_order_relaxed));
+                return m_inline + off;
+            }
+
+            /**
+             * @brief 获取下一个分片，不存在时创建
+            */
+            AutoContext* _next()
+            {
+                AutoContext* next = m_next.load(std::memory_order_acquire);
+                if(next)
+                    return next;
+                AutoContext* created = new AutoContext();
+                if(m_next.compare_exchange_strong(next, created, std::memory_order_acq_rel))
+                    return created;
+                delete created;
+                return next;
+            }
     };
 }   // namespace handy
\ No newline at end of file
@@ -0,0 +1,754 @@
+#include "http.h"
+#include "logger.h"
+#include <algorithm>
+#include <time.h>
+
+namespace handy
+{
+    namespace
+    {
+        /**
+         * @brief ASCII小写转换（不受locale影响）
+        */
+        inline char asciiLower(char c)
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+        }
+
+        /**
+         * @brief 在[from, n)区间内查找"\r\n\r\n"
+         * @param p 数据起始指针
+         * @param from 起始偏移
+         * @param n 数据长度
+         * @return size_t "\r\n\r\n"的起始偏移，未找到返回Slice::npos
+        */
+        size_t findHeaderEnd(const char* p, size_t from, size_t n)
+        {
+            if(from >= n)
+                return Slice::npos;
+            const size_t pos = Slice(p + from, n - from).find(Slice("\r\n\r\n", 4));
+            return pos == Slice::npos ? pos : from + pos;
+        }
+
+        /**
+         * @brief 解析十进制长度（仅允许数字，防止溢出）
+         * @param s 数字字符串
+         * @param [out] v 解析结果
+         * @return bool true: 成功，false: 格式错误
+        */
+        bool parseLength(Slice s, size_t& v)
+        {
+            if(s.empty() || s.size() > 18)
+                return false;
+            size_t r = 0;
+            for(const char* p = s.begin(); p < s.end(); ++p)
+            {
+                if(*p < '0' || *p > '9')
+                    return false;
+                r = r * 10 + static_cast<size_t>(*p - '0');
+            }
+            v = r;
+            return true;
+        }
+
+        /**
+         * @brief 获取状态码对应的标准描述
+         * @param status 状态码
+         * @return const char* 状态描述，未知状态码返回空字符串
+        */
+        const char* statusText(int status)
+        {
+            switch(status)
+            {
+                case 100: return "Continue";
+                case 101: return "Switching Protocols";
+                case 200: return "OK";
+                case 201: return "Created";
+                case 202: return "Accepted";
+                case 204: return "No Content";
+                case 206: return "Partial Content";
+                case 301: return "Moved Permanently";
+                case 302: return "Found";
+                case 304: return "Not Modified";
+                case 400: return "Bad Request";
+                case 401: return "Unauthorized";
+                case 403: return "Forbidden";
+                case 404: return "Not Found";
+                case 405: return "Method Not Allowed";
+                case 408: return "Request Timeout";
+                case 413: return "Payload Too Large";
+                case 500: return "Internal Server Error";
+                case 501: return "Not Implemented";
+                case 502: return "Bad Gateway";
+                case 503: return "Service Unavailable";
+                default: return "";
+            }
+        }
+
+        /**
+         * @brief 获取预序列化的HTTP/1.1状态行（进程内只生成一次）
+         * @param status 状态码
+         * @return const std::string* 状态行（含\r\n），未知状态码返回nullptr
+        */
+        const std::string* cachedStatusLine(int status)
+        {
+            static const std::vector<std::string> lines = []
+            {
+                std::vector<std::string> v(600);
+                for(int code = 100; code < 600; ++code)
+                {
+                    const char* word = statusText(code);
+                    if(*word)
+                        v[code] = "HTTP/1.1 " + std::to_string(code) + " " + word + "\r\n";
+                }
+                return v;
+            }();
+            if(status < 100 || status >= 600 || lines[status].empty())
+                return nullptr;
+            return &lines[status];
+        }
+
+        /**
+         * @brief 追加Date头部（每个线程缓存一份，每秒最多格式化一次）
+         * @param [out] buf 输出缓冲区
+        */
+        void appendDateHeader(Buffer& buf)
+        {
+            thread_local time_t cachedSec = 0;
+            thread_local char cached[64];
+            thread_local size_t cachedLen = 0;
+
+            time_t now = time(nullptr);
+            if(now != cachedSec)
+            {
+                struct tm t;
+                gmtime_r(&now, &t);
+                cachedLen = strftime(cached, sizeof(cached), "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &t);
+                cachedSec = now;
+            }
+            buf.append(cached, cachedLen);
+        }
+
+        /**
+         * @brief 根据请求版本与Connection头部判断是否保持连接
+         * @param req HTTP请求
+         * @return bool true: 保持连接，false: 响应后关闭
+        */
+        bool isKeepAlive(const HttpRequest& req)
+        {
+            Slice conn = req.getHeaderSlice("connection");
+            if(req.getVersion() == "HTTP/1.1")
+                return !httpNameEquals(conn, "close");
+            return httpNameEquals(conn, "keep-alive");
+        }
+
+        /**
+         * @brief 在输出缓冲区发送完毕后关闭连接
+         * @param conn TCP连接
+        */
+        void closeWhenFlushed(const TcpConnPtr& conn)
+        {
+            if(conn->getOutputBuffer().empty())
+                conn->close();
+            else
+                conn->onWritable([](const TcpConnPtr& c) { c->close(); });
+        }
+    } // namespace
+
+    bool httpNameEquals(Slice a, Slice b) noexcept
+    {
+        return a.equalsNoCase(b);
+    }
+
+    // -------------------------- HttpMsg --------------------------
+    void HttpMsg::clear()
+    {
+        m_headers.clear();
+        m_headerSlices.clear();
+        m_version = "HTTP/1.1";
+        m_versionSlice.clear();
+        m_body.clear();
+        m_body2.clear();
+        m_completed = false;
+        m_headerParsed = false;
+        m_expect = false;
+        m_contentLen = 0;
+        m_scannedLen = 0;
+        m_errorStatus = 0;
+    }
+
+    Slice HttpMsg::getHeaderSlice(Slice name) const
+    {
+        if(m_zeroCopy)
+            return m_headerSlices.get(name);
+
+        auto it = m_headers.find(name.toString());
+        if(it == m_headers.end())
+        {
+            std::string lower(name.size(), '\0');
+            std::transform(name.begin(), name.end(), lower.begin(), asciiLower);
+            it = m_headers.find(lower);
+        }
+        return it == m_headers.end() ? Slice() : Slice(it->second);
+    }
+
+    std::string HttpMsg::_getValueFromMap(const std::map<std::string, std::string>& map,
+                                            const std::string& name) const
+    {
+        auto it = map.find(name);
+        if(it != map.end())
+            return it->second;
+
+        std::string lower(name);
+        std::transform(lower.begin(), lower.end(), lower.begin(), asciiLower);
+        it = map.find(lower);
+        return it == map.end() ? std::string() : it->second;
+    }
+
+    void HttpMsg::detach()
+    {
+        if(m_zeroCopy)
+        {
+            for(size_t i = 0; i < m_headerSlices.size(); ++i)
+            {
+                const HttpHeaders::Field& f = m_headerSlices[i];
+                std::string key(f.name.size(), '\0');
+                std::transform(f.name.begin(), f.name.end(), key.begin(), asciiLower);
+                m_headers[key] = f.value.toString();
+            }
+            m_headerSlices.clear();
+            m_version.assign(m_versionSlice.data(), m_versionSlice.size());
+            m_versionSlice.clear();
+            m_zeroCopy = false;
+        }
+
+        if(!m_body2.empty())
+        {
+            m_body.assign(m_body2.data(), m_body2.size());
+            m_body2.clear();
+        }
+    }
+
+    bool HttpMsg::_parseHeaderFields(Slice block)
+    {
+        bool hasLen = false;
+        const char* p = block.begin();
+        const char* end = block.end();
+        while(p < end)
+        {
+            // 1. 截取一行（行以\r\n分隔，最后一行没有结尾的\r\n）
+            const char* nl = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+            const char* le = nl ? nl : end;
+            const char* next = nl ? nl + 1 : end;
+            if(le > p && *(le - 1) == '\r')
+                --le;
+
+            // 2. 拆分字段名与字段值
+            const char* colon = static_cast<const char*>(memchr(p, ':', static_cast<size_t>(le - p)));
+            if(colon == nullptr || colon == p || colon[-1] == ' ' || colon[-1] == '\t')
+            {
+                ERROR("bad http header line: %.*s", static_cast<int>(le - p), p);
+                m_errorStatus = 400;
+                return false;
+            }
+            Slice name(p, colon);
+            Slice value(colon + 1, le);
+            value.trimSpace();
+
+            // 3. 提取解析所需的字段
+            if(name.size() == 14 && httpNameEquals(name, "content-length"))
+            {
+                // 重复的Content-Length必须一致，否则前后端对消息边界的理解可能不同
+                size_t len = 0;
+                if(!parseLength(value, len) || (hasLen && len != m_contentLen))
+                {
+                    ERROR("bad content-length: %.*s", static_cast<int>(value.size()), value.data());
+                    m_errorStatus = 400;
+                    return false;
+                }
+                m_contentLen = len;
+                hasLen = true;
+            }
+            // 不支持分块等传输编码：若忽略该字段，消息体会被当作下一个流水线请求解析
+            else if(name.size() == 17 && httpNameEquals(name, "transfer-encoding"))
+            {
+                ERROR("unsupported transfer-encoding: %.*s", static_cast<int>(value.size()), value.data());
+                m_errorStatus = 501;
+                return false;
+            }
+
+            // 4. 保存字段
+            if(m_zeroCopy)
+            {
+                m_headerSlices.add(name, value);
+            }
+            else
+            {
+                std::string key(name.size(), '\0');
+                std::transform(name.begin(), name.end(), key.begin(), asciiLower);
+                m_headers[key] = value.toString();
+            }
+            p = next;
+        }
+        return true;
+    }
+
+    HttpMsg::Result HttpMsg::_tryDecode(Slice buf, bool isCopyBody, Slice& line1)
+    {
+        line1.clear();
+        if(m_completed)
+            return Result::Complete;
+
+        if(!m_headerParsed)
+        {
+            // 1. 从上次停止的位置继续查找头部结束标记，已扫描过的数据不再重复扫描
+            const size_t pos = findHeaderEnd(buf.data(), m_scannedLen, buf.size());
+            if(pos == Slice::npos)
+            {
+                if(buf.size() > kMaxHeaderLen)
+                {
+                    ERROR("http header too long: %zu", buf.size());
+                    return _fail(400);
+                }
+                // 保留最后3个字节，"\r\n\r\n"可能跨越两次到达的数据
+                m_scannedLen = buf.size() > 3 ? buf.size() - 3 : 0;
+                return Result::NotComplete;
+            }
+
+            // 2. 解析首行与头部字段
+            Slice block(buf.data(), pos);
+            const char* nl = static_cast<const char*>(memchr(block.data(), '\n', block.size()));
+            const char* l1e = nl ? nl : block.end();
+            line1 = Slice(block.data(), (l1e > block.data() && *(l1e - 1) == '\r') ? l1e - 1 : l1e);
+            if(line1.empty())
+            {
+                ERROR("http message without start line");
+                return _fail(400);
+            }
+            m_contentLen = 0;
+            m_headerSlices.clear();
+            if(nl && !_parseHeaderFields(Slice(nl + 1, block.end())))
+                return Result::Error;
+            if(m_contentLen > m_maxBodyLen)
+            {
+                ERROR("http body too large: %zu > %zu", m_contentLen, m_maxBodyLen);
+                return _fail(413);
+            }
+
+            // 3. 零拷贝模式下，若消息体未到齐则丢弃本次解析结果，
+            //    避免持有的Slice在缓冲区扩容后失效；下次直接从头部结束位置开始
+            const size_t headerLen = pos + 4;
+            if(m_zeroCopy && buf.size() < headerLen + m_contentLen)
+            {
+                const bool expect = !m_headerSlices.get("expect").empty();
+                m_headerSlices.clear();
+                m_scannedLen = pos;
+                line1.clear();
+                if(expect && !m_expect)
+                {
+                    m_expect = true;
+                    return Result::Continue100;
+                }
+                return Result::NotComplete;
+            }
+
+            m_scannedLen = headerLen;
+            m_headerParsed = true;
+            if(buf.size() < headerLen + m_contentLen && !getHeaderSlice("expect").empty())
+            {
+                m_expect = true;
+                return Result::Continue100;
+            }
+        }
+
+        // 4. 消息体
+        if(buf.size() < m_scannedLen + m_contentLen)
+            return Result::NotComplete;
+
+        if(isCopyBody)
+            m_body.assign(buf.data() + m_scannedLen, m_contentLen);
+        else
+            m_body2 = Slice(buf.data() + m_scannedLen, m_contentLen);
+        m_scannedLen += m_contentLen;
+        m_completed = true;
+        return Result::Complete;
+    }
+
+    void HttpMsg::_encodeHeadersAndBody(Buffer& buf)
+    {
+        for(auto& hd : m_headers)
+        {
+            buf.append(hd.first).append(": ").append(hd.second).append("\r\n");
+        }
+        Slice body = getBody();
+        char conlen[64];
+        int n = snprintf(conlen, sizeof conlen, "Content-Length: %zu\r\n\r\n", body.size());
+        buf.append(conlen, static_cast<size_t>(n)).append(body);
+    }
+
+    // -------------------------- HttpRequest --------------------------
+    void HttpRequest::clear()
+    {
+        HttpMsg::clear();
+        m_method = "GET";
+        m_uri.clear();
+        m_queryUri.clear();
+        m_methodSlice.clear();
+        m_uriSlice.clear();
+        m_queryUriSlice.clear();
+    }
+
+    void HttpRequest::detach()
+    {
+        if(m_zeroCopy)
+        {
+            m_method.assign(m_methodSlice.data(), m_methodSlice.size());
+            m_uri.assign(m_uriSlice.data(), m_uriSlice.size());
+            m_queryUri.assign(m_queryUriSlice.data(), m_queryUriSlice.size());
+            m_methodSlice.clear();
+            m_uriSlice.clear();
+            m_queryUriSlice.clear();
+        }
+        HttpMsg::detach();
+    }
+
+    void HttpRequest::setQueryUri(const std::string& queryUri)
+    {
+        m_queryUri = queryUri;
+        m_uri = m_queryUri.substr(0, m_queryUri.find('?'));
+    }
+
+    std::string HttpRequest::getArg(const std::string& name) const
+    {
+        Slice q = getQueryUri();
+        size_t qm = q.find('?');
+        if(qm == Slice::npos)
+            return std::string();
+
+        // 按需扫描查询串，解析阶段不为参数分配内存
+        const char* p = q.data() + qm + 1;
+        const char* end = q.end();
+        while(p < end)
+        {
+            const char* amp = static_cast<const char*>(memchr(p, '&', static_cast<size_t>(end - p)));
+            const char* e = amp ? amp : end;
+            const char* eq = static_cast<const char*>(memchr(p, '=', static_cast<size_t>(e - p)));
+            const char* ke = eq ? eq : e;
+            if(Slice(p, ke) == Slice(name))
+                return eq ? std::string(eq + 1, e) : std::string();
+            p = amp ? amp + 1 : end;
+        }
+        return std::string();
+    }
+
+    int HttpRequest::encode(Buffer& buf)
+    {
+        size_t osz = buf.size();
+        buf.append(m_method).append(" ").append(m_queryUri).append(" ").append(m_version).append("\r\n");
+        _encodeHeadersAndBody(buf);
+        return static_cast<int>(buf.size() - osz);
+    }
+
+    HttpMsg::Result HttpRequest::tryDecode(Slice buf, bool isCopyBody)
+    {
+        Slice ln1;
+        Result r = _tryDecode(buf, isCopyBody, ln1);
+        if(ln1.empty())
+            return r;
+
+        // 请求行："方法 请求目标 版本"
+        const char* p = ln1.begin();
+        const char* end = ln1.end();
+        const char* s1 = static_cast<const char*>(memchr(p, ' ', static_cast<size_t>(end - p)));
+        const char* s2 = s1 ? static_cast<const char*>(memchr(s1 + 1, ' ', static_cast<size_t>(end - s1 - 1))) : nullptr;
+        if(s1 == nullptr || s2 == nullptr || s1 == p || s2 == s1 + 1 || s2 + 1 == end)
+        {
+            ERROR("bad http request line: %.*s", static_cast<int>(ln1.size()), ln1.data());
+            return _fail(400);
+        }
+
+        Slice method(p, s1), queryUri(s1 + 1, s2), version(s2 + 1, end);
+        size_t qm = queryUri.find('?');
+        Slice uri = qm == Slice::npos ? queryUri : Slice(queryUri.data(), qm);
+        if(m_zeroCopy)
+        {
+            m_methodSlice = method;
+            m_queryUriSlice = queryUri;
+            m_uriSlice = uri;
+            m_versionSlice = version;
+        }
+        else
+        {
+            m_method.assign(method.data(), method.size());
+            m_queryUri.assign(queryUri.data(), queryUri.size());
+            m_uri.assign(uri.data(), uri.size());
+            m_version.assign(version.data(), version.size());
+        }
+        return r;
+    }
+
+    // -------------------------- HttpResponse --------------------------
+    void HttpResponse::clear()
+    {
+        HttpMsg::clear();
+        m_status = 200;
+        m_statusWord.clear();
+        m_keepAlive = true;
+    }
+
+    int HttpResponse::encodeHead(Buffer& buf, bool isChunked)
+    {
+        size_t osz = buf.size();
+
+        // 1. 状态行：标准状态码直接使用预序列化文本
+        const std::string* line = (m_statusWord.empty() && m_version == "HTTP/1.1") ? cachedStatusLine(m_status) : nullptr;
+        if(line)
+        {
+            buf.append(*line);
+        }
+        else
+        {
+            char code[16];
+            int n = snprintf(code, sizeof(code), " %d ", m_status);
+            buf.append(m_version).append(code, static_cast<size_t>(n))
+               .append(m_statusWord.empty() ? statusText(m_status) : m_statusWord.c_str()).append("\r\n");
+        }
+
+        // 2. 预序列化的静态头部与缓存的Date头部
+        if(m_staticHeaders)
+            buf.append(*m_staticHeaders);
+        appendDateHeader(buf);
+
+        // 3. 本次响应的头部
+        for(auto& hd : m_headers)
+        {
+            buf.append(hd.first).append(": ").append(hd.second).append("\r\n");
+        }
+        buf.append(m_keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+
+        if(isChunked)
+        {
+            buf.append("Transfer-Encoding: chunked\r\n\r\n");
+        }
+        else
+        {
+            char conlen[64];
+            int n = snprintf(conlen, sizeof(conlen), "Content-Length: %zu\r\n\r\n", getBody().size());
+            buf.append(conlen, static_cast<size_t>(n));
+        }
+        return static_cast<int>(buf.size() - osz);
+    }
+
+    int HttpResponse::encode(Buffer& buf)
+    {
+        size_t osz = buf.size();
+        encodeHead(buf, false);
+        buf.append(getBody());
+        return static_cast<int>(buf.size() - osz);
+    }
+
+    HttpMsg::Result HttpResponse::tryDecode(Slice buf, bool isCopyBody)
+    {
+        Slice ln1;
+        Result r = _tryDecode(buf, isCopyBody, ln1);
+        if(ln1.empty())
+            return r;
+
+        // 状态行："版本 状态码 状态描述"
+        const char* p = ln1.begin();
+        const char* end = ln1.end();
+        const char* s1 = static_cast<const char*>(memchr(p, ' ', static_cast<size_t>(end - p)));
+        int status = 0;
+        const char* q = s1 ? s1 + 1 : end;
+        for(; q < end && *q >= '0' && *q <= '9'; ++q)
+            status = status * 10 + (*q - '0');
+        if(s1 == nullptr || s1 == p || q != s1 + 4 || (q < end && *q != ' '))
+        {
+            ERROR("bad http status line: %.*s", static_cast<int>(ln1.size()), ln1.data());
+            return _fail(400);
+        }
+
+        Slice version(p, s1);
+        if(m_zeroCopy)
+            m_versionSlice = version;
+        else
+            m_version.assign(version.data(), version.size());
+        m_status = status;
+        m_statusWord.assign(q < end ? q + 1 : end, end);
+        return r;
+    }
+
+    // -------------------------- HttpConnPtr --------------------------
+    void HttpConnPtr::onHttpMsg(const HttpCallBack& cb, CallSite site) const
+    {
+        HttpContext& ctx = _ctx();
+        ctx.cb = cb;
+        ctx.req.setZeroCopy(true);
+        m_tcp->onReadable([](const TcpConnPtr& conn) { HttpConnPtr(conn)._handleRead(); }, site);
+    }
+
+    void HttpConnPtr::_handleRead() const
+    {
+        HttpContext& ctx = _ctx();
+        if(ctx.dispatching)
+            return;
+
+        ctx.dispatching = true;
+        Buffer& input = m_tcp->getInputBuffer();
+        // 流水线请求逐个派发：前一个响应完成（pending为false）后才解析下一个
+        while(!ctx.pending && !ctx.closing && !input.empty())
+        {
+            HttpMsg::Result r = ctx.req.tryDecode(Slice(input.peek(), input.size()), false);
+            if(r == HttpMsg::Result::Error)
+            {
+                // 出错后无法确定下一个请求的起始位置，回复错误并关闭连接
+                ctx.closing = true;
+                int status = ctx.req.getErrorStatus() ? ctx.req.getErrorStatus() : 400;
+                m_tcp->getOutputBuffer().append(*cachedStatusLine(status))
+                    .append("Connection: close\r\nContent-Length: 0\r\n\r\n");
+                break;
+            }
+            else if(r == HttpMsg::Result::Continue100)
+            {
+                m_tcp->send("HTTP/1.1 100 Continue\r\n\r\n");
+                break;
+            }
+            else if(r == HttpMsg::Result::NotComplete)
+            {
+                break;
+            }
+
+            ctx.pending = true;
+            ctx.keepAlive = isKeepAlive(ctx.req);
+            TRACE("http request: %.*s %.*s",
+                    static_cast<int>(ctx.req.getMethod().size()), ctx.req.getMethod().data(),
+                    static_cast<int>(ctx.req.getQueryUri().size()), ctx.req.getQueryUri().data());
+            ctx.cb(*this);
+
+            // 回调没有立即响应：请求可能在之后被访问，而输入缓冲区会继续追加数据，需要复制请求内容
+            if(ctx.pending)
+                ctx.req.detach();
+        }
+        ctx.dispatching = false;
+
+        // 同一批流水线请求的响应合并为一次发送
+        if(!m_tcp->getOutputBuffer().empty())
+            m_tcp->sendOutputBuffer();
+        if(ctx.closing)
+            closeWhenFlushed(m_tcp);
+    }
+
+    void HttpConnPtr::_finish() const
+    {
+        HttpContext& ctx = _ctx();
+        if(!ctx.pending)
+            return;
+
+        m_tcp->getInputBuffer().consume(ctx.req.getScannedLen());
+        ctx.req.clear();
+        ctx.req.setZeroCopy(true);
+        ctx.resp.clear();
+        ctx.pending = false;
+
+        // 派发过程中完成的请求由_handleRead在发送完响应后统一处理关闭与后续请求
+        if(ctx.dispatching)
+        {
+            ctx.closing = !ctx.keepAlive;
+        }
+        else if(!ctx.keepAlive)
+        {
+            ctx.closing = true;
+            closeWhenFlushed(m_tcp);
+        }
+        // 异步响应完成后，继续处理已经到达的后续请求
+        else
+        {
+            _handleRead();
+        }
+    }
+
+    void HttpConnPtr::sendResponse() const
+    {
+        HttpContext& ctx = _ctx();
+        ctx.resp.setKeepAlive(ctx.keepAlive);
+        ctx.resp.encode(m_tcp->getOutputBuffer());
+        // 派发过程中同步产生的响应由_handleRead统一发送
+        if(!ctx.dispatching)
+            m_tcp->sendOutputBuffer();
+        _finish();
+    }
+
+    void HttpConnPtr::beginChunked() const
+    {
+        HttpContext& ctx = _ctx();
+        ctx.resp.setKeepAlive(ctx.keepAlive);
+        ctx.resp.encodeHead(m_tcp->getOutputBuffer(), true);
+        m_tcp->sendOutputBuffer();
+    }
+
+    void HttpConnPtr::sendChunk(Slice data) const
+    {
+        if(data.empty())
+            return;
+
+        char head[32];
+        int n = snprintf(head, sizeof(head), "%zx\r\n", data.size());
+        m_tcp->getOutputBuffer().append(head, static_cast<size_t>(n)).append(data).append("\r\n");
+        m_tcp->sendOutputBuffer();
+    }
+
+    void HttpConnPtr::endChunked() const
+    {
+        m_tcp->getOutputBuffer().append("0\r\n\r\n");
+        if(!_ctx().dispatching)
+            m_tcp->sendOutputBuffer();
+        _finish();
+    }
+
+    // -------------------------- HttpServer --------------------------
+    HttpServer::HttpServer(EventBases* bases)
+        : TcpServer(bases)
+        , m_defCB([](const HttpConnPtr& hcon)
+            {
+                hcon.getResponse().setNotFound();
+                hcon.sendResponse();
+            })
+        , m_connCB([](EventBase* base) { return TcpConn::create(base); })
+        , m_staticHeaders(std::make_shared<const std::string>("Server: handy\r\n"))
+        , m_maxBodyLen(HttpMsg::kDefaultMaxBodyLen)
+    {
+        onConnCreate([this](EventBase* base)
+        {
+            TcpConnPtr tcp = m_connCB(base);
+            HttpConnPtr hcon(tcp);
+            hcon.getResponse().setStaticHeaders(m_staticHeaders);
+            hcon.getRequest().setMaxBodyLen(m_maxBodyLen);
+            hcon.onHttpMsg([this](const HttpConnPtr& c) { _dispatch(c); });
+            return tcp;
+        });
+    }
+
+    void HttpServer::addStaticHeader(const std::string& name, const std::string& value)
+    {
+        auto block = std::make_shared<std::string>(*m_staticHeaders);
+        block->append(name).append(": ").append(value).append("\r\n");
+        m_staticHeaders = std::move(block);
+    }
+
+    void HttpServer::_dispatch(const HttpConnPtr& hcon)
+    {
+        HttpRequest& req = hcon.getRequest();
+        // 路由表使用透明比较器，直接用Slice查找，不构造临时字符串
+        auto methodIt = m_cbs.find(req.getMethod());
+        if(methodIt != m_cbs.end())
+        {
+            auto uriIt = methodIt->second.find(req.getUri());
+            if(uriIt != methodIt->second.end())
+            {
+                uriIt->second(hcon);
+                return;
+            }
+        }
+        m_defCB(hcon);
+    }
+} // namespace handy
@@ -3,16 +3,114 @@
 #include "conn.h"
 #include "slice.h"
 #include <map>
+#include <vector>
 
 namespace handy
 {
+    /**
+     * @brief 比较两个HTTP头部字段名是否相等（ASCII大小写不敏感）
+     * @param a 字段名a
+     * @param b 字段名b
+     * @return bool true: 相等，false: 不相等
+     * @note 即Slice::equalsNoCase()（较长的字段名使用SSE4.2/AVX2批量比较）
+    */
+    bool httpNameEquals(Slice a, Slice b) noexcept;
+
+    /**
+     * @class HttpHeaders
+     * @brief 零拷贝模式下的头部字段表
+     * @details 1. 字段名与字段值均为指向输入缓冲区的Slice，解析过程不分配内存
+     *          2. 前kInlineCapacity个字段存放在对象内部的定长数组中，超出部分才落入std::vector
+     * @note Slice的生命周期与输入缓冲区绑定，缓冲区被消费或扩容后不可再访问
+    */
+    class HttpHeaders
+    {
+        public:
+            // 内联存储的字段数量（覆盖绝大多数请求）
+            static constexpr size_t kInlineCapacity = 24;
+
+            // 单个头部字段
+            struct Field
+            {
+                Slice name;     // 字段名（保持原始大小写）
+                Slice value;    // 字段值（已去除首尾空白）
+            };
+
+            /**
+             * @brief 清空所有字段（不释放溢出区容量，便于复用）
+            */
+            void clear() noexcept
+            {
+                m_size = 0;
+                m_overflow.clear();
+            }
+
+            /**
+             * @brief 追加一个字段
+             * @param name 字段名
+             * @param value 字段值
+            */
+            void add(Slice name, Slice value)
+            {
+                if(m_size < kInlineCapacity)
+                    m_inline[m_size] = Field{name, value};
+                else
+                    m_overflow.push_back(Field{name, value});
+                ++m_size;
+            }
+
+            /**
+             * @brief 获取字段数量
+            */
+            size_t size() const noexcept { return m_size; }
+
+            /**
+             * @brief 判断是否没有任何字段
+            */
+            bool empty() const noexcept { return m_size == 0; }
+
+            /**
+             * @brief 按下标访问字段（按到达顺序）
+             * @param i 下标，需小于size()
+            */
+            const Field& operator[](size_t i) const noexcept
+            {
+                return i < kInlineCapacity ? m_inline[i] : m_overflow[i - kInlineCapacity];
+            }
+
+            /**
+             * @brief 查找字段值（字段名大小写不敏感）
+             * @param name 字段名
+             * @return Slice 字段值，未找到时返回空Slice
+            */
+            Slice get(Slice name) const noexcept
+            {
+                for(size_t i = 0; i < m_size; ++i)
+                {
+                    const Field& f = (*this)[i];
+                    if(f.name.size() == name.size() && httpNameEquals(f.name, name))
+                        return f.value;
+                }
+                return Slice();
+            }
+
+        private:
+            Field m_inline[kInlineCapacity];    // 内联字段数组
+            size_t m_size = 0;                  // 字段总数
+            std::vector<Field> m_overflow;      // 超出内联容量的字段
+    };
+
     /**
      * @class HttpMsg
      * @brief HTTP消息基类，封装HTTP请求和响应的通用功能
-     * @note 提供HTTP消息的解析（解码）和序列化（编码）基础逻辑
+     * @note 1. 提供HTTP消息的解析（解码）和序列化（编码）基础逻辑
+     * @note 2. 支持两种解析模式：
+     *          拷贝模式（默认）：头部存入std::map（键为小写），消息体按isCopyBody决定是否复制
+     *          零拷贝模式：头部以Slice形式存入HttpHeaders，全程不分配内存
+     * @note 3. 解析是增量的：数据分多次到达时，从m_scannedLen处继续查找头部结束位置
     */
     class HttpMsg : private NonCopyAble
-    { 
+    {
         public:
             // 消息解析结果状态
             enum class Result
@@ -23,10 +121,17 @@ namespace handy
                 Continue100     // 需要发送100Continue响应
             };
 
+            // 头部区域的最大长度，超过则视为错误（防止恶意请求耗尽内存）
+            static constexpr size_t kMaxHeaderLen = 64 * 1024;
+            // 默认的消息体最大长度
+            static constexpr size_t kDefaultMaxBodyLen = 64 * 1024 * 1024;
+
             /**
              * @brief 默认构造函数
             */
-            HttpMsg() { clear(); }
+            HttpMsg() : m_zeroCopy(false), m_maxBodyLen(kDefaultMaxBodyLen) { HttpMsg::clear(); }
+
+            virtual ~HttpMsg() = default;
 
             /**
              * @brief 纯虚函数，将消息编码到缓冲区
@@ -41,13 +146,33 @@ namespace handy
              * @param isCopyBody 是否赋值消息体（true: 将消息体复制到m_body, false: 使用m_body2进行引用）
              * @return Result 解析状态
             */
-            virtual Result tryDecode(Slice buf, bool isCopyBody=true) 0;
+            virtual Result tryDecode(Slice buf, bool isCopyBody = true) = 0;
 
             /**
              * @brief 清空消息所有字段，恢复初始状态
+             * @note 不改变解析模式（零拷贝/拷贝）
             */
             virtual void clear();
 
+            /**
+             * @brief 将引用输入缓冲区的数据（零拷贝头部、引用模式消息体）复制为自有数据
+             * @note 调用后切换为拷贝模式，之后输入缓冲区可以被安全地扩容或消费
+            */
+            virtual void detach();
+
+            /**
+             * @brief 设置解析模式
+             * @param zeroCopy true: 零拷贝模式（头部与消息体均引用输入缓冲区），false: 拷贝模式
+             * @note 零拷贝模式下，消息在完整到达之前不会保存任何指向缓冲区的Slice，
+             *       因此两次tryDecode之间缓冲区可以安全扩容；解析完成后在消费缓冲区前使用结果
+            */
+            void setZeroCopy(bool zeroCopy) { m_zeroCopy = zeroCopy; }
+
+            /**
+             * @brief 是否为零拷贝模式
+            */
+            bool isZeroCopy() const { return m_zeroCopy; }
+
             /**
              * @brief 获取指定头部字段的值
              * @param name 头部字段名（不区分大小写）
@@ -55,26 +180,126 @@ namespace handy
             */
             std::string getHeader(const std::string& name) const
             {
-                return getValueFromMap(m_headers, name);
+                return getHeaderSlice(name).toString();
             }
+
+            /**
+             * @brief 获取指定头部字段的值（不分配内存）
+             * @param name 头部字段名（不区分大小写）
+             * @return Slice 头部字段值（空Slice表示未找到）
+            */
+            Slice getHeaderSlice(Slice name) const;
+
+            /**
+             * @brief 获取零拷贝模式下的头部字段表
+            */
+            const HttpHeaders& getHeaderSlices() const { return m_headerSlices; }
+
+            /**
+             * @brief 获取拷贝模式下的头部字段表（键为小写）
+            */
+            const std::map<std::string, std::string>& getHeaders() const { return m_headers; }
+
+            /**
+             * @brief 设置头部字段（用于编码）
+             * @param name 字段名
+             * @param value 字段值
+            */
+            void setHeader(const std::string& name, const std::string& value) { m_headers[name] = value; }
+
+            /**
+             * @brief 获取消息体（根据解析时的isCopyBody返回复制或引用的数据）
+            */
+            Slice getBody() const { return m_body2.empty() ? Slice(m_body) : m_body2; }
+
+            /**
+             * @brief 设置消息体（用于编码）
+             * @param body 消息体内容
+            */
+            void setBody(const std::string& body) { m_body = body; m_body2.clear(); }
+
+            /**
+             * @brief 获取HTTP版本（如"HTTP/1.1"）
+            */
+            Slice getVersion() const { return m_zeroCopy ? m_versionSlice : Slice(m_version); }
+
+            /**
+             * @brief 设置HTTP版本（用于编码）
+            */
+            void setVersion(const std::string& version) { m_version = version; }
+
+            /**
+             * @brief 消息是否已解析完成
+            */
+            bool isCompleted() const { return m_completed; }
+
+            /**
+             * @brief 获取已解析的字节数
+             * @return size_t 解析完成后即为整个消息（头部+消息体）在缓冲区中占用的字节数
+            */
+            size_t getScannedLen() const { return m_scannedLen; }
+
+            /**
+             * @brief 获取消息体长度（来自Content-Length）
+            */
+            size_t getContentLen() const { return m_contentLen; }
+
+            /**
+             * @brief 设置消息体最大长度，Content-Length超过该值时解析失败
+             * @param maxBodyLen 最大长度（字节）
+             * @note clear()不会重置该设置
+            */
+            void setMaxBodyLen(size_t maxBodyLen) { m_maxBodyLen = maxBodyLen; }
+
+            /**
+             * @brief 获取解析失败对应的响应状态码
+             * @return int 400: 格式错误（含多个不一致的Content-Length），
+             *             413: 消息体超过最大长度，501: 携带Transfer-Encoding（不支持）；未失败时为0
+            */
+            int getErrorStatus() const { return m_errorStatus; }
+
         protected:
             std::map<std::string, std::string> m_headers;   // 头部字段（键为小写）
+            HttpHeaders m_headerSlices;                     // 头部字段（零拷贝模式）
             std::string m_version;                          // HTTP版本（如"HTTP/1.1"）
-            std::string body;                               // 消息体(复制模式)
+            Slice m_versionSlice;                           // HTTP版本（零拷贝模式）
+            std::string m_body;                             // 消息体(复制模式)
             Slice m_body2;                                  // 消息体（引用模式）
+            bool m_zeroCopy;                                // 是否为零拷贝解析模式
             bool m_completed;                               // 消息解析完成标志
+            bool m_headerParsed;                            // 头部是否已解析（拷贝模式下跨调用保留）
+            bool m_expect;                                  // 是否携带Expect头部
             size_t m_contentLen;                            // 消息体长度（从Content-Length中获取）
             size_t m_scannedLen;                            // 已解析的字节数
+            size_t m_maxBodyLen;                            // 消息体最大长度
+            int m_errorStatus;                              // 解析失败对应的响应状态码（0：未失败）
 
             /**
              * @brief 内部解析辅助函数，处理通用HTTP消息结构
              * @param buf 输入缓冲区
              * @param isCopyBody 是否复制消息体
-             * @param [out] line1 存储消息的第一行（请求行/状态行）
-             * @return Result 解析状态 
+             * @param [out] line1 存储消息的第一行（请求行/状态行），仅在本次调用解析了头部时非空
+             * @return Result 解析状态
             */
             Result _tryDecode(Slice buf, bool isCopyBody, Slice& line1);
 
+            /**
+             * @brief 记录解析失败对应的状态码
+             * @param status 响应状态码
+             * @return Result 总是Result::Error
+            */
+            Result _fail(int status)
+            {
+                m_errorStatus = status;
+                return Result::Error;
+            }
+
+            /**
+             * @brief 将头部字段与消息体编码到缓冲区（首行由派生类负责）
+             * @param [out] buf 输出缓冲区
+            */
+            void _encodeHeadersAndBody(Buffer& buf);
+
             /**
              * @brief 从映射表中获取指定键的值（不区分大小写）
              * @param map 键值对映射表
@@ -84,5 +309,354 @@ namespace handy
             std::string _getValueFromMap(const std::map<std::string, std::string>& map,
                                             const std::string& name) const;
 
+        private:
+            /**
+             * @brief 解析头部区域中的所有字段
+             * @param block 头部区域（不含首行与结尾空行）
+             * @return bool true: 成功，false: 格式错误（m_errorStatus记录对应的状态码）
+             * @note 为防止请求走私，携带Transfer-Encoding或多个不一致的Content-Length均视为错误
+            */
+            bool _parseHeaderFields(Slice block);
+    };
+
+    /**
+     * @class HttpRequest
+     * @brief HTTP请求消息
+    */
+    class HttpRequest : public HttpMsg
+    {
+        public:
+            HttpRequest() { HttpRequest::clear(); }
+
+            /**
+             * @brief 将请求编码到缓冲区
+             * @param [out] buf 输出缓冲区
+             * @return int 编码的字节数
+            */
+            int encode(Buffer& buf) override;
+
+            /**
+             * @brief 尝试从缓冲区解码请求
+             * @param buf 输入缓冲区（包含已到达的全部数据）
+             * @param isCopyBody 是否复制消息体
+             * @return Result 解析状态
+            */
+            Result tryDecode(Slice buf, bool isCopyBody = true) override;
+
+            /**
+             * @brief 清空请求
+            */
+            void clear() override;
+
+            /**
+             * @brief 将引用输入缓冲区的数据复制为自有数据
+            */
+            void detach() override;
+
+            /**
+             * @brief 获取请求方法（如"GET"）
+            */
+            Slice getMethod() const { return m_zeroCopy ? m_methodSlice : Slice(m_method); }
+
+            /**
+             * @brief 获取请求路径（不含查询参数）
+            */
+            Slice getUri() const { return m_zeroCopy ? m_uriSlice : Slice(m_uri); }
+
+            /**
+             * @brief 获取完整的请求目标（含查询参数）
+            */
+            Slice getQueryUri() const { return m_zeroCopy ? m_queryUriSlice : Slice(m_queryUri); }
+
+            /**
+             * @brief 获取查询参数中指定参数的值
+             * @param name 参数名
+             * @return std::string 参数值（空字符串表示未找到）
+            */
+            std::string getArg(const std::string& name) const;
+
+            /**
+             * @brief 设置请求方法（用于编码）
+            */
+            void setMethod(const std::string& method) { m_method = method; }
+
+            /**
+             * @brief 设置请求目标（用于编码）
+            */
+            void setQueryUri(const std::string& queryUri);
+
+        private:
+            std::string m_method;       // 请求方法
+            std::string m_uri;          // 请求路径
+            std::string m_queryUri;     // 完整请求目标
+            Slice m_methodSlice;        // 请求方法（零拷贝模式）
+            Slice m_uriSlice;           // 请求路径（零拷贝模式）
+            Slice m_queryUriSlice;      // 完整请求目标（零拷贝模式）
+    };
+
+    /**
+     * @class HttpResponse
+     * @brief HTTP响应消息
+     * @note 编码时状态行使用按状态码缓存的预序列化文本，静态头部块与Date头部也均为预先生成的文本
+    */
+    class HttpResponse : public HttpMsg
+    {
+        public:
+            HttpResponse() { HttpResponse::clear(); }
+
+            /**
+             * @brief 将响应（含消息体）编码到缓冲区
+             * @param [out] buf 输出缓冲区
+             * @return int 编码的字节数
+            */
+            int encode(Buffer& buf) override;
+
+            /**
+             * @brief 仅编码状态行与头部（用于分块传输）
+             * @param [out] buf 输出缓冲区
+             * @param isChunked true: 使用Transfer-Encoding: chunked，false: 使用Content-Length
+             * @return int 编码的字节数
+            */
+            int encodeHead(Buffer& buf, bool isChunked);
+
+            /**
+             * @brief 尝试从缓冲区解码响应（仅支持Content-Length方式的消息体）
+             * @param buf 输入缓冲区
+             * @param isCopyBody 是否复制消息体
+             * @return Result 解析状态
+            */
+            Result tryDecode(Slice buf, bool isCopyBody = true) override;
+
+            /**
+             * @brief 清空响应（保留静态头部块）
+            */
+            void clear() override;
+
+            /**
+             * @brief 设置状态码
+             * @param status 状态码
+             * @param statusWord 状态描述，为空时使用标准描述
+            */
+            void setStatus(int status, const std::string& statusWord = "")
+            {
+                m_status = status;
+                m_statusWord = statusWord;
+            }
+
+            /**
+             * @brief 获取状态码
+            */
+            int getStatus() const { return m_status; }
+
+            /**
+             * @brief 获取状态描述
+            */
+            Slice getStatusWord() const { return m_statusWord; }
+
+            /**
+             * @brief 设置为404响应
+            */
+            void setNotFound()
+            {
+                setStatus(404);
+                setBody("Not Found");
+            }
+
+            /**
+             * @brief 设置连接是否保持（决定Connection头部）
+            */
+            void setKeepAlive(bool keepAlive) { m_keepAlive = keepAlive; }
+
+            /**
+             * @brief 设置预序列化的静态头部块（如"Server: handy\r\n"），在多个响应之间共享
+             * @param block 头部块，每个字段以\r\n结尾
+            */
+            void setStaticHeaders(std::shared_ptr<const std::string> block) { m_staticHeaders = std::move(block); }
+
+        private:
+            int m_status;                                   // 状态码
+            std::string m_statusWord;                       // 状态描述（为空时使用标准描述）
+            bool m_keepAlive;                               // 是否保持连接
+            std::shared_ptr<const std::string> m_staticHeaders; // 预序列化的静态头部块
+    };
+
+    class HttpConnPtr;
+    // HTTP消息回调函数类型
+    using HttpCallBack = std::function<void(const HttpConnPtr&)>;
+
+    /**
+     * @brief HTTP连接的内部状态，保存在TcpConn的内部上下文中
+    */
+    struct HttpContext
+    {
+        HttpRequest req;            // 当前请求
+        HttpResponse resp;          // 当前响应
+        HttpCallBack cb;            // 请求完成时的回调
+        bool pending = false;       // 请求已派发但响应尚未发送完毕
+        bool dispatching = false;   // 正在派发请求（用于区分同步/异步响应）
+        bool keepAlive = true;      // 当前请求完成后是否保持连接
+        bool closing = false;       // 连接将在输出缓冲区发送完毕后关闭
+    };
+
+    /**
+     * @class HttpConnPtr
+     * @brief HTTP连接（TcpConnPtr的轻量包装）
+     * @details 1. 同一连接上流水线到达的多个请求按顺序逐个派发，前一个响应发送完毕后才派发下一个
+     *          2. 回调中可以同步调用sendResponse()，也可以稍后在连接所属的事件循环线程中异步调用
+     *          3. 请求默认以零拷贝模式解析，异步响应时请求内容会被复制，避免引用失效
+     * @note 所有接口需在连接所属的事件循环线程中调用
+    */
+    class HttpConnPtr
+    {
+        public:
+            /**
+             * @brief 构造函数
+             * @param conn TCP连接
+            */
+            HttpConnPtr(const TcpConnPtr& conn) : m_tcp(conn) {}
+
+            /**
+             * @brief 获取底层TCP连接
+            */
+            const TcpConnPtr& getTcp() const { return m_tcp; }
+
+            /**
+             * @brief 访问底层TCP连接
+            */
+            TcpConn* operator->() const { return m_tcp.get(); }
+
+            /**
+             * @brief 获取当前请求
+            */
+            HttpRequest& getRequest() const { return _ctx().req; }
+
+            /**
+             * @brief 获取当前响应
+            */
+            HttpResponse& getResponse() const { return _ctx().resp; }
+
+            /**
+             * @brief 发送当前响应，并开始处理下一个请求
+            */
+            void sendResponse() const;
+
+            /**
+             * @brief 开始分块传输（发送状态行与头部）
+            */
+            void beginChunked() const;
+
+            /**
+             * @brief 发送一个数据块
+             * @param data 数据块内容（为空时忽略，空块表示结束）
+            */
+            void sendChunk(Slice data) const;
+
+            /**
+             * @brief 结束分块传输，并开始处理下一个请求
+            */
+            void endChunked() const;
+
+            /**
+             * @brief 设置请求完成时的回调
+             * @param cb 回调函数
+             * @param site 注册位置（默认为调用者位置，用于慢回调告警）
+            */
+            void onHttpMsg(const HttpCallBack& cb, CallSite site = CallSite::current()) const;
+
+        private:
+            TcpConnPtr m_tcp;   // 底层TCP连接
+
+            /**
+             * @brief 获取HTTP连接状态
+            */
+            HttpContext& _ctx() const { return m_tcp->getInternalContext<HttpContext>(); }
+
+            /**
+             * @brief 解析并派发输入缓冲区中的请求
+            */
+            void _handleRead() const;
+
+            /**
+             * @brief 当前请求处理完毕：消费请求数据，重置状态
+            */
+            void _finish() const;
+    };
+
+    /**
+     * @class HttpServer
+     * @brief HTTP/1.1服务器，支持keep-alive、流水线请求与分块传输
+    */
+    class HttpServer : public TcpServer
+    {
+        public:
+            /**
+             * @brief 构造函数
+             * @param bases 事件循环组（可以是EventBase或MultiBase）
+            */
+            explicit HttpServer(EventBases* bases);
+
+            /**
+             * @brief 设置连接类型
+             * @tparam C 连接类型，需继承自TcpConn
+            */
+            template <class C = TcpConn>
+            void setConnType()
+            {
+                m_connCB = [](EventBase* base) { return TcpConn::create<C>(base); };
+            }
+
+            /**
+             * @brief 注册GET请求的处理函数
+             * @param uri 请求路径（不含查询参数）
+             * @param cb 处理函数
+            */
+            void onGet(const std::string& uri, const HttpCallBack& cb) { onRequest("GET", uri, cb); }
+
+            /**
+             * @brief 注册请求处理函数
+             * @param method 请求方法
+             * @param uri 请求路径（不含查询参数）
+             * @param cb 处理函数
+            */
+            void onRequest(const std::string& method, const std::string& uri, const HttpCallBack& cb)
+            {
+                m_cbs[method][uri] = cb;
+            }
+
+            /**
+             * @brief 设置未匹配到路由时的处理函数（默认返回404）
+             * @param cb 处理函数
+            */
+            void onDefault(const HttpCallBack& cb) { m_defCB = cb; }
+
+            /**
+             * @brief 设置请求消息体的最大长度（默认HttpMsg::kDefaultMaxBodyLen）
+             * @param maxBodyLen 最大长度（字节），Content-Length超过该值时回复413并关闭连接
+             * @note 需在bind()之前调用
+            */
+            void setMaxBodyLen(size_t maxBodyLen) { m_maxBodyLen = maxBodyLen; }
+
+            /**
+             * @brief 添加所有响应都携带的静态头部（预序列化一次，之后所有响应直接复用）
+             * @param name 字段名
+             * @param value 字段值
+             * @note 需在bind()之前调用
+            */
+            void addStaticHeader(const std::string& name, const std::string& value);
+
+        private:
+            using RouteMap = std::map<std::string, HttpCallBack, std::less<>>;
+
+            HttpCallBack m_defCB;                               // 默认处理函数
+            std::function<TcpConnPtr(EventBase*)> m_connCB;     // 连接创建函数
+            std::map<std::string, RouteMap, std::less<>> m_cbs; // 路由表：方法 -> 路径 -> 处理函数
+            std::shared_ptr<const std::string> m_staticHeaders; // 预序列化的静态头部块
+            size_t m_maxBodyLen;                                // 请求消息体最大长度
+
+            /**
+             * @brief 按路由表派发请求
+             * @param hcon HTTP连接
+            */
+            void _dispatch(const HttpConnPtr& hcon);
     };
 } // namespace handy
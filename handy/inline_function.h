@@ -0,0 +1,333 @@
+/**
+ * @file inline_function.h
+ * @brief 带内联缓冲区的函数包装器（InlineFunction），用于替代事件循环热路径上的std::function
+ * @details 1. 可调用对象不超过Capacity字节（且移动构造不抛异常）时直接存放在对象内部，构造、移动都不分配堆内存
+ *          2. 超出内联缓冲区的可调用对象退化为堆上存储，行为与std::function一致
+ *          3. 默认只能移动（可以保存只能移动的可调用对象，如捕获了unique_ptr的lambda）；
+ *             Copyable为true时可以拷贝，但只接受可拷贝的可调用对象
+*/
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace handy
+{
+    /**
+     * @class InlineFunctionBase
+     * @brief InlineFunction的公共实现（存储、调用、移动与析构），拷贝能力由派生类决定
+    */
+    template <typename Signature, size_t Capacity, bool Copyable>
+    class InlineFunctionBase;
+
+    template <typename R, typename... Args, size_t Capacity, bool Copyable>
+    class InlineFunctionBase<R(Args...), Capacity, Copyable>
+    {
+        private:
+            /**
+             * @brief 可调用对象的操作表（每种可调用对象类型、每种存储方式各一份静态实例）
+            */
+            struct Ops
+            {
+                R (*invoke)(void* storage, Args&&... args);
+                void (*move)(void* dst, void* src) noexcept;    // 移动到dst，并析构src
+                void (*copy)(void* dst, const void* src);       // 拷贝到dst（仅Copyable）
+                void (*destroy)(void* storage) noexcept;
+                bool isInline;
+            };
+
+            /**
+             * @brief 可调用对象能否存放在内联缓冲区中
+            */
+            template <typename F>
+            static constexpr bool kFitsInline = sizeof(F) <= Capacity
+                                                && alignof(F) <= alignof(std::max_align_t)
+                                                && std::is_nothrow_move_constructible_v<F>;
+
+            /**
+             * @brief 内联存储的操作表
+            */
+            template <typename F>
+            struct InlineOps
+            {
+                static F* get(void* storage) noexcept { return std::launder(reinterpret_cast<F*>(storage)); }
+
+                static R invoke(void* storage, Args&&... args)
+                {
+                    return _call(*get(storage), std::forward<Args>(args)...);
+                }
+
+                static void move(void* dst, void* src) noexcept
+                {
+                    ::new (dst) F(std::move(*get(src)));
+                    get(src)->~F();
+                }
+
+                static void copy(void* dst, const void* src)
+                {
+                    if constexpr(Copyable)
+                        ::new (dst) F(*get(const_cast<void*>(src)));
+                }
+
+                static void destroy(void* storage) noexcept { get(storage)->~F(); }
+
+                static constexpr Ops kOps = {&invoke, &move, Copyable ? &copy : nullptr, &destroy, true};
+            };
+
+            /**
+             * @brief 堆上存储的操作表（内联缓冲区中只保存指针）
+            */
+            template <typename F>
+            struct HeapOps
+            {
+                static F*& get(void* storage) noexcept { return *std::launder(reinterpret_cast<F**>(storage)); }
+
+                static R invoke(void* storage, Args&&... args)
+                {
+                    return _call(*get(storage), std::forward<Args>(args)...);
+                }
+
+                static void move(void* dst, void* src) noexcept
+                {
+                    ::new (dst) F*(get(src));
+                }
+
+                static void copy(void* dst, const void* src)
+                {
+                    if constexpr(Copyable)
+                        ::new (dst) F*(new F(*get(const_cast<void*>(src))));
+                }
+
+                static void destroy(void* storage) noexcept { delete get(storage); }
+
+                static constexpr Ops kOps = {&invoke, &move, Copyable ? &copy : nullptr, &destroy, false};
+            };
+
+            /**
+             * @brief 调用可调用对象（R为void时丢弃返回值，与std::function一致）
+            */
+            template <typename F>
+            static R _call(F& f, Args&&... args)
+            {
+                if constexpr(std::is_void_v<R>)
+                    std::invoke(f, std::forward<Args>(args)...);
+                else
+                    return std::invoke(f, std::forward<Args>(args)...);
+            }
+
+            template <typename F>
+            static constexpr const Ops* _opsFor() noexcept
+            {
+                if constexpr(kFitsInline<F>)
+                    return &InlineOps<F>::kOps;
+                else
+                    return &HeapOps<F>::kOps;
+            }
+
+        protected:
+            /**
+             * @brief 可以被包装的可调用对象类型（排除InlineFunction自身，Copyable时要求可拷贝）
+            */
+            template <typename F, typename D = std::decay_t<F>>
+            static constexpr bool kAccepts = !std::is_base_of_v<InlineFunctionBase, D>
+                                            && !std::is_same_v<D, std::nullptr_t>
+                                            && std::is_invocable_r_v<R, D&, Args...>
+                                            && (!Copyable || std::is_copy_constructible_v<D>);
+
+        public:
+            InlineFunctionBase() noexcept = default;
+
+            InlineFunctionBase(std::nullptr_t) noexcept {}
+
+            /**
+             * @brief 包装可调用对象（空的函数指针/std::function得到空的InlineFunction）
+            */
+            template <typename F, typename = std::enable_if_t<kAccepts<F>>>
+            InlineFunctionBase(F&& f)
+            {
+                using D = std::decay_t<F>;
+                using Raw = std::remove_cv_t<std::remove_reference_t<F>>;     // 函数引用不需要判空
+                if constexpr(std::is_pointer_v<Raw> || std::is_member_pointer_v<Raw>
+                                || std::is_same_v<Raw, std::function<R(Args...)>>)
+                {
+                    if(!f)
+                        return;
+                }
+
+                if constexpr(kFitsInline<D>)
+                    ::new (static_cast<void*>(&m_storage)) D(std::forward<F>(f));
+                else
+                    ::new (static_cast<void*>(&m_storage)) D*(new D(std::forward<F>(f)));
+                m_ops = _opsFor<D>();
+            }
+
+            InlineFunctionBase(InlineFunctionBase&& other) noexcept { _moveFrom(other); }
+
+            InlineFunctionBase& operator=(InlineFunctionBase&& other) noexcept
+            {
+                if(this != &other)
+                {
+                    reset();
+                    _moveFrom(other);
+                }
+                return *this;
+            }
+
+            InlineFunctionBase(const InlineFunctionBase&) = delete;
+            InlineFunctionBase& operator=(const InlineFunctionBase&) = delete;
+
+            ~InlineFunctionBase() { reset(); }
+
+            /**
+             * @brief 调用被包装的对象
+             * @throw std::bad_function_call 对象为空
+            */
+            R operator()(Args... args) const
+            {
+                if(!m_ops)
+                    throw std::bad_function_call();
+                return m_ops->invoke(const_cast<void*>(static_cast<const void*>(&m_storage)),
+                                        std::forward<Args>(args)...);
+            }
+
+            explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+            /**
+             * @brief 清空被包装的对象
+            */
+            void reset() noexcept
+            {
+                if(m_ops)
+                {
+                    m_ops->destroy(&m_storage);
+                    m_ops = nullptr;
+                }
+            }
+
+            /**
+             * @brief 被包装的对象是否存放在内联缓冲区中（空对象返回true）
+            */
+            bool isInline() const noexcept { return !m_ops || m_ops->isInline; }
+
+            /**
+             * @brief 获取被包装的对象（与std::function::target语义相同）
+             * @return T* 类型匹配时返回对象指针，否则返回nullptr
+            */
+            template <typename T>
+            T* target() noexcept
+            {
+                if(m_ops == &InlineOps<T>::kOps)
+                    return InlineOps<T>::get(&m_storage);
+                if(m_ops == &HeapOps<T>::kOps)
+                    return HeapOps<T>::get(&m_storage);
+                return nullptr;
+            }
+
+            template <typename T>
+            const T* target() const noexcept
+            {
+                return const_cast<InlineFunctionBase*>(this)->template target<T>();
+            }
+
+            friend bool operator==(const InlineFunctionBase& f, std::nullptr_t) noexcept { return !f; }
+            friend bool operator!=(const InlineFunctionBase& f, std::nullptr_t) noexcept { return static_cast<bool>(f); }
+
+        protected:
+            void _moveFrom(InlineFunctionBase& other) noexcept
+            {
+                if(other.m_ops)
+                {
+                    other.m_ops->move(&m_storage, &other.m_storage);
+                    m_ops = other.m_ops;
+                    other.m_ops = nullptr;
+                }
+            }
+
+            void _copyFrom(const InlineFunctionBase& other)
+            {
+                if(other.m_ops)
+                {
+                    other.m_ops->copy(&m_storage, &other.m_storage);
+                    m_ops = other.m_ops;
+                }
+            }
+
+        private:
+            alignas(std::max_align_t) unsigned char m_storage[Capacity];   // 内联缓冲区
+            const Ops* m_ops = nullptr;                                     // 操作表（nullptr表示空）
+    };
+
+    /**
+     * @class InlineFunction
+     * @brief 只能移动的函数包装器
+     * @tparam Signature 函数签名，如void(int)
+     * @tparam Capacity 内联缓冲区大小（字节）
+     * @tparam Copyable 是否可拷贝
+    */
+    template <typename Signature, size_t Capacity = 48, bool Copyable = false>
+    class InlineFunction;
+
+    template <typename R, typename... Args, size_t Capacity>
+    class InlineFunction<R(Args...), Capacity, false> : public InlineFunctionBase<R(Args...), Capacity, false>
+    {
+        using Base = InlineFunctionBase<R(Args...), Capacity, false>;
+
+        public:
+            using Base::Base;
+
+            InlineFunction() noexcept = default;
+            InlineFunction(InlineFunction&&) noexcept = default;
+            InlineFunction& operator=(InlineFunction&&) noexcept = default;
+
+            InlineFunction& operator=(std::nullptr_t) noexcept
+            {
+                this->reset();
+                return *this;
+            }
+
+            template <typename F, typename = std::enable_if_t<Base::template kAccepts<F>>>
+            InlineFunction& operator=(F&& f)
+            {
+                return *this = InlineFunction(std::forward<F>(f));
+            }
+    };
+
+    /**
+     * @brief 可拷贝的函数包装器（拷贝内联存储的对象时同样不分配堆内存）
+    */
+    template <typename R, typename... Args, size_t Capacity>
+    class InlineFunction<R(Args...), Capacity, true> : public InlineFunctionBase<R(Args...), Capacity, true>
+    {
+        using Base = InlineFunctionBase<R(Args...), Capacity, true>;
+
+        public:
+            using Base::Base;
+
+            InlineFunction() noexcept = default;
+            InlineFunction(InlineFunction&&) noexcept = default;
+            InlineFunction& operator=(InlineFunction&&) noexcept = default;
+
+            InlineFunction(const InlineFunction& other) : Base() { this->_copyFrom(other); }
+
+            InlineFunction& operator=(const InlineFunction& other)
+            {
+                if(this != &other)
+                    *this = InlineFunction(other);
+                return *this;
+            }
+
+            InlineFunction& operator=(std::nullptr_t) noexcept
+            {
+                this->reset();
+                return *this;
+            }
+
+            template <typename F, typename = std::enable_if_t<Base::template kAccepts<F>>>
+            InlineFunction& operator=(F&& f)
+            {
+                return *this = InlineFunction(std::forward<F>(f));
+            }
+    };
+} // namespace handy
@@ -27,6 +27,34 @@ namespace handy
             return;
         }
 
+        // 处理可变参数：先格式化到栈上的缓冲区，放不下时再按所需长度分配
+        char buf[1024];
+        va_list args;
+        va_start(args, fmt);
+        va_list argsCopy;
+        va_copy(argsCopy, args);
+        int contentLength = vsnprintf(buf, sizeof(buf), fmt, argsCopy);
+        va_end(argsCopy);
+        if(contentLength < 0)
+        {
+            va_end(args);
+            return;
+        }
+        if(static_cast<size_t>(contentLength) < sizeof(buf))
+        {
+            va_end(args);
+            writeLog(level, file, line, func, buf, contentLength);
+            return;
+        }
+
+        std::unique_ptr<char[]> contentBuffer(new char[contentLength + 1]);
+        vsnprintf(contentBuffer.get(), contentLength + 1, fmt, args);
+        va_end(args);
+        writeLog(level, file, line, func, contentBuffer.get(), contentLength);
+    }
+
+    void Logger::writeLog(int level, const char* file, int line, const char* func, const char* msg, size_t len)
+    {
         // 检查并进行日志轮转
         checkAndRotateLogFile();
 
@@ -35,14 +63,19 @@ namespace handy
         auto now = std::chrono::system_clock::now();
         // 转换为C语言传统的time_t类型（秒级精度，便于兼容传统时间函数）
         std::time_t nowC = std::chrono::system_clock::to_time_t(now);
-        struct tm tm_info;
-        // 使用线程安全版本的localtime_r函数将时间戳转换为包含年月日时分秒的结构体
-        localtime_r(&nowC, &tm_info);
 
-        // 格式化时间字符串
-        char timeStr[32];
-        // 按格式字符串生成时间字符串
-        strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &tm_info);
+        // 格式化时间字符串（同一秒内复用线程缓存的结果，避免每条日志都调用localtime_r与strftime）
+        thread_local std::time_t cachedSecond = -1;
+        thread_local char timeStr[32];
+        if(nowC != cachedSecond)
+        {
+            struct tm tm_info;
+            // 使用线程安全版本的localtime_r函数将时间戳转换为包含年月日时分秒的结构体
+            localtime_r(&nowC, &tm_info);
+            // 按格式字符串生成时间字符串
+            strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &tm_info);
+            cachedSecond = nowC;
+        }
 
         // 获取毫秒
         // now.time_since_epoch()：获取从纪元时间（1970-01-01 00:00:00）到当前的总时长
@@ -51,29 +84,8 @@ namespace handy
 
         // 构建日志前缀
         char logPrefix[256];
-        int prefixLength = snprintf(logPrefix, sizeof(logPrefix), "[%s.%03lld] [%s] [%s:%d %s] ", timeStr, ms, getLogLevelString(static_cast<LogLevel>(level)), file, line, func);
-
-        // 处理可变参数
-        // C标准库类型，用于访问可变参数
-        va_list args;
-        // 初始化args，绑定到fmt后的可变参数（第二个参数必须是最后一个固定参数名）
-        // va_start必须与后续的va_end配对使用，否则会导致资源泄漏。
-        va_start(args, fmt);
-
-        // 计算日志内容长度
-        va_list argsCopy;
-        va_copy(argsCopy, args);
-        // vsnprintf会消耗参数，需保留原参数用于后续真正格式化
-        int contentLength = vsnprintf(nullptr, 0, fmt, argsCopy);
-        va_end(argsCopy);
-
-        // 分配缓冲区
-        std::unique_ptr<char[]> contentBuffer(new char[contentLength + 1]);
-        // 将可变参数按fmt格式写入缓冲区
-        // vsnprintf 是一个 C 风格的函数，它需要的是一个原始字符指针（char*） 作为输出缓冲区，而不是 std::unique_ptr 类型
-        // contentBuffer.get() 可以获取智能指针内部保存的原始指针
-        vsnprintf(contentBuffer.get(), contentLength + 1, fmt, args);
-        va_end(args);
+        size_t prefixLength = formatTo(logPrefix, sizeof(logPrefix), "[%s.%03lld] [%s] [%s:%d %s] ", timeStr, ms, getLogLevelString(static_cast<LogLevel>(level)), file, line, func);
+        prefixLength = std::min(prefixLength, sizeof(logPrefix) - 1);
 
         // 加锁并写入日志
         std::lock_guard<std::mutex> lock(m_mutex);
@@ -82,22 +94,10 @@ namespace handy
         if(!m_fd)
             m_fd = stdout;
 
-        // 写入日志
-        size_t totalLength = prefixLength + contentLength + 2;  // 添加换行符\n
-        std::unique_ptr<char[]> logBuffer(new char[totalLength]);
-        // 精确写入日志前缀 + 内容 + \n，确保无多余空字符
-        int written = snprintf(logBuffer.get(), totalLength, "%s%s\n", logPrefix, contentBuffer.get());
-        if (written < 0 || written >= static_cast<int>(totalLength)) {
-            // 错误处理：写入失败或越界，回退到 stdout 避免污染文件
-            fprintf(stderr, "Log buffer write error, fallback to stdout\n");
-            fwrite(logPrefix, 1, prefixLength, stdout);
-            fwrite(contentBuffer.get(), 1, contentLength, stdout);
-            fwrite("\n", 1, 1, stdout);
-            fflush(stdout);
-            return;
-        }
-        // 使用C标准库函数 fwrite 将完整日志写入文件描述符 m_fd
-        size_t actualWritten = fwrite(logBuffer.get(), 1, written, m_fd);
+        // 写入日志：前缀 + 内容 + \n（FILE缓冲区合并为一次写入）
+        size_t actualWritten = fwrite(logPrefix, 1, prefixLength, m_fd);
+        actualWritten += fwrite(msg, 1, len, m_fd);
+        actualWritten += fwrite("\n", 1, 1, m_fd);
         // fwrite 通常会先将数据写入内存缓冲区，而非直接写入磁盘或控制台
         // 调用 fflush 强制将缓冲区中的数据立即写入目标设备
         fflush(m_fd);   // 确保日志立即写入 
@@ -1,36 +1,23 @@
 #pragma once
 #include "non_copy_able.h"
+#include "format.h"
 #include <string>
 #include <mutex>
 #include <cstdio>
 #include <atomic>
 
-// 日志宏定义：根据编译模式（调试/发布）提供不同的日志处理逻辑
-#ifdef NDEBUG
-// 若当前为发布模式（Release）
-// 只有当当前日志级别小于等于日志系统设置的级别是时，才进行日志记录 
+// 日志宏定义
+// 1. 只有当前日志级别小于等于日志系统设置的级别时，才格式化并记录日志
+// 2. HANDY_CHECK_FORMAT在编译期检查格式字符串与参数类型（如"%s"传入int、参数个数不符），不匹配时编译失败
+// 3. 参数按实际类型格式化（见format.h），std::string、Slice可以直接传给"%s"
 #define HLOG(level, fmt, ...)                                                               \
     do {                                                                                    \
+        HANDY_CHECK_FORMAT(fmt, ##__VA_ARGS__);                                             \
         if(level <= handy::Logger::getInstance().getLogLevel())                             \
         {                                                                                   \
-            handy::Logger::getInstance().logv(level, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__);      \
+            handy::Logger::getInstance().log(level, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__);      \
         }                                                                                   \
     } while (0)
-#else
-// 若当前为调试模式（Debug）
-// 用日志格式字符串初始化一个静态常量，让编译器在编译器检查日志格式字符串的语法有效性
-// static const char* checkFmt = fmt: 仅用格式字符串初始化，不含变量
-// 避免编译器警告"未使用的变量checkFmt"，将其强制转换为void，表示已使用
-#define HLOG(level, fmt, ...)                                                                    \
-    do {                                                                                    \
-        if(level <= handy::Logger::getInstance().getLogLevel())                             \
-        {                                                                                   \
-            static const char* checkFmt = fmt;                                              \
-            (void)checkFmt;                                                                 \
-            handy::Logger::getInstance().logv(level, __FILE__, __LINE__, __func__, fmt, ##__VA_ARGS__);      \
-        }                                                                                   \
-    } while (0)
-#endif
 
 // 简化日志宏：直接传递 level + fmt + 可变参数（与 HLOG 格式匹配）
 #define TRACE(fmt, ...) HLOG(handy::Logger::LTRACE, fmt, ##__VA_ARGS__)
@@ -101,7 +88,40 @@ namespace handy
             }
 
             /**
-             * @brief 日志记录函数
+             * @brief 日志记录函数（类型安全，日志宏使用该接口）
+             * @param level 日志级别
+             * @param file 日志文件名
+             * @param line 日志行号
+             * @param func 日志函数名
+             * @param fmt 日志格式化字符串
+             * @param args 格式化参数
+             * @note 1. 仅当日志级别小于等于当前日志系统级别时，记录日志
+             * @note 2. 日志内容先格式化到栈上的缓冲区，超过缓冲区时才分配内存
+            */
+            template <class... Args>
+            void log(int level, const char* file, int line, const char* func, const char* fmt, const Args&... args)
+            {
+                if(level < LFATAL || level > LALL || level > getLogLevel())
+                {
+                    return;
+                }
+
+                char buf[1024];
+                ArraySink sink(buf, sizeof(buf));
+                formatTo(sink, fmt, args...);
+                if(!sink.truncated())
+                {
+                    writeLog(level, file, line, func, buf, sink.size());
+                    return;
+                }
+                std::string content;
+                content.reserve(sink.size());
+                formatTo(content, fmt, args...);
+                writeLog(level, file, line, func, content.data(), content.size());
+            }
+
+            /**
+             * @brief 日志记录函数（C可变参数版本，格式化使用vsnprintf）
              * @param level 日志级别
              * @param file 日志文件名
              * @param line 日志行号
@@ -109,7 +129,8 @@ namespace handy
              * @param fmt 日志格式化字符串
              * @note 仅当日志级别小于等于当前日志系统级别时，记录日志
             */
-           void logv(int level, const char* file, int line, const char* func, const char* fmt, ...);
+            void logv(int level, const char* file, int line, const char* func, const char* fmt, ...)
+                __attribute__((format(printf, 6, 7)));
 
             // 设置日志文件名称
             void setLogFileName(const std::string& logFileName);
@@ -187,6 +208,9 @@ namespace handy
                 }
             }
 
+            // 写入一条日志（前缀 + 内容 + 换行）
+            void writeLog(int level, const char* file, int line, const char* func, const char* msg, size_t len);
+
             // 检查并进行日志轮转
             void checkAndRotateLogFile();
 
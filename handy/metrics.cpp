@@ -0,0 +1,207 @@
+#include "metrics.h"
+#include <stdexcept>
+#include <stdio.h>
+
+namespace handy
+{
+    size_t metricShard() noexcept
+    {
+        static std::atomic<size_t> nextShard{0};
+        thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+        return shard;
+    }
+
+    uint64_t Histogram::Snapshot::percentile(double q) const noexcept
+    {
+        if(count == 0)
+            return 0;
+
+        // 目标样本的序号（从1开始），至少为1
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count) + 0.5);
+        if(rank == 0)
+            rank = 1;
+
+        uint64_t seen = 0;
+        for(int i = 0; i < kBuckets; ++i)
+        {
+            seen += buckets[i];
+            if(seen >= rank)
+                return bucketUpperBound(i);
+        }
+        return bucketUpperBound(kBuckets - 1);
+    }
+
+    Histogram::Snapshot Histogram::snapshot() const noexcept
+    {
+        Snapshot snap;
+        for(int i = 0; i < kBuckets; ++i)
+        {
+            snap.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+            snap.count += snap.buckets[i];
+        }
+        snap.sum = m_sum.load(std::memory_order_relaxed);
+        return snap;
+    }
+
+    MetricsRegistry& MetricsRegistry::instance()
+    {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    MetricsRegistry::Entry& MetricsRegistry::_entry(const std::string& name, const std::string& help,
+                                                        const std::string& labels, Type type)
+    {
+        auto [it, inserted] = m_families.try_emplace(name);
+        Family& family = it->second;
+        if(inserted)
+        {
+            family.type = type;
+            family.help = help;
+        }
+        else if(family.type != type)
+        {
+            throw std::invalid_argument("metric " + name + " already registered with another type");
+        }
+        return family.entries[labels];
+    }
+
+    Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = _entry(name, help, labels, Type::COUNTER);
+        if(!entry.counter)
+            entry.counter = std::make_unique<Counter>();
+        return *entry.counter;
+    }
+
+    Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = _entry(name, help, labels, Type::GAUGE);
+        if(!entry.gauge)
+            entry.gauge = std::make_unique<Gauge>();
+        return *entry.gauge;
+    }
+
+    void MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                                    const std::string& labels, ValueCallBack cb)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        _entry(name, help, labels, Type::GAUGE).cb = std::move(cb);
+    }
+
+    void MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                    const std::string& labels, ValueCallBack cb)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        _entry(name, help, labels, Type::COUNTER).cb = std::move(cb);
+    }
+
+    Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                            const std::string& labels, double scale)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = _entry(name, help, labels, Type::HISTOGRAM);
+        if(!entry.histogram)
+        {
+            entry.histogram = std::make_unique<Histogram>();
+            entry.scale = scale;
+        }
+        return *entry.histogram;
+    }
+
+    void MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels,
+                                        const Histogram& hist, double scale)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = _entry(name, help, labels, Type::HISTOGRAM);
+        entry.histogramRef = &hist;
+        entry.scale = scale;
+    }
+
+    void MetricsRegistry::remove(const std::string& name, const std::string& labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_families.find(name);
+        if(it == m_families.end())
+            return;
+        it->second.entries.erase(labels);
+        if(it->second.entries.empty())
+            m_families.erase(it);
+    }
+
+    namespace
+    {
+        // 输出一行样本：name{labels[,extra]} value
+        void appendSample(std::string& out, const std::string& name, const char* suffix,
+                            const std::string& labels, const std::string& extra, double value)
+        {
+            out += name;
+            out += suffix;
+            if(!labels.empty() || !extra.empty())
+            {
+                out += '{';
+                out += labels;
+                if(!labels.empty() && !extra.empty())
+                    out += ',';
+                out += extra;
+                out += '}';
+            }
+            char buf[64];
+            snprintf(buf, sizeof(buf), " %.17g\n", value);
+            out += buf;
+        }
+    } // namespace
+
+    std::string MetricsRegistry::render() const
+    {
+        static const char* typeNames[] = {"counter", "gauge", "histogram"};
+
+        std::string out;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(const auto& [name, family] : m_families)
+        {
+            out += "# HELP " + name + " " + family.help + "\n";
+            out += "# TYPE " + name + " " + typeNames[static_cast<int>(family.type)] + "\n";
+
+            for(const auto& [labels, entry] : family.entries)
+            {
+                const Histogram* hist = entry.histogram ? entry.histogram.get() : entry.histogramRef;
+                if(entry.cb)
+                {
+                    appendSample(out, name, "", labels, "", entry.cb());
+                }
+                else if(entry.counter)
+                {
+                    appendSample(out, name, "", labels, "", static_cast<double>(entry.counter->value()));
+                }
+                else if(entry.gauge)
+                {
+                    appendSample(out, name, "", labels, "", static_cast<double>(entry.gauge->value()));
+                }
+                else if(hist)
+                {
+                    // 只在每个2的幂区间的末尾输出一个le桶，保证桶边界稳定且数量可控
+                    Histogram::Snapshot snap = hist->snapshot();
+                    uint64_t cumulative = 0;
+                    for(int i = 0; i < Histogram::kBuckets; ++i)
+                    {
+                        cumulative += snap.buckets[i];
+                        bool octaveEnd = i < Histogram::kSubBuckets || (i % Histogram::kSubBuckets) == Histogram::kSubBuckets - 1;
+                        if(!octaveEnd || i == Histogram::kBuckets - 1)
+                            continue;
+                        char le[64];
+                        snprintf(le, sizeof(le), "le=\"%.17g\"",
+                                    static_cast<double>(Histogram::bucketUpperBound(i)) * entry.scale);
+                        appendSample(out, name, "_bucket", labels, le, static_cast<double>(cumulative));
+                    }
+                    appendSample(out, name, "_bucket", labels, "le=\"+Inf\"", static_cast<double>(snap.count));
+                    appendSample(out, name, "_sum", labels, "", static_cast<double>(snap.sum) * entry.scale);
+                    appendSample(out, name, "_count", labels, "", static_cast<double>(snap.count));
+                }
+            }
+        }
+        return out;
+    }
+} // namespace handy
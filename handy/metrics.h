@@ -0,0 +1,285 @@
+/**
+ * @file metrics.h
+ * @brief 运行时指标（计数器、仪表、直方图）与指标注册表
+ * @details 热路径上的更新只做relaxed原子操作（计数器按线程分片），
+ *          所有汇总工作都推迟到抓取（render）时进行
+*/
+#pragma once
+#include "non_copy_able.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace handy
+{
+    /**
+     * @brief 获取当前线程使用的指标分片下标
+     * @return size_t 分片下标（[0, kMetricShards)，线程首次调用时轮询分配）
+    */
+    size_t metricShard() noexcept;
+
+    // 计数器分片数量（每个线程固定落在其中一个分片上）
+    constexpr size_t kMetricShards = 16;
+
+    /**
+     * @class Counter
+     * @brief 单调递增计数器
+     * @details 按线程分片存储，每个分片独占一条cache line，多线程并发add()不会相互争用
+    */
+    class Counter : private NonCopyAble
+    {
+        public:
+            Counter() = default;
+
+            /**
+             * @brief 增加计数
+             * @param n 增量（应为非负数）
+            */
+            void add(int64_t n = 1) noexcept
+            {
+                m_cells[metricShard()].v.fetch_add(n, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief 汇总所有分片的计数
+             * @return int64_t 当前计数值
+            */
+            int64_t value() const noexcept
+            {
+                int64_t sum = 0;
+                for(const auto& cell : m_cells)
+                    sum += cell.v.load(std::memory_order_relaxed);
+                return sum;
+            }
+
+        private:
+            struct alignas(64) Cell
+            {
+                std::atomic<int64_t> v{0};
+            };
+            Cell m_cells[kMetricShards];
+    };
+
+    /**
+     * @class Gauge
+     * @brief 可增可减的瞬时值
+     * @note 内部只有一个原子变量，适用于单写者或低频更新的场景（如连接数、队列深度）
+    */
+    class Gauge : private NonCopyAble
+    {
+        public:
+            Gauge() = default;
+
+            void set(int64_t v) noexcept { m_v.store(v, std::memory_order_relaxed); }
+
+            void add(int64_t n) noexcept { m_v.fetch_add(n, std::memory_order_relaxed); }
+
+            int64_t value() const noexcept { return m_v.load(std::memory_order_relaxed); }
+
+        private:
+            std::atomic<int64_t> m_v{0};
+    };
+
+    /**
+     * @class Histogram
+     * @brief HDR风格的对数-线性直方图（每个2的幂区间再细分为4个子桶，相对误差不超过25%）
+     * @details 1. 桶下标由最高位与其后2位直接算出，observe()只有两次relaxed的fetch_add（所在桶的计数与样本总和），不加锁
+     *          2. 取值范围[0, 2^40)，更大的值计入最后一个桶
+     * @note 各桶之间不做同步，抓取到的快照在并发写入时可能有微小的不一致
+    */
+    class Histogram : private NonCopyAble
+    {
+        public:
+            static constexpr int kSubBits = 2;
+            static constexpr int kSubBuckets = 1 << kSubBits;
+            static constexpr int kMaxBits = 40;
+            static constexpr int kBuckets = (kMaxBits - kSubBits + 1) * kSubBuckets;
+
+            /**
+             * @brief 直方图快照（抓取时生成，之后可以无锁读取）
+            */
+            struct Snapshot
+            {
+                uint64_t buckets[kBuckets] = {};
+                uint64_t count = 0;
+                uint64_t sum = 0;
+
+                /**
+                 * @brief 估算分位数
+                 * @param q 分位（0~1，例如0.99）
+                 * @return uint64_t 分位数所在桶的上界（无样本时返回0）
+                */
+                uint64_t percentile(double q) const noexcept;
+            };
+
+            Histogram() = default;
+
+            /**
+             * @brief 记录一个样本
+             * @param v 样本值
+            */
+            void observe(uint64_t v) noexcept
+            {
+                m_buckets[bucketIndex(v)].fetch_add(1, std::memory_order_relaxed);
+                m_sum.fetch_add(v, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief 记录一个样本（仅限单一写线程，如事件循环自身的统计）
+             * @details 以relaxed的load+store代替fetch_add，避免带lock前缀的读改写指令；读线程仍可并发抓取
+             * @param v 样本值
+            */
+            void observeExclusive(uint64_t v) noexcept
+            {
+                std::atomic<uint64_t>& bucket = m_buckets[bucketIndex(v)];
+                bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                m_sum.store(m_sum.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief 生成快照
+            */
+            Snapshot snapshot() const noexcept;
+
+            /**
+             * @brief 计算样本值对应的桶下标
+            */
+            static int bucketIndex(uint64_t v) noexcept
+            {
+                if(v < static_cast<uint64_t>(kSubBuckets))
+                    return static_cast<int>(v);
+                int msb = 63 - __builtin_clzll(v);
+                if(msb >= kMaxBits)
+                    return kBuckets - 1;
+                int sub = static_cast<int>(v >> (msb - kSubBits)) & (kSubBuckets - 1);
+                return (msb - kSubBits + 1) * kSubBuckets + sub;
+            }
+
+            /**
+             * @brief 获取桶的上界（闭区间）
+            */
+            static uint64_t bucketUpperBound(int idx) noexcept
+            {
+                if(idx < kSubBuckets)
+                    return static_cast<uint64_t>(idx);
+                int msb = idx / kSubBuckets + kSubBits - 1;
+                uint64_t sub = static_cast<uint64_t>(idx % kSubBuckets);
+                uint64_t width = uint64_t{1} << (msb - kSubBits);
+                return ((kSubBuckets + sub) << (msb - kSubBits)) + width - 1;
+            }
+
+        private:
+            std::atomic<uint64_t> m_buckets[kBuckets] = {};
+            std::atomic<uint64_t> m_sum{0};
+    };
+
+    /**
+     * @class MetricsRegistry
+     * @brief 指标注册表，负责指标的命名、存储与Prometheus文本格式输出
+     * @details 1. 同名同标签的指标只创建一次，重复注册返回已有对象（引用在注册表生命周期内有效）
+     *          2. 注册/注销/输出需要加锁，但指标本身的更新不经过注册表，不受锁影响
+     *          3. 回调型仪表在输出时才求值，适合把已有的状态（如队列长度）直接暴露出来
+    */
+    class MetricsRegistry : private NonCopyAble
+    {
+        public:
+            using ValueCallBack = std::function<double()>;
+
+            MetricsRegistry() = default;
+
+            /**
+             * @brief 获取进程级的默认注册表
+            */
+            static MetricsRegistry& instance();
+
+            /**
+             * @brief 获取或创建计数器
+             * @param name 指标名（Prometheus规范，计数器建议以_total结尾）
+             * @param help 说明文字
+             * @param labels 标签（形如loop="0",conn="a"，可为空）
+             * @throw std::invalid_argument 同名指标已以其他类型注册
+            */
+            Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+            /**
+             * @brief 获取或创建仪表
+             * @throw std::invalid_argument 同名指标已以其他类型注册
+            */
+            Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+            /**
+             * @brief 注册回调型仪表（重复注册时替换回调）
+             * @param cb 输出时调用的求值函数（在执行render()的线程中调用，需自行保证线程安全）
+             * @throw std::invalid_argument 同名指标已以其他类型注册
+            */
+            void gauge(const std::string& name, const std::string& help, const std::string& labels, ValueCallBack cb);
+
+            /**
+             * @brief 注册回调型计数器（用于导出其他模块自行维护的计数，重复注册时替换回调）
+             * @throw std::invalid_argument 同名指标已以其他类型注册
+            */
+            void counter(const std::string& name, const std::string& help, const std::string& labels, ValueCallBack cb);
+
+            /**
+             * @brief 获取或创建直方图
+             * @param scale 输出时样本值乘以的系数（如样本单位为微秒，输出为秒时传1e-6）
+             * @throw std::invalid_argument 同名指标已以其他类型注册
+            */
+            Histogram& histogram(const std::string& name, const std::string& help,
+                                    const std::string& labels = "", double scale = 1.0);
+
+            /**
+             * @brief 导出由其他模块持有的直方图
+             * @param hist 直方图（需在注销前保持有效）
+             * @param scale 输出时样本值乘以的系数
+             * @throw std::invalid_argument 同名指标已以其他类型注册
+            */
+            void histogram(const std::string& name, const std::string& help, const std::string& labels,
+                            const Histogram& hist, double scale = 1.0);
+
+            /**
+             * @brief 注销指标
+             * @param name 指标名
+             * @param labels 标签（需与注册时一致）
+            */
+            void remove(const std::string& name, const std::string& labels = "");
+
+            /**
+             * @brief 以Prometheus文本格式（version 0.0.4）输出全部指标
+             * @return std::string 输出内容
+            */
+            std::string render() const;
+
+        private:
+            enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+            struct Entry
+            {
+                std::unique_ptr<Counter> counter;
+                std::unique_ptr<Gauge> gauge;
+                std::unique_ptr<Histogram> histogram;
+                const Histogram* histogramRef = nullptr;
+                ValueCallBack cb;
+                double scale = 1.0;
+            };
+
+            struct Family
+            {
+                Type type;
+                std::string help;
+                std::map<std::string, Entry> entries;   // key：标签
+            };
+
+            /**
+             * @brief 查找或创建指标（调用者需持有m_mutex）
+            */
+            Entry& _entry(const std::string& name, const std::string& help, const std::string& labels, Type type);
+
+            mutable std::mutex m_mutex;
+            std::map<std::string, Family> m_families;
+    };
+} // namespace handy
@@ -1,8 +1,11 @@
 #include "net.h"
 #include "logger.h"
 #include "utils.h"
+#include "current_os.h"
 #include <fcntl.h>
 #include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace handy
 {
@@ -119,6 +122,183 @@ namespace handy
         return true;
     }
 
+    bool Net::setBusyPoll(int fd, int busyPoll_us, int* errCode)
+    {
+        if(fd < 0)
+        {
+            if(errCode)
+                *errCode = EBADF;
+            ERROR("Net::setBusyPoll: invalid fd = %d", fd);
+            return false;
+        }
+
+#ifdef SO_BUSY_POLL
+        int value = busyPoll_us > 0 ? busyPoll_us : 0;
+        if(setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) < 0)
+        {
+            int err = errno;
+            if(errCode)
+                *errCode = err;
+            ERROR("Net::setBusyPoll: setsockopt(%d, SO_BUSY_POLL) failed, err = %d(%s)", fd, err, strerror(err));
+            return false;
+        }
+        return true;
+#else
+        if(errCode)
+            *errCode = ENOPROTOOPT;
+        ERROR("Net::setBusyPoll: SO_BUSY_POLL is not supported on this platform");
+        return false;
+#endif
+    }
+
+    namespace
+    {
+        /**
+         * @brief 设置int类型的Socket选项，失败时记录日志并输出错误码
+         * @param func 调用者名称（用于日志）
+         * @param optName 选项名称（用于日志）
+        */
+        bool setIntOption(const char* func, const char* optName, int fd, int level, int opt, int value, int* errCode)
+        {
+            if(fd < 0)
+            {
+                if(errCode)
+                    *errCode = EBADF;
+                ERROR("Net::%s: invalid fd = %d", func, fd);
+                return false;
+            }
+
+            if(setsockopt(fd, level, opt, &value, sizeof(value)) < 0)
+            {
+                int err = errno;
+                if(errCode)
+                    *errCode = err;
+                ERROR("Net::%s: setsockopt(%d, %s) failed, err = %d(%s)", func, fd, optName, err, strerror(err));
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief 平台不支持某个选项时的统一处理（所有选项都受支持的平台上不会用到）
+        */
+        [[maybe_unused]] bool unsupportedOption(const char* func, const char* optName, int* errCode)
+        {
+            if(errCode)
+                *errCode = ENOPROTOOPT;
+            ERROR("Net::%s: %s is not supported on this platform", func, optName);
+            return false;
+        }
+    } // namespace
+
+    bool Net::setRecvBuf(int fd, int bytes, int* errCode)
+    {
+        return setIntOption("setRecvBuf", "SO_RCVBUF", fd, SOL_SOCKET, SO_RCVBUF, bytes, errCode);
+    }
+
+    bool Net::setSendBuf(int fd, int bytes, int* errCode)
+    {
+        return setIntOption("setSendBuf", "SO_SNDBUF", fd, SOL_SOCKET, SO_SNDBUF, bytes, errCode);
+    }
+
+    bool Net::setQuickAck(int fd, bool value, int* errCode)
+    {
+#ifdef TCP_QUICKACK
+        return setIntOption("setQuickAck", "TCP_QUICKACK", fd, IPPROTO_TCP, TCP_QUICKACK, value ? 1 : 0, errCode);
+#else
+        return unsupportedOption("setQuickAck", "TCP_QUICKACK", errCode);
+#endif
+    }
+
+    bool Net::setDeferAccept(int fd, int timeout_s, int* errCode)
+    {
+#ifdef TCP_DEFER_ACCEPT
+        return setIntOption("setDeferAccept", "TCP_DEFER_ACCEPT", fd, IPPROTO_TCP, TCP_DEFER_ACCEPT,
+                            timeout_s > 0 ? timeout_s : 0, errCode);
+#else
+        return unsupportedOption("setDeferAccept", "TCP_DEFER_ACCEPT", errCode);
+#endif
+    }
+
+    bool Net::setFastOpen(int fd, int queueLen, int* errCode)
+    {
+#ifdef TCP_FASTOPEN
+        return setIntOption("setFastOpen", "TCP_FASTOPEN", fd, IPPROTO_TCP, TCP_FASTOPEN,
+                            queueLen > 0 ? queueLen : 0, errCode);
+#else
+        return unsupportedOption("setFastOpen", "TCP_FASTOPEN", errCode);
+#endif
+    }
+
+    bool Net::setFastOpenConnect(int fd, bool value, int* errCode)
+    {
+#ifdef TCP_FASTOPEN_CONNECT
+        return setIntOption("setFastOpenConnect", "TCP_FASTOPEN_CONNECT", fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT,
+                            value ? 1 : 0, errCode);
+#else
+        return unsupportedOption("setFastOpenConnect", "TCP_FASTOPEN_CONNECT", errCode);
+#endif
+    }
+
+    bool Net::setNotSentLowat(int fd, int bytes, int* errCode)
+    {
+#ifdef TCP_NOTSENT_LOWAT
+        return setIntOption("setNotSentLowat", "TCP_NOTSENT_LOWAT", fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, bytes, errCode);
+#else
+        return unsupportedOption("setNotSentLowat", "TCP_NOTSENT_LOWAT", errCode);
+#endif
+    }
+
+    bool Net::setCork(int fd, bool value, int* errCode)
+    {
+#if defined(TCP_CORK)
+        return setIntOption("setCork", "TCP_CORK", fd, IPPROTO_TCP, TCP_CORK, value ? 1 : 0, errCode);
+#elif defined(TCP_NOPUSH)
+        return setIntOption("setCork", "TCP_NOPUSH", fd, IPPROTO_TCP, TCP_NOPUSH, value ? 1 : 0, errCode);
+#else
+        return unsupportedOption("setCork", "TCP_CORK", errCode);
+#endif
+    }
+
+    bool Net::setIncomingCpu(int fd, int cpu, int* errCode)
+    {
+#ifdef SO_INCOMING_CPU
+        return setIntOption("setIncomingCpu", "SO_INCOMING_CPU", fd, SOL_SOCKET, SO_INCOMING_CPU, cpu, errCode);
+#else
+        return unsupportedOption("setIncomingCpu", "SO_INCOMING_CPU", errCode);
+#endif
+    }
+
+    bool SocketOptions::apply(int fd, Role role) const
+    {
+        bool ok = true;
+        if(recvBuf > 0)
+            ok = Net::setRecvBuf(fd, recvBuf) && ok;
+        if(sendBuf > 0)
+            ok = Net::setSendBuf(fd, sendBuf) && ok;
+
+        if(role == Role::LISTEN)
+        {
+            if(deferAccept_s > 0)
+                ok = Net::setDeferAccept(fd, deferAccept_s) && ok;
+            if(fastOpenQueue > 0)
+                ok = Net::setFastOpen(fd, fastOpenQueue) && ok;
+            if(incomingCpu >= 0)
+                ok = Net::setIncomingCpu(fd, incomingCpu) && ok;
+            return ok;
+        }
+
+        if(noDelay)
+            ok = Net::setNoDelay(fd, true) && ok;
+        if(quickAck)
+            ok = Net::setQuickAck(fd, true) && ok;
+        if(notSentLowat > 0)
+            ok = Net::setNotSentLowat(fd, notSentLowat) && ok;
+        if(role == Role::CONNECT && fastOpenConnect)
+            ok = Net::setFastOpenConnect(fd, true) && ok;
+        return ok;
+    }
+
     void Ipv4Addr::initAddr(unsigned short port, uint32_t ipNetOrder)
     {
         memset(&m_addr, 0, sizeof(m_addr));
@@ -233,16 +413,69 @@ namespace handy
         return false;
     }
 
+    namespace
+    {
+        /**
+         * @brief 系统页大小（镜像映射的容量必须是它的整数倍）
+        */
+        size_t pageSize()
+        {
+            static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            return size;
+        }
+
+        /**
+         * @brief 创建镜像映射：[p, p + cap)与[p + cap, p + 2 * cap)映射到同一组物理页
+         * @param cap 容量（页大小的整数倍）
+         * @return char* 映射起始地址，失败返回nullptr
+        */
+        char* mapMirror(size_t cap)
+        {
+#ifdef OS_LINUX
+            int fd = memfd_create("handy-buffer", MFD_CLOEXEC);
+            if(fd < 0)
+            {
+                ERROR("Buffer: memfd_create failed, err = %d(%s)", errno, strerror(errno));
+                return nullptr;
+            }
+
+            char* mirror = nullptr;
+            if(ftruncate(fd, static_cast<off_t>(cap)) == 0)
+            {
+                // 先保留2 * cap的连续地址空间，再把同一个文件固定映射到前后两半
+                void* base = mmap(nullptr, 2 * cap, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if(base != MAP_FAILED)
+                {
+                    char* p = static_cast<char*>(base);
+                    if(mmap(p, cap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+                        mmap(p + cap, cap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED)
+                        mirror = p;
+                    else
+                        munmap(base, 2 * cap);
+                }
+            }
+            if(!mirror)
+                ERROR("Buffer: map mirror of %zu bytes failed, err = %d(%s)", cap, errno, strerror(errno));
+            // 映射持有文件的引用，关闭fd不影响映射
+            close(fd);
+            return mirror;
+#else
+            (void)cap;
+            return nullptr;
+#endif
+        }
+    } // namespace
+
     Buffer::Buffer()
-        : m_buf(nullptr), m_b(0), m_e(0), m_cap(0), m_exp(512), m_mutex(new std::mutex()) {}
+        : m_buf(nullptr), m_b(0), m_e(0), m_cap(0), m_exp(512), m_ring(false), m_mutex(new std::mutex()) {}
 
     Buffer::~Buffer()
     {
-        delete[] m_buf;
+        _release();
     }
 
     Buffer::Buffer(const Buffer& other)
-        : m_buf(nullptr), m_b(0), m_e(0), m_cap(0), m_exp(512), m_mutex(new std::mutex())
+        : m_buf(nullptr), m_b(0), m_e(0), m_cap(0), m_exp(512), m_ring(false), m_mutex(new std::mutex())
     {
         std::lock_guard<std::mutex> lock(*other.m_mutex); 
         _copyFrom(other);
@@ -260,7 +493,7 @@ namespace handy
 
     Buffer::Buffer(Buffer&& other) noexcept
         : m_buf(other.m_buf), m_b(other.m_b), m_e(other.m_e), 
-        m_cap(other.m_cap), m_exp(other.m_exp), m_mutex(std::move(other.m_mutex))
+        m_cap(other.m_cap), m_exp(other.m_exp), m_ring(other.m_ring), m_mutex(std::move(other.m_mutex))
     {
         // 将other的成员重置为“空状态”，避免析构时重复释放
         other.m_buf = nullptr;
@@ -268,6 +501,7 @@ namespace handy
         other.m_e = 0;
         other.m_cap = 0;
         other.m_exp = 512;
+        other.m_ring = false;
         other.m_mutex.reset(new std::mutex());  // 确保other后续使用时锁有效
     }
 
@@ -275,13 +509,16 @@ namespace handy
     {
         if(this != &other)
         {
-            std::lock_guard<std::mutex> lock(*m_mutex);  // 仅对当前对象加锁（保护自身资源）
-            // 转移other的资源
+            std::unique_ptr<std::mutex> mutex = std::move(m_mutex);
+            std::lock_guard<std::mutex> lock(*mutex);  // 仅对当前对象加锁（保护自身资源）
+            // 释放自身资源，再转移other的资源
+            _release();
             m_buf = other.m_buf;
             m_b = other.m_b;
             m_e = other.m_e;
             m_cap = other.m_cap;
             m_exp = other.m_exp;
+            m_ring = other.m_ring;
             m_mutex = std::move(other.m_mutex);
             
             // 重置other
@@ -290,6 +527,7 @@ namespace handy
             other.m_e = 0;
             other.m_cap = 0;
             other.m_exp = 512;
+            other.m_ring = false;
             other.m_mutex.reset(new std::mutex());
         }
         return *this;
@@ -298,7 +536,7 @@ namespace handy
     void Buffer::clear()
     {
         std::lock_guard<std::mutex> lock(*m_mutex);
-        delete[] m_buf;
+        _release();
         m_buf = nullptr;
         m_b = 0;
         m_e = 0;
@@ -338,7 +576,8 @@ namespace handy
     size_t Buffer::space() const
     {
         std::lock_guard<std::mutex> lock(*m_mutex);
-        return m_cap - m_e;
+        // 环形模式下数据之后的空间经由第二份映射连续可写
+        return m_ring ? m_cap - _size() : m_cap - m_e;
     }
 
     const char* Buffer::peek() const 
@@ -350,13 +589,18 @@ namespace handy
     void Buffer::makeRoom()
     {
         std::lock_guard<std::mutex> lock(*m_mutex);
-        if(space() < m_exp)
+        if(m_ring && (m_cap - _size() >= m_exp || _remapRing(std::max(2 * m_cap, _size() + m_exp))))
+            return;
+        // 已持有锁，不能调用space()，否则会重复加锁导致死锁
+        if(m_cap - m_e < m_exp)
             _expand(0);
     }
 
     char* Buffer::makeRoom(size_t len)
     {
         std::lock_guard<std::mutex> lock(*m_mutex);
+        if(m_ring && (m_cap - _size() >= len || _remapRing(std::max(2 * m_cap, _size() + len))))
+            return m_buf + m_e;
         if(m_e + len > m_cap)
         {
             if(_size() + len < m_exp / 2)
@@ -420,7 +664,18 @@ namespace handy
         size_t consumeLen = std::min(len, m_e - m_b);
         m_b += consumeLen;
 
-        if(m_b == m_e)
+        if(m_ring)
+        {
+            // 环形模式保留映射，只回绕偏移量
+            if(m_b == m_e)
+                m_b = m_e = 0;
+            else if(m_b >= m_cap)
+            {
+                m_b -= m_cap;
+                m_e -= m_cap;
+            }
+        }
+        else if(m_b == m_e)
         {
             // 不能使用clear()，会产生死锁
             delete[] m_buf;
@@ -448,7 +703,8 @@ namespace handy
         if(other.m_b == other.m_e)
             return *this;
 
-        if(m_b == m_e)
+        // 两者模式相同时才能直接交换底层内存
+        if(m_b == m_e && m_ring == other.m_ring)
         {
             std::swap(m_buf, other.m_buf);
             std::swap(m_cap, other.m_cap);
@@ -458,8 +714,9 @@ namespace handy
         else
         {
             appendUnSafe(other.m_buf + other.m_b, other.m_e - other.m_b);
-            other.m_b = other.m_e;
-            delete[] other.m_buf;
+            other._release();
+            other.m_b = 0;
+            other.m_e = 0;
             other.m_buf = nullptr;
             other.m_cap = 0;
         }
@@ -479,8 +736,24 @@ namespace handy
         return Slice(m_buf + m_b, m_e - m_b);
     }
 
+    bool Buffer::enableRing(size_t cap)
+    {
+        std::lock_guard<std::mutex> lock(*m_mutex);
+        if(m_ring)
+            return true;
+        return _remapRing(std::max(cap > 0 ? cap : m_exp, _size()));
+    }
+
+    bool Buffer::isRing() const
+    {
+        std::lock_guard<std::mutex> lock(*m_mutex);
+        return m_ring;
+    }
+
     char* Buffer::_makeRoom(size_t len)
     {
+        if(m_ring && (m_cap - _size() >= len || _remapRing(std::max(2 * m_cap, _size() + len))))
+            return m_buf + m_e;
         if(m_e + len <= m_cap)
             return m_buf + m_e;
 
@@ -519,12 +792,64 @@ namespace handy
         m_b = 0;
     }
 
+    bool Buffer::_remapRing(size_t minCap)
+    {
+        const size_t page = pageSize();
+        const size_t newCap = std::max(page, (minCap + page - 1) / page * page);
+        const size_t currentSize = _size();
+
+        char* newBuf = mapMirror(newCap);
+        const bool mapped = newBuf != nullptr;
+        if(!mapped)
+        {
+            // 尚未进入环形模式：保持原状；环形模式扩容失败：退回普通模式，数据转移到堆上
+            if(!m_ring)
+                return false;
+            WARN("Buffer: fall back to plain buffer of %zu bytes", newCap);
+            newBuf = new char[newCap];
+        }
+
+        if(currentSize > 0)
+            memcpy(newBuf, m_buf + m_b, currentSize);
+
+        _release();
+        m_buf = newBuf;
+        m_b = 0;
+        m_e = currentSize;
+        m_cap = newCap;
+        m_ring = mapped;
+        return mapped;
+    }
+
+    void Buffer::_release() noexcept
+    {
+        if(!m_buf)
+            return;
+        if(m_ring)
+            munmap(m_buf, 2 * m_cap);
+        else
+            delete[] m_buf;
+    }
+
     void Buffer::_copyFrom(const Buffer& other)
     {
+        m_exp = other.m_exp;
+        if(other.m_ring)
+        {
+            // 环形缓冲区拷贝为普通模式，只拷贝有效数据
+            const size_t len = other.m_e - other.m_b;
+            m_buf = len > 0 ? new char[len] : nullptr;
+            if(len > 0)
+                memcpy(m_buf, other.m_buf + other.m_b, len);
+            m_b = 0;
+            m_e = len;
+            m_cap = len;
+            return;
+        }
+
         m_b = other.m_b;
         m_e = other.m_e;
         m_cap = other.m_cap;
-        m_exp = other.m_exp;
 
         if(other.m_buf && other.m_cap > 0)
         {
@@ -542,6 +867,7 @@ namespace handy
         std::swap(m_e, other.m_e);
         std::swap(m_cap, other.m_cap);
         std::swap(m_exp, other.m_exp);
+        std::swap(m_ring, other.m_ring);
         std::swap(m_mutex, other.m_mutex);
     }
 } // namespace handy
\ No newline at end of file
@@ -102,6 +102,140 @@ namespace handy
          * @note 禁用Nagle算法，减少小数据包的传输延迟，但可能增加网络负载
         */
         static bool setNoDelay(int fd, bool value = true, int* errCode = nullptr);
+
+        /**
+         * @brief 设置Socket的忙轮询时间(SO_BUSY_POLL，仅Linux)
+         * @param fd 目标Socket文件描述符
+         * @param busyPoll_us 接收队列为空时，阻塞读/poll在驱动层忙轮询的时间（微秒，0表示关闭）
+         * @param errCode[out] 错误码，为nullptr时不输出
+         * @return bool 操作成功返回true，否则返回false
+         * @note 超过系统默认值（net.core.busy_read）时需要CAP_NET_ADMIN权限；非Linux平台返回false(ENOPROTOOPT)
+        */
+        static bool setBusyPoll(int fd, int busyPoll_us, int* errCode = nullptr);
+
+        /**
+         * @brief 设置Socket的接收缓冲区大小(SO_RCVBUF)
+         * @param fd 目标Socket文件描述符
+         * @param bytes 缓冲区大小（字节，内核实际使用其两倍，上限为net.core.rmem_max）
+         * @param errCode[out] 错误码，为nullptr时不输出
+         * @return bool 操作成功返回true，否则返回false
+         * @note 固定大小会关闭内核的接收缓冲区自动调整；需在listen()/connect()之前设置才能影响窗口扩大因子
+        */
+        static bool setRecvBuf(int fd, int bytes, int* errCode = nullptr);
+
+        /**
+         * @brief 设置Socket的发送缓冲区大小(SO_SNDBUF)
+         * @param fd 目标Socket文件描述符
+         * @param bytes 缓冲区大小（字节，内核实际使用其两倍，上限为net.core.wmem_max）
+         * @param errCode[out] 错误码，为nullptr时不输出
+         * @return bool 操作成功返回true，否则返回false
+        */
+        static bool setSendBuf(int fd, int bytes, int* errCode = nullptr);
+
+        /**
+         * @brief 设置TCP快速确认(TCP_QUICKACK，仅Linux)
+         * @param fd 目标TCP Socket文件描述符
+         * @param value true: 立即发送ACK，false: 允许延迟ACK
+         * @param errCode[out] 错误码，为nullptr时不输出
+         * @return bool 操作成功返回true，否则返回false
+         * @note 该选项不是永久的，内核会根据后续的交互重新进入延迟ACK模式，请求-响应类场景可在每次读取后重新设置
+        */
+        static bool setQuickAck(int fd, bool value = true, int* errCode = nullptr);
+
+        /**
+         * @brief 设置监听Socket的延迟接受(TCP_DEFER_ACCEPT，仅Linux)
+         * @param fd 监听Socket文件描述符
+         * @param timeout_s 等待首个数据包的最长时间（秒，0表示关闭）
+         * @param errCode[out] 错误码，为nullptr时不输出
+         * @return bool 操作成功返回true，否则返回false
+         * @note 连接在收到数据之前不会被accept()返回，适用于客户端先发送数据的协议（如HTTP）
+        */
+        static bool setDeferAccept(int fd, int timeout_s, int* errCode = nullptr);
+
+        /**
+         * @brief 在监听Socket上开启TCP Fast Open(TCP_FASTOPEN)
+         * @param fd 监听Socket文件描述符
+         * @param queueLen 尚未完成三次握手的TFO请求队列长度（0表示关闭）
+         * @param errCode[out] 错误码，为nullptr时不输出
+         * @return bool 操作成功返回true，否则返回false
+         * @note 还需要系统开启net.ipv4.tcp_fastopen的服务端位（0x2）
+        */
+        static bool setFastOpen(int fd, int queueLen, int* errCode = nullptr);
+
+        /**
+         * @brief 在客户端Socket上开启TCP Fast Open(TCP_FASTOPEN_CONNECT，仅Linux)
+         * @param fd 尚未connect()的客户端Socket文件描述符
+         * @param value true: 开启，false: 关闭
+         * @param errCode[out] 错误码，为nullptr时不输出
+         * @return bool 操作成功返回true，否则返回false
+         * @note 开启后connect()立即返回，第一次写入的数据随SYN一起发出（持有服务端的TFO cookie时）
+        */
+        static bool setFastOpenConnect(int fd, bool value = true, int* errCode = nullptr);
+
+        /**
+         * @brief 设置发送队列中未发出数据的上限(TCP_NOTSENT_LOWAT)
+         * @param fd 目标TCP Socket文件描述符
+         * @param bytes 未发出的数据低于该值时才报告可写（字节）
+         * @param errCode[out] 错误码，为nullptr时不输出
+         * @return bool 操作成功返回true，否则返回false
+         * @note 减少积压在内核中的数据，让应用层的输出缓冲区与水位控制更快生效
+        */
+        static bool setNotSentLowat(int fd, int bytes, int* errCode = nullptr);
+
+        /**
+         * @brief 设置TCP_CORK(Linux)/TCP_NOPUSH(BSD)
+         * @param fd 目标TCP Socket文件描述符
+         * @param value true: 只发送满的报文段，false: 立即发出积攒的数据
+         * @param errCode[out] 错误码，为nullptr时不输出
+         * @return bool 操作成功返回true，否则返回false
+         * @note 在多段写入前后成对调用，把它们合并成尽量少的报文段
+        */
+        static bool setCork(int fd, bool value, int* errCode = nullptr);
+
+        /**
+         * @brief 设置Socket的期望处理CPU(SO_INCOMING_CPU，仅Linux)
+         * @param fd 目标Socket文件描述符
+         * @param cpu CPU编号
+         * @param errCode[out] 错误码，为nullptr时不输出
+         * @return bool 操作成功返回true，否则返回false
+         * @note 设置在SO_REUSEPORT组内的监听Socket上时，内核优先把在该CPU上收到的连接分给它，
+         *       配合绑定到同一CPU的事件循环，连接从软中断到应用处理都留在同一个CPU上
+        */
+        static bool setIncomingCpu(int fd, int cpu, int* errCode = nullptr);
+    };
+
+    /**
+     * @struct SocketOptions
+     * @brief TCP连接的调优选项，由TcpServer（监听与接受的Socket）和TcpConn（主动连接的Socket）统一应用
+     * @note 各字段为0/false/-1时表示不设置，保留系统默认值；设置失败只记录日志，不影响连接
+    */
+    struct SocketOptions
+    {
+        // 选项应用到的Socket类型，不同类型适用的选项不同
+        enum class Role
+        {
+            LISTEN,     // 监听Socket（在listen()之前应用，部分选项会被接受的连接继承）
+            ACCEPTED,   // 服务端接受的连接
+            CONNECT,    // 客户端连接（在connect()之前应用）
+        };
+
+        int recvBuf = 0;                // SO_RCVBUF（字节，所有类型）
+        int sendBuf = 0;                // SO_SNDBUF（字节，所有类型）
+        bool noDelay = false;           // TCP_NODELAY（接受的连接、客户端连接）
+        bool quickAck = false;          // TCP_QUICKACK（接受的连接、客户端连接）
+        int deferAccept_s = 0;          // TCP_DEFER_ACCEPT（秒，监听Socket）
+        int fastOpenQueue = 0;          // TCP_FASTOPEN队列长度（监听Socket）
+        bool fastOpenConnect = false;   // TCP_FASTOPEN_CONNECT（客户端连接）
+        int notSentLowat = 0;           // TCP_NOTSENT_LOWAT（字节，接受的连接、客户端连接）
+        int incomingCpu = -1;           // SO_INCOMING_CPU（监听Socket，-1表示不设置）
+
+        /**
+         * @brief 按Socket类型应用适用的选项
+         * @param fd 目标Socket文件描述符
+         * @param role Socket类型
+         * @return bool 全部设置成功返回true，任一失败返回false（失败原因记录在日志中）
+        */
+        bool apply(int fd, Role role) const;
     };
 
     /**
@@ -215,6 +349,8 @@ namespace handy
      * @note 1. 数据的追加、消耗、清空
      * @note 2. 缓冲区的自动扩展和内存碎片整理
      * @note 3. 线程安全的拷贝和移动操作
+     * @note 4. 可选的环形模式（enableRing）：同一组物理页连续映射两次，可读数据与可写空间始终连续，
+     * @note    消费和追加都不需要移动数据（普通模式空间不足时会memmove未读数据到头部）
     */
     class Buffer
     {
@@ -229,6 +365,8 @@ namespace handy
             size_t m_cap;
             // 期望增长大小（字节数），用于减少内存分配次数
             size_t m_exp;
+            // 环形模式：m_buf为镜像映射（虚拟地址长度2 * m_cap），0 <= m_b < m_cap，m_e - m_b <= m_cap
+            bool m_ring;
             // 互斥锁，保证多线程访问的线程安全
             std::unique_ptr<std::mutex> m_mutex;
 
@@ -253,6 +391,20 @@ namespace handy
             */
             void _moveHead();
 
+            /**
+             * @brief 环形模式下重新映射容量不小于minCap的镜像区域，并把数据拷贝到开头
+             * @param minCap 最小容量（字节数）
+             * @return bool 成功返回true；映射失败时退回普通模式（数据保留）并返回false
+             * @note 内部方法，调用前需先加锁
+            */
+            bool _remapRing(size_t minCap);
+
+            /**
+             * @brief 释放底层内存（按当前模式delete[]或解除映射），不修改偏移量
+             * @note 内部方法，调用前需先加锁
+            */
+            void _release() noexcept;
+
             /**
              * @brief 从另一个缓冲区深拷贝数据和状态
              * @param other 被拷贝的缓冲区
@@ -423,7 +575,7 @@ namespace handy
             template <class T>
             Buffer& appendValue(const T& v)
             {
-                static_assert(std::is_pod<T>::value, "Buffer::appendValue only support POD types");
+                static_assert(std::is_trivial<T>::value && std::is_standard_layout<T>::value, "Buffer::appendValue only support POD types");
                 return append(reinterpret_cast<const char*>(&v), sizeof(T));
             }
 
@@ -455,5 +607,22 @@ namespace handy
              * @note 返回的Slice对象仅在当前语句有效，请勿保存引用
             */
             operator Slice() const;
+
+            /**
+             * @brief 切换为环形缓冲区（同一组物理页通过memfd + mmap连续映射两次）
+             * @param cap 初始容量（字节数，向上取整为页大小的整数倍；0表示按期望增长大小）
+             * @return bool 成功返回true；平台不支持或映射失败时返回false，缓冲区保持普通模式
+             * @details 1. 环形模式下begin()/end()之间的数据、end()之后space()字节的可写空间都是连续的，
+             *             数据跨越物理末尾时由第二份映射接上，消费只移动起始偏移，不会memmove
+             *          2. 已有数据会被拷贝到新映射中；空间不足时按2倍扩容（需要一次拷贝）
+             *          3. 拷贝得到的Buffer是普通模式；clear()只释放映射，仍保持环形模式
+             * @note 仅Linux支持（memfd_create）
+            */
+            bool enableRing(size_t cap = 0);
+
+            /**
+             * @brief 是否处于环形模式
+            */
+            bool isRing() const;
     };
 } // namespace handy
\ No newline at end of file
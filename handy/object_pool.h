@@ -0,0 +1,203 @@
+/**
+ * @file object_pool.h
+ * @brief 按大小分级的内存块回收池（BlockPool）与配套的分配器（PoolAllocator）
+ * @details 1. 每个EventBase持有一个池，用于连接（TcpConn）与通道（Channel）这类频繁创建、销毁的对象
+ *          2. 分配只在池的所属线程（事件循环线程）中进行，释放可以在任意线程：
+ *             释放的内存块以无锁方式压入"远端"链表，分配时本地链表为空再整体取回，不需要加锁
+ *          3. 池按引用计数管理：每个未归还的内存块持有一个引用，EventBase先于对象析构时，
+ *             池在最后一个内存块归还后才真正释放
+*/
+#pragma once
+#include "non_copy_able.h"
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace handy
+{
+    /**
+     * @class BlockPool
+     * @brief 内存块回收池（按64字节分级，超过kMaxBlock的请求直接使用全局operator new）
+     * @note allocate()同一时刻只能被一个线程调用；deallocate()线程安全
+    */
+    class BlockPool : private NonCopyAble
+    {
+        public:
+            static constexpr size_t kGranularity = 64;                      // 分级粒度（字节）
+            static constexpr size_t kClasses = 32;                          // 级数
+            static constexpr size_t kMaxBlock = kGranularity * kClasses;    // 池化的最大内存块（字节）
+            static constexpr size_t kMaxCached = 1024;                      // 每一级最多缓存的空闲内存块数量
+
+            /**
+             * @brief 创建内存池（创建者持有一个引用，用完后调用release()）
+            */
+            static BlockPool* create() { return new BlockPool(); }
+
+            /**
+             * @brief 释放创建者持有的引用
+            */
+            void release() noexcept { _unref(); }
+
+            /**
+             * @brief 分配内存块（仅限所属线程）
+             * @param size 字节数
+             * @return void* 内存块（对齐到alignof(std::max_align_t)）
+             * @throw std::bad_alloc 内存不足
+            */
+            void* allocate(size_t size)
+            {
+                if(size == 0 || size > kMaxBlock)
+                    return ::operator new(size);
+
+                SizeClass& sc = m_classes[_classOf(size)];
+                if(!sc.local)
+                    sc.local = sc.remote.exchange(nullptr, std::memory_order_acquire);
+
+                void* p;
+                if(sc.local)
+                {
+                    FreeBlock* block = sc.local;
+                    sc.local = block->next;
+                    sc.cached.fetch_sub(1, std::memory_order_relaxed);
+                    p = block;
+                }
+                else
+                    p = ::operator new(_blockSize(size));
+
+                m_refs.fetch_add(1, std::memory_order_relaxed);
+                return p;
+            }
+
+            /**
+             * @brief 归还内存块（线程安全）
+             * @param p allocate()返回的内存块
+             * @param size 分配时的字节数
+            */
+            void deallocate(void* p, size_t size) noexcept
+            {
+                if(size == 0 || size > kMaxBlock)
+                {
+                    ::operator delete(p);
+                    return;
+                }
+
+                SizeClass& sc = m_classes[_classOf(size)];
+                if(sc.cached.fetch_add(1, std::memory_order_relaxed) >= kMaxCached)
+                {
+                    sc.cached.fetch_sub(1, std::memory_order_relaxed);
+                    ::operator delete(p);
+                }
+                else
+                {
+                    FreeBlock* block = static_cast<FreeBlock*>(p);
+                    block->next = sc.remote.load(std::memory_order_relaxed);
+                    while(!sc.remote.compare_exchange_weak(block->next, block,
+                                std::memory_order_release, std::memory_order_relaxed))
+                        ;
+                }
+                _unref();
+            }
+
+            /**
+             * @brief 获取当前缓存的空闲内存块数量（各级之和，仅用于统计）
+            */
+            size_t cached() const noexcept
+            {
+                size_t n = 0;
+                for(const SizeClass& sc : m_classes)
+                    n += sc.cached.load(std::memory_order_relaxed);
+                return n;
+            }
+
+        private:
+            struct FreeBlock
+            {
+                FreeBlock* next;
+            };
+
+            struct SizeClass
+            {
+                FreeBlock* local = nullptr;                 // 所属线程独占的空闲链表
+                std::atomic<FreeBlock*> remote{nullptr};    // 归还的内存块（无锁栈，由所属线程整体取回）
+                std::atomic<size_t> cached{0};              // 两个链表中的空闲块总数
+            };
+
+            BlockPool() = default;
+
+            ~BlockPool()
+            {
+                for(SizeClass& sc : m_classes)
+                {
+                    _freeList(sc.local);
+                    _freeList(sc.remote.load(std::memory_order_acquire));
+                }
+            }
+
+            static size_t _classOf(size_t size) noexcept { return (size - 1) / kGranularity; }
+
+            static size_t _blockSize(size_t size) noexcept { return (_classOf(size) + 1) * kGranularity; }
+
+            static void _freeList(FreeBlock* block) noexcept
+            {
+                while(block)
+                {
+                    FreeBlock* next = block->next;
+                    ::operator delete(block);
+                    block = next;
+                }
+            }
+
+            void _unref() noexcept
+            {
+                if(m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    delete this;
+            }
+
+            SizeClass m_classes[kClasses];
+            std::atomic<long> m_refs{1};    // 创建者的引用 + 未归还的内存块数量
+    };
+
+    /**
+     * @class PoolAllocator
+     * @brief 从BlockPool分配内存的分配器，可用于std::allocate_shared（对象与控制块在同一个内存块中）
+     * @details pool为空时退化为全局operator new，便于在事件循环线程以外的地方使用同一份代码
+    */
+    template <typename T>
+    class PoolAllocator
+    {
+        public:
+            using value_type = T;
+
+            explicit PoolAllocator(BlockPool* pool) noexcept : m_pool(pool) {}
+
+            template <typename U>
+            PoolAllocator(const PoolAllocator<U>& other) noexcept : m_pool(other.getPool()) {}
+
+            T* allocate(size_t n)
+            {
+                static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+                size_t size = n * sizeof(T);
+                return static_cast<T*>(m_pool ? m_pool->allocate(size) : ::operator new(size));
+            }
+
+            void deallocate(T* p, size_t n) noexcept
+            {
+                if(m_pool)
+                    m_pool->deallocate(p, n * sizeof(T));
+                else
+                    ::operator delete(p);
+            }
+
+            BlockPool* getPool() const noexcept { return m_pool; }
+
+            template <typename U>
+            bool operator==(const PoolAllocator<U>& other) const noexcept { return m_pool == other.getPool(); }
+
+            template <typename U>
+            bool operator!=(const PoolAllocator<U>& other) const noexcept { return m_pool != other.getPool(); }
+
+        private:
+            BlockPool* m_pool;
+    };
+} // namespace handy
@@ -194,11 +194,13 @@ namespace handy
         int PollerEpoll::loopOnce(int waitTime_ms)
         {
             // 记录轮询开始时间
-            const int64_t  startTime_ms = utils::timeMilli();
+            const int64_t startTime_us = utils::steadyMicro();
 
             // 等待事件
             m_lastActive = epoll_wait(m_epollFd, m_activeEvs, kMaxEvents, waitTime_ms);
-            const int64_t usedTime_ms = utils::timeMilli() - startTime_ms;
+            m_lastWaitEnd_us = utils::steadyMicro();
+            m_lastWait_us = m_lastWaitEnd_us - startTime_us;
+            const int64_t usedTime_ms = m_lastWait_us / 1000;
 
             TRACE("poller.cpp::PollerEpoll::loopOnce(): PollerEpoll[%lld] epoll_wait, waitTime_ms=%d, m_lastActive=%d, usedTime_ms=%d",
                     static_cast<long long>(getId()), waitTime_ms, m_lastActive, usedTime_ms);
@@ -221,8 +223,8 @@ namespace handy
                 if(ch == nullptr)
                     continue; // 已被移除的Channel，跳过
 
-                // 处理读事件（包含错误事件POLLERR
-                if(ev.events & (kReadEvent | POLLERR))
+                // 处理读事件（包含错误事件POLLERR与挂断事件POLLHUP）
+                if(ev.events & (kReadEvent | POLLERR | POLLHUP))
                 {
                     TRACE("PollerEpoll::loopOnce(): PollerEpoll[%lld] handle read: Channel[%lld], fd=%d",
                             static_cast<long long>(getId()),
@@ -482,7 +484,9 @@ namespace handy
                 active_evs_, kMaxEvents,   // 活跃事件存储
                 (wait_ms < 0) ? nullptr : &timeout  // 超时参数
             );
-            const int64_t used_ms = utils::timeMilli() - start_ms;
+            m_lastWaitEnd_us = utils::steadyMicro();
+            m_lastWait_us = (utils::timeMilli() - start_ms) * 1000;
+            const int64_t used_ms = m_lastWait_us / 1000;
 
             // 日志：输出轮询结果
             trace("PollerKqueue[%lld] kevent: wait_ms=%d, return=%d, used_ms=%lld, errno=%d", 
@@ -70,10 +70,24 @@ namespace handy
             */
             int64_t getId() const noexcept { return m_id; }
 
+            /**
+             * @brief 获取最近一次轮询在系统调用中阻塞等待的时间
+             * @return int64_t 等待时间（微秒）
+            */
+            int64_t getLastWaitTime() const noexcept { return m_lastWait_us; }
+
+            /**
+             * @brief 获取最近一次轮询从系统调用返回的时刻
+             * @return int64_t 单调时钟时间戳（微秒，utils::steadyMicro()）
+            */
+            int64_t getLastWaitEnd() const noexcept { return m_lastWaitEnd_us; }
+
         protected:
             static std::atomic<int64_t> globalId;   // 静态原子变量，确保多线程环境下ID唯一递增
             const int64_t m_id;                 // 轮询器唯一标识符（构造时生成）
             int m_lastActive;                   // 最后一次活跃事件的索引（用于遍历）
+            int64_t m_lastWait_us = 0;          // 最近一次轮询的等待时间（微秒）
+            int64_t m_lastWaitEnd_us = 0;       // 最近一次轮询返回的时刻（微秒）
 
     };
 
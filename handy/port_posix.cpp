@@ -5,6 +5,8 @@
 #include <stdexcept>
 #include <netdb.h>
 #include <cstring>
+#include <cctype>
+#include <cstdlib>
 #include <sys/syscall.h>
 #include <unistd.h>
 #include <arpa/inet.h>
@@ -12,6 +14,10 @@
 #include "port_posix.h"
 #include <pthread.h>
 #include <current_os.h>
+#ifdef OS_LINUX
+#include <sched.h>
+#include <dirent.h>
+#endif
 
 namespace handy
 {
@@ -59,6 +65,86 @@ namespace handy
             {
                 return static_cast<uint64_t>(syscall(SYS_gettid));
             }
+
+            /**
+             * @brief 设置当前线程的名称（Linux版本）
+            */
+            bool setThreadName(const std::string& name)
+            {
+                // 内核限制线程名最长15个字符（不含结尾的'\0'）
+                return pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+            }
+
+            /**
+             * @brief 获取当前线程的名称（Linux版本）
+            */
+            std::string getThreadName()
+            {
+                char buf[16] = {0};
+                return pthread_getname_np(pthread_self(), buf, sizeof(buf)) == 0 ? buf : "";
+            }
+
+            /**
+             * @brief 将当前线程绑定到指定的CPU集合（Linux版本）
+            */
+            bool setThreadAffinity(const std::vector<int>& cpus)
+            {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                int count = 0;
+                for(int cpu : cpus)
+                {
+                    if(cpu >= 0 && cpu < CPU_SETSIZE)
+                    {
+                        CPU_SET(cpu, &set);
+                        ++count;
+                    }
+                }
+                // pid为0表示调用线程
+                return count > 0 && sched_setaffinity(0, sizeof(set), &set) == 0;
+            }
+
+            /**
+             * @brief 获取当前线程允许运行的CPU集合（Linux版本）
+            */
+            std::vector<int> getThreadAffinity()
+            {
+                std::vector<int> cpus;
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                if(sched_getaffinity(0, sizeof(set), &set) != 0)
+                    return cpus;
+                for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                {
+                    if(CPU_ISSET(cpu, &set))
+                        cpus.push_back(cpu);
+                }
+                return cpus;
+            }
+
+            /**
+             * @brief 获取CPU所在的NUMA节点（Linux版本）
+            */
+            int getNumaNode(int cpu)
+            {
+                // sysfs中CPU目录下的nodeN链接指向其所在的NUMA节点（非NUMA内核没有该链接）
+                std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+                DIR* dir = opendir(path.c_str());
+                if(!dir)
+                    return -1;
+
+                int node = -1;
+                while(struct dirent* ent = readdir(dir))
+                {
+                    if(strncmp(ent->d_name, "node", 4) == 0 && isdigit(static_cast<unsigned char>(ent->d_name[4])))
+                    {
+                        node = atoi(ent->d_name + 4);
+                        break;
+                    }
+                }
+                closedir(dir);
+                return node;
+            }
         #elif defined(OS_MACOSX)
             /**
              * @brief 线程安全的主机名解析实现（macOS版本）
@@ -96,6 +182,40 @@ namespace handy
                 pthread_threadid_np(NULL, &tid);
                 return tid;
             }
+
+            /**
+             * @brief 设置当前线程的名称（macOS版本）
+            */
+            bool setThreadName(const std::string& name)
+            {
+                // macOS只能设置调用线程自身的名称
+                return pthread_setname_np(name.c_str()) == 0;
+            }
+
+            /**
+             * @brief 获取当前线程的名称（macOS版本）
+            */
+            std::string getThreadName()
+            {
+                char buf[64] = {0};
+                return pthread_getname_np(pthread_self(), buf, sizeof(buf)) == 0 ? buf : "";
+            }
+
+            // macOS不支持将线程绑定到指定CPU，也没有NUMA节点信息
+            bool setThreadAffinity(const std::vector<int>&)
+            {
+                return false;
+            }
+
+            std::vector<int> getThreadAffinity()
+            {
+                return {};
+            }
+
+            int getNumaNode(int)
+            {
+                return -1;
+            }
         #else
         #error "Unsupported POSIX platform"
         #endif
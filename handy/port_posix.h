@@ -1,10 +1,11 @@
 /**
  * @file port_posix.h
- * @brief 跨平台端口工具函数，提供字节序转换、主机名解析和线程ID获取等功能
+ * @brief 跨平台端口工具函数，提供字节序转换、主机名解析、线程ID获取以及线程命名与CPU绑定等功能
 */
 #pragma once
 #include <netinet/in.h>
 #include <string>
+#include <vector>
 #include <cstdint>
 #include <endian.h>
 
@@ -173,6 +174,40 @@ namespace handy
         */
         uint64_t getCurrentThreadId();
 
+        /**
+         * @brief 设置当前线程的名称
+         * @param name 线程名（Linux下最多15个字符，超出部分被截断）
+         * @return 成功返回true，失败返回false
+         * @details 线程名会出现在top -H、perf、gdb等工具中，便于区分事件循环线程与工作线程
+        */
+        bool setThreadName(const std::string& name);
+
+        /**
+         * @brief 获取当前线程的名称
+         * @return 线程名（获取失败时返回空字符串）
+        */
+        std::string getThreadName();
+
+        /**
+         * @brief 将当前线程绑定到指定的CPU集合
+         * @param cpus CPU编号列表（为空或全部越界时不做修改）
+         * @return 成功返回true；失败或平台不支持（macOS）时返回false
+        */
+        bool setThreadAffinity(const std::vector<int>& cpus);
+
+        /**
+         * @brief 获取当前线程允许运行的CPU集合
+         * @return CPU编号列表（升序；平台不支持时为空）
+        */
+        std::vector<int> getThreadAffinity();
+
+        /**
+         * @brief 获取CPU所在的NUMA节点
+         * @param cpu CPU编号
+         * @return NUMA节点编号（非NUMA系统或无法获取时返回-1）
+        */
+        int getNumaNode(int cpu);
+
         /**
          * @brief 将Ipv4地址转换为字符串显示
          * @param addr 指向IPv4地址结构的指针
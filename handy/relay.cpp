@@ -0,0 +1,405 @@
+#include "relay.h"
+#include "logger.h"
+#include "metrics.h"
+#include "current_os.h"
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace handy
+{
+    namespace
+    {
+        // 中继的进程级指标（注册到默认注册表，由StatServer导出）
+        struct RelayMetrics
+        {
+            Counter& bytes;         // 转发的字节数
+            Counter& started;       // 累计建立的中继数
+            Gauge& sessions;        // 当前正在转发的中继数
+        };
+
+        RelayMetrics& relayMetrics()
+        {
+            static RelayMetrics metrics{
+                MetricsRegistry::instance().counter("handy_relay_forwarded_bytes_total", "Bytes forwarded by TCP relays"),
+                MetricsRegistry::instance().counter("handy_relay_sessions_total", "TCP relays started"),
+                MetricsRegistry::instance().gauge("handy_relay_sessions", "TCP relays currently forwarding"),
+            };
+            return metrics;
+        }
+
+        // 非Linux平台上代替管道的缓冲区容量
+        constexpr size_t kDefaultRelayBuffer = 64 * 1024;
+
+        void closePipe(int (&p)[2])
+        {
+            for(int& fd : p)
+            {
+                if(fd >= 0)
+                    ::close(fd);
+                fd = -1;
+            }
+        }
+    } // namespace
+
+    TcpRelay::TcpRelay() :
+        m_base(nullptr),
+        m_pipeSize(0),
+        m_highWater(0),
+        m_lowWater(0),
+        m_closed(false) {}
+
+    TcpRelay::~TcpRelay()
+    {
+        for(Direction& d : m_dirs)
+            closePipe(d.pipe);
+    }
+
+    TcpRelay::Ptr TcpRelay::create(const TcpConnPtr& first, const TcpConnPtr& second, size_t pipeSize)
+    {
+        if(!first || !second || first == second)
+        {
+            ERROR("TcpRelay needs two distinct connections");
+            return nullptr;
+        }
+
+        EventBase* base = first->getBase();
+        if(!base || base != second->getBase())
+        {
+            ERROR("TcpRelay connections must belong to the same EventBase: %s, %s",
+                    first->getPeerStr().c_str(), second->getPeerStr().c_str());
+            return nullptr;
+        }
+        if(!base->isInLoopThread())
+        {
+            ERROR("TcpRelay::create must be called in the event loop thread");
+            return nullptr;
+        }
+        if(first->getState() != TcpConn::State::CONNECTED || !first->getChannel() ||
+            second->getState() != TcpConn::State::CONNECTED || !second->getChannel())
+        {
+            ERROR("TcpRelay connections must be connected: %s state %d, %s state %d",
+                    first->getPeerStr().c_str(), static_cast<int>(first->getState()),
+                    second->getPeerStr().c_str(), static_cast<int>(second->getState()));
+            return nullptr;
+        }
+
+        Ptr relay(new TcpRelay());
+        relay->m_base = base;
+        relay->m_dirs[0].src = first;
+        relay->m_dirs[0].dst = second;
+        relay->m_dirs[1].src = second;
+        relay->m_dirs[1].dst = first;
+        if(!relay->_initPipes(pipeSize))
+            return nullptr;
+
+        relay->_start();
+        return relay;
+    }
+
+    bool TcpRelay::_initPipes(size_t pipeSize)
+    {
+#ifdef OS_LINUX
+        for(Direction& d : m_dirs)
+        {
+            if(pipe2(d.pipe, O_NONBLOCK | O_CLOEXEC) != 0)
+            {
+                ERROR("TcpRelay pipe creation failed: errno=%d, msg=%s", errno, strerror(errno));
+                return false;
+            }
+            if(pipeSize > 0 && fcntl(d.pipe[1], F_SETPIPE_SZ, static_cast<int>(pipeSize)) < 0)
+                WARN("Failed to set relay pipe size to %zu: errno=%d, msg=%s, using default",
+                        pipeSize, errno, strerror(errno));
+            int size = fcntl(d.pipe[1], F_GETPIPE_SZ);
+            // 两个管道容量不同时按较小的计算
+            if(size > 0 && (m_pipeSize == 0 || static_cast<size_t>(size) < m_pipeSize))
+                m_pipeSize = static_cast<size_t>(size);
+        }
+#endif
+        if(m_pipeSize == 0)
+            m_pipeSize = pipeSize > 0 ? pipeSize : kDefaultRelayBuffer;
+        m_highWater = m_pipeSize;
+        m_lowWater = m_pipeSize / 2;
+        return true;
+    }
+
+    void TcpRelay::setWaterMarks(size_t high, size_t low)
+    {
+        m_highWater = (high == 0 || high > m_pipeSize) ? m_pipeSize : high;
+        m_lowWater = low < m_highWater ? low : m_highWater;
+    }
+
+    void TcpRelay::_start()
+    {
+        relayMetrics().started.add();
+        relayMetrics().sessions.add(1);
+
+        Ptr self = shared_from_this();
+        for(int i = 0; i < 2; ++i)
+        {
+            Direction& d = m_dirs[i];
+            // 中继自己做流量控制，连接原有的水位与上限不再适用
+            d.src->setWaterMarks(0, 0);
+            d.src->setOutputLimit(0);
+
+            // 源连接已读到但尚未处理的数据排在目标连接的输出缓冲区之后发出
+            size_t buffered = d.src->getInputBuffer().size();
+            if(buffered > 0)
+            {
+                d.dst->getOutputBuffer().absorb(d.src->getInputBuffer());
+                d.bytes.fetch_add(static_cast<int64_t>(buffered), std::memory_order_relaxed);
+                relayMetrics().bytes.add(static_cast<int64_t>(buffered));
+            }
+
+            // 先复制一份智能指针：结束中继时Channel（连同这里的lambda）会被释放
+            Channel* ch = d.src->getChannel();
+            ch->onRead([self, i]{ Ptr r = self; r->_handleRead(i); });
+            ch->onWrite([self, i]{ Ptr r = self; r->_drain(r->m_dirs[1 - i]); });
+            ch->enableRead(true);
+        }
+
+        TRACE("TcpRelay started: %s <-> %s, pipe size %zu",
+                m_dirs[0].src->getPeerStr().c_str(), m_dirs[1].src->getPeerStr().c_str(), m_pipeSize);
+
+        for(Direction& d : m_dirs)
+        {
+            if(!_drain(d))
+                return;
+        }
+    }
+
+    void TcpRelay::_handleRead(int i)
+    {
+        if(isClosed())
+            return;
+
+        Direction& d = m_dirs[i];
+        Direction& back = m_dirs[1 - i];    // 发往该连接的方向
+        Channel* ch = d.src->getChannel();
+        if(!ch || ch->getFd() < 0)
+        {
+            // 两个方向都已结束的连接由中继提前关闭，不影响另一个连接上的转发；
+            // 否则是连接被外部关闭（Channel::close()会回调到这里）
+            if(!(d.eof && back.shut))
+                _finish();
+            return;
+        }
+
+        // Poller同时报告可读与可写时只派发读事件，这里顺带处理可写，避免反方向的转发被饿死
+        if(ch->isWritable() && !_drain(back))
+            return;
+
+        // 已读到EOF（读事件已关闭）仍被调用：连接上报了POLLHUP/POLLERR
+        if(d.eof)
+        {
+            // 该连接的两个方向都已结束：提前关闭它，避免挂断事件反复触发
+            if(back.shut)
+            {
+                TcpConnPtr conn = d.src;
+                conn->cleanup(conn);
+            }
+            // 没有待发给它的数据时，对端已不可用，结束中继；有待发数据时由写入暴露错误
+            else if(!ch->isWritable())
+                _finish();
+            return;
+        }
+
+        while(!d.eof)
+        {
+            // 积压达到高水位：暂停读取，目标连接取走数据后在_drain()中恢复
+            if(d.pending >= m_highWater)
+            {
+                ch->enableRead(false);
+                d.paused = true;
+                break;
+            }
+
+            ssize_t n = _fill(d, m_highWater - d.pending);
+            if(n > 0)
+            {
+                d.pending += n;
+                d.bytes.fetch_add(n, std::memory_order_relaxed);
+                relayMetrics().bytes.add(n);
+                if(!_drain(d))
+                    return;
+            }
+            else if(n < 0 && errno == EINTR)
+                continue;
+            else if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                // 管道按页占用槽位，积压字节数未到高水位时管道也可能已满（splice同样返回EAGAIN），
+                // 此时socket仍然可读，继续监听会空转，因此同样暂停读取
+                if(d.pending > 0)
+                {
+                    ch->enableRead(false);
+                    d.paused = true;
+                }
+                break;
+            }
+            // 读到EOF：停止读取，积压的数据发完后在_drain()中关闭目标连接的写端
+            else if(n == 0)
+            {
+                TRACE("TcpRelay half-close: %s -> %s", d.src->getPeerStr().c_str(), d.dst->getPeerStr().c_str());
+                d.eof = true;
+                ch->enableRead(false);
+                if(!_drain(d))
+                    return;
+            }
+            else
+            {
+                WARN("TcpRelay read from %s failed: errno=%d, msg=%s",
+                        d.src->getPeerStr().c_str(), errno, strerror(errno));
+                _finish();
+                return;
+            }
+        }
+
+        d.src->_touchIdle();
+    }
+
+    bool TcpRelay::_drain(Direction& d)
+    {
+        if(isClosed())
+            return false;
+
+        Channel* ch = d.dst->getChannel();
+        if(!ch || ch->getFd() < 0)
+        {
+            _finish();
+            return false;
+        }
+
+        // 目标连接的输出缓冲区中还有建立中继前的数据，需先于管道中的数据发出
+        Buffer& out = d.dst->getOutputBuffer();
+        if(!out.empty())
+        {
+            out.consume(d.dst->_send(out.begin(), out.size()));
+            d.dst->_updateOutput();
+            // _send()遇到EAGAIN时会开启写事件，没有开启说明写入出错
+            if(!out.empty() && !ch->isWritable())
+            {
+                _finish();
+                return false;
+            }
+        }
+
+        while(out.empty() && d.pending > 0)
+        {
+            ssize_t n = _flush(d);
+            if(n > 0)
+                d.pending -= n;
+            else if(n < 0 && errno == EINTR)
+                continue;
+            else if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                if(!ch->isWritable())
+                    ch->enableWrite(true);
+                break;
+            }
+            else
+            {
+                WARN("TcpRelay write to %s failed: errno=%d, msg=%s",
+                        d.dst->getPeerStr().c_str(), errno, strerror(errno));
+                _finish();
+                return false;
+            }
+        }
+
+        bool drained = out.empty() && d.pending == 0;
+        if(drained && ch->isWritable())
+            ch->enableWrite(false);
+
+        // 积压回落到低水位：恢复读取源连接
+        if(d.paused && d.pending <= m_lowWater)
+        {
+            d.paused = false;
+            Channel* srcCh = d.src->getChannel();
+            if(!d.eof && srcCh)
+                srcCh->enableRead(true);
+        }
+
+        // 源连接已读到EOF且数据已全部发出：关闭目标连接的写端
+        if(drained && d.eof && !d.shut)
+        {
+            d.shut = true;
+            ::shutdown(ch->getFd(), SHUT_WR);
+            _checkDone();
+            return !isClosed();
+        }
+        return true;
+    }
+
+    ssize_t TcpRelay::_fill(Direction& d, size_t len)
+    {
+        int fd = d.src->getChannel()->getFd();
+#ifdef OS_LINUX
+        return splice(fd, nullptr, d.pipe[1], nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+#else
+        char* p = d.buf.makeRoom(len);
+        ssize_t n = ::read(fd, p, len);
+        if(n > 0)
+            d.buf.addSize(n);
+        return n;
+#endif
+    }
+
+    ssize_t TcpRelay::_flush(Direction& d)
+    {
+        int fd = d.dst->getChannel()->getFd();
+#ifdef OS_LINUX
+        return splice(d.pipe[0], nullptr, fd, nullptr, d.pending, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+#else
+        ssize_t n = ::write(fd, d.buf.peek(), d.buf.size());
+        if(n > 0)
+            d.buf.consume(n);
+        return n;
+#endif
+    }
+
+    void TcpRelay::_checkDone()
+    {
+        if(m_dirs[0].shut && m_dirs[1].shut)
+            _finish();
+    }
+
+    void TcpRelay::close()
+    {
+        Ptr self = shared_from_this();
+        m_base->safeCall([self]() { self->_finish(); });
+    }
+
+    void TcpRelay::_finish()
+    {
+        if(m_closed.exchange(true, std::memory_order_acq_rel))
+            return;
+
+        // 清理连接会释放Channel中的lambda（其中持有中继的引用），先持有一份
+        Ptr self = shared_from_this();
+        relayMetrics().sessions.add(-1);
+        TRACE("TcpRelay finished: %s <-> %s, %lld bytes forward, %lld bytes backward",
+                m_dirs[0].src->getPeerStr().c_str(), m_dirs[1].src->getPeerStr().c_str(),
+                (long long)getForwardBytes(), (long long)getBackwardBytes());
+
+        for(Direction& d : m_dirs)
+        {
+            closePipe(d.pipe);
+            d.buf.clear();
+            d.pending = 0;
+        }
+
+        for(Direction& d : m_dirs)
+        {
+            TcpConnPtr conn = d.src;
+            if(conn->getChannel())
+                conn->cleanup(conn);
+        }
+
+        if(m_closeCB)
+        {
+            RelayCallBack cb = std::move(m_closeCB);
+            m_closeCB = nullptr;
+            cb(self);
+        }
+    }
+}   // namespace handy
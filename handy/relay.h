@@ -0,0 +1,186 @@
+/**
+ * @file relay.h
+ * @brief TCP中继（代理转发）组件，在两个TcpConn之间双向转发数据
+*/
+#pragma once
+#include "conn.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace handy
+{
+    /**
+     * @class TcpRelay
+     * @brief 在两个已连接的TcpConn之间双向转发字节流
+     * @details 1. Linux下每个方向使用一个管道，数据经splice()从源socket移入管道、再从管道移入目标socket，
+     *             不经过用户态缓冲区；其他平台退化为read()/write()经由一块缓冲区转发
+     *          2. 管道（或缓冲区）即输出队列：积压达到高水位时暂停读取源连接，回落到低水位后恢复，
+     *             慢速的一方由此通过TCP流量控制把速度传导给另一方
+     *          3. 支持半关闭：一个方向读到EOF后，待该方向积压的数据发完再shutdown(SHUT_WR)目标连接，
+     *             另一个方向继续转发；两个方向都结束或任一方出错时关闭两个连接
+     * @note 1. 两个连接需属于同一个事件循环，且处于CONNECTED状态；create()需在该事件循环线程中调用
+     * @note 2. 中继接管两个连接的读写事件：之后不应再对它们调用send()，读回调也不再触发；
+     *          连接原有的水位与输出上限设置被清除，状态回调照常在关闭时触发
+     * @note 3. 连接的输入缓冲区中已读到的数据、输出缓冲区中尚未发出的数据会先于后续数据转发
+     * @note 4. TcpConn读到EOF会关闭整个连接：向上游发起连接期间，可先暂停读取已接受的连接
+     *          （getChannel()->enableRead(false)），避免客户端先半关闭导致连接在中继接管前被关闭；
+     *          create()会恢复两个连接的读事件
+     * @note 5. 不适用于重写了读写实现（_readImp/_writeImp）的连接类型，如SSL连接
+    */
+    class TcpRelay : public std::enable_shared_from_this<TcpRelay>, private NonCopyAble
+    {
+        public:
+            using Ptr = std::shared_ptr<TcpRelay>;                  // TcpRelay智能指针类型定义
+            using RelayCallBack = std::function<void(const Ptr&)>;  // 中继结束时的回调函数类型定义
+
+            /**
+             * @brief 在两个连接之间建立中继并立即开始转发
+             * @param first 第一个连接（通常是服务端接受的连接）
+             * @param second 第二个连接（通常是向上游发起的客户端连接）
+             * @param pipeSize 每个方向的管道容量（字节，0表示使用系统默认值，通常为64KB）；
+             *                 超过/proc/sys/fs/pipe-max-size时设置失败，记录告警后使用默认容量
+             * @return Ptr 中继对象的智能指针，nullptr表示参数不满足要求或创建管道失败
+            */
+            static Ptr create(const TcpConnPtr& first, const TcpConnPtr& second, size_t pipeSize = 0);
+
+            /**
+             * @brief 析构函数，关闭管道
+            */
+            ~TcpRelay();
+
+            /**
+             * @brief 设置两个方向积压数据的高、低水位（需在事件循环线程中调用）
+             * @param high 高水位（字节，不超过管道容量；0表示使用管道容量）
+             * @param low 低水位（字节，应小于high）
+             * @note 默认高水位为管道容量，低水位为其一半
+            */
+            void setWaterMarks(size_t high, size_t low);
+
+            /**
+             * @brief 设置中继结束（两个连接均已关闭）时的回调函数
+             * @param cb 回调函数
+             * @note 需在事件循环线程中设置
+            */
+            void onClose(const RelayCallBack& cb) { m_closeCB = cb; }
+
+            /**
+             * @brief 关闭中继与两个连接（线程安全，总是通过safeCall()在事件循环线程中处理）
+            */
+            void close();
+
+            /**
+             * @brief 获取第一个连接
+             * @return const TcpConnPtr& 连接的智能指针
+            */
+            const TcpConnPtr& getFirst() const { return m_dirs[0].src; }
+
+            /**
+             * @brief 获取第二个连接
+             * @return const TcpConnPtr& 连接的智能指针
+            */
+            const TcpConnPtr& getSecond() const { return m_dirs[1].src; }
+
+            /**
+             * @brief 获取从第一个连接转发到第二个连接的字节数（线程安全）
+             * @return int64_t 字节数
+            */
+            int64_t getForwardBytes() const { return m_dirs[0].bytes.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief 获取从第二个连接转发到第一个连接的字节数（线程安全）
+             * @return int64_t 字节数
+            */
+            int64_t getBackwardBytes() const { return m_dirs[1].bytes.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief 判断中继是否已经结束（线程安全）
+             * @return bool true：已结束，false：正在转发
+            */
+            bool isClosed() const { return m_closed.load(std::memory_order_acquire); }
+
+            /**
+             * @brief 获取管道容量（每个方向）
+             * @return size_t 管道容量（字节）
+            */
+            size_t getPipeSize() const { return m_pipeSize; }
+
+        private:
+            // 一个转发方向：src -> 管道 -> dst
+            struct Direction
+            {
+                TcpConnPtr src;                 // 源连接
+                TcpConnPtr dst;                 // 目标连接
+                int pipe[2] = {-1, -1};         // 管道（[0]读端，[1]写端；非Linux平台不使用）
+                Buffer buf;                     // 积压的数据（非Linux平台代替管道）
+                size_t pending = 0;             // 管道中积压的字节数
+                bool paused = false;            // 因达到高水位而暂停读取源连接
+                bool eof = false;               // 源连接已读到EOF
+                bool shut = false;              // 已对目标连接执行shutdown(SHUT_WR)
+                std::atomic<int64_t> bytes{0};  // 已转发的字节数
+            };
+
+            Direction m_dirs[2];                // [0]：first -> second，[1]：second -> first
+            EventBase* m_base;                  // 两个连接所属的事件循环
+            size_t m_pipeSize;                  // 管道容量
+            size_t m_highWater;                 // 积压数据的高水位
+            size_t m_lowWater;                  // 积压数据的低水位
+            std::atomic<bool> m_closed;         // 中继已结束
+            RelayCallBack m_closeCB;            // 中继结束时的回调函数
+
+            /**
+             * @brief 构造函数（通过create()创建）
+            */
+            TcpRelay();
+
+            /**
+             * @brief 创建各方向的管道并设置容量
+             * @param pipeSize 期望的管道容量（0表示使用系统默认值）
+             * @return bool true：成功，false：创建管道失败
+            */
+            bool _initPipes(size_t pipeSize);
+
+            /**
+             * @brief 接管两个连接的读写事件，转发连接中已缓冲的数据
+            */
+            void _start();
+
+            /**
+             * @brief 处理连接的可读事件：把数据移入管道，再尽量发往另一个连接
+             * @param i 连接下标（0：first，1：second），即以该连接为源的转发方向
+            */
+            void _handleRead(int i);
+
+            /**
+             * @brief 把积压的数据发往目标连接（目标连接可写时也会调用）
+             * @param d 转发方向
+             * @return bool true：正常，false：出错，中继已结束
+            */
+            bool _drain(Direction& d);
+
+            /**
+             * @brief 从源连接读取数据到管道
+             * @param d 转发方向
+             * @param len 最多读取的字节数
+             * @return ssize_t 读取的字节数，0表示EOF，-1表示出错（errno指明原因）
+            */
+            ssize_t _fill(Direction& d, size_t len);
+
+            /**
+             * @brief 把管道中的数据写入目标连接
+             * @param d 转发方向
+             * @return ssize_t 写入的字节数，-1表示出错（errno指明原因）
+            */
+            ssize_t _flush(Direction& d);
+
+            /**
+             * @brief 检查两个方向是否都已结束
+            */
+            void _checkDone();
+
+            /**
+             * @brief 结束中继：关闭管道与两个连接，触发结束回调
+            */
+            void _finish();
+    };
+}   // namespace handy
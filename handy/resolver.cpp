@@ -0,0 +1,211 @@
+#include "resolver.h"
+#include "logger.h"
+#include "metrics.h"
+#include "thread_pool.h"
+#include "utils.h"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <string.h>
+
+namespace handy
+{
+    namespace
+    {
+        // 解析器的进程级指标（注册到默认注册表，由StatServer导出）
+        struct ResolverMetrics
+        {
+            Counter& lookups;       // 交给解析线程执行的查询数
+            Counter& cacheHits;     // 命中缓存的请求数
+            Counter& failures;      // 失败的查询数
+        };
+
+        ResolverMetrics& resolverMetrics()
+        {
+            static ResolverMetrics metrics{
+                MetricsRegistry::instance().counter("handy_resolver_lookups_total", "Host name lookups run on resolver threads"),
+                MetricsRegistry::instance().counter("handy_resolver_cache_hits_total", "Host name requests answered from the cache"),
+                MetricsRegistry::instance().counter("handy_resolver_failures_total", "Host name lookups that failed"),
+            };
+            return metrics;
+        }
+
+        // 缓存项超过该数量时清除过期项
+        constexpr size_t kPurgeThreshold = 1024;
+
+        bool defaultLookup(const std::string& host, struct in_addr& addr)
+        {
+            struct addrinfo hints;
+            memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_STREAM;
+
+            struct addrinfo* res = nullptr;
+            int r = getaddrinfo(host.c_str(), nullptr, &hints, &res);
+            if(r != 0 || !res)
+            {
+                WARN("Resolve %s failed: %s", host.c_str(), gai_strerror(r));
+                return false;
+            }
+
+            addr = reinterpret_cast<struct sockaddr_in*>(res->ai_addr)->sin_addr;
+            freeaddrinfo(res);
+            return true;
+        }
+    } // namespace
+
+    Resolver& Resolver::instance()
+    {
+        // 有意不析构：退出时可能仍有解析线程阻塞在查询中，不应让进程等待它们
+        static Resolver* resolver = new Resolver();
+        return *resolver;
+    }
+
+    Resolver::Resolver(int threads) :
+        m_ttl_s(60),
+        m_negativeTtl_s(5),
+        m_threads(threads > 0 ? threads : 1) {}
+
+    // m_pool最后声明、最先析构：ThreadPool析构时等待解析线程退出，其余成员此时仍然有效
+    Resolver::~Resolver() = default;
+
+    void Resolver::resolve(EventBase* base, const std::string& host, ResolveCallBack cb)
+    {
+        struct in_addr addr;
+        memset(&addr, 0, sizeof(addr));
+        bool ok = false;
+        bool answered = false;
+
+        if(inet_pton(AF_INET, host.c_str(), &addr) == 1)
+        {
+            ok = true;
+            answered = true;
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_cache.find(host);
+            if(it != m_cache.end() && it->second.expire_ms > utils::timeMilli())
+            {
+                addr = it->second.addr;
+                ok = it->second.ok;
+                answered = true;
+                resolverMetrics().cacheHits.add();
+            }
+            else
+            {
+                // 已有相同名字的查询在执行：等待它的结果
+                std::vector<Waiter>& waiters = m_pending[host];
+                waiters.push_back(Waiter{base->getHandle(), std::move(cb)});
+                if(waiters.size() > 1)
+                    return;
+
+                if(!m_pool)
+                {
+                    m_pool.reset(new ThreadPool(m_threads, 0, false));
+                    m_pool->setThreadName("handy-dns").start();
+                }
+                resolverMetrics().lookups.add();
+                m_pool->addTask([this, host]{ _lookup(host); });
+            }
+        }
+
+        if(answered)
+            base->safeCall([cb = std::move(cb), ok, addr]{ cb(ok, addr); });
+    }
+
+    bool Resolver::lookupCached(const std::string& host, struct in_addr& addr)
+    {
+        if(inet_pton(AF_INET, host.c_str(), &addr) == 1)
+            return true;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_cache.find(host);
+        if(it == m_cache.end() || !it->second.ok || it->second.expire_ms <= utils::timeMilli())
+            return false;
+        addr = it->second.addr;
+        resolverMetrics().cacheHits.add();
+        return true;
+    }
+
+    void Resolver::setTtl(int ttl_s, int negativeTtl_s)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ttl_s = ttl_s;
+        m_negativeTtl_s = negativeTtl_s;
+    }
+
+    void Resolver::setLookup(LookupFunc func)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lookup = std::move(func);
+    }
+
+    void Resolver::clearCache()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cache.clear();
+    }
+
+    void Resolver::_lookup(const std::string& host)
+    {
+        LookupFunc func;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            func = m_lookup;
+        }
+
+        struct in_addr addr;
+        memset(&addr, 0, sizeof(addr));
+        int ttl_s = -1;
+        bool ok = false;
+        try
+        {
+            ok = func ? func(host, addr, ttl_s) : defaultLookup(host, addr);
+        }
+        catch(const std::exception& e)
+        {
+            ERROR("Resolve %s failed: lookup threw %s", host.c_str(), e.what());
+            ok = false;
+        }
+        if(!ok)
+            resolverMetrics().failures.add();
+
+        std::vector<Waiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            int64_t now_ms = utils::timeMilli();
+            int ttl = ok ? (ttl_s >= 0 ? ttl_s : m_ttl_s) : m_negativeTtl_s;
+            if(ttl > 0)
+            {
+                if(m_cache.size() >= kPurgeThreshold)
+                    _purgeExpired(now_ms);
+                m_cache[host] = Entry{addr, ok, now_ms + static_cast<int64_t>(ttl) * 1000};
+            }
+
+            auto it = m_pending.find(host);
+            if(it != m_pending.end())
+            {
+                waiters.swap(it->second);
+                m_pending.erase(it);
+            }
+        }
+
+        // 阻塞查询期间事件循环可能已经析构：通过句柄投递，失效时丢弃回调
+        for(Waiter& w : waiters)
+        {
+            if(!w.base->safeCall([cb = std::move(w.cb), ok, addr]{ cb(ok, addr); }))
+                TRACE("Resolve %s finished after its event loop was destroyed, callback dropped", host.c_str());
+        }
+    }
+
+    void Resolver::_purgeExpired(int64_t now_ms)
+    {
+        for(auto it = m_cache.begin(); it != m_cache.end();)
+        {
+            if(it->second.expire_ms <= now_ms)
+                it = m_cache.erase(it);
+            else
+                ++it;
+        }
+    }
+}   // namespace handy
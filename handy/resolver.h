@@ -0,0 +1,132 @@
+/**
+ * @file resolver.h
+ * @brief 异步域名解析器：阻塞的名字查询在解析线程池中执行，结果通过safeCall交回事件循环，并按TTL缓存
+*/
+#pragma once
+#include "event_base.h"
+#include <netinet/in.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace handy
+{
+    class ThreadPool;
+
+    /**
+     * @class Resolver
+     * @brief 不阻塞事件循环的IPv4域名解析器
+     * @details 1. IP地址字面量与未过期的缓存结果直接返回，其余查询交给解析线程池（默认使用getaddrinfo），
+     *             完成后通过safeCall()在发起查询的事件循环线程中回调
+     *          2. 缓存在进程内所有事件循环之间共享：成功结果按查询函数给出的TTL（未给出时使用默认TTL）保存，
+     *             失败结果按较短的失败TTL保存，避免不可解析的名字反复占用解析线程
+     *          3. 同一名字同时只有一个查询在执行，其余请求等待该查询的结果
+     * @note 1. 回调总是在事件循环线程中异步执行（即使结果已在缓存中）；查询结束前事件循环已析构时，
+     *          回调不再执行，直接在解析线程中析构
+     * @note 2. 解析线程在第一次需要查询时才创建
+    */
+    class Resolver : private NonCopyAble
+    {
+        public:
+            using ResolveCallBack = std::function<void(bool ok, const struct in_addr& addr)>;  // 解析完成的回调函数类型定义
+            /**
+             * @brief 名字查询函数类型定义（在解析线程中调用，可以阻塞）
+             * @param host 主机名
+             * @param addr 输出解析得到的IPv4地址
+             * @param ttl_s 输出结果的有效期（秒），保持为-1表示使用默认TTL
+             * @return bool true：解析成功，false：解析失败
+            */
+            using LookupFunc = std::function<bool(const std::string& host, struct in_addr& addr, int& ttl_s)>;
+
+            /**
+             * @brief 获取进程级的默认解析器（TcpConn::createConnection使用）
+            */
+            static Resolver& instance();
+
+            /**
+             * @brief 构造函数
+             * @param threads 解析线程数（至少为1）
+            */
+            explicit Resolver(int threads = 2);
+
+            /**
+             * @brief 析构函数，等待正在执行的查询结束
+            */
+            ~Resolver();
+
+            /**
+             * @brief 异步解析主机名
+             * @param base 执行回调的事件循环
+             * @param host 主机名或IPv4地址字面量
+             * @param cb 解析完成的回调函数，在base的事件循环线程中执行
+             * @note 线程安全，可在任意线程中调用
+            */
+            void resolve(EventBase* base, const std::string& host, ResolveCallBack cb);
+
+            /**
+             * @brief 不阻塞地获取已知的地址：IPv4地址字面量或未过期的成功缓存
+             * @param host 主机名或IPv4地址字面量
+             * @param addr 输出地址
+             * @return bool true：已得到地址，false：需要调用resolve()查询（或缓存了失败结果）
+            */
+            bool lookupCached(const std::string& host, struct in_addr& addr);
+
+            /**
+             * @brief 设置缓存的有效期
+             * @param ttl_s 查询函数未给出TTL时成功结果的有效期（秒，默认60；0表示不缓存）
+             * @param negativeTtl_s 失败结果的有效期（秒，默认5；0表示不缓存）
+            */
+            void setTtl(int ttl_s, int negativeTtl_s);
+
+            /**
+             * @brief 替换名字查询函数（如接入自己的DNS客户端，或在测试中模拟慢速/失败的解析）
+             * @param func 查询函数，nullptr表示恢复默认的getaddrinfo()
+            */
+            void setLookup(LookupFunc func);
+
+            /**
+             * @brief 清空缓存（不影响正在执行的查询）
+            */
+            void clearCache();
+
+        private:
+            // 缓存项
+            struct Entry
+            {
+                struct in_addr addr;        // 解析得到的地址
+                bool ok;                    // 是否解析成功
+                int64_t expire_ms;          // 过期时间
+            };
+
+            // 等待查询结果的请求
+            struct Waiter
+            {
+                std::shared_ptr<BaseHandle> base;   // 执行回调的事件循环（查询期间可能析构）
+                ResolveCallBack cb;                 // 回调函数
+            };
+
+            std::mutex m_mutex;                                             // 保护以下成员
+            std::unordered_map<std::string, Entry> m_cache;                 // 查询结果缓存
+            std::unordered_map<std::string, std::vector<Waiter>> m_pending; // 正在查询的名字及等待者
+            LookupFunc m_lookup;                                            // 名字查询函数（空表示getaddrinfo）
+            int m_ttl_s;                                                    // 默认TTL
+            int m_negativeTtl_s;                                            // 失败结果的TTL
+            int m_threads;                                                  // 解析线程数
+            std::unique_ptr<ThreadPool> m_pool;                             // 解析线程池（按需创建）
+
+            /**
+             * @brief 在解析线程中查询名字，写入缓存并回调所有等待者
+             * @param host 主机名
+            */
+            void _lookup(const std::string& host);
+
+            /**
+             * @brief 清除过期的缓存项（需持有m_mutex）
+             * @param now_ms 当前时间
+            */
+            void _purgeExpired(int64_t now_ms);
+    };
+}   // namespace handy
@@ -0,0 +1,467 @@
+#include "slice.h"
+#include <atomic>
+#include <cstdint>
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HANDY_SLICE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace handy
+{
+namespace simd
+{
+    namespace
+    {
+        // 各指令集的实现
+        struct Kernels
+        {
+            Level level;
+            const char* (*findSubstr)(const char*, const char*, const char*, size_t);
+            const char* (*findFirstOf)(const char*, const char*, const char*, size_t);
+            const char* (*skipSpace)(const char*, const char*);
+            const char* (*findSpace)(const char*, const char*);
+            const char* (*rskipSpace)(const char*, const char*);
+            const char* (*findLineEnd)(const char*, const char*);
+            bool (*equalsNoCase)(const char*, const char*, size_t);
+        };
+
+        inline char asciiLower(char c)
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+        }
+
+        // -------------------------- 标量实现（参照版本） --------------------------
+        const char* scalarFindSubstr(const char* b, const char* e, const char* needle, size_t n)
+        {
+            if(n == 0)
+                return b;
+            if(static_cast<size_t>(e - b) < n)
+                return e;
+            const char* last = e - n;
+            for(const char* p = b; p <= last; ++p)
+            {
+                p = static_cast<const char*>(memchr(p, needle[0], static_cast<size_t>(last - p) + 1));
+                if(!p)
+                    return e;
+                if(memcmp(p + 1, needle + 1, n - 1) == 0)
+                    return p;
+            }
+            return e;
+        }
+
+        const char* scalarFindFirstOf(const char* b, const char* e, const char* set, size_t n)
+        {
+            // 256位的字符集合
+            uint64_t bits[4] = {0, 0, 0, 0};
+            for(size_t i = 0; i < n; ++i)
+            {
+                const unsigned char c = static_cast<unsigned char>(set[i]);
+                bits[c >> 6] |= uint64_t(1) << (c & 63);
+            }
+            for(const char* p = b; p < e; ++p)
+            {
+                const unsigned char c = static_cast<unsigned char>(*p);
+                if(bits[c >> 6] & (uint64_t(1) << (c & 63)))
+                    return p;
+            }
+            return e;
+        }
+
+        const char* scalarSkipSpace(const char* b, const char* e)
+        {
+            while(b < e && isSpace(*b))
+                ++b;
+            return b;
+        }
+
+        const char* scalarFindSpace(const char* b, const char* e)
+        {
+            while(b < e && !isSpace(*b))
+                ++b;
+            return b;
+        }
+
+        const char* scalarRskipSpace(const char* b, const char* e)
+        {
+            while(e > b && isSpace(e[-1]))
+                --e;
+            return e;
+        }
+
+        const char* scalarFindLineEnd(const char* b, const char* e)
+        {
+            while(b < e && *b != '\n' && *b != '\r')
+                ++b;
+            return b;
+        }
+
+        bool scalarEqualsNoCase(const char* a, const char* b, size_t n)
+        {
+            for(size_t i = 0; i < n; ++i)
+            {
+                if(asciiLower(a[i]) != asciiLower(b[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        const Kernels kScalar = {Level::SCALAR, scalarFindSubstr, scalarFindFirstOf, scalarSkipSpace,
+                                 scalarFindSpace, scalarRskipSpace, scalarFindLineEnd, scalarEqualsNoCase};
+
+#ifdef HANDY_SLICE_X86
+        // -------------------------- SSE4.2实现（每次16字节） --------------------------
+        // 字节按有符号比较：>=0x80的字节为负数，不会落在[9, 13]或['A', 'Z']区间
+        __attribute__((target("sse4.2"))) inline __m128i spaceMask16(__m128i x)
+        {
+            const __m128i ctrl = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(8)), _mm_cmplt_epi8(x, _mm_set1_epi8(14)));
+            return _mm_or_si128(ctrl, _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+        }
+
+        __attribute__((target("sse4.2"))) inline __m128i lower16(__m128i x)
+        {
+            const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(x, _mm_set1_epi8('Z' + 1)));
+            return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+        }
+
+        __attribute__((target("sse4.2"))) inline __m128i load16(const char* p)
+        {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        }
+
+        __attribute__((target("sse4.2")))
+        const char* sse42FindSubstr(const char* b, const char* e, const char* needle, size_t n)
+        {
+            if(n < 2 || static_cast<size_t>(e - b) < n)
+                return scalarFindSubstr(b, e, needle, n);
+
+            // 同时比较首字节与末字节，两者都匹配的位置才做完整比较
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last = _mm_set1_epi8(needle[n - 1]);
+            const char* p = b;
+            for(; static_cast<size_t>(e - p) >= n - 1 + 16; p += 16)
+            {
+                const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(load16(p), first), _mm_cmpeq_epi8(load16(p + n - 1), last));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+                while(mask)
+                {
+                    const char* c = p + __builtin_ctz(mask);
+                    if(memcmp(c + 1, needle + 1, n - 2) == 0)
+                        return c;
+                    mask &= mask - 1;
+                }
+            }
+            return scalarFindSubstr(p, e, needle, n);
+        }
+
+        __attribute__((target("sse4.2")))
+        const char* sse42FindFirstOf(const char* b, const char* e, const char* set, size_t n)
+        {
+            if(n == 0 || n > 16)
+                return n == 0 ? e : scalarFindFirstOf(b, e, set, n);
+
+            // PCMPESTRI：16字节中第一个属于集合的字节
+            char buf[16] = {0};
+            memcpy(buf, set, n);
+            const __m128i setv = load16(buf);
+            const int setLen = static_cast<int>(n);
+            const char* p = b;
+            for(; e - p >= 16; p += 16)
+            {
+                const int idx = _mm_cmpestri(setv, setLen, load16(p), 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+                if(idx < 16)
+                    return p + idx;
+            }
+            return scalarFindFirstOf(p, e, set, n);
+        }
+
+        __attribute__((target("sse4.2")))
+        const char* sse42SkipSpace(const char* b, const char* e)
+        {
+            for(; e - b >= 16; b += 16)
+            {
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(spaceMask16(load16(b)))) ^ 0xFFFFu;
+                if(mask)
+                    return b + __builtin_ctz(mask);
+            }
+            return scalarSkipSpace(b, e);
+        }
+
+        __attribute__((target("sse4.2")))
+        const char* sse42FindSpace(const char* b, const char* e)
+        {
+            for(; e - b >= 16; b += 16)
+            {
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(spaceMask16(load16(b))));
+                if(mask)
+                    return b + __builtin_ctz(mask);
+            }
+            return scalarFindSpace(b, e);
+        }
+
+        __attribute__((target("sse4.2")))
+        const char* sse42RskipSpace(const char* b, const char* e)
+        {
+            for(; e - b >= 16; e -= 16)
+            {
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(spaceMask16(load16(e - 16)))) ^ 0xFFFFu;
+                if(mask)
+                    return e - 16 + (31 - __builtin_clz(mask)) + 1;
+            }
+            return scalarRskipSpace(b, e);
+        }
+
+        __attribute__((target("sse4.2")))
+        const char* sse42FindLineEnd(const char* b, const char* e)
+        {
+            const __m128i cr = _mm_set1_epi8('\r');
+            const __m128i lf = _mm_set1_epi8('\n');
+            for(; e - b >= 16; b += 16)
+            {
+                const __m128i x = load16(b);
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(x, cr), _mm_cmpeq_epi8(x, lf))));
+                if(mask)
+                    return b + __builtin_ctz(mask);
+            }
+            return scalarFindLineEnd(b, e);
+        }
+
+        __attribute__((target("sse4.2")))
+        bool sse42EqualsNoCase(const char* a, const char* b, size_t n)
+        {
+            size_t i = 0;
+            for(; i + 16 <= n; i += 16)
+            {
+                if(_mm_movemask_epi8(_mm_cmpeq_epi8(lower16(load16(a + i)), lower16(load16(b + i)))) != 0xFFFF)
+                    return false;
+            }
+            return scalarEqualsNoCase(a + i, b + i, n - i);
+        }
+
+        const Kernels kSse42 = {Level::SSE42, sse42FindSubstr, sse42FindFirstOf, sse42SkipSpace,
+                                sse42FindSpace, sse42RskipSpace, sse42FindLineEnd, sse42EqualsNoCase};
+
+        // -------------------------- AVX2实现（每次32字节） --------------------------
+        __attribute__((target("avx2"))) inline __m256i spaceMask32(__m256i x)
+        {
+            const __m256i ctrl = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(8)), _mm256_cmpgt_epi8(_mm256_set1_epi8(14), x));
+            return _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+        }
+
+        __attribute__((target("avx2"))) inline __m256i lower32(__m256i x)
+        {
+            const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), x));
+            return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+        }
+
+        __attribute__((target("avx2"))) inline __m256i load32(const char* p)
+        {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        }
+
+        __attribute__((target("avx2"))) inline unsigned mask32(__m256i x)
+        {
+            return static_cast<unsigned>(_mm256_movemask_epi8(x));
+        }
+
+        __attribute__((target("avx2")))
+        const char* avx2FindSubstr(const char* b, const char* e, const char* needle, size_t n)
+        {
+            if(n < 2 || static_cast<size_t>(e - b) < n)
+                return scalarFindSubstr(b, e, needle, n);
+
+            const __m256i first = _mm256_set1_epi8(needle[0]);
+            const __m256i last = _mm256_set1_epi8(needle[n - 1]);
+            const char* p = b;
+            for(; static_cast<size_t>(e - p) >= n - 1 + 32; p += 32)
+            {
+                unsigned mask = mask32(_mm256_and_si256(_mm256_cmpeq_epi8(load32(p), first), _mm256_cmpeq_epi8(load32(p + n - 1), last)));
+                while(mask)
+                {
+                    const char* c = p + __builtin_ctz(mask);
+                    if(memcmp(c + 1, needle + 1, n - 2) == 0)
+                        return c;
+                    mask &= mask - 1;
+                }
+            }
+            return sse42FindSubstr(p, e, needle, n);
+        }
+
+        __attribute__((target("avx2")))
+        const char* avx2FindFirstOf(const char* b, const char* e, const char* set, size_t n)
+        {
+            // 小集合逐个字符比较后合并；较大的集合使用PCMPESTRI
+            if(n == 0 || n > 4)
+                return sse42FindFirstOf(b, e, set, n);
+
+            __m256i sets[4];
+            for(size_t i = 0; i < n; ++i)
+                sets[i] = _mm256_set1_epi8(set[i]);
+            const char* p = b;
+            for(; e - p >= 32; p += 32)
+            {
+                const __m256i x = load32(p);
+                __m256i eq = _mm256_cmpeq_epi8(x, sets[0]);
+                for(size_t i = 1; i < n; ++i)
+                    eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(x, sets[i]));
+                const unsigned mask = mask32(eq);
+                if(mask)
+                    return p + __builtin_ctz(mask);
+            }
+            return sse42FindFirstOf(p, e, set, n);
+        }
+
+        __attribute__((target("avx2")))
+        const char* avx2SkipSpace(const char* b, const char* e)
+        {
+            for(; e - b >= 32; b += 32)
+            {
+                const unsigned mask = ~mask32(spaceMask32(load32(b)));
+                if(mask)
+                    return b + __builtin_ctz(mask);
+            }
+            return sse42SkipSpace(b, e);
+        }
+
+        __attribute__((target("avx2")))
+        const char* avx2FindSpace(const char* b, const char* e)
+        {
+            for(; e - b >= 32; b += 32)
+            {
+                const unsigned mask = mask32(spaceMask32(load32(b)));
+                if(mask)
+                    return b + __builtin_ctz(mask);
+            }
+            return sse42FindSpace(b, e);
+        }
+
+        __attribute__((target("avx2")))
+        const char* avx2RskipSpace(const char* b, const char* e)
+        {
+            for(; e - b >= 32; e -= 32)
+            {
+                const unsigned mask = ~mask32(spaceMask32(load32(e - 32)));
+                if(mask)
+                    return e - 32 + (31 - __builtin_clz(mask)) + 1;
+            }
+            return sse42RskipSpace(b, e);
+        }
+
+        __attribute__((target("avx2")))
+        const char* avx2FindLineEnd(const char* b, const char* e)
+        {
+            const __m256i cr = _mm256_set1_epi8('\r');
+            const __m256i lf = _mm256_set1_epi8('\n');
+            for(; e - b >= 32; b += 32)
+            {
+                const __m256i x = load32(b);
+                const unsigned mask = mask32(_mm256_or_si256(_mm256_cmpeq_epi8(x, cr), _mm256_cmpeq_epi8(x, lf)));
+                if(mask)
+                    return b + __builtin_ctz(mask);
+            }
+            return sse42FindLineEnd(b, e);
+        }
+
+        __attribute__((target("avx2")))
+        bool avx2EqualsNoCase(const char* a, const char* b, size_t n)
+        {
+            size_t i = 0;
+            for(; i + 32 <= n; i += 32)
+            {
+                if(~mask32(_mm256_cmpeq_epi8(lower32(load32(a + i)), lower32(load32(b + i)))))
+                    return false;
+            }
+            return sse42EqualsNoCase(a + i, b + i, n - i);
+        }
+
+        const Kernels kAvx2 = {Level::AVX2, avx2FindSubstr, avx2FindFirstOf, avx2SkipSpace,
+                               avx2FindSpace, avx2RskipSpace, avx2FindLineEnd, avx2EqualsNoCase};
+#endif
+
+        const Kernels* kernelsFor(Level level)
+        {
+#ifdef HANDY_SLICE_X86
+            if(level == Level::AVX2)
+                return &kAvx2;
+            if(level == Level::SSE42)
+                return &kSse42;
+#endif
+            (void)level;
+            return &kScalar;
+        }
+
+        // 当前使用的实现（首次调用时按CPU支持的指令集选择）
+        std::atomic<const Kernels*> g_active{nullptr};
+
+        inline const Kernels* active()
+        {
+            const Kernels* k = g_active.load(std::memory_order_acquire);
+            if(!k)
+            {
+                k = kernelsFor(supportedLevel());
+                g_active.store(k, std::memory_order_release);
+            }
+            return k;
+        }
+    } // namespace
+
+    Level supportedLevel() noexcept
+    {
+#ifdef HANDY_SLICE_X86
+        static const Level level = __builtin_cpu_supports("avx2") ? Level::AVX2
+                                   : __builtin_cpu_supports("sse4.2") ? Level::SSE42
+                                   : Level::SCALAR;
+        return level;
+#else
+        return Level::SCALAR;
+#endif
+    }
+
+    Level activeLevel() noexcept
+    {
+        return active()->level;
+    }
+
+    Level setLevel(Level level) noexcept
+    {
+        if(static_cast<int>(level) > static_cast<int>(supportedLevel()))
+            level = supportedLevel();
+        g_active.store(kernelsFor(level), std::memory_order_release);
+        return level;
+    }
+
+    const char* findSubstr(const char* b, const char* e, const char* needle, size_t n) noexcept
+    {
+        return active()->findSubstr(b, e, needle, n);
+    }
+
+    const char* findFirstOf(const char* b, const char* e, const char* set, size_t n) noexcept
+    {
+        return active()->findFirstOf(b, e, set, n);
+    }
+
+    const char* skipSpace(const char* b, const char* e) noexcept
+    {
+        return active()->skipSpace(b, e);
+    }
+
+    const char* findSpace(const char* b, const char* e) noexcept
+    {
+        return active()->findSpace(b, e);
+    }
+
+    const char* rskipSpace(const char* b, const char* e) noexcept
+    {
+        return active()->rskipSpace(b, e);
+    }
+
+    const char* findLineEnd(const char* b, const char* e) noexcept
+    {
+        return active()->findLineEnd(b, e);
+    }
+
+    bool equalsNoCase(const char* a, const char* b, size_t n) noexcept
+    {
+        return active()->equalsNoCase(a, b, n);
+    }
+} // namespace simd
+} // namespace handy
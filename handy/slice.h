@@ -2,17 +2,96 @@
 #include <stdexcept>
 #include <cstring>
 #include <vector>
-#include <mutex>
+#include <string>
 #include <unistd.h>
 
 namespace handy
 {
+    /**
+     * @brief 判断是否为空白字符（与"C" locale下的isspace相同：' '、\t、\n、\v、\f、\r）
+     * @note 不受locale影响，与simd::skipSpace()等向量化实现的结果一致
+    */
+    inline bool isSpace(char c) noexcept
+    {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    /**
+     * @brief Slice解析热路径使用的扫描原语（SSE4.2/AVX2向量化，运行时按CPU选择实现）
+     * @details 1. 首次调用时检测CPU，依次选择AVX2、SSE4.2或标量实现
+     *          2. 区间为[b, e)，查找类函数未找到时返回e
+     *          3. setLevel()用于测试与性能对比，可以强制使用较低的指令集
+     * @note 非x86平台只有标量实现
+    */
+    namespace simd
+    {
+        // 指令集级别
+        enum class Level
+        {
+            SCALAR,     // 标量实现
+            SSE42,      // 每次16字节（字符集合查找使用PCMPESTRI）
+            AVX2        // 每次32字节
+        };
+
+        /**
+         * @brief 当前CPU支持的最高级别
+        */
+        Level supportedLevel() noexcept;
+
+        /**
+         * @brief 当前使用的级别
+        */
+        Level activeLevel() noexcept;
+
+        /**
+         * @brief 切换使用的级别（超过supportedLevel()时使用supportedLevel()）
+         * @return Level 实际使用的级别
+        */
+        Level setLevel(Level level) noexcept;
+
+        /**
+         * @brief 查找子串needle[0, n)第一次出现的位置（n为0时返回b）
+        */
+        const char* findSubstr(const char* b, const char* e, const char* needle, size_t n) noexcept;
+
+        /**
+         * @brief 查找第一个属于字符集合set[0, n)的字符
+        */
+        const char* findFirstOf(const char* b, const char* e, const char* set, size_t n) noexcept;
+
+        /**
+         * @brief 跳过前导空白，返回第一个非空白字符
+        */
+        const char* skipSpace(const char* b, const char* e) noexcept;
+
+        /**
+         * @brief 查找第一个空白字符
+        */
+        const char* findSpace(const char* b, const char* e) noexcept;
+
+        /**
+         * @brief 去掉尾部空白，返回新的结束位置
+        */
+        const char* rskipSpace(const char* b, const char* e) noexcept;
+
+        /**
+         * @brief 查找第一个'\n'或'\r'
+        */
+        const char* findLineEnd(const char* b, const char* e) noexcept;
+
+        /**
+         * @brief 不区分大小写（仅ASCII字母）比较两段长度为n的数据是否相等
+        */
+        bool equalsNoCase(const char* a, const char* b, size_t n) noexcept;
+    } // namespace simd
+
     /**
      * @brief 非持有型字符序列试图（类似std::string_view，但兼容C++11）
      * @note 1. 不管理内存，仅持有外部字符序列的指针，需确保外部数据生命周期有效
      * @note 2. 线程安全：成员函数均为const/无状态操作，多线程只读访问安全
      * @note 3. 若需多线程修改（如eat/trimSpace），需外部加锁
-     * @note 4. 禁止空指针访问，所有构造/操作均做空指针校验
+     * @note 4. 禁止空指针访问，带检查的构造函数做空指针校验；热路径可使用不检查的kUnchecked构造函数
+     * @note 5. operator[]与sub()只在调试版本（未定义NDEBUG）中检查边界，at()总是检查
     */
     class Slice
     {
@@ -20,11 +99,15 @@ namespace handy
             // 静态常量：表示“未找到”的位置
             static constexpr size_t npos = static_cast<size_t>(-1);
 
+            // 标记：构造时不做空指针与区间检查（调用者保证参数有效）
+            struct Unchecked {};
+            static constexpr Unchecked kUnchecked{};
+
             // -------------------------- 构造函数（严格空指针校验） --------------------------
             /**
              * @brief 默认构造：空视图
             */
-            Slice() noexcept : m_pb(kEmptyData), m_pe(kEmptyData) {}
+            constexpr Slice() noexcept : m_pb(kEmptyData), m_pe(kEmptyData) {}
 
             /**
              * @brief 从[b, e)区间构造（左闭右开）
@@ -32,7 +115,7 @@ namespace handy
              * @param e 结束指针，不可为nullptr且e >= b
              * @throw std::invalid_argument 如果b或e为nullptr或e < b，则抛出此异常
             */
-            Slice(const char* b, const char* e)
+            constexpr Slice(const char* b, const char* e) : m_pb(b), m_pe(e)
             {
                 if(b == nullptr || e == nullptr)
                 {
@@ -42,18 +125,22 @@ namespace handy
                 {
                     throw std::invalid_argument("Slice: e cannot be less than b");
                 }
-
-                m_pb = b;
-                m_pe = e;
             }
 
+            /**
+             * @brief 从[b, e)区间构造，不做检查
+             * @param b 起始指针（非空）
+             * @param e 结束指针（e >= b）
+            */
+            constexpr Slice(const char* b, const char* e, Unchecked) noexcept : m_pb(b), m_pe(e) {}
+
             /**
              * @brief 从指针+长度构造
              * @param d 数据指针（不可为 nullptr，空视图需传 kEmptyData）
              * @param n 长度（不可为负数）
              * @throw std::invalid_argument 若 d 为空且 n > 0
             */
-            Slice(const char* d, size_t n)
+            constexpr Slice(const char* d, size_t n) : m_pb(d), m_pe(d + n)
             {
                 if(d == nullptr)
                 {
@@ -64,13 +151,15 @@ namespace handy
                     m_pb = kEmptyData;
                     m_pe = kEmptyData;
                 }
-                else
-                {
-                    m_pb = d;
-                    m_pe = d + n;
-                }
             }
 
+            /**
+             * @brief 从指针+长度构造，不做检查
+             * @param d 数据指针（非空）
+             * @param n 长度
+            */
+            constexpr Slice(const char* d, size_t n, Unchecked) noexcept : m_pb(d), m_pe(d + n) {}
+
             /**
              * @brief 从 std::string 构造（持有 string 的 data() 指针）
              * @note 需确保 string 生命周期长于 Slice
@@ -82,14 +171,13 @@ namespace handy
              * @param s 以 '\0' 结尾的字符串（不可为 nullptr）
              * @throw std::invalid_argument 若 s 为空
             */
-            Slice(const char* s)
+            constexpr Slice(const char* s) : m_pb(s), m_pe(s)
             {
                 if(s == nullptr)
                 {
                     throw std::invalid_argument("Slice: s cannot be nullptr");
                 }
-                m_pb = s;
-                m_pe = s + std::strlen(s);
+                m_pe = s + std::char_traits<char>::length(s);
             }
 
             // 是否禁止拷贝/移动
@@ -102,23 +190,23 @@ namespace handy
             /**
              * @brief 获取数据起始指针（非空）
             */
-            const char* data() const noexcept { return m_pb; }
+            constexpr const char* data() const noexcept { return m_pb; }
 
             /**
              * @brief 获取起始迭代器（兼容STL算法）
             */
-            const char* begin() const noexcept { return m_pb; }
+            constexpr const char* begin() const noexcept { return m_pb; }
 
             /**
              * @brief 获取结束迭代器（兼容STL算法）
             */
-            const char* end() const noexcept { return m_pe; }
+            constexpr const char* end() const noexcept { return m_pe; }
 
             /**
              * @brief 获取第一个字符
              * @throw std::out_of_range 若视图为空
             */
-            char front() const
+            constexpr char front() const
             {
                 if(empty())
                 {
@@ -131,7 +219,7 @@ namespace handy
              * @brief 获取最后一个字符
              * @throw std::out_of_range 若视图为空
             */
-            char back() const
+            constexpr char back() const
             {
                 if(empty())
                 {
@@ -143,12 +231,12 @@ namespace handy
             /**
              * @brief 获取视图长度
             */
-            size_t size() const noexcept { return static_cast<size_t>(m_pe - m_pb); }
+            constexpr size_t size() const noexcept { return static_cast<size_t>(m_pe - m_pb); }
 
             /**
              * @brief 判断视图是否为空
             */
-            bool empty() const noexcept { return m_pb == m_pe; }
+            constexpr bool empty() const noexcept { return m_pb == m_pe; }
 
             // -------------------------- 视图修改接口（非线程安全，需外部同步） --------------------------
             /**
@@ -156,7 +244,7 @@ namespace handy
              * @param sz 目标长度
              * @throw std::out_of_range 若sz > 当前 size()
             */
-            void resize(size_t sz)
+            constexpr void resize(size_t sz)
             {
                 if(sz > size())
                 {
@@ -168,7 +256,7 @@ namespace handy
             /**
              * @brief 清空试图（重置为空视图）
             */
-            void clear() noexcept
+            constexpr void clear() noexcept
             {
                 m_pb = kEmptyData;
                 m_pe = kEmptyData;
@@ -180,13 +268,13 @@ namespace handy
              * @return 返回被吞噬的子视图
              * @throw std::out_of_range 若sz > 当前size()
             */
-            Slice eat(size_t sz)
+            constexpr Slice eat(size_t sz)
             {
                 if(sz > size())
                 {
                     throw std::out_of_range("Slice: eat() exceeds current size");
                 }
-                Slice res(m_pb, sz);
+                Slice res(m_pb, sz, kUnchecked);
                 m_pb += sz;
                 return res;
             }
@@ -196,18 +284,35 @@ namespace handy
              * @param ch 要查找的字符
              * @return size_t 位置索引，若未找到返回 npos
             */
-            size_t find(char ch) const noexcept
+            constexpr size_t find(char ch) const noexcept
             {
-                const char* p = m_pb;
-                while(p < m_pe)
-                {
-                    if(*p == ch)
-                    {
-                        return static_cast<size_t>(p - m_pb);
-                    }
-                    ++p;
-                }
-                return npos;
+                // 运行时即memchr（常见libc中已经向量化）
+                const char* p = std::char_traits<char>::find(m_pb, size(), ch);
+                return p ? static_cast<size_t>(p - m_pb) : npos;
+            }
+
+            /**
+             * @brief 查找子串位置
+             * @param needle 要查找的子串
+             * @return size_t 第一次出现的位置（needle为空时返回0），若未找到返回 npos
+            */
+            size_t find(const Slice& needle) const noexcept
+            {
+                if(needle.empty())
+                    return 0;
+                const char* p = simd::findSubstr(m_pb, m_pe, needle.m_pb, needle.size());
+                return p == m_pe ? npos : static_cast<size_t>(p - m_pb);
+            }
+
+            /**
+             * @brief 查找第一个属于字符集合的字符
+             * @param set 字符集合（如" \t\r\n"）
+             * @return size_t 位置索引，若未找到返回 npos
+            */
+            size_t findFirstOf(const Slice& set) const noexcept
+            {
+                const char* p = simd::findFirstOf(m_pb, m_pe, set.m_pb, set.size());
+                return p == m_pe ? npos : static_cast<size_t>(p - m_pb);
             }
 
             /**
@@ -216,42 +321,31 @@ namespace handy
             */
             Slice eatWord() noexcept
             {
-                // 跳过前导空白（isspace需处理unsigned char，避免符号错误）
+                // 跳过前导空白
                 const char* b = m_pb;
-                while(b < m_pe && std::isspace(static_cast<unsigned char>(*b)))
-                    ++b;
+                if(b < m_pe && isSpace(*b))
+                    b = simd::skipSpace(b, m_pe);
 
                 // 读取单词内容
-                const char* e = b;
-                while(e < m_pe && !std::isspace(static_cast<unsigned char>(*e)))
-                    ++e;
+                const char* e = simd::findSpace(b, m_pe);
 
                 // 更新当前视图
                 m_pb = e;
-                return Slice(b, e);
+                return Slice(b, e, kUnchecked);
             }
 
             /**
              * @brief 吞噬一行（直到 \n 或 \r，兼容 Windows/Linux 换行）
-             * @return 行内容的子视图（不含换行符）
+             * @return 行内容的子视图（不含换行符；没有换行符时为剩余的全部内容）
             */
             Slice eatLine() noexcept
             {
-                const char* p = m_pb;
-                // 跳过非换行字符
-                while(m_pb < m_pe && *m_pb != '\n' && *m_pb != '\r')
-                    ++m_pb;
-                // 跳过换行符本身（避免残留）
-                if(m_pb < m_pe && (*m_pb == '\n' || *m_pb == '\r'))
-                {
+                Slice line(m_pb, simd::findLineEnd(m_pb, m_pe), kUnchecked);
+                m_pb = line.m_pe;
+                // 跳过换行符本身（避免残留），处理Windows 换行（\r\n）
+                if(m_pb < m_pe && *m_pb++ == '\r' && m_pb < m_pe && *m_pb == '\n')
                     ++m_pb;
-                    // 处理Windows 换行（\r\n）
-                    if(m_pb < m_pe && *m_pb == '\n' && *(m_pb - 1) == '\r')
-                        ++m_pb;
-                } 
-
-                // 不含换行符
-                return Slice(p, m_pb - 1);
+                return line;
             }
             
             /**
@@ -259,9 +353,9 @@ namespace handy
              * @param bOff 起始偏移（正数：从开头；负数：从结尾）
              * @param eOff 结束偏移（正数：从开头；负数：从结尾，默认 0 表示原结束）
              * @return 子视图
-             * @throw std::out_of_range 若偏移越界
+             * @throw std::out_of_range 若偏移越界（仅调试版本检查，发布版本由调用者保证）
             */
-            Slice sub(int bOff, int eOff = 0) const
+            constexpr Slice sub(int bOff, int eOff = 0) const
             {
                 // 计算实际起始位置
                 const char* b = m_pb;
@@ -270,19 +364,21 @@ namespace handy
                 else
                     b += size() + bOff;
 
-                // 计算实际结束位置
+                // 计算实际结束位置（0表示原结束）
                 const char* e = m_pe;
-                if(eOff >= 0)
+                if(eOff > 0)
                     e = m_pb + eOff;
                 else
                     e = m_pe + eOff;
 
+#ifndef NDEBUG
                 // 校验边界
                 if(b < m_pb || b > e || e > m_pe)
                 {
                     throw std::out_of_range("Slice: sub() offset out of range");
                 }
-                return Slice(b, e);
+#endif
+                return Slice(b, e, kUnchecked);
             }
 
             /**
@@ -291,13 +387,14 @@ namespace handy
             */
             Slice& trimSpace() noexcept
             {
+                // 首尾不是空白时（最常见的情况）不需要扫描
                 // 移除前导空白
-                while(m_pb < m_pe && std::isspace(static_cast<unsigned char>(*m_pb)))
-                    ++m_pb;
+                if(m_pb < m_pe && isSpace(*m_pb))
+                    m_pb = simd::skipSpace(m_pb, m_pe);
 
                 // 移除尾部空白
-                while(m_pe > m_pb && std::isspace(static_cast<unsigned char>(*(m_pe - 1))))
-                    --m_pe;
+                if(m_pe > m_pb && isSpace(m_pe[-1]))
+                    m_pe = simd::rskipSpace(m_pb, m_pe);
                 return *this;
             }
 
@@ -306,14 +403,31 @@ namespace handy
              * @brief 下标访问（支持随机访问）
              * @param n 索引
              * @return 对应字符
-             * @throw std::out_of_range 若索引越界
+             * @throw std::out_of_range 若索引越界（仅调试版本检查，发布版本由调用者保证）
             */
-            char operator[](size_t n) const
+            constexpr char operator[](size_t n) const
             {
+#ifndef NDEBUG
                 if(n >= size())
                 {
                     throw std::out_of_range("Slice: operator[] out of range");
                 }
+#endif
+                return m_pb[n];
+            }
+
+            /**
+             * @brief 带边界检查的下标访问（任何构建模式下都检查）
+             * @param n 索引
+             * @return 对应字符
+             * @throw std::out_of_range 若索引越界
+            */
+            constexpr char at(size_t n) const
+            {
+                if(n >= size())
+                {
+                    throw std::out_of_range("Slice: at() out of range");
+                }
                 return m_pb[n];
             }
 
@@ -335,11 +449,11 @@ namespace handy
              * @param b 待比较的Slice
              * @return 0:相等，<0:小于，>0:大于
             */
-            int compare(const Slice& b) const noexcept
+            constexpr int compare(const Slice& b) const noexcept
             {
-                const size_t minLen = std::min(size(), b.size());
-                // 比较前minLen个字符(memcmp 处理二进制安全)
-                const int cmp = std::memcmp(m_pb, b.m_pb, minLen);
+                const size_t minLen = size() < b.size() ? size() : b.size();
+                // 比较前minLen个字符（运行时即memcmp，二进制安全）
+                const int cmp = std::char_traits<char>::compare(m_pb, b.m_pb, minLen);
                 if(cmp != 0)
                     return cmp;
 
@@ -351,20 +465,49 @@ namespace handy
              * @brief 判断是否以指定前缀开头
              * @param prefix 前缀视图
             */
-            bool startsWith(const Slice& prefix) const noexcept
+            constexpr bool startsWith(const Slice& prefix) const noexcept
             {
                 return (size() >= prefix.size() &&
-                        (std::memcmp(m_pb, prefix.m_pb, prefix.size()) == 0));
+                        (std::char_traits<char>::compare(m_pb, prefix.m_pb, prefix.size()) == 0));
             }
 
             /**
              * @brief 判断是否以指定后缀结尾
              * @param suffix 后缀视图
             */
-            bool endsWith(const Slice& suffix) const noexcept
+            constexpr bool endsWith(const Slice& suffix) const noexcept
             {
                 return (size() >= suffix.size() &&
-                        (std::memcmp(m_pe - suffix.size(), suffix.m_pb, suffix.size()) == 0));
+                        (std::char_traits<char>::compare(m_pe - suffix.size(), suffix.m_pb, suffix.size()) == 0));
+            }
+
+            /**
+             * @brief 不区分大小写（仅ASCII字母）判断是否相等
+             * @param b 待比较的Slice
+            */
+            bool equalsNoCase(const Slice& b) const noexcept
+            {
+                const size_t n = size();
+                if(n != b.size())
+                    return false;
+                // 短数据（如HTTP头部字段名）直接逐字节比较，省去函数调用
+                if(n >= 16)
+                    return simd::equalsNoCase(m_pb, b.m_pb, n);
+                for(size_t i = 0; i < n; ++i)
+                {
+                    if(_lower(m_pb[i]) != _lower(b.m_pb[i]))
+                        return false;
+                }
+                return true;
+            }
+
+            /**
+             * @brief 不区分大小写（仅ASCII字母）判断是否以指定前缀开头
+             * @param prefix 前缀视图
+            */
+            bool startsWithNoCase(const Slice& prefix) const noexcept
+            {
+                return size() >= prefix.size() && simd::equalsNoCase(m_pb, prefix.m_pb, prefix.size());
             }
 
             /**
@@ -381,14 +524,14 @@ namespace handy
                 {
                     if(*p == ch)
                     {
-                        res.emplace_back(cur, p);
+                        res.emplace_back(cur, p, kUnchecked);
                         cur = p + 1;
                     }
                 }
 
                 // 添加最后一个子视图（若不为空）
                 if(cur < m_pe)
-                    res.emplace_back(cur, m_pe);
+                    res.emplace_back(cur, m_pe, kUnchecked);
                 
                 return res;
             }
@@ -400,16 +543,21 @@ namespace handy
             static const char* getEmptyData() noexcept { return kEmptyData; }
 
             /**
-             * @brief 线程安全的Slice构造（多线程创建时避免空指针竞争）
-             * @note 需外部保证data生命周期
+             * @brief 线程安全的Slice构造（空指针时返回空视图）
+             * @note 1. 构造只读取参数、不访问共享状态，本身就是线程安全的，无需加锁
+             * @note 2. 需外部保证data生命周期
             */
-            static Slice createSafe(const char* data, size_t len)
+            static constexpr Slice createSafe(const char* data, size_t len) noexcept
             {
-                static std::mutex mutex;
-                std::lock_guard<std::mutex> lock(mutex);
-                return Slice(data, len);
+                return data ? Slice(data, len, kUnchecked) : Slice();
             }
         private:
+            // ASCII小写转换（不受locale影响）
+            static constexpr char _lower(char c) noexcept
+            {
+                return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+            }
+
             // 全局空数据（避免空指针，所有空视图指向此处）
             static constexpr const char* kEmptyData = "";
 
@@ -419,32 +567,32 @@ namespace handy
             const char* m_pe;
     };
     // -------------------------- 全局比较运算符（非成员函数） --------------------------
-    inline bool operator<(const Slice& lhs, const Slice& rhs) noexcept
+    constexpr bool operator<(const Slice& lhs, const Slice& rhs) noexcept
     {
         return lhs.compare(rhs) < 0;
     }
 
-    inline bool operator==(const Slice &lhs, const Slice &rhs) noexcept
+    constexpr bool operator==(const Slice &lhs, const Slice &rhs) noexcept
     {
         return lhs.compare(rhs) == 0;
     }
 
-    inline bool operator!=(const Slice &lhs, const Slice &rhs) noexcept
+    constexpr bool operator!=(const Slice &lhs, const Slice &rhs) noexcept
     {
         return !(lhs == rhs);
     }
 
-    inline bool operator<=(const Slice &lhs, const Slice &rhs) noexcept
+    constexpr bool operator<=(const Slice &lhs, const Slice &rhs) noexcept
     {
         return lhs.compare(rhs) <= 0;
     }
 
-    inline bool operator>(const Slice &lhs, const Slice &rhs) noexcept
+    constexpr bool operator>(const Slice &lhs, const Slice &rhs) noexcept
     {
         return lhs.compare(rhs) > 0;
     }
 
-    inline bool operator>=(const Slice &lhs, const Slice &rhs) noexcept
+    constexpr bool operator>=(const Slice &lhs, const Slice &rhs) noexcept
     {
         return lhs.compare(rhs) >= 0;
     }
@@ -0,0 +1,103 @@
+#include "stat-svr.h"
+#include "logger.h"
+
+namespace handy
+{
+    StatServer::StatServer(EventBase* base, MetricsRegistry& registry)
+        : m_server(base)
+        , m_registry(registry)
+    {
+        m_pages.emplace_back("/metrics", "metrics in prometheus text format");
+        m_server.onGet("/metrics", [this](const HttpConnPtr& con)
+        {
+            _sendText(con, "text/plain; version=0.0.4", m_registry.render());
+        });
+
+        m_server.onGet("/", [this](const HttpConnPtr& con)
+        {
+            std::string body;
+            for(const auto& [uri, desc] : m_pages)
+                body += uri + "\t" + desc + "\n";
+            _sendText(con, "text/plain", body);
+        });
+    }
+
+    StatServer::~StatServer()
+    {
+        for(const auto& [name, labels] : m_loopMetrics)
+            m_registry.remove(name, labels);
+    }
+
+    void StatServer::addEventBase(EventBase* base, const std::string& name)
+    {
+        if(!base)
+            throw std::invalid_argument("StatServer::addEventBase: base is null");
+
+        std::string labels = "loop=\"" + name + "\"";
+        const LoopStats& stats = base->getStats();
+
+        m_registry.counter("handy_loop_iterations_total", "Event loop iterations", labels, [&stats]
+        {
+            return static_cast<double>(stats.iterations.load(std::memory_order_relaxed));
+        });
+        m_registry.counter("handy_loop_slow_callbacks_total", "Callbacks that exceeded the slow callback threshold",
+                            labels, [&stats]
+        {
+            return static_cast<double>(stats.slowCallbacks.load(std::memory_order_relaxed));
+        });
+        m_registry.histogram("handy_loop_busy_seconds", "Time spent handling events per loop iteration, excluding poll wait",
+                                labels, stats.busy_us, 1e-6);
+        m_registry.gauge("handy_loop_pending_tasks", "Tasks queued by safeCall and not yet run", labels, [base]
+        {
+            return static_cast<double>(base->getPendingTasks());
+        });
+        m_registry.gauge("handy_loop_timers", "Timers registered on the event loop", labels, [&stats]
+        {
+            return static_cast<double>(stats.timers.load(std::memory_order_relaxed));
+        });
+        m_registry.gauge("handy_loop_connections", "TCP connections attached to the event loop", labels, [&stats]
+        {
+            return static_cast<double>(stats.connections.load(std::memory_order_relaxed));
+        });
+        m_registry.gauge("handy_loop_busy_ratio", "Recent fraction of time spent handling events", labels, [base]
+        {
+            return base->getRecentBusy();
+        });
+        for(const char* metric : {"handy_loop_iterations_total", "handy_loop_slow_callbacks_total",
+                                    "handy_loop_busy_seconds", "handy_loop_pending_tasks", "handy_loop_timers",
+                                    "handy_loop_connections", "handy_loop_busy_ratio"})
+            m_loopMetrics.emplace_back(metric, labels);
+
+        // 每轮循环各阶段的耗时分布
+        const std::pair<const char*, const Histogram*> phases[] = {
+            {"poll", &stats.pollWait_us},
+            {"io", &stats.io_us},
+            {"timers", &stats.timers_us},
+            {"tasks", &stats.tasks_us},
+        };
+        for(const auto& [phase, hist] : phases)
+        {
+            std::string phaseLabels = labels + ",phase=\"" + phase + "\"";
+            m_registry.histogram("handy_loop_phase_seconds", "Time spent in each loop phase per iteration",
+                                    phaseLabels, *hist, 1e-6);
+            m_loopMetrics.emplace_back("handy_loop_phase_seconds", phaseLabels);
+        }
+    }
+
+    void StatServer::onPage(const std::string& uri, const std::string& desc, const PageCallBack& cb)
+    {
+        m_pages.emplace_back(uri, desc);
+        m_server.onGet(uri, [cb](const HttpConnPtr& con)
+        {
+            _sendText(con, "text/plain", cb());
+        });
+    }
+
+    void StatServer::_sendText(const HttpConnPtr& con, const std::string& contentType, const std::string& body)
+    {
+        HttpResponse& resp = con.getResponse();
+        resp.setHeader("Content-Type", contentType);
+        resp.setBody(body);
+        con.sendResponse();
+    }
+} // namespace handy
@@ -1,3 +1,75 @@
 #pragma once
 #include "non_copy_able.h"
-#include "event_base.h"
\ No newline at end of file
+#include "event_base.h"
+#include "http.h"
+#include "metrics.h"
+
+namespace handy
+{
+    /**
+     * @class StatServer
+     * @brief 状态监控服务器，通过HTTP导出运行中进程的指标
+     * @details 1. GET /metrics 以Prometheus文本格式输出注册表中的全部指标
+     *          2. GET / 输出索引页，列出所有可访问的页面
+     *          3. addEventBase()导出事件循环各阶段（poll/io/timers/tasks）的耗时分布、循环次数、
+     *             慢回调次数、任务队列深度、定时器数量、连接数与最近的繁忙程度
+     *          4. 指标只在抓取时汇总，被监控的事件循环只承担relaxed原子操作的开销
+     * @note 服务器本身运行在构造时指定的EventBase上，可以与业务共用，也可以单独开一个循环
+    */
+    class StatServer : private NonCopyAble
+    {
+        public:
+            using PageCallBack = std::function<std::string()>;
+
+            /**
+             * @brief 构造函数
+             * @param base 运行监控服务器的事件循环
+             * @param registry 要导出的指标注册表（默认为进程级注册表）
+            */
+            explicit StatServer(EventBase* base, MetricsRegistry& registry = MetricsRegistry::instance());
+
+            /**
+             * @brief 析构函数：注销addEventBase()注册的指标
+            */
+            ~StatServer();
+
+            /**
+             * @brief 绑定监听地址
+             * @param host 监听的主机地址
+             * @param port 监听端口
+             * @return int 0：成功；其他：errno
+            */
+            int bind(const std::string& host, unsigned short port) { return m_server.bind(host, port); }
+
+            /**
+             * @brief 导出事件循环的运行指标（以loop="name"标签区分）
+             * @param base 事件循环（需在StatServer析构前保持有效）
+             * @param name 事件循环名称
+            */
+            void addEventBase(EventBase* base, const std::string& name);
+
+            /**
+             * @brief 注册自定义的文本页面
+             * @param uri 页面路径
+             * @param desc 页面说明（显示在索引页）
+             * @param cb 生成页面内容的回调（在监控服务器的事件循环线程中调用）
+            */
+            void onPage(const std::string& uri, const std::string& desc, const PageCallBack& cb);
+
+            /**
+             * @brief 获取导出的指标注册表
+            */
+            MetricsRegistry& getRegistry() const { return m_registry; }
+
+        private:
+            HttpServer m_server;                                            // HTTP服务器
+            MetricsRegistry& m_registry;                                    // 导出的指标注册表
+            std::vector<std::pair<std::string, std::string>> m_loopMetrics; // addEventBase()注册的指标：名称 -> 标签
+            std::vector<std::pair<std::string, std::string>> m_pages;       // 页面列表：路径 -> 说明
+
+            /**
+             * @brief 发送文本响应
+            */
+            static void _sendText(const HttpConnPtr& con, const std::string& contentType, const std::string& body);
+    };
+} // namespace handy
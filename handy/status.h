@@ -5,9 +5,11 @@
 #include <cstring>
 #include <string>
 #include "utils.h"
-#include <cstdarg>
 #include <iostream>
 #include <type_traits>
+#include <atomic>
+#include <cstddef>
+#include <new>
 
 namespace handy
 {
@@ -37,65 +39,78 @@ namespace handy
     /**
      * @class Status
      * @brief 表示操作的状态信息，包含错误码和描述信息
+     * @details 错误信息按长度与来源选择存储方式，出错路径上尽量不分配堆内存：
+     *          1. 静态：fromSystem()的常见errno（0 ~ kStaticErrno-1）使用进程内预先生成的错误信息，拷贝只复制指针
+     *          2. 内联：不超过kInlineSize-1字节的信息直接存放在对象内部
+     *          3. 堆：更长的信息分配一次，之后的拷贝只增加引用计数（内容不可变，可以跨线程共享）
      * @note 1. 线程安全的状态封装类，用于传递操作结果和错误信息
-     * @note 2. 采用值语义设计，支持移动操作以提高性能
+     * @note 2. 采用值语义设计，移动操作不分配内存，移动后原对象为成功状态
     */
     class Status
     {
         public:
+            static constexpr size_t kInlineSize = 24;       // 内联信息的存储大小（含结尾的'\0'）
+            static constexpr int kStaticErrno = 160;        // 预先生成错误信息的errno范围上限
+
             /**
              * @brief 构造函数，创建一个表示“成功”的Status对象
             */
-            Status() noexcept : m_state(nullptr) {}
+            Status() noexcept : m_heap(nullptr), m_code(0), m_kind(Kind::NONE) {}
 
             /**
              * @brief 创建包含指定状态码和错误信息的Status对象
              * @param code 状态码，0表示成功
              * @param msg 错误描述信息
             */
-            Status(int code, const char* msg);
+            Status(int code, const char* msg) noexcept
+            {
+                _assign(code, msg ? msg : "", msg ? std::strlen(msg) : 0);
+            }
 
             /**
              * @brief 创建包含指定状态码和错误信息的Status对象
              * @param code 状态码，0表示成功
              * @param msg 错误描述信息
             */
-            Status(int code, const std::string& msg) : Status(code, msg.c_str()) {}
+            Status(int code, const std::string& msg) noexcept
+            {
+                _assign(code, msg.c_str(), msg.size());
+            }
 
             /**
-             * @brief 拷贝构造寒素
+             * @brief 拷贝构造函数（静态、内联信息直接复制，堆上的信息增加引用计数）
              * @param other 要拷贝的Status对象
             */
-            Status(const Status& other)
+            Status(const Status& other) noexcept
             {
-                m_state = copyState(other.m_state);
+                _copy(other);
             }
 
             /**
              * @brief 移动构造函数
              * @param other 要移动的Status对象
             */
-            Status(Status&& other) noexcept : m_state(other.m_state)
+            Status(Status&& other) noexcept
             {
-                other.m_state = nullptr;
+                _steal(other);
             }
 
             /**
              * @brief 析构函数
             */
-            ~Status() { delete[] m_state; }
+            ~Status() { _release(); }
 
             /**
              * @brief 拷贝赋值运算符
              * @param other 要拷贝的Status对象
              * @return Status& 自身引用
             */
-            Status& operator=(const Status& other)
+            Status& operator=(const Status& other) noexcept
             {
                 if(this != &other)
                 {
-                    delete[] m_state;
-                    m_state = copyState(other.m_state);
+                    _release();
+                    _copy(other);
                 }
                 return *this;
             }
@@ -109,9 +124,8 @@ namespace handy
             {
                 if(this != &other)
                 {
-                    delete[] m_state;
-                    m_state = other.m_state;
-                    other.m_state = nullptr;
+                    _release();
+                    _steal(other);
                 }
                 return *this;
             }
@@ -122,16 +136,19 @@ namespace handy
             */
             static Status fromSystem()
             {
-                return Status(errno, errstr());
+                return fromSystem(errno);
             }
 
             /**
              * @brief 根据指定的系统错误码创建Status对象
              * @param err 系统错误码
-             * @return 包含对应错误信息的Status对象
+             * @return 包含对应错误信息的Status对象（常见errno使用预先生成的信息，不分配内存）
             */
             static Status fromSystem(int err)
             {
+                if(err >= 0 && err < kStaticErrno)
+                    return Status(err, _errnoMsg(err), Kind::STATIC);
+
                 thread_local char buf[256];
                 const char* msg;
 
@@ -151,11 +168,13 @@ namespace handy
             /**
              * @brief 根据格式化字符串创建Status对象
              * @param code 状态码
-             * @param fmt 格式化字符串
-             * @param ... 格式化参数
+             * @param fmt 格式化字符串（语法同printf，参数按实际类型格式化，见format.h）
+             * @param args 格式化参数
              * @return 包含格式化错误信息的Status对象
+             * @note 先格式化到栈上的缓冲区，只有超过缓冲区时才再格式化一次
             */
-            static Status fromFormat(int code, const char* fmt, ...) noexcept;
+            template <class... Args>
+            static Status fromFormat(int code, const char* fmt, const Args&... args) noexcept;
 
             /**
              * @brief 创建I/O操作错误的Status对象
@@ -174,7 +193,7 @@ namespace handy
             */
             int code() const noexcept
             {
-                return m_state ? *reinterpret_cast<const uint32_t*>(m_state + 4) : 0;
+                return m_code;
             }
 
             /**
@@ -183,7 +202,17 @@ namespace handy
             */
             const char* msg() const noexcept
             {
-                return m_state ? m_state + 8 : "";
+                switch(m_kind)
+                {
+                    case Kind::INLINE:
+                        return m_inline;
+                    case Kind::STATIC:
+                        return m_static;
+                    case Kind::HEAP:
+                        return m_heap->msg;
+                    default:
+                        return "";
+                }
             }
 
             /**
@@ -202,72 +231,146 @@ namespace handy
             }
 
         private:
-            // 状态信息（存储格式：0-3 总长度；4-7 状态码、8- 错误信息，以'\0'结尾）
-            const char* m_state;
+            // 错误信息的存储方式
+            enum class Kind : uint8_t
+            {
+                NONE,       // 无信息
+                STATIC,     // 指向静态存储期的字符串
+                INLINE,     // 存放在m_inline中
+                HEAP        // 堆上的HeapState（引用计数）
+            };
+
+            // 堆上的错误信息（内容不可变，引用计数为0时释放）
+            struct HeapState
+            {
+                std::atomic<uint32_t> refs;     // 引用计数
+                char msg[1];                    // 错误信息（以'\0'结尾）
+            };
+
+            union
+            {
+                HeapState* m_heap;              // 堆上的错误信息
+                const char* m_static;           // 静态错误信息
+                char m_inline[kInlineSize];     // 内联错误信息
+            };
+            int32_t m_code;                     // 状态码
+            Kind m_kind;                        // 错误信息的存储方式
+
+            /**
+             * @brief 使用静态错误信息构造（不复制信息）
+            */
+            Status(int code, const char* msg, Kind) noexcept : m_static(msg), m_code(code), m_kind(Kind::STATIC) {}
 
             /**
-             * @brief 深拷贝状态信息
-             * @param state 要拷贝的状态信息
-             * @return 新分配的状态信息指针
+             * @brief 获取预先生成的errno错误信息（首次调用时生成全部）
             */
-            const char* copyState(const char* state)
+            static const char* _errnoMsg(int err)
             {
-                if(!state)
-                    return nullptr;
-                
-                const uint32_t size = *reinterpret_cast<const uint32_t*>(state);
-                char* newState = new char[size];
-                std::memcpy(newState, state, size);
-                return newState;
+                struct Table
+                {
+                    char msgs[kStaticErrno][64];
+                    Table()
+                    {
+                        for(int i = 0; i < kStaticErrno; ++i)
+                        {
+                            char buf[256];
+                            const char* msg;
+                            auto ret = strerror_r(i, buf, sizeof(buf));
+                            if constexpr (std::is_same_v<decltype(ret), int>) {
+                                msg = (ret == 0) ? buf : "Unknown error";
+                            } else {
+                                msg = ret;
+                            }
+                            snprintf(msgs[i], sizeof(msgs[i]), "%s", msg);
+                        }
+                    }
+                };
+                static const Table table;
+                return table.msgs[err];
             }
-    };
 
-    inline Status::Status(int code, const char* msg)
-    {
-        if(!msg)
-            msg = "";
-        
-        // 包含终止符
-        const uint32_t msgLen = static_cast<uint32_t>(std::strlen(msg)) + 1;
-        const uint32_t totalLen = 4 + 4 + msgLen;
-
-        char* newState = new char[totalLen];
-        *reinterpret_cast<uint32_t*>(newState) = totalLen;
-        *reinterpret_cast<uint32_t*>(newState + 4) = code;
-        std::memcpy(newState + 8, msg, msgLen);
-
-        m_state = newState;
-    }
-
-    inline Status Status::fromFormat(int code, const char* fmt, ...) noexcept
-    {
-        if(!fmt)
-            return Status(code, "");
+            /**
+             * @brief 设置状态码与信息：短信息内联，长信息分配到堆上（分配失败时使用静态信息）
+            */
+            void _assign(int code, const char* msg, size_t len) noexcept
+            {
+                m_code = code;
+                if(len < kInlineSize)
+                {
+                    m_kind = Kind::INLINE;
+                    std::memcpy(m_inline, msg, len);
+                    m_inline[len] = '\0';
+                    return;
+                }
+                void* p = ::operator new(offsetof(HeapState, msg) + len + 1, std::nothrow);
+                if(!p)
+                {
+                    m_kind = Kind::STATIC;
+                    m_static = "Memory allocation failed";
+                    return;
+                }
+                m_heap = ::new (p) HeapState;
+                m_heap->refs.store(1, std::memory_order_relaxed);
+                std::memcpy(m_heap->msg, msg, len);
+                m_heap->msg[len] = '\0';
+                m_kind = Kind::HEAP;
+            }
 
-        // 第一次调用获取所需缓冲区的大小
-        va_list ap;
-        va_start(ap, fmt);
-        const int msgLen = vsnprintf(nullptr, 0, fmt, ap);
-        va_end(ap);
+            void _copy(const Status& other) noexcept
+            {
+                std::memcpy(m_inline, other.m_inline, kInlineSize);
+                m_code = other.m_code;
+                m_kind = other.m_kind;
+                if(m_kind == Kind::HEAP)
+                    m_heap->refs.fetch_add(1, std::memory_order_relaxed);
+            }
 
-        if(msgLen < 0)
-            return Status(code, "Format error");
+            void _steal(Status& other) noexcept
+            {
+                std::memcpy(m_inline, other.m_inline, kInlineSize);
+                m_code = other.m_code;
+                m_kind = other.m_kind;
+                other.m_code = 0;
+                other.m_kind = Kind::NONE;
+            }
 
-        // 分配缓冲区并格式化字符串
-        const uint32_t totalLen = 4 + 4 + static_cast<uint32_t>(msgLen) + 1;
-        char* newState = new (std::nothrow) char[totalLen];
-        if(!newState)
-            return Status(code, "Memory allocation failed");
+            void _release() noexcept
+            {
+                if(m_kind == Kind::HEAP && m_heap->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    m_heap->~HeapState();
+                    ::operator delete(m_heap);
+                }
+                m_kind = Kind::NONE;
+            }
+    };
 
-        *reinterpret_cast<uint32_t*>(newState) = totalLen;
-        *reinterpret_cast<uint32_t*>(newState + 4) = code;
+    template <class... Args>
+    Status Status::fromFormat(int code, const char* fmt, const Args&... args) noexcept
+    {
+        if(!fmt)
+            return Status(code, "");
 
-        va_start(ap, fmt);
-        vsnprintf(newState + 8, msgLen + 1, fmt, ap);
-        va_end(ap);
+        // 先格式化到栈上的缓冲区（大多数错误信息足够）
+        char buf[512];
+        const size_t msgLen = formatTo(buf, sizeof(buf), fmt, args...);
+        if(msgLen < sizeof(buf))
+        {
+            Status result;
+            result._assign(code, buf, msgLen);
+            return result;
+        }
 
+        // 超过栈上缓冲区：直接格式化到堆上
+        void* p = ::operator new(offsetof(HeapState, msg) + msgLen + 1, std::nothrow);
+        if(!p)
+            return Status(code, "Memory allocation failed", Kind::STATIC);
         Status result;
-        result.m_state = newState;
+        result.m_heap = ::new (p) HeapState;
+        result.m_heap->refs.store(1, std::memory_order_relaxed);
+        result.m_code = code;
+        result.m_kind = Kind::HEAP;
+        formatTo(result.m_heap->msg, msgLen + 1, fmt, args...);
         return result;
     }
 } // namespace handy
@@ -1,88 +1,9 @@
 #include "thread_pool.h"
-#include <chrono>
+#include "port_posix.h"
+#include <cstring>
 
 using namespace handy;
 
-template <typename T>
-bool SafeQueue<T>::push(T&& value)
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    if(m_isExited)
-        return false;
-
-    if(m_capacity > 0 && m_items.size() >= m_capacity)
-        return false;
-
-    m_items.push_back(std::move(value));
-
-    // 唤醒一个等待的消费者线程
-    m_condReady.notify_one();
-    return true;
-}
-
-template <typename T>
-void SafeQueue<T>::waitReady(std::unique_lock<std::mutex>& lock, int waitTime_ms)
-{
-    if (waitTime_ms == 0) {
-        return; // 非阻塞
-    }
-
-    auto pred = [this] { return m_isExited || !m_items.empty(); };
-
-    if (waitTime_ms == kWaitInfinite) {
-        m_condReady.wait(lock, pred);
-    } else {
-        auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(waitTime_ms);
-        m_condReady.wait_until(lock, timeout, pred);
-    }
-}
-
-template <typename T>
-bool SafeQueue<T>::popWait(T* value, int waitTime_ms)
-{
-    if(value == nullptr)
-        throw std::invalid_argument("SafeQueue::popWait(): value pointer is null");
-
-    // 支持条件变量等待的锁
-    std::unique_lock<std::mutex> lock(m_mutex);
-
-    waitReady(lock, waitTime_ms);
-
-    if(m_items.empty())
-        return false;
-
-    // 移动元素到输出参数，然后从队列中移除
-    *value = std::move(m_items.front());
-    m_items.pop_front();
-
-    return true;
-}
-
-template <typename T>
-size_t SafeQueue<T>::size() const
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_items.size();
-}
-
-template <typename T>
-void SafeQueue<T>::exit()
-{
-    // 原子操作，确保只执行一次退出逻辑
-    if(m_isExited.exchange(true))
-        return;
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_condReady.notify_all();
-}
-
-template <typename T>
-bool SafeQueue<T>::isExited() const noexcept
-{
-    return m_isExited;
-}
-
 // 显示实例化任务类型的安全队列
 template class SafeQueue<Task>;
 
@@ -90,6 +11,7 @@ ThreadPool::ThreadPool(int threadNum, int taskQueueCapacity, bool isStartImmedia
     : m_taskQueue(static_cast<size_t>(taskQueueCapacity))
     , m_isStarted(false)
     , m_isExited(false)
+    , m_threadName("handy-pool")
 {
     if(threadNum <= 0)
         throw std::invalid_argument("ThreadPool::ThreadPool(): threadNum must be greater than 0");
@@ -126,11 +48,49 @@ void ThreadPool::start()
     const size_t threadNum = m_threads.capacity();
     for(size_t i = 0; i < threadNum; ++i)
     {
-        // 直接在容器中构造线程，绑定工作线程
-        m_threads.emplace_back(&ThreadPool::workerLoop, this);
+        // 直接在容器中构造线程，先设置线程名与CPU绑定，再进入工作循环
+        m_threads.emplace_back([this, i]()
+        {
+            _setupThread(i);
+            workerLoop();
+        });
     }
 }
 
+ThreadPool& ThreadPool::setThreadName(const std::string& prefix)
+{
+    if(m_isStarted)
+    {
+        WARN("ThreadPool::setThreadName(): thread pool is already started, ignored");
+        return *this;
+    }
+    m_threadName = prefix;
+    return *this;
+}
+
+ThreadPool& ThreadPool::setCpuAffinity(const std::vector<std::vector<int>>& cpuSets)
+{
+    if(m_isStarted)
+    {
+        WARN("ThreadPool::setCpuAffinity(): thread pool is already started, ignored");
+        return *this;
+    }
+    m_cpuSets = cpuSets;
+    return *this;
+}
+
+void ThreadPool::_setupThread(size_t idx)
+{
+    std::string name = m_threadName + "-" + std::to_string(idx);
+    port::setThreadName(name);
+    if(m_cpuSets.empty())
+        return;
+
+    const std::vector<int>& cpus = m_cpuSets[idx % m_cpuSets.size()];
+    if(!port::setThreadAffinity(cpus))
+        WARN("ThreadPool: %s failed to set cpu affinity, errno=%d, msg=%s", name.c_str(), errno, strerror(errno));
+}
+
 void ThreadPool::exit()
 {
     if(m_isExited.exchange(true))
@@ -10,9 +10,11 @@
 #include "logger.h"
 #include <mutex>
 #include "non_copy_able.h"
+#include "inline_function.h"
 #include <vector>
 #include <thread>
 #include <condition_variable>
+#include <chrono>
 #include <list>
 
 namespace handy 
@@ -119,9 +121,91 @@ namespace handy
             void waitReady(std::unique_lock<std::mutex>& lock, int waitTime_ms);
     };
 
+    // SafeQueue的成员函数定义放在头文件中，其他元素类型（如事件循环的任务队列）可以直接实例化
+    template <typename T>
+    bool SafeQueue<T>::push(T&& value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if(m_isExited)
+            return false;
+
+        if(m_capacity > 0 && m_items.size() >= m_capacity)
+            return false;
+
+        m_items.push_back(std::move(value));
+
+        // 唤醒一个等待的消费者线程
+        m_condReady.notify_one();
+        return true;
+    }
+
+    template <typename T>
+    void SafeQueue<T>::waitReady(std::unique_lock<std::mutex>& lock, int waitTime_ms)
+    {
+        if (waitTime_ms == 0) {
+            return; // 非阻塞
+        }
+
+        auto pred = [this] { return m_isExited || !m_items.empty(); };
+
+        if (waitTime_ms == kWaitInfinite) {
+            m_condReady.wait(lock, pred);
+        } else {
+            auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(waitTime_ms);
+            m_condReady.wait_until(lock, timeout, pred);
+        }
+    }
+
+    template <typename T>
+    bool SafeQueue<T>::popWait(T* value, int waitTime_ms)
+    {
+        if(value == nullptr)
+            throw std::invalid_argument("SafeQueue::popWait(): value pointer is null");
+
+        // 支持条件变量等待的锁
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        waitReady(lock, waitTime_ms);
+
+        if(m_items.empty())
+            return false;
+
+        // 移动元素到输出参数，然后从队列中移除
+        *value = std::move(m_items.front());
+        m_items.pop_front();
+
+        return true;
+    }
+
+    template <typename T>
+    size_t SafeQueue<T>::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_items.size();
+    }
+
+    template <typename T>
+    void SafeQueue<T>::exit()
+    {
+        // 原子操作，确保只执行一次退出逻辑
+        if(m_isExited.exchange(true))
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_condReady.notify_all();
+    }
+
+    template <typename T>
+    bool SafeQueue<T>::isExited() const noexcept
+    {
+        return m_isExited;
+    }
+
     // 任务类型定义(函数对象)
     // 线程池执行的任务需符合此类型,可封装普通函数/lambda表达式/函数指针或具有operator()的类对象
-    using Task = std::function<void()>;
+    // 不超过48字节的可调用对象内联存储，投递任务时不再额外分配堆内存；任务只能移动
+    using Task = InlineFunction<void()>;
 
     // SafeQueue<Task>的显式实例化声明
     // 避免模版在多个编译单元中重复实例化,减少编译时间与二进制体积
@@ -134,6 +218,8 @@ namespace handy
      *        2. 适用于高并发任务调度场景(如网络服务/批量计算)
      * @note 1. 禁止拷贝与移动,确保线程资源的唯一管理
      *       2. 任务执行异常不会导致线程退出
+     *       3. 工作线程按"前缀-下标"命名（默认handy-pool-0、handy-pool-1...），
+     *          线程名与CPU绑定须在start()之前设置（构造时isStartImmediately传false）
     */
     class ThreadPool : private NonCopyAble
     {
@@ -166,6 +252,19 @@ namespace handy
             */
             ThreadPool& operator=(ThreadPool&&) = delete;
 
+            /**
+             * @brief 设置工作线程的名称前缀（线程名为"前缀-下标"，默认前缀为handy-pool）
+             * @note 须在start()之前调用
+            */
+            ThreadPool& setThreadName(const std::string& prefix);
+
+            /**
+             * @brief 设置工作线程绑定的CPU集合
+             * @param cpuSets 第i个工作线程绑定到cpuSets[i % cpuSets.size()]（为空时不绑定）
+             * @note 须在start()之前调用
+            */
+            ThreadPool& setCpuAffinity(const std::vector<std::vector<int>>& cpuSets);
+
             /**
              * @brief 启动线程池（线程安全）
              * @throw std::logic_error 当线程池已退出时抛出
@@ -243,6 +342,17 @@ namespace handy
             // 线程池退出标志（原子变量）
             std::atomic<bool> m_isExited;
 
+            // 工作线程的名称前缀
+            std::string m_threadName;
+
+            // 工作线程绑定的CPU集合（为空时不绑定）
+            std::vector<std::vector<int>> m_cpuSets;
+
+            /**
+             * @brief 设置第idx个工作线程的名称与CPU绑定（在该线程中调用）
+            */
+            void _setupThread(size_t idx);
+
             /**
              * @brief 线程工作循环（每个线程的入口函数，仅内部调用）
              * @note 1. 线程启动后持续循环：从任务队列取任务
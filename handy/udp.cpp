@@ -6,6 +6,7 @@
 #include "udp.h"
 #include "fcntl.h"
 #include "logger.h"
+#include "daemon.h"
 
 namespace handy
 {
@@ -20,22 +21,21 @@ namespace handy
     {
         if(m_channel)
         {
+            Daemon::removeListenFd(m_channel->getFd());
             // 在事件循环线程中安全删除通道
             m_base->safeCall([this]() { delete m_channel; });
             m_channel = nullptr;
         }
     }
 
-    int UdpServer::bind(const std::string& host, unsigned short port, bool isReusePort)
+    int UdpServer::_createSocket(bool isReusePort)
     {
-        m_addr = Ipv4Addr(host, port);
-
         // 创建UDP套接字
         int fd = socket(AF_INET, SOCK_DGRAM, 0);
         if(fd < 0)
         {
             ERROR("Create socket failed: errno=%d, msg=%s", errno, strerror(errno));
-            return errno;
+            return -1;
         }
 
         // 设置地址复用
@@ -44,7 +44,7 @@ namespace handy
         {
             ERROR("Set reuse addr failed: errno=%d, msg=%s", errno, strerror(errno));
             close(fd);
-            return errno;
+            return -1;
         }
 
         // 设置端口复用
@@ -55,7 +55,7 @@ namespace handy
             {
                 ERROR("Set reuse port failed: errno=%d, msg=%s", errno, strerror(errno));
                 close(fd);
-                return errno;
+                return -1;
             }
         }
 
@@ -65,7 +65,7 @@ namespace handy
         {
             ERROR("Set FD_CLOEXEC failed: errno=%d, msg=%s", errno, strerror(errno));
             close(fd);
-            return errno;
+            return -1;
         }
 
         // 绑定地址
@@ -75,7 +75,7 @@ namespace handy
         {
             ERROR("Bind to %s failed: errno=%d, msg=%s", m_addr.toString(), errno, strerror(errno));
             close(fd);
-            return errno;
+            return -1;
         }
 
         // 设置非阻塞模式
@@ -83,8 +83,25 @@ namespace handy
         {
             ERROR("Set non-block failed: errno=%d, msg=%s", errno, strerror(errno));
             close(fd);
-            return errno;
+            return -1;
         }
+        return fd;
+    }
+
+    int UdpServer::bind(const std::string& host, unsigned short port, bool isReusePort)
+    {
+        m_addr = Ipv4Addr(host, port);
+        const std::string key = "udp:" + m_addr.toString();
+
+        // 平滑重启：优先使用上一个进程交接过来的Socket（已绑定且为非阻塞模式）
+        int fd = Daemon::takeInheritedFd(key);
+        if(fd >= 0)
+            INFO("UDP server adopt inherited fd %d at %s", fd, m_addr.toString().c_str());
+        else
+            fd = _createSocket(isReusePort);
+        if(fd < 0)
+            return errno;
+        Daemon::addListenFd(key, fd);
 
         INFO("UDP server(fd=%d) bind to %s success", fd, m_addr.toString().c_str());
 
@@ -260,7 +277,7 @@ namespace handy
                 return;
             }
 
-            TRACE("UDP connection(fd=%d) recving...");
+            TRACE("UDP connection(fd=%d) recving...", conn->m_channel->getFd());
 
             Buffer input;
             int fd = conn->m_channel->getFd();
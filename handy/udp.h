@@ -162,6 +162,7 @@ namespace handy
              * @param port 绑定的端口号
              * @param isReusePort 是否复用端口
              * @return int 0: 成功; -1: 失败
+             * @note 平滑重启时优先使用上一个进程通过Daemon::handoff()交接过来的同地址Socket
             */
             int bind(const std::string& host, unsigned short port, bool isReusePort = false);
 
@@ -228,6 +229,13 @@ namespace handy
             Ipv4Addr m_addr = Ipv4Addr(0);                    // 服务器绑定的地址
             Channel* m_channel = nullptr;       // 通道对象
             ServerMsgCallBack m_serverMsgCallback;          // 消息处理回调函数
+
+            /**
+             * @brief 创建、绑定UDP套接字并设置为非阻塞模式
+             * @param isReusePort 是否复用端口
+             * @return int 套接字fd，-1: 失败（errno为失败原因）
+            */
+            int _createSocket(bool isReusePort);
     };
 
     /**
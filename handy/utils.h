@@ -1,5 +1,6 @@
 #pragma once
 #include "non_copy_able.h"
+#include "format.h"
 #include <string>
 #include <cstring>
 #include <functional>
@@ -16,13 +17,34 @@ namespace handy
         /**
          * @brief 格式化字符串
          * @param fmt 格式化字符串
-         * @param ... 可变参数列表
+         * @param args 格式化参数
          * @return 格式化后的std::string（空字符串表示失败）
-         * @note 1. 自动调整缓冲区大小，最大限制1MB（防止内存耗尽
-         * @note 2. 支持所有printf兼容的占位符（%d/%s/%f等）
-         * @note 3. 线程安全，内部使用vsnprintf实现
+         * @note 1. 先格式化到栈上的缓冲区，放不下时按所需长度分配一次，最大限制1MB（防止内存耗尽）
+         * @note 2. 支持printf兼容的占位符（%d/%s/%f等），参数按实际类型格式化（见format.h），std::string可以直接传给%s
+         * @note 3. 线程安全
          */
-        static std::string format(const char* fmt, ...) noexcept;
+        template <class... Args>
+        static std::string format(const char* fmt, const Args&... args) noexcept
+        {
+            // 最大结果限制（1MB，防止恶意输入导致内存溢出）
+            const size_t maxBufSize = 1024 * 1024;
+            try
+            {
+                char buf[512];
+                size_t len = formatTo(buf, sizeof(buf), fmt, args...);
+                if(len < sizeof(buf))
+                    return std::string(buf, len);
+                if(len + 1 > maxBufSize)
+                    return "";
+                std::string result(len, '\0');
+                formatTo(&result[0], len + 1, fmt, args...);
+                return result;
+            }
+            catch(...)
+            {
+                return "";
+            }
+        }
 
         /**
          * @brief 获取当前系统时间(微秒级，线程安全)
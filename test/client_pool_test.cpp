@@ -0,0 +1,345 @@
+#include "client_pool.h"
+#include "logger.h"
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <map>
+#include <iostream>
+
+namespace handy {
+namespace clientPoolTest {
+
+// 连接池测试端口（每个测试使用不同的端口）
+static const unsigned short kPoolPort = 12390;
+
+// -------------------------- 测试辅助函数 --------------------------
+/**
+ * @brief 初始化Logger（输出到client_pool_test.log）
+ */
+void initTestLogger() {
+    Logger::getInstance().setLogFileName("client_pool_test.log");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+    INFO("=== client_pool_test 测试开始 ===");
+}
+
+/**
+ * @brief 等待条件成立（最多等待timeout_ms毫秒）
+ */
+template <typename Pred>
+bool waitFor(Pred pred, int timeout_ms = 3000) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * @brief 测试服务端：原样带回请求ID回显内容
+ * @details "slow"开头的请求200ms后回复，"drop"不回复，"close"关闭连接；
+ *          内容为空的健康探测在dropProbes为true时不回复
+ */
+struct EchoServer {
+    EventBase base;
+    TcpServer::Ptr server;
+    std::thread thread;
+    std::atomic<int> accepted{0};
+    std::atomic<bool> dropProbes{false};
+    std::atomic<int> probes{0};
+    std::mutex mutex;
+    std::map<int, int> requestsPerConn;  // fd -> 请求数
+
+    explicit EchoServer(unsigned short port) {
+        server = TcpServer::startServer(&base, "127.0.0.1", port);
+        server->onConnState([this](const TcpConnPtr& c) {
+            if (c->getState() == TcpConn::State::CONNECTED) {
+                ++accepted;
+            }
+        });
+        server->onConnMsg(std::unique_ptr<CodecBase>(new LengthCodec()), [this](const TcpConnPtr& c, const Slice& msg) {
+            uint64_t id = 0;
+            Slice body;
+            if (!TcpClientPool::parseFrame(msg, id, body)) {
+                c->close();
+                return;
+            }
+            std::string req = body.toString();
+            if (req.empty()) {
+                ++probes;
+                if (!dropProbes) {
+                    c->sendMsg(TcpClientPool::makeFrame(id, Slice()));
+                }
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++requestsPerConn[c->getChannel()->getFd()];
+            }
+            if (req == "drop") {
+                return;
+            }
+            if (req == "close") {
+                c->close();
+                return;
+            }
+            std::string frame = TcpClientPool::makeFrame(id, "echo:" + req);
+            if (req.compare(0, 4, "slow") == 0) {
+                c->getBase()->runAfter(200, [c, frame] { c->sendMsg(frame); });
+            } else {
+                c->sendMsg(frame);
+            }
+        });
+        thread = std::thread([this] { base.loop(); });
+    }
+
+    ~EchoServer() {
+        base.exit();
+        thread.join();
+    }
+};
+
+/**
+ * @brief 在后台线程中运行的多线程事件循环（客户端）
+ */
+struct ClientLoops {
+    MultiBase bases;
+    std::thread thread;
+
+    explicit ClientLoops(int n) : bases(n), thread([this] { bases.loop(); }) {}
+    ~ClientLoops() {
+        bases.exit();
+        thread.join();
+    }
+};
+
+/**
+ * @brief 同步发送一个请求并等待响应
+ * @return int 1：成功且响应为expected，0：失败回调，-1：响应不符或超时未回调
+ */
+int requestSync(const TcpClientPool::Ptr& pool, const std::string& body, const std::string& expected,
+                int timeout_ms = 3000) {
+    std::atomic<int> result{-2};
+    pool->request(body, [&](bool ok, const Slice& resp) {
+        result = !ok ? 0 : (resp.toString() == expected ? 1 : -1);
+    });
+    if (!waitFor([&] { return result != -2; }, timeout_ms)) {
+        return -1;
+    }
+    return result;
+}
+
+// -------------------------- 测试用例 --------------------------
+/**
+ * @brief 测试流水线请求：大量并发请求按请求ID匹配响应，分散到所有连接
+ */
+void test_ClientPool_pipeline() {
+    DEBUG("=== 开始流水线请求测试 ===");
+    EchoServer server(kPoolPort);
+    ClientLoops loops(2);
+    TcpClientPool::Options opts;
+    opts.connections = 4;
+    TcpClientPool::Ptr pool = TcpClientPool::create(&loops.bases, "127.0.0.1", kPoolPort, opts);
+
+    bool connected = waitFor([&] { return pool->getConnected() == 4; });
+    DEBUG("建立4条连接（%s）", connected ? "通过" : "失败");
+
+    const int kRequests = 2000;
+    std::atomic<int> okCount{0}, badCount{0};
+    for (int i = 0; i < kRequests; ++i) {
+        std::string body = "req-" + std::to_string(i);
+        pool->request(body, [&, body](bool ok, const Slice& resp) {
+            if (ok && resp.toString() == "echo:" + body) {
+                ++okCount;
+            } else {
+                ++badCount;
+            }
+        });
+    }
+    bool allDone = waitFor([&] { return okCount + badCount == kRequests; });
+    DEBUG("%d个请求全部按ID匹配到响应: ok=%d, bad=%d（%s）", kRequests, okCount.load(), badCount.load(),
+          allDone && okCount == kRequests ? "通过" : "失败");
+
+    int minPerConn = kRequests;
+    {
+        std::lock_guard<std::mutex> lock(server.mutex);
+        for (auto& kv : server.requestsPerConn) {
+            minPerConn = std::min(minPerConn, kv.second);
+        }
+        DEBUG("请求分散到所有连接: 连接数=%zu, 最少的连接处理%d个（%s）", server.requestsPerConn.size(), minPerConn,
+              server.requestsPerConn.size() == 4 && minPerConn > kRequests / 16 ? "通过" : "失败");
+    }
+    DEBUG("请求全部完成后未完成数归零（%s）", pool->getInflight() == 0 ? "通过" : "失败");
+
+    // 慢请求不阻塞同一连接上之后的请求，响应可以乱序返回
+    TcpClientPool::Options one;
+    one.connections = 1;
+    TcpClientPool::Ptr single = TcpClientPool::create(&loops.bases, "127.0.0.1", kPoolPort, one);
+    waitFor([&] { return single->getConnected() == 1; });
+    std::atomic<int> order{0}, slowOrder{0}, fastOrder{0};
+    single->request("slow-1", [&](bool ok, const Slice& resp) {
+        slowOrder = ok && resp.toString() == "echo:slow-1" ? ++order : -1;
+    });
+    single->request("fast-1", [&](bool ok, const Slice& resp) {
+        fastOrder = ok && resp.toString() == "echo:fast-1" ? ++order : -1;
+    });
+    waitFor([&] { return order == 2; });
+    DEBUG("同一连接上的响应乱序返回: fast=%d, slow=%d（%s）", fastOrder.load(), slowOrder.load(),
+          fastOrder == 1 && slowOrder == 2 ? "通过" : "失败");
+
+    pool->close();
+    single->close();
+    DEBUG("=== 流水线请求测试结束 ===\n");
+}
+
+/**
+ * @brief 测试请求超时与连接断开：未响应的请求以失败结束，连接断开后自动重连
+ */
+void test_ClientPool_failures() {
+    DEBUG("=== 开始请求失败测试 ===");
+    EchoServer server(kPoolPort + 1);
+    ClientLoops loops(1);
+    TcpClientPool::Options opts;
+    opts.connections = 1;
+    opts.requestTimeout_ms = 200;
+    opts.backoffBase_ms = 50;
+    TcpClientPool::Ptr pool = TcpClientPool::create(&loops.bases, "127.0.0.1", kPoolPort + 1, opts);
+    waitFor([&] { return pool->getConnected() == 1; });
+
+    auto start = std::chrono::steady_clock::now();
+    int r = requestSync(pool, "drop", "");
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    DEBUG("无响应的请求超时失败: %lld ms（%s）", (long long)cost, r == 0 && cost >= 190 && cost < 1000 ? "通过" : "失败");
+
+    // 服务端关闭连接：已发出的请求失败，随后重连，新请求成功
+    std::atomic<int> lostResult{-2};
+    pool->request("slow-lost", [&](bool ok, const Slice&) { lostResult = ok ? 1 : 0; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    r = requestSync(pool, "close", "");
+    waitFor([&] { return lostResult != -2; });
+    DEBUG("连接断开时已发出的请求失败（%s）", r == 0 && lostResult == 0 ? "通过" : "失败");
+
+    bool reconnected = waitFor([&] { return server.accepted == 2 && pool->getConnected() == 1; });
+    r = requestSync(pool, "after", "echo:after");
+    DEBUG("断开后自动重连，新请求成功（%s）", reconnected && r == 1 ? "通过" : "失败");
+
+    pool->close();
+    r = requestSync(pool, "closed", "");
+    DEBUG("关闭后的请求立即失败（%s）", r == 0 ? "通过" : "失败");
+    DEBUG("=== 请求失败测试结束 ===\n");
+}
+
+/**
+ * @brief 测试健康探测：空闲连接发送探测，探测超时则关闭连接并重连
+ */
+void test_ClientPool_healthCheck() {
+    DEBUG("=== 开始健康探测测试 ===");
+    EchoServer server(kPoolPort + 2);
+    ClientLoops loops(1);
+    TcpClientPool::Options opts;
+    opts.connections = 1;
+    opts.healthCheck_s = 1;
+    opts.healthTimeout_ms = 300;
+    opts.backoffBase_ms = 50;
+    TcpClientPool::Ptr pool = TcpClientPool::create(&loops.bases, "127.0.0.1", kPoolPort + 2, opts);
+    waitFor([&] { return pool->getConnected() == 1; });
+
+    bool probed = waitFor([&] { return server.probes >= 1; }, 4000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    DEBUG("空闲连接收到健康探测，探测成功时连接保持（%s）", probed && server.accepted == 1 ? "通过" : "失败");
+
+    server.dropProbes = true;
+    bool reconnected = waitFor([&] { return server.accepted >= 2; }, 5000);
+    DEBUG("探测超时后关闭连接并重连（%s）", reconnected ? "通过" : "失败");
+    server.dropProbes = false;
+    waitFor([&] { return pool->getConnected() == 1; });
+    int r = requestSync(pool, "ok", "echo:ok");
+    DEBUG("重连后请求成功（%s）", r == 1 ? "通过" : "失败");
+
+    pool->close();
+    DEBUG("=== 健康探测测试结束 ===\n");
+}
+
+/**
+ * @brief 测试指数退避重连：服务端不可用时重连间隔逐渐增大，服务端恢复后连接建立；排队的请求在连接后发出
+ */
+void test_ClientPool_backoff() {
+    DEBUG("=== 开始退避重连测试 ===");
+    Counter& reconnects = MetricsRegistry::instance().counter("handy_client_reconnects_total", "");
+    ClientLoops loops(1);
+    TcpClientPool::Options opts;
+    opts.connections = 1;
+    opts.backoffBase_ms = 20;
+    opts.backoffMax_ms = 400;
+    opts.requestTimeout_ms = 0;
+    int64_t before = reconnects.value();
+    TcpClientPool::Ptr pool = TcpClientPool::create(&loops.bases, "127.0.0.1", kPoolPort + 3, opts);
+
+    // 退避：10~20、20~40、40~80、80~160、160~320、200~400...，1.5秒内约7~10次（固定20ms间隔约为70次）
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    int64_t attempts = reconnects.value() - before;
+    DEBUG("服务端不可用时按指数退避重连: 1.5秒内%lld次（%s）", (long long)attempts,
+          attempts >= 5 && attempts <= 12 ? "通过" : "失败");
+
+    // 没有可用连接时请求排队，连接建立后发出
+    std::atomic<int> queued{-2};
+    pool->request("queued", [&](bool ok, const Slice& resp) {
+        queued = ok && resp.toString() == "echo:queued" ? 1 : 0;
+    });
+    EchoServer server(kPoolPort + 3);
+    bool connected = waitFor([&] { return pool->getConnected() == 1; });
+    waitFor([&] { return queued != -2; });
+    DEBUG("服务端恢复后连接建立（最长退避400ms）（%s）", connected ? "通过" : "失败");
+    DEBUG("排队的请求在连接建立后发出（%s）", queued == 1 ? "通过" : "失败");
+
+    pool->close();
+    DEBUG("=== 退避重连测试结束 ===\n");
+}
+
+/**
+ * @brief 测试按(host, port)获取共享的连接池
+ */
+void test_ClientPool_registry() {
+    DEBUG("=== 开始连接池注册表测试 ===");
+    ClientLoops loops(1);
+    TcpClientPool::Ptr a = TcpClientPool::get(&loops.bases, "127.0.0.1", kPoolPort + 4);
+    TcpClientPool::Ptr b = TcpClientPool::get(&loops.bases, "127.0.0.1", kPoolPort + 4);
+    TcpClientPool::Ptr c = TcpClientPool::get(&loops.bases, "127.0.0.1", kPoolPort + 5);
+    DEBUG("相同(host, port)返回同一个连接池（%s）", a == b && a != c ? "通过" : "失败");
+    a->close();
+    TcpClientPool::Ptr d = TcpClientPool::get(&loops.bases, "127.0.0.1", kPoolPort + 4);
+    DEBUG("关闭后重新创建（%s）", d != a ? "通过" : "失败");
+    c->close();
+    d->close();
+    DEBUG("=== 连接池注册表测试结束 ===\n");
+}
+
+// -------------------------- 测试入口函数 --------------------------
+void run_all_tests() {
+    // 1. 初始化日志
+    initTestLogger();
+
+    // 2. 执行所有测试
+    test_ClientPool_pipeline();
+    test_ClientPool_failures();
+    test_ClientPool_healthCheck();
+    test_ClientPool_backoff();
+    test_ClientPool_registry();
+
+    // 3. 测试总结
+    INFO("=== client_pool_test 所有测试执行完成 ===");
+}
+
+}  // namespace clientPoolTest
+}  // namespace handy
+
+// 主函数：启动测试
+int main() {
+    handy::clientPoolTest::run_all_tests();
+    return 0;
+}
@@ -1,11 +1,17 @@
 #include "conf.h"
 #include "logger.h"  // 假设Logger类声明在此头文件中
+#include "event_base.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
 #include <fstream>
 #include <vector>
 #include <cassert>
 #include <algorithm>
 #include <thread>
 #include <atomic>
+#include <sys/stat.h>
 
 // 测试用全局原子变量（用于多线程测试计数）
 std::atomic<int> g_threadTestCount(0);
@@ -308,8 +314,28 @@ Key = Value
     bool defaultsOk = (defStr == "default" && defInt == 123 && defBool == true);
     DEBUG("默认值测试: %s", defaultsOk ? "通过" : "失败");
 
+    // 测试4: 大小报告为0的文件（FIFO）：Conf::parse按read()读取全部内容
+    const std::string fifoFile = "fifo_test.ini";
+    deleteTempIniFile(fifoFile);
+    bool fifoOk = mkfifo(fifoFile.c_str(), 0600) == 0;
+    if (fifoOk) {
+        std::thread writer([&fifoFile] { createTempIniFile("[Fifo]\nKey = FromPipe\n", fifoFile); });
+        Conf conf4;
+        int ret4 = conf4.parse(fifoFile);
+        writer.join();
+        fifoOk = ret4 == 0 && conf4.get("Fifo", "Key", "") == "FromPipe";
+    }
+    DEBUG("FIFO文件测试（%s）", fifoOk ? "通过" : "失败");
+
+    // 测试5: 来自procfs的文件（st_size为0）不会被当作空文件
+    Conf conf5;
+    int ret5 = conf5.parse("/proc/self/status");
+    DEBUG("procfs文件测试: 返回值=%d, Name=%s（%s）", ret5, conf5.get("", "Name", "").c_str(),
+          ret5 == 0 && !conf5.get("", "Name", "").empty() ? "通过" : "失败");
+
     deleteTempIniFile(badFile);
     deleteTempIniFile(goodFile);
+    deleteTempIniFile(fifoFile);
     DEBUG("=== 错误处理和边界情况测试结束 ===\n");
 }
 
@@ -370,6 +396,221 @@ Value4 = test_string
     DEBUG("=== 线程安全特性测试结束 ===\n");
 }
 
+/**
+ * @brief 等待条件成立（最多等待timeout_ms毫秒）
+ */
+template <typename Pred>
+bool waitFor(Pred pred, int timeout_ms = 3000) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * @brief 写临时文件后rename替换目标文件（配置文件的原子替换方式）
+ */
+bool replaceIniFile(const std::string& content, const std::string& filename) {
+    std::string tmp = filename + ".tmp";
+    return createTempIniFile(content, tmp) && std::rename(tmp.c_str(), filename.c_str()) == 0;
+}
+
+/**
+ * @brief 测试ConfSnapshot：与Conf的解析结果一致，值指向映射内存
+ */
+void test_snapshot() {
+    DEBUG("=== 开始测试ConfSnapshot ===");
+    const std::string iniContent = R"(
+; 注释
+[Server]
+Port = 8080
+Hex = 0x1a3f
+Ratio = 1.23e-4
+EnableSSL = Yes
+Name = handy
+[List]
+Items = item1
+  item2
+  item3
+[Database]
+Host: localhost
+)";
+    const std::string tempFile = "snapshot_test.ini";
+    createTempIniFile(iniContent, tempFile);
+
+    Conf conf;
+    conf.parse(tempFile);
+    int err = -2;
+    ConfSnapshot::Ptr snap = ConfSnapshot::load(tempFile, &err);
+    bool ok = snap && err == 0 && snap->size() == 7;
+    DEBUG("加载快照: err=%d, 键数量=%zu（%s）", err, snap ? snap->size() : 0, ok ? "通过" : "失败");
+    if (!snap) {
+        deleteTempIniFile(tempFile);
+        return;
+    }
+
+    ok = snap->getInteger("server", "PORT", -1) == conf.getInteger("Server", "Port", -2)
+         && snap->getInteger("Server", "Hex", -1) == 0x1a3f
+         && snap->getReal("Server", "Ratio", -1) == conf.getReal("Server", "Ratio", -2)
+         && snap->getBoolean("Server", "EnableSSL", false)
+         && snap->get("Database", "Host") == "localhost"
+         && snap->get("Server", "Name") == conf.get("Server", "Name", "");
+    DEBUG("类型值与Conf一致，大小写不敏感（%s）", ok ? "通过" : "失败");
+
+    const std::vector<Slice>& items = snap->getStrings("List", "Items");
+    std::list<std::string> expected = conf.getStrings("List", "Items");
+    ok = items.size() == 3 && std::equal(items.begin(), items.end(), expected.begin(),
+                                         [](const Slice& a, const std::string& b) { return a == b; });
+    DEBUG("多行值: 数量=%zu（预期: 3，%s）", items.size(), ok ? "通过" : "失败");
+
+    ok = snap->get("Server", "Missing", "def") == "def" && snap->getInteger("Server", "Name", 7) == 7
+         && !snap->getBoolean("Server", "Port", false) && snap->getStrings("No", "Such").empty();
+    DEBUG("缺失键与无法解析的值返回默认值（%s）", ok ? "通过" : "失败");
+
+    // 格式错误与文件不存在
+    ConfSnapshot::Ptr bad = ConfSnapshot::load("nonexistent_file.ini", &err);
+    ok = !bad && err == -1;
+    createTempIniFile("[BadSection\nKey = Value\n", "bad_snapshot_test.ini");
+    bad = ConfSnapshot::load("bad_snapshot_test.ini", &err);
+    ok = ok && !bad && err == 1;
+    DEBUG("文件不存在返回-1，格式错误返回行号（%s）", ok ? "通过" : "失败");
+
+    deleteTempIniFile("bad_snapshot_test.ini");
+    deleteTempIniFile(tempFile);
+    DEBUG("=== ConfSnapshot测试结束 ===\n");
+}
+
+/**
+ * @brief 测试MappedConf热加载：rename替换与原地写入都触发重新加载，读线程持续读取不受影响，格式错误时保留旧快照
+ */
+void test_hot_reload() {
+    DEBUG("=== 开始测试MappedConf热加载 ===");
+    const std::string tempFile = "reload_test.ini";
+    createTempIniFile("[Route]\nVersion = 1\nTarget = a\n", tempFile);
+
+    MappedConf conf;
+    bool ok = conf.load(tempFile) == 0 && conf.getInteger("Route", "Version", 0) == 1 && conf.getVersion() == 1;
+    DEBUG("首次加载: Version=%ld（%s）", conf.getInteger("Route", "Version", 0), ok ? "通过" : "失败");
+
+    EventBase base;
+    std::atomic<int> reloads{0}, lastResult{0};
+    ok = conf.watch(&base, [&](int r) {
+        lastResult = r;
+        ++reloads;
+    });
+    std::thread th([&base] { base.loop(); });
+    DEBUG("开始监视（%s）", ok ? "通过" : "失败");
+
+    // 读线程持续读取：只能看到完整的旧值或新值
+    std::atomic<bool> stop{false};
+    std::atomic<long> reads{0}, torn{0};
+    std::thread reader([&] {
+        while (!stop) {
+            ConfSnapshot::Ptr snap = conf.snapshot();
+            long v = snap->getInteger("Route", "Version", 0);
+            Slice target = snap->get("Route", "Target");
+            if (v <= 0 || target.size() != 1 || target[0] != static_cast<char>('a' + v - 1)) {
+                ++torn;
+            }
+            ++reads;
+        }
+    });
+
+    // rename替换
+    for (int v = 2; v <= 5; ++v) {
+        std::string content = "[Route]\nVersion = " + std::to_string(v) + "\nTarget = " + std::string(1, 'a' + v - 1) + "\n";
+        replaceIniFile(content, tempFile);
+        waitFor([&] { return conf.getInteger("Route", "Version", 0) == v; });
+    }
+    ok = conf.getInteger("Route", "Version", 0) == 5 && reloads >= 4 && lastResult == 0;
+    DEBUG("rename替换后自动重新加载: Version=%ld, 重新加载%d次（%s）", conf.getInteger("Route", "Version", 0),
+          reloads.load(), ok ? "通过" : "失败");
+
+    // 格式错误：保留旧快照
+    int before = reloads;
+    uint64_t version = conf.getVersion();
+    replaceIniFile("[Route\nVersion = 7\n", tempFile);
+    ok = waitFor([&] { return reloads > before; }) && lastResult > 0 && conf.getVersion() == version
+         && conf.getInteger("Route", "Version", 0) == 5;
+    DEBUG("格式错误时保留旧快照: result=%d（%s）", lastResult.load(), ok ? "通过" : "失败");
+
+    stop = true;
+    reader.join();
+    ok = torn == 0 && reads > 0;
+    DEBUG("读线程读取%ld次，不一致%ld次（%s）", reads.load(), torn.load(), ok ? "通过" : "失败");
+
+    // 原地写入（写入关闭后重新加载）：改写已映射的文件会影响旧快照，只在没有读线程时进行
+    createTempIniFile("[Route]\nVersion = 6\nTarget = f\n", tempFile);
+    ok = waitFor([&] { return conf.getInteger("Route", "Version", 0) == 6; });
+    DEBUG("原地写入后自动重新加载（%s）", ok ? "通过" : "失败");
+
+    base.safeCall([&] { conf.unwatch(); base.exit(); });
+    th.join();
+    deleteTempIniFile(tempFile);
+    DEBUG("=== MappedConf热加载测试结束 ===\n");
+}
+
+/**
+ * @brief 基准：大配置文件上Conf与MappedConf的加载时间与每次查询耗时
+ */
+void test_mapped_benchmark() {
+    DEBUG("=== 开始测试配置查询基准 ===");
+    const int kSections = 100, kKeys = 1000;
+    const std::string tempFile = "bench_test.ini";
+    {
+        std::ofstream ofs(tempFile);
+        for (int s = 0; s < kSections; ++s) {
+            ofs << "[route" << s << "]\n";
+            for (int k = 0; k < kKeys; ++k) {
+                ofs << "backend" << k << " = " << (s * kKeys + k) << "\n";
+            }
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    Conf conf;
+    int r1 = conf.parse(tempFile);
+    auto t1 = std::chrono::steady_clock::now();
+    MappedConf mapped;
+    int r2 = mapped.load(tempFile);
+    auto t2 = std::chrono::steady_clock::now();
+
+    const int kLookups = 200000;
+    std::vector<std::pair<std::string, std::string>> keys;
+    for (int i = 0; i < 1000; ++i) {
+        int s = (i * 37) % kSections, k = (i * 101) % kKeys;
+        keys.emplace_back("route" + std::to_string(s), "backend" + std::to_string(k));
+    }
+    long sum1 = 0, sum2 = 0;
+    auto t3 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kLookups; ++i) {
+        auto& key = keys[i % keys.size()];
+        sum1 += conf.getInteger(key.first, key.second, 0);
+    }
+    auto t4 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kLookups; ++i) {
+        auto& key = keys[i % keys.size()];
+        sum2 += mapped.getInteger(key.first, key.second, 0);
+    }
+    auto t5 = std::chrono::steady_clock::now();
+
+    auto ms = [](auto a, auto b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    auto ns = [&](auto a, auto b) { return std::chrono::duration<double, std::nano>(b - a).count() / kLookups; };
+    INFO("%d个键: Conf加载%.1fms、查询%.0fns/次；MappedConf加载%.1fms、查询%.0fns/次", kSections * kKeys,
+         ms(t0, t1), ns(t3, t4), ms(t1, t2), ns(t4, t5));
+    std::cout << "Conf: load " << ms(t0, t1) << " ms, getInteger " << ns(t3, t4) << " ns" << std::endl;
+    std::cout << "MappedConf: load " << ms(t1, t2) << " ms, getInteger " << ns(t4, t5) << " ns" << std::endl;
+    bool ok = r1 == 0 && r2 == 0 && sum1 == sum2 && sum1 > 0;
+    DEBUG("两种方式查询结果一致（%s）", ok ? "通过" : "失败");
+
+    deleteTempIniFile(tempFile);
+    DEBUG("=== 配置查询基准测试结束 ===\n");
+}
+
 // -------------------------- 测试入口函数 --------------------------
 void run_all_tests() {
     // 1. 初始化日志
@@ -382,6 +623,9 @@ void run_all_tests() {
     test_data_types();
     test_error_handling();
     test_thread_safety();
+    test_snapshot();
+    test_hot_reload();
+    test_mapped_benchmark();
 
     // 3. 测试总结
     INFO("=== conf_test 所有测试执行完成 ===");
@@ -0,0 +1,1168 @@
+#include "conn.h"
+#include "logger.h"
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <atomic>
+#include <iostream>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <algorithm>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// -------------------------- 堆分配计数 --------------------------
+// 替换全局operator new，统计进程内的堆分配次数
+static std::atomic<long> g_allocs{0};
+
+void* operator new(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace handy {
+namespace connTest {
+
+// TCP连接测试端口
+static const unsigned short kConnPort = 12352;
+
+// -------------------------- 测试辅助函数 --------------------------
+/**
+ * @brief 初始化Logger（输出到conn_test.log）
+ */
+void initTestLogger() {
+    Logger::getInstance().setLogFileName("conn_test.log");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+    INFO("=== conn_test 测试开始 ===");
+}
+
+/**
+ * @brief 用阻塞socket连接本地端口
+ * @return int 连接的fd（失败返回-1）
+ */
+int connectLocal(unsigned short port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    timeval tv{3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+/**
+ * @brief 读取CPU时间戳计数器（非x86平台返回0）
+ */
+inline uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief 等待条件成立（最多等待timeout_ms毫秒）
+ */
+template <typename Pred>
+bool waitFor(Pred pred, int timeout_ms = 3000) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// -------------------------- 测试用例 --------------------------
+/**
+ * @brief 测试InlineFunction：内联存储不分配堆内存，只能移动的可调用对象，以及超出缓冲区时的退化
+ */
+void test_InlineFunction() {
+    DEBUG("=== 开始InlineFunction测试 ===");
+    // 1. 捕获一个shared_ptr与若干整数的lambda：构造、移动、调用都不分配
+    auto conn = std::make_shared<int>(7);
+    int a = 1, b = 2, c = 3;
+    long before = g_allocs.load();
+    int sum = 0;
+    Task task = [conn, a, b, c, &sum] { sum = *conn + a + b + c; };
+    Task moved = std::move(task);
+    moved();
+    bool ok = g_allocs.load() == before && sum == 13 && !task && moved.isInline();
+    DEBUG("内联存储（%s）", ok ? "通过" : "失败");
+
+    // 2. 可拷贝的TcpCallBack：拷贝内联对象时同样不分配
+    TcpCallBack cb = [conn](const TcpConnPtr& p) { (void)p; };
+    long refs = conn.use_count();
+    before = g_allocs.load();
+    TcpCallBack copied = cb;
+    ok = g_allocs.load() == before && copied && cb && conn.use_count() == refs + 1;
+    DEBUG("TcpCallBack拷贝（%s）", ok ? "通过" : "失败");
+
+    // 3. 只能移动的可调用对象
+    auto owned = std::make_unique<int>(42);
+    int got = 0;
+    Task moveOnly = [p = std::move(owned), &got] { got = *p; };
+    moveOnly();
+    ok = got == 42;
+    DEBUG("只能移动的可调用对象（%s）", ok ? "通过" : "失败");
+
+    // 4. 超出内联缓冲区时退化为堆上存储
+    char big[128] = {5};
+    before = g_allocs.load();
+    Task heap = [big, &got] { got = big[0]; };
+    heap();
+    ok = got == 5 && !heap.isInline() && g_allocs.load() == before + 1;
+    DEBUG("超出内联缓冲区（%s）", ok ? "通过" : "失败");
+
+    // 5. 空对象调用抛出std::bad_function_call
+    bool thrown = false;
+    try {
+        Task empty;
+        empty();
+    } catch (const std::bad_function_call&) {
+        thrown = true;
+    }
+    DEBUG("空对象调用（%s）", thrown ? "通过" : "失败");
+    DEBUG("=== InlineFunction测试结束 ===\n");
+}
+
+/**
+ * @brief 测试BlockPool：内存块回收复用、跨线程归还，以及对象晚于对象池的创建者释放
+ */
+void test_BlockPool() {
+    DEBUG("=== 开始BlockPool测试 ===");
+    // 1. 归还后再次分配同一级别的内存块，复用刚归还的内存
+    BlockPool* pool = BlockPool::create();
+    void* a = pool->allocate(700);
+    pool->deallocate(a, 700);
+    long before = g_allocs.load();
+    void* b = pool->allocate(650);
+    bool ok = a == b && g_allocs.load() == before && pool->cached() == 0;
+    DEBUG("同级内存块复用（%s）", ok ? "通过" : "失败");
+
+    // 2. 其他线程归还的内存块同样可以被复用
+    std::thread th([pool, b] { pool->deallocate(b, 650); });
+    th.join();
+    void* c = pool->allocate(700);
+    ok = c == b;
+    DEBUG("跨线程归还（%s）", ok ? "通过" : "失败");
+
+    // 3. 创建者先释放引用，未归还的对象仍然有效，最后一个对象归还时释放对象池
+    auto conn = std::allocate_shared<std::string>(PoolAllocator<std::string>(pool), "pooled");
+    pool->deallocate(c, 700);
+    pool->release();
+    ok = *conn == "pooled";
+    conn.reset();
+    DEBUG("对象晚于创建者释放（%s）", ok ? "通过" : "失败");
+    DEBUG("=== BlockPool测试结束 ===\n");
+}
+
+/**
+ * @brief 测试AutoContext：按类型存储、内部存储区与堆分配、分片扩展、并发创建与逆序销毁
+ */
+struct CtxSmall {
+    int64_t value = 0;
+};
+struct CtxLarge {
+    char data[256] = {0};
+};
+struct CtxCounted {
+    static std::atomic<int> created;
+    static std::vector<int>* order;
+    int id;
+    CtxCounted() : id(++created) {}
+    ~CtxCounted() {
+        if (order) {
+            order->push_back(id);
+        }
+    }
+};
+std::atomic<int> CtxCounted::created{0};
+std::vector<int>* CtxCounted::order = nullptr;
+template <int N>
+struct CtxN : CtxCounted {};
+// 构造时等待一段时间后抛出异常（用于在槽位之间留下空位）
+struct CtxThrowing {
+    static std::atomic<bool> entered;
+    CtxThrowing() {
+        entered = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        throw std::runtime_error("CtxThrowing");
+    }
+};
+std::atomic<bool> CtxThrowing::entered{false};
+
+void test_AutoContext() {
+    DEBUG("=== 开始AutoContext测试 ===");
+    // 1. 不同类型的上下文互不干扰；小对象构造在内部存储区，不分配堆内存
+    std::vector<int> order;
+    CtxCounted::order = &order;
+    {
+        AutoContext ctx;
+        Logger::getInstance().setLogLevel(Logger::LogLevel::LWARN);
+        long before = g_allocs.load();
+        CtxSmall& small = ctx.context<CtxSmall>();
+        small.value = 42;
+        long allocs = g_allocs.load() - before;
+        Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+        bool ok = allocs == 0
+                  && reinterpret_cast<char*>(&small) >= reinterpret_cast<char*>(&ctx)
+                  && reinterpret_cast<char*>(&small) < reinterpret_cast<char*>(&ctx) + sizeof(ctx);
+        DEBUG("小对象构造在内部存储区，无堆分配（%s）", ok ? "通过" : "失败");
+
+        CtxLarge& large = ctx.context<CtxLarge>();
+        ok = ctx.context<CtxSmall>().value == 42 && &ctx.context<CtxLarge>() == &large
+             && ctx.find<CtxSmall>() == &small && ctx.find<std::string>() == nullptr;
+        DEBUG("多种类型共存，重复获取返回同一对象（%s）", ok ? "通过" : "失败");
+
+        // 2. 槽位用完后链接新的分片
+        ctx.context<CtxN<1>>();
+        ctx.context<CtxN<2>>();
+        ctx.context<CtxN<3>>();
+        ok = ctx.find<CtxN<3>>() != nullptr && ctx.context<CtxN<1>>().id == 1 && ctx.context<CtxN<3>>().id == 3;
+        DEBUG("超过%zu种类型时扩展分片（%s）", AutoContext::kSlots, ok ? "通过" : "失败");
+
+        // 3. 已创建的上下文访问不分配内存
+        before = g_allocs.load();
+        auto start = std::chrono::steady_clock::now();
+        const int kLoops = 10000000;
+        int64_t sum = 0;
+        for (int i = 0; i < kLoops; ++i) {
+            sum += ctx.context<CtxSmall>().value;
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kLoops;
+        allocs = g_allocs.load() - before;
+        INFO("AutoContext::context<T>() 已创建时每次 %.2f ns", ns);
+        std::cout << "AutoContext::context<T>(): " << ns << " ns/op" << std::endl;
+        ok = allocs == 0 && sum == 42LL * kLoops;
+        DEBUG("已创建时访问无堆分配（%s）", ok ? "通过" : "失败");
+    }
+    bool ok = order == std::vector<int>({3, 2, 1});
+    DEBUG("析构时按创建的逆序销毁（%s）", ok ? "通过" : "失败");
+
+    // 4. 多个线程并发获取同一类型，只创建一次
+    CtxCounted::order = nullptr;
+    ok = true;
+    for (int round = 0; round < 100 && ok; ++round) {
+        AutoContext ctx;
+        int createdBefore = CtxCounted::created.load();
+        std::vector<CtxN<4>*> got(8, nullptr);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 8; ++i) {
+            threads.emplace_back([&ctx, &got, i] {
+                ctx.context<CtxSmall>();
+                got[i] = &ctx.context<CtxN<4>>();
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        ok = CtxCounted::created.load() == createdBefore + 1
+             && std::all_of(got.begin(), got.end(), [&](CtxN<4>* p) { return p == got[0]; });
+    }
+    DEBUG("并发创建同一类型只创建一次（%s）", ok ? "通过" : "失败");
+
+    // 5. 创建失败的槽位之后有其他线程创建的上下文：find()继续查找，context<T>()不会在失败的槽位上再创建一个T
+    {
+        AutoContext ctx;
+        std::thread thrower([&ctx] {
+            try {
+                ctx.context<CtxThrowing>();
+            } catch (const std::exception&) {
+            }
+        });
+        waitFor([] { return CtxThrowing::entered.load(); });
+        CtxSmall& small = ctx.context<CtxSmall>();
+        small.value = 42;
+        thrower.join();
+        ok = ctx.find<CtxSmall>() == &small && ctx.find<CtxThrowing>() == nullptr;
+        DEBUG("失败槽位之后的上下文仍能找到（%s）", ok ? "通过" : "失败");
+
+        CtxSmall& again = ctx.context<CtxSmall>();
+        ok = &again == &small && again.value == 42 && ctx.find<CtxSmall>() == &small;
+    }
+    DEBUG("创建失败后再次获取返回原有的上下文，值不丢失（%s）", ok ? "通过" : "失败");
+    DEBUG("=== AutoContext测试结束 ===\n");
+}
+
+/**
+ * @brief 测试事件循环的对象池只交给执行loop()的线程：未运行的事件循环上两个线程同时创建连接，
+ *        不会同时从对象池分配（对象池的本地空闲链表不是线程安全的）
+ */
+void test_LocalPool_owner() {
+    DEBUG("=== 开始对象池所属线程测试 ===");
+    EventBase base;
+    bool ok = base.getLocalPool() == nullptr;
+    DEBUG("loop()启动前不返回对象池（%s）", ok ? "通过" : "失败");
+
+    // 两个线程在未运行的事件循环上反复创建、释放连接（修复前两者共用对象池的本地链表）
+    const int kRounds = 20000;
+    std::atomic<int> pooled{0}, bad{0};
+    auto worker = [&] {
+        std::vector<TcpConnPtr> conns;
+        for (int i = 0; i < kRounds; ++i) {
+            if (base.getLocalPool()) {
+                ++pooled;
+            }
+            conns.push_back(TcpConn::create(&base));
+            if (conns.size() == 8) {
+                // 同一个线程持有的连接地址各不相同，否则说明空闲链表被破坏、同一块内存分配了两次
+                for (size_t a = 0; a < conns.size(); ++a) {
+                    for (size_t b = a + 1; b < conns.size(); ++b) {
+                        bad += conns[a] == conns[b];
+                    }
+                }
+                conns.clear();
+            }
+        }
+    };
+    std::thread t1(worker), t2(worker);
+    t1.join();
+    t2.join();
+    ok = pooled == 0 && bad == 0;
+    DEBUG("两个线程同时创建连接时都使用全局堆（%s）", ok ? "通过" : "失败");
+
+    // loop()运行期间只有循环线程拿到对象池，loop()退出后不再返回
+    std::atomic<int> inLoop{-1};
+    std::thread th([&base] { base.loop(); });
+    base.safeCall([&] { inLoop = base.getLocalPool() != nullptr; });
+    ok = waitFor([&] { return inLoop != -1; }) && inLoop == 1 && base.getLocalPool() == nullptr;
+    DEBUG("loop()运行时只有循环线程得到对象池（%s）", ok ? "通过" : "失败");
+    base.exit();
+    th.join();
+    ok = base.getLocalPool() == nullptr;
+    DEBUG("loop()退出后不返回对象池（%s）", ok ? "通过" : "失败");
+    DEBUG("=== 对象池所属线程测试结束 ===\n");
+}
+
+/**
+ * @brief 测试TcpServer的回显与连接状态回调
+ */
+void test_TcpServer_echo() {
+    DEBUG("=== 开始TcpServer回显测试 ===");
+    EventBase base;
+    std::atomic<int> connected{0}, closed{0}, cloexec{0};
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", kConnPort);
+    server->onConnState([&](const TcpConnPtr& con) {
+        if (con->getState() == TcpConn::State::CONNECTED) {
+            ++connected;
+            cloexec = fcntl(con->getChannel()->getFd(), F_GETFD) & FD_CLOEXEC ? 1 : 0;
+        } else if (con->getState() == TcpConn::State::CLOSED) {
+            ++closed;
+        }
+    });
+    server->onConnRead([](const TcpConnPtr& con) {
+        con->send(con->getInputBuffer());
+    });
+    std::thread th([&base] { base.loop(); });
+
+    int fd = connectLocal(kConnPort);
+    const char msg[] = "hello handy";
+    char buf[64] = {0};
+    bool ok = fd >= 0 && ::send(fd, msg, sizeof(msg) - 1, MSG_NOSIGNAL) == (ssize_t)(sizeof(msg) - 1);
+    size_t got = 0;
+    while (ok && got < sizeof(msg) - 1) {
+        ssize_t n = ::recv(fd, buf + got, sizeof(buf) - 1 - got, 0);
+        ok = n > 0;
+        got += ok ? n : 0;
+    }
+    ok = ok && std::string(buf, got) == msg && connected == 1;
+    DEBUG("回显: %s（%s）", buf, ok ? "通过" : "失败");
+    DEBUG("接受的连接带有FD_CLOEXEC（%s）", cloexec == 1 ? "通过" : "失败");
+
+    ::close(fd);
+    ok = waitFor([&] { return closed == 1; });
+    DEBUG("对端关闭后触发CLOSED状态回调（%s）", ok ? "通过" : "失败");
+
+    base.exit();
+    th.join();
+    DEBUG("=== TcpServer回显测试结束 ===\n");
+}
+
+/**
+ * @brief 测试TcpConn的慢回调告警报告用户回调的注册位置，且不重复计为Channel回调
+ */
+void test_SlowCallback_site() {
+    DEBUG("=== 开始连接回调慢回调告警测试 ===");
+    EventBase base;
+    base.setSlowCallbackThreshold(10 * 1000);
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", kConnPort + 14);
+    const int readLine = __LINE__ + 1;
+    server->onConnRead([](const TcpConnPtr& con) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(15));
+        con->send(con->getInputBuffer());
+    });
+    std::thread th([&base] { base.loop(); });
+
+    int fd = connectLocal(kConnPort + 14);
+    char buf[8];
+    bool ok = fd >= 0 && ::send(fd, "x", 1, MSG_NOSIGNAL) == 1 && ::recv(fd, buf, sizeof(buf), 0) == 1;
+    uint64_t slow = base.getStats().slowCallbacks.load();
+
+    // 告警中的位置是conn_test.cpp中注册回调的那一行
+    std::ifstream log("conn_test.log");
+    std::string text((std::istreambuf_iterator<char>(log)), std::istreambuf_iterator<char>());
+    std::string site = "slow readable callback registered at conn_test.cpp:" + std::to_string(readLine);
+    ok = ok && slow == 1 && text.find(site) != std::string::npos;
+    DEBUG("慢回调次数%llu（预期1），告警位置conn_test.cpp:%d（%s）",
+          (unsigned long long)slow, readLine, ok ? "通过" : "失败");
+
+    if (fd >= 0) ::close(fd);
+    base.exit();
+    th.join();
+    DEBUG("=== 连接回调慢回调告警测试结束 ===\n");
+}
+
+/**
+ * @brief 测试环形输入缓冲区：按随机大小分段发送的行在服务端被完整解析，不完整的行留在缓冲区中
+ */
+void test_RingInput() {
+    DEBUG("=== 开始环形输入缓冲区测试 ===");
+    const int kLines = 2000;
+    EventBase base;
+    std::atomic<int> lines{0}, ring{0};
+    std::atomic<size_t> bytes{0};
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", kConnPort + 13);
+    server->onConnState([&](const TcpConnPtr& con) {
+        if (con->getState() == TcpConn::State::CONNECTED && con->setRingInput(16 * 1024)) {
+            ++ring;
+        }
+    });
+    // 只消费完整的行，末尾不完整的部分留到下次读取
+    server->onConnRead([&](const TcpConnPtr& con) {
+        Buffer& in = con->getInputBuffer();
+        Slice data = in;
+        size_t used = 0;
+        for (size_t pos; (pos = data.find('\n')) != Slice::npos;) {
+            ++lines;
+            bytes += pos;
+            used += pos + 1;
+            data.eat(pos + 1);
+        }
+        in.consume(used);
+    });
+    std::thread th([&base] { base.loop(); });
+
+    // 每行长度在1~6000之间，按随机大小分段发送
+    std::string payload;
+    size_t expected = 0;
+    srand(1016);
+    for (int i = 0; i < kLines; ++i) {
+        size_t len = rand() % 6000 + 1;
+        payload.append(len, static_cast<char>('a' + i % 26));
+        payload += '\n';
+        expected += len;
+    }
+    int fd = connectLocal(kConnPort + 13);
+    bool ok = fd >= 0;
+    for (size_t off = 0; ok && off < payload.size();) {
+        size_t n = std::min<size_t>(rand() % 9000 + 1, payload.size() - off);
+        ok = ::send(fd, payload.data() + off, n, MSG_NOSIGNAL) == static_cast<ssize_t>(n);
+        off += n;
+    }
+    ok = ok && waitFor([&] { return lines == kLines; }) && bytes == expected && ring == 1;
+    DEBUG("环形输入缓冲区：解析%d行（预期%d），%zu字节（预期%zu）（%s）",
+          lines.load(), kLines, bytes.load(), expected, ok ? "通过" : "失败");
+
+    if (fd >= 0) ::close(fd);
+    base.exit();
+    th.join();
+    DEBUG("=== 环形输入缓冲区测试结束 ===\n");
+}
+
+/**
+ * @brief 统计每个被动接受的连接（accept到CONNECTED）产生的堆分配次数
+ * @details 测量期间日志级别调到INFO以上，客户端只使用原始socket，不产生堆分配
+ */
+void test_Accept_allocations() {
+    DEBUG("=== 开始连接堆分配统计测试 ===");
+    const int kConns = 200;
+    EventBase base;
+    std::atomic<int> connected{0};
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", kConnPort + 1);
+    server->onConnState([&](const TcpConnPtr& con) {
+        if (con->getState() == TcpConn::State::CONNECTED) {
+            ++connected;
+        }
+    });
+    server->onConnRead([](const TcpConnPtr& con) {
+        con->send(con->getInputBuffer());
+    });
+    std::thread th([&base] { base.loop(); });
+
+    // 预热：让首次使用时才初始化的静态对象（指标、日志缓冲等）先完成初始化
+    int warm = connectLocal(kConnPort + 1);
+    bool ok = warm >= 0 && waitFor([&] { return connected == 1; });
+
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LWARN);
+    std::vector<int> fds;
+    fds.reserve(kConns);
+    long before = g_allocs.load();
+    for (int i = 0; i < kConns; ++i) {
+        fds.push_back(connectLocal(kConnPort + 1));
+    }
+    ok = ok && waitFor([&] { return connected == kConns + 1; });
+    long allocs = g_allocs.load() - before;
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+
+    double perConn = static_cast<double>(allocs) / kConns;
+    INFO("每个被动连接的堆分配: %.2f 次（%d个连接共%ld次）", perConn, kConns, allocs);
+    std::cout << "allocations per accepted connection: " << perConn << std::endl;
+    DEBUG("连接建立（%s）", ok ? "通过" : "失败");
+
+    for (int fd : fds) {
+        ::close(fd);
+    }
+    ::close(warm);
+    base.exit();
+    th.join();
+    DEBUG("=== 连接堆分配统计测试结束 ===\n");
+}
+
+/**
+ * @brief 短连接基准：客户端逐个发起HTTP/1.0式的短连接（发送请求、读取响应后由服务端关闭），
+ *        统计每秒处理的连接数与每个连接的堆分配次数
+ * @details 连接对象与Channel在事件循环线程中创建、销毁，预热后应从对象池中复用
+ */
+void test_Accept_churn() {
+    DEBUG("=== 开始短连接基准测试 ===");
+    const int kConns = 5000;
+    EventBase base;
+    std::atomic<int> closed{0};
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", kConnPort + 3);
+    server->onConnState([&](const TcpConnPtr& con) {
+        if (con->getState() == TcpConn::State::CLOSED) {
+            ++closed;
+        }
+    });
+    server->onConnRead([](const TcpConnPtr& con) {
+        con->getInputBuffer().clear();
+        con->send("ok");
+        con->close();
+    });
+    std::thread th([&base] { base.loop(); });
+
+    // 客户端：发送请求后阻塞读取，直到服务端关闭连接
+    auto shortConn = [] {
+        int fd = connectLocal(kConnPort + 3);
+        char buf[16];
+        bool ok = fd >= 0 && ::send(fd, "GET", 3, MSG_NOSIGNAL) == 3;
+        size_t got = 0;
+        ssize_t n;
+        while (ok && (n = ::recv(fd, buf, sizeof(buf), 0)) > 0) {
+            got += n;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return ok && got == 2;
+    };
+
+    // 预热：填充对象池与首次使用时才初始化的静态对象
+    bool ok = true;
+    for (int i = 0; i < 16; ++i) {
+        ok = shortConn() && ok;
+    }
+
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LWARN);
+    long before = g_allocs.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kConns && ok; ++i) {
+        ok = shortConn();
+    }
+    ok = ok && waitFor([&] { return closed == kConns + 16; });
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long allocs = g_allocs.load() - before;
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+
+    double rate = kConns / secs;
+    double perConn = static_cast<double>(allocs) / kConns;
+    INFO("短连接: %.0f 个/秒，每个连接的堆分配 %.2f 次（%d个连接）", rate, perConn, kConns);
+    std::cout << "short connections: " << rate << " conn/s, " << perConn << " allocations/conn" << std::endl;
+    DEBUG("全部连接完成请求并关闭（%s）", ok ? "通过" : "失败");
+
+    base.exit();
+    th.join();
+    DEBUG("=== 短连接基准测试结束 ===\n");
+}
+
+/**
+ * @brief 用阻塞socket发送一个字节并等待一个字节的回复
+ */
+bool pingOnce(int fd, char c) {
+    char r;
+    return ::send(fd, &c, 1, MSG_NOSIGNAL) == 1 && ::recv(fd, &r, 1, 0) == 1 && r == c;
+}
+
+/**
+ * @brief 测试连接迁移：服务端连接从一个事件循环迁移到另一个后，回显与空闲回调照常工作
+ */
+void test_Migrate() {
+    DEBUG("=== 开始连接迁移测试 ===");
+    EventBase from, to;
+    std::thread th1([&from] { from.loop(); });
+    std::thread th2([&to] { to.loop(); });
+    std::atomic<int> migrated{0};
+    std::atomic<EventBase*> readOn{nullptr};
+    TcpServer::Ptr server = TcpServer::startServer(&from, "127.0.0.1", kConnPort + 4);
+    server->onConnState([&](const TcpConnPtr& con) {
+        if (con->getState() == TcpConn::State::CONNECTED) {
+            con->addIdleCB(60, [](const TcpConnPtr&) {});
+        }
+    });
+    server->onConnRead([&](const TcpConnPtr& con) {
+        readOn = con->getBase();
+        std::string in = con->getInputBuffer().data();
+        con->getInputBuffer().clear();
+        con->send(in);
+        // 收到'm'时回复后迁移到另一个事件循环
+        if (in == "m" && con->migrate(&to)) {
+            ++migrated;
+        }
+    });
+
+    int fd = connectLocal(kConnPort + 4);
+    bool ok = fd >= 0 && pingOnce(fd, 'a') && readOn == &from;
+    ok = ok && pingOnce(fd, 'm') && waitFor([&] { return migrated == 1; });
+    ok = ok && waitFor([&] { return to.getStats().connections == 1; });
+    ok = ok && pingOnce(fd, 'b') && readOn == &to && from.getStats().connections == 0;
+    DEBUG("迁移后回显（%s）", ok ? "通过" : "失败");
+
+    ::close(fd);
+    ok = waitFor([&] { return to.getStats().connections == 0; });
+    DEBUG("迁移后关闭，连接数归零（%s）", ok ? "通过" : "失败");
+    from.exit();
+    to.exit();
+    th1.join();
+    th2.join();
+    DEBUG("=== 连接迁移测试结束 ===\n");
+}
+
+/**
+ * @brief 测试同一批接受的连接按最少连接策略均匀分配：分配时预占连接数，不必等到目标循环attach
+ */
+void test_Accept_burst_balance() {
+    DEBUG("=== 开始突发连接分配测试 ===");
+    const int kLoops = 4;
+    const int kConns = 16;
+    MultiBase bases(kLoops);
+    bases.setAllocPolicy(MultiBase::AllocPolicy::LEAST_CONNECTIONS);
+    TcpServer::Ptr server = TcpServer::startServer(&bases, "127.0.0.1", kConnPort + 15);
+    std::thread th([&bases] { bases.loop(); });
+
+    // 连接在监听循环处理之前全部完成握手，一次可读事件中被连续接受
+    std::vector<int> fds;
+    for (int i = 0; i < kConns; ++i) {
+        fds.push_back(connectLocal(kConnPort + 15));
+    }
+    auto total = [&] {
+        int64_t n = 0;
+        for (int i = 0; i < kLoops; ++i) {
+            n += bases.getBase(i)->getStats().connections.load();
+        }
+        return n;
+    };
+    bool ok = waitFor([&] { return total() == kConns; });
+    int64_t counts[kLoops];
+    for (int i = 0; i < kLoops; ++i) {
+        counts[i] = bases.getBase(i)->getStats().connections.load();
+        ok = ok && counts[i] == kConns / kLoops;
+    }
+    DEBUG("各循环连接数: %lld/%lld/%lld/%lld（%s）", (long long)counts[0], (long long)counts[1],
+          (long long)counts[2], (long long)counts[3], ok ? "通过" : "失败");
+
+    for (int fd : fds) {
+        ::close(fd);
+    }
+    ok = waitFor([&] { return total() == 0; });
+    DEBUG("关闭后连接数归零（%s）", ok ? "通过" : "失败");
+    bases.exit();
+    th.join();
+    DEBUG("=== 突发连接分配测试结束 ===\n");
+}
+
+/**
+ * @brief 负载倾斜基准：每4个连接中有1个热点连接（每条消息占用服务端200us），比较各分配策略下事件循环之间的负载差异
+ * @details 1. 连接逐个建立，建立后持续发送请求，使最近最空闲策略能观察到各循环的繁忙程度
+ *          2. 全部建立后再测量一段时间，以各循环处理事件的总耗时计算不均衡度（最大值/平均值，1为完全均衡）
+ */
+double runSkewedLoad(MultiBase::AllocPolicy policy, unsigned short port) {
+    const int kConns = 16;
+    const int kLoops = 4;
+    MultiBase bases(kLoops);
+    bases.setAllocPolicy(policy);
+    TcpServer::Ptr server = TcpServer::startServer(&bases, "127.0.0.1", port);
+    server->onConnRead([](const TcpConnPtr& con) {
+        Buffer& in = con->getInputBuffer();
+        std::string reply = in.data();
+        in.clear();
+        for (char c : reply) {
+            if (c == 'H') {
+                auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(200);
+                while (std::chrono::steady_clock::now() < end) {
+                }
+            }
+        }
+        con->send(reply);
+    });
+    std::thread th([&bases] { bases.loop(); });
+
+    // 热点连接每轮发送一次请求，普通连接每20轮一次
+    std::vector<int> fds;
+    int round = 0;
+    auto drive = [&](int ms) {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+        bool ok = true;
+        while (ok && std::chrono::steady_clock::now() < end) {
+            for (size_t i = 0; i < fds.size() && ok; ++i) {
+                bool hot = i % 4 == 0;
+                if (hot || round % 20 == 0) {
+                    ok = pingOnce(fds[i], hot ? 'H' : 'c');
+                }
+            }
+            ++round;
+        }
+        return ok;
+    };
+
+    bool ok = true;
+    for (int i = 0; i < kConns && ok; ++i) {
+        fds.push_back(connectLocal(port));
+        ok = fds.back() >= 0 && drive(150);
+    }
+
+    uint64_t before[kLoops], busy[kLoops];
+    for (int i = 0; i < kLoops; ++i) {
+        before[i] = bases.getBase(i)->getStats().busy_us.snapshot().sum;
+    }
+    ok = ok && drive(1000);
+    uint64_t total = 0, maxBusy = 0;
+    for (int i = 0; i < kLoops; ++i) {
+        busy[i] = bases.getBase(i)->getStats().busy_us.snapshot().sum - before[i];
+        total += busy[i];
+        maxBusy = std::max(maxBusy, busy[i]);
+    }
+    double imbalance = total > 0 ? static_cast<double>(maxBusy) * kLoops / total : 0;
+    INFO("各循环耗时(ms): %.0f/%.0f/%.0f/%.0f，不均衡度 %.2f",
+         busy[0] / 1e3, busy[1] / 1e3, busy[2] / 1e3, busy[3] / 1e3, imbalance);
+
+    for (int fd : fds) {
+        ::close(fd);
+    }
+    bases.exit();
+    th.join();
+    return ok ? imbalance : 0;
+}
+
+void test_Skewed_load() {
+    DEBUG("=== 开始负载倾斜基准测试 ===");
+    const std::pair<const char*, MultiBase::AllocPolicy> policies[] = {
+        {"round-robin", MultiBase::AllocPolicy::ROUND_ROBIN},
+        {"least-connections", MultiBase::AllocPolicy::LEAST_CONNECTIONS},
+        {"least-loaded", MultiBase::AllocPolicy::LEAST_LOADED},
+        {"power-of-two", MultiBase::AllocPolicy::POWER_OF_TWO},
+    };
+    unsigned short port = kConnPort + 5;
+    double leastLoaded = 0, roundRobin = 0;
+    for (const auto& [name, policy] : policies) {
+        double imbalance = runSkewedLoad(policy, port++);
+        std::cout << "skewed load imbalance (" << name << "): " << imbalance << std::endl;
+        INFO("%s: 不均衡度 %.2f", name, imbalance);
+        if (policy == MultiBase::AllocPolicy::LEAST_LOADED) {
+            leastLoaded = imbalance;
+        } else if (policy == MultiBase::AllocPolicy::ROUND_ROBIN) {
+            roundRobin = imbalance;
+        }
+    }
+    bool ok = leastLoaded > 0 && leastLoaded < roundRobin;
+    DEBUG("最近最空闲策略比轮询更均衡（%s）", ok ? "通过" : "失败");
+    DEBUG("=== 负载倾斜基准测试结束 ===\n");
+}
+
+/**
+ * @brief 回显往返基准：同一事件循环内的客户端与服务端连接互相收发，统计每次往返的耗时
+ * @details 收发都在循环线程中完成，没有线程切换，测得的是连接读写路径本身（含系统调用）的开销
+ */
+void test_Echo_benchmark() {
+    DEBUG("=== 开始回显往返基准测试 ===");
+    const int kRounds = 100000;
+    const size_t kMsgLen = 64;
+    const std::string msg(kMsgLen, 'x');
+    EventBase base;
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", kConnPort + 2);
+    server->onConnRead([](const TcpConnPtr& con) {
+        con->send(con->getInputBuffer());
+    });
+
+    int rounds = 0;
+    std::chrono::steady_clock::time_point start, end;
+    uint64_t startCycles = 0, endCycles = 0;
+    TcpConnPtr client = TcpConn::createConnection(&base, "127.0.0.1", kConnPort + 2);
+    client->onState([&](const TcpConnPtr& con) {
+        if (con->getState() == TcpConn::State::CONNECTED) {
+            start = std::chrono::steady_clock::now();
+            startCycles = readCycles();
+            con->send(msg);
+        }
+    });
+    client->onReadable([&](const TcpConnPtr& con) {
+        Buffer& in = con->getInputBuffer();
+        while (in.size() >= kMsgLen) {
+            in.consume(kMsgLen);
+            if (++rounds == kRounds) {
+                endCycles = readCycles();
+                end = std::chrono::steady_clock::now();
+                base.exit();
+                return;
+            }
+            con->send(msg);
+        }
+    });
+
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LWARN);
+    base.runAfter(60000, [&base] { base.exit(); });
+    base.loop();
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+
+    bool ok = rounds == kRounds;
+    double ns = ok ? std::chrono::duration<double, std::nano>(end - start).count() / kRounds : 0;
+    double cycles = ok ? static_cast<double>(endCycles - startCycles) / kRounds : 0;
+    INFO("回显往返: %.0f ns/次，%.0f cycles/次（%d次，%zu字节）", ns, cycles, kRounds, kMsgLen);
+    std::cout << "echo round trip: " << ns << " ns, " << cycles << " cycles" << std::endl;
+    DEBUG("完成全部往返（%s）", ok ? "通过" : "失败");
+    client->close();
+    DEBUG("=== 回显往返基准测试结束 ===\n");
+}
+
+/**
+ * @brief 用阻塞socket连接本地端口，连接前把接收缓冲区调小（模拟读取缓慢的对端）
+ */
+int connectSlowReader(unsigned short port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int rcvBuf = 4096;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    timeval tv{3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+/**
+ * @brief 测试输出缓冲区的高低水位：对端不读取时触发高水位并暂停读取，对端读完后触发低水位并恢复读取；
+ *        超过上限的连接被关闭
+ */
+void test_WaterMarks() {
+    DEBUG("=== 开始输出缓冲区水位测试 ===");
+    const size_t kPayload = 1 << 20;
+    EventBase base;
+    std::atomic<int> high{0}, low{0}, reads{0}, closed{0};
+    std::atomic<size_t> buffered{0};
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", kConnPort + 11);
+    server->onConnState([&](const TcpConnPtr& con) {
+        if (con->getState() == TcpConn::State::CONNECTED) {
+            // 发送缓冲区调小，让数据积压在输出缓冲区中
+            int sndBuf = 4096;
+            setsockopt(con->getChannel()->getFd(), SOL_SOCKET, SO_SNDBUF, &sndBuf, sizeof(sndBuf));
+            con->setWaterMarks(64 * 1024, 16 * 1024, true);
+            con->setOutputLimit(kPayload / 2);
+            con->onHighWater([&](const TcpConnPtr& c) {
+                ++high;
+                buffered = c->getOutputBuffer().size();
+            });
+            con->onLowWater([&](const TcpConnPtr&) { ++low; });
+        } else if (con->getState() == TcpConn::State::CLOSED) {
+            ++closed;
+        }
+    });
+    // 收到"s"时发送kPayload/4字节，收到"o"时发送kPayload字节（超过上限），之后继续发送'e'（应全部丢弃）
+    server->onConnRead([&](const TcpConnPtr& con) {
+        ++reads;
+        std::string in = con->getInputBuffer().data();
+        con->getInputBuffer().clear();
+        if (in.find('s') != std::string::npos) {
+            con->send(std::string(kPayload / 4, 'd'));
+        } else if (in.find('o') != std::string::npos) {
+            con->send(std::string(kPayload, 'd'));
+            con->send(std::string(16, 'e'));
+            con->send(std::string(kPayload, 'e'));
+            // 从其他线程发送的数据在事件循环中处理，同样应被丢弃
+            std::thread([con] { con->send(std::string(1024, 'e')); }).join();
+        }
+    });
+    std::thread th([&base] { base.loop(); });
+
+    // 1. 对端不读取：触发高水位并暂停读取，之后发来的数据不会被读取
+    int fd = connectSlowReader(kConnPort + 11);
+    bool ok = fd >= 0 && ::send(fd, "s", 1, MSG_NOSIGNAL) == 1 && waitFor([&] { return high == 1; });
+    ok = ok && ::send(fd, "x", 1, MSG_NOSIGNAL) == 1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ok = ok && reads == 1 && low == 0;
+    DEBUG("高水位回调（积压%zu字节）并暂停读取（%s）", buffered.load(), ok ? "通过" : "失败");
+
+    // 2. 对端读完全部数据：触发低水位，恢复读取后收到暂停期间发来的数据
+    size_t got = 0;
+    char buf[65536];
+    while (ok && got < kPayload / 4) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        ok = n > 0;
+        got += ok ? n : 0;
+    }
+    ok = ok && waitFor([&] { return low == 1 && reads == 2; });
+    DEBUG("低水位回调并恢复读取（%s）", ok ? "通过" : "失败");
+
+    // 3. 超过上限：丢弃积压的数据并关闭连接，对端最终读到EOF
+    auto& overflows = MetricsRegistry::instance().counter("handy_tcp_output_overflows_total", "");
+    int64_t before = overflows.value();
+    ok = ::send(fd, "o", 1, MSG_NOSIGNAL) == 1 && waitFor([&] { return closed == 1; });
+    ssize_t n;
+    bool tail = false;
+    while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) {
+        tail = tail || memchr(buf, 'e', n) != nullptr;
+    }
+    ok = ok && n == 0 && overflows.value() == before + 1;
+    DEBUG("超过上限后关闭连接（%s）", ok ? "通过" : "失败");
+
+    // 4. 溢出后继续发送的数据全部丢弃：对端不会在缺失的数据之后收到后续数据，也只计一次溢出
+    ok = !tail && overflows.value() == before + 1;
+    DEBUG("溢出后发送的数据被丢弃（%s）", ok ? "通过" : "失败");
+    ::close(fd);
+
+    base.exit();
+    th.join();
+    DEBUG("=== 输出缓冲区水位测试结束 ===\n");
+}
+
+/**
+ * @brief 读取int类型的Socket选项（失败返回-1）
+ */
+int getIntOption(int fd, int level, int opt) {
+    int value = -1;
+    socklen_t len = sizeof(value);
+    if (getsockopt(fd, level, opt, &value, &len) != 0) {
+        return -1;
+    }
+    return value;
+}
+
+/**
+ * @brief 测试Socket调优选项：TcpServer应用到接受的连接，createConnection应用到客户端连接；setCork开关TCP_CORK
+ */
+void test_SocketOptions() {
+    DEBUG("=== 开始Socket调优选项测试 ===");
+    EventBase base;
+    std::atomic<int> acceptedNoDelay{-1}, acceptedLowat{-1}, acceptedRcvBuf{-1};
+    std::atomic<int> clientNoDelay{-1}, clientLowat{-1}, corked{-1}, uncorked{-1};
+    std::atomic<int> echoed{0};
+
+    SocketOptions serverOpts;
+    serverOpts.recvBuf = 256 * 1024;
+    serverOpts.noDelay = true;
+    serverOpts.notSentLowat = 16384;
+    serverOpts.deferAccept_s = 1;
+    TcpServer::Ptr server(new TcpServer(&base));
+    server->setSocketOptions(serverOpts);
+    bool ok = server->bind("127.0.0.1", kConnPort + 12) == 0;
+    server->onConnState([&](const TcpConnPtr& con) {
+        if (con->getState() == TcpConn::State::CONNECTED) {
+            int fd = con->getChannel()->getFd();
+            acceptedNoDelay = getIntOption(fd, IPPROTO_TCP, TCP_NODELAY);
+            acceptedLowat = getIntOption(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT);
+            acceptedRcvBuf = getIntOption(fd, SOL_SOCKET, SO_RCVBUF);
+        }
+    });
+    // 回显时用CORK把两段数据合并发出
+    server->onConnRead([&](const TcpConnPtr& con) {
+        std::string in = con->getInputBuffer().data();
+        con->getInputBuffer().clear();
+        con->setCork(true);
+        corked = getIntOption(con->getChannel()->getFd(), IPPROTO_TCP, TCP_CORK);
+        con->send(in.substr(0, 1));
+        con->send(in.substr(1));
+        con->setCork(false);
+        uncorked = getIntOption(con->getChannel()->getFd(), IPPROTO_TCP, TCP_CORK);
+    });
+
+    SocketOptions clientOpts;
+    clientOpts.noDelay = true;
+    clientOpts.notSentLowat = 4096;
+    TcpConnPtr client;
+    base.safeCall([&] {
+        client = TcpConn::createConnection(&base, "127.0.0.1", kConnPort + 12, 0, "", clientOpts);
+        client->onState([&](const TcpConnPtr& con) {
+            if (con->getState() == TcpConn::State::CONNECTED) {
+                int fd = con->getChannel()->getFd();
+                clientNoDelay = getIntOption(fd, IPPROTO_TCP, TCP_NODELAY);
+                clientLowat = getIntOption(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT);
+                // TCP_DEFER_ACCEPT：客户端先发数据，服务端才会接受连接
+                con->send("ping");
+            }
+        });
+        client->onReadable([&](const TcpConnPtr& con) {
+            if (con->getInputBuffer().size() >= 4) {
+                ++echoed;
+            }
+        });
+    });
+    std::thread th([&base] { base.loop(); });
+
+    ok = ok && waitFor([&] { return echoed == 1; });
+    DEBUG("延迟接受的连接完成回显（%s）", ok ? "通过" : "失败");
+    ok = acceptedNoDelay == 1 && acceptedLowat == 16384 && acceptedRcvBuf >= 256 * 1024;
+    DEBUG("接受的连接: TCP_NODELAY=%d，TCP_NOTSENT_LOWAT=%d，SO_RCVBUF=%d（%s）", acceptedNoDelay.load(),
+          acceptedLowat.load(), acceptedRcvBuf.load(), ok ? "通过" : "失败");
+    ok = clientNoDelay == 1 && clientLowat == 4096;
+    DEBUG("客户端连接: TCP_NODELAY=%d，TCP_NOTSENT_LOWAT=%d（%s）", clientNoDelay.load(), clientLowat.load(),
+          ok ? "通过" : "失败");
+    ok = corked == 1 && uncorked == 0;
+    DEBUG("setCork: 开启后%d，关闭后%d（%s）", corked.load(), uncorked.load(), ok ? "通过" : "失败");
+
+    base.safeCall([&] { client->close(); });
+    base.exit();
+    th.join();
+    DEBUG("=== Socket调优选项测试结束 ===\n");
+}
+
+/**
+ * @brief 测量跨线程回显的往返延迟分布：服务端事件循环运行在独立线程中，客户端用阻塞socket逐个收发
+ * @param spin_us 服务端事件循环的忙轮询预算（0表示阻塞模式）
+ * @param[out] p50_ns、p99_ns 往返延迟的中位数与99分位（纳秒）
+ * @return bool 是否完成全部往返
+ */
+bool runEchoLatency(int64_t spin_us, unsigned short port, double* p50_ns, double* p99_ns) {
+    const int kRounds = 20000;
+    const size_t kMsgLen = 64;
+    EventBase base;
+    base.setBusyPoll(spin_us);
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", port);
+    if (spin_us > 0) {
+        server->setBusyPoll(static_cast<int>(spin_us));
+    }
+    server->onConnRead([](const TcpConnPtr& con) {
+        con->send(con->getInputBuffer());
+    });
+    std::thread th([&base] { base.loop(); });
+
+    int fd = connectLocal(port);
+    char msg[kMsgLen], buf[kMsgLen];
+    memset(msg, 'x', sizeof(msg));
+    std::vector<int64_t> samples;
+    samples.reserve(kRounds);
+    bool ok = fd >= 0;
+    for (int i = 0; i < kRounds && ok; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        ok = ::send(fd, msg, kMsgLen, MSG_NOSIGNAL) == (ssize_t)kMsgLen;
+        size_t got = 0;
+        while (ok && got < kMsgLen) {
+            ssize_t n = ::recv(fd, buf + got, kMsgLen - got, 0);
+            ok = n > 0;
+            got += ok ? n : 0;
+        }
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    base.exit();
+    th.join();
+
+    std::sort(samples.begin(), samples.end());
+    *p50_ns = samples.empty() ? 0 : samples[samples.size() / 2];
+    *p99_ns = samples.empty() ? 0 : samples[samples.size() * 99 / 100];
+    return ok;
+}
+
+/**
+ * @brief 忙轮询延迟基准：比较阻塞模式与忙轮询模式下跨线程回显的p50/p99往返延迟
+ */
+void test_BusyPoll_latency() {
+    DEBUG("=== 开始忙轮询延迟基准测试 ===");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LWARN);
+    double blockP50 = 0, blockP99 = 0, spinP50 = 0, spinP99 = 0;
+    bool ok = runEchoLatency(0, kConnPort + 9, &blockP50, &blockP99);
+    ok = runEchoLatency(200, kConnPort + 10, &spinP50, &spinP99) && ok;
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+
+    INFO("阻塞模式: p50 %.0f ns，p99 %.0f ns；忙轮询: p50 %.0f ns，p99 %.0f ns",
+         blockP50, blockP99, spinP50, spinP99);
+    std::cout << "echo latency blocking: p50 " << blockP50 << " ns, p99 " << blockP99 << " ns" << std::endl;
+    std::cout << "echo latency busy-poll: p50 " << spinP50 << " ns, p99 " << spinP99 << " ns" << std::endl;
+    DEBUG("两种模式都完成全部往返（%s）", ok ? "通过" : "失败");
+    DEBUG("=== 忙轮询延迟基准测试结束 ===\n");
+}
+
+// -------------------------- 测试入口函数 --------------------------
+void run_all_tests() {
+    // 1. 初始化日志
+    initTestLogger();
+
+    // 2. 执行所有测试
+    test_InlineFunction();
+    test_BlockPool();
+    test_LocalPool_owner();
+    test_AutoContext();
+    test_TcpServer_echo();
+    test_SlowCallback_site();
+    test_Accept_allocations();
+    test_Accept_churn();
+    test_Migrate();
+    test_WaterMarks();
+    test_RingInput();
+    test_SocketOptions();
+    test_Accept_burst_balance();
+    test_Skewed_load();
+    test_Echo_benchmark();
+    test_BusyPoll_latency();
+
+    // 3. 测试总结
+    INFO("=== conn_test 所有测试执行完成 ===");
+}
+
+}  // namespace connTest
+}  // namespace handy
+
+// 主函数：启动测试
+int main() {
+    handy::connTest::run_all_tests();
+    return 0;
+}
@@ -0,0 +1,392 @@
+#include "coro.h"
+#include "codec.h"
+#include "logger.h"
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <iostream>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace handy {
+namespace coroTest {
+
+// 协程测试端口（kCoroPort起依次使用）
+static const unsigned short kCoroPort = 12400;
+
+// -------------------------- 测试辅助函数 --------------------------
+/**
+ * @brief 初始化Logger（输出到coro_test.log）
+ */
+void initTestLogger() {
+    Logger::getInstance().setLogFileName("coro_test.log");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+    INFO("=== coro_test 测试开始 ===");
+}
+
+/**
+ * @brief 等待条件成立（最多等待timeout_ms毫秒）
+ */
+template <typename Pred>
+bool waitFor(Pred pred, int timeout_ms = 3000) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * @brief 用阻塞socket连接本地端口
+ * @return int 连接的fd（失败返回-1）
+ */
+int connectLocal(unsigned short port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    timeval tv{5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+/**
+ * @brief 阻塞接收恰好len字节
+ */
+bool recvAll(int fd, char* p, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::recv(fd, p, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// -------------------------- 测试用协程 --------------------------
+/**
+ * @brief 等待ms毫秒后返回参数的两倍
+ */
+co::Task<int> doubleAfter(EventBase* base, int ms, int v) {
+    co_await co::sleep(base, ms);
+    co_return v * 2;
+}
+
+/**
+ * @brief 等待后抛出异常
+ */
+co::Task<int> throwAfter(EventBase* base, int ms) {
+    co_await co::sleep(base, ms);
+    throw std::runtime_error("boom");
+}
+
+/**
+ * @brief 依次等待子任务，检查返回值、异常传递与等待时间
+ */
+co::Task<void> sleepMain(EventBase* base, std::atomic<int>* result, std::atomic<int64_t>* elapsed) {
+    int64_t start = utils::timeMilli();
+    int sum = 0;
+    for (int i = 1; i <= 3; ++i) {
+        sum += co_await doubleAfter(base, 20, i);
+    }
+    bool caught = false;
+    try {
+        co_await throwAfter(base, 10);
+    } catch (const std::runtime_error& e) {
+        caught = strcmp(e.what(), "boom") == 0;
+    }
+    *elapsed = utils::timeMilli() - start;
+    *result = caught ? sum : -1;
+}
+
+/**
+ * @brief 回显处理：读到的数据原样写回，直到连接关闭
+ */
+co::Task<void> echoHandler(co::Conn conn) {
+    size_t n;
+    while ((n = co_await conn.read()) > 0) {
+        Slice data = conn->getInputBuffer();
+        if (!co_await conn.write(data)) {
+            break;
+        }
+        conn->getInputBuffer().consume(data.size());
+    }
+}
+
+/**
+ * @brief 消息处理：每条LengthCodec消息回复"re:"+内容，收到"bye"时关闭连接
+ */
+co::Task<void> msgHandler(co::Conn conn) {
+    LengthCodec codec;
+    while (std::optional<Slice> msg = co_await conn.readMsg(codec)) {
+        if (*msg == "bye") {
+            break;
+        }
+        std::string reply = "re:" + msg->toString();
+        co_await conn.writeMsg(codec, reply);
+    }
+}
+
+/**
+ * @brief 客户端：连接回显服务，发送若干大小不同的数据并校验回显
+ */
+co::Task<void> echoClient(EventBase* base, unsigned short port, std::atomic<int>* result) {
+    co::Conn conn = co_await co::Conn::connect(base, "127.0.0.1", port, 1000);
+    if (!conn.connected()) {
+        *result = -1;
+        co_return;
+    }
+    const size_t sizes[] = {1, 100, 4096, 1 << 20};
+    for (size_t len : sizes) {
+        std::string msg(len, '\0');
+        for (size_t i = 0; i < len; ++i) {
+            msg[i] = static_cast<char>(i % 251);
+        }
+        if (!co_await conn.write(msg)) {
+            *result = -2;
+            co_return;
+        }
+        while (conn->getInputBuffer().size() < len) {
+            if (co_await conn.read() == 0) {
+                *result = -3;
+                co_return;
+            }
+        }
+        if (Slice(conn->getInputBuffer()) != Slice(msg)) {
+            *result = -4;
+            co_return;
+        }
+        conn->getInputBuffer().consume(len);
+    }
+    *result = 1;
+}
+
+/**
+ * @brief 客户端：一次写入多条消息（流水线），逐条读取回复，最后等待服务端关闭连接
+ */
+co::Task<void> msgClient(EventBase* base, unsigned short port, std::atomic<int>* result) {
+    co::Conn conn = co_await co::Conn::connect(base, "127.0.0.1", port, 1000);
+    if (!conn.connected()) {
+        *result = -1;
+        co_return;
+    }
+    LengthCodec codec;
+    Buffer out;
+    const char* msgs[] = {"a", "hello", "coroutine"};
+    for (const char* m : msgs) {
+        codec.encode(m, out);
+    }
+    codec.encode("bye", out);
+    co_await conn.write(out);
+    for (const char* m : msgs) {
+        std::optional<Slice> reply = co_await conn.readMsg(codec);
+        if (!reply || *reply != "re:" + std::string(m)) {
+            *result = -2;
+            co_return;
+        }
+    }
+    // 服务端收到"bye"后关闭连接：readMsg返回空
+    std::optional<Slice> last = co_await conn.readMsg(codec);
+    *result = last ? -3 : 1;
+}
+
+/**
+ * @brief 客户端：连接一个没有监听的端口
+ */
+co::Task<void> failClient(EventBase* base, unsigned short port, std::atomic<int>* result) {
+    co::Conn conn = co_await co::Conn::connect(base, "127.0.0.1", port, 1000);
+    *result = (!conn.connected() && conn->getState() == TcpConn::State::FAILED) ? 1 : -1;
+}
+
+// -------------------------- 测试用例 --------------------------
+/**
+ * @brief 测试co::sleep与Task：子任务返回值、异常传递、等待时间
+ */
+void test_Coro_sleep() {
+    DEBUG("=== 开始协程定时测试 ===");
+    EventBase base;
+    std::thread th([&base] { base.loop(); });
+    std::atomic<int> result{0};
+    std::atomic<int64_t> elapsed{0};
+    base.safeCall([&] { co::spawn(sleepMain(&base, &result, &elapsed)); });
+    bool ok = waitFor([&] { return result != 0; });
+    DEBUG("子任务返回值之和=%d（期望12），异常在co_await处重新抛出（%s）", result.load(),
+          ok && result == 12 ? "通过" : "失败");
+    DEBUG("等待时间%lldms（期望约70ms）（%s）", (long long)elapsed.load(),
+          elapsed >= 70 && elapsed < 1000 ? "通过" : "失败");
+    base.exit();
+    th.join();
+    DEBUG("=== 协程定时测试结束 ===\n");
+}
+
+/**
+ * @brief 测试co::Conn：协程回显服务端与协程客户端
+ */
+void test_Coro_echo() {
+    DEBUG("=== 开始协程回显测试 ===");
+    const unsigned short port = kCoroPort;
+    EventBase base;
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", port);
+    co::Conn::serve(server, echoHandler);
+    std::thread th([&base] { base.loop(); });
+
+    std::atomic<int> result{0};
+    base.safeCall([&] { co::spawn(echoClient(&base, port, &result)); });
+    bool ok = waitFor([&] { return result != 0; }) && result == 1;
+    DEBUG("协程客户端经协程服务端回显1B~1MB数据，内容一致（%s）", ok ? "通过" : "失败");
+
+    // 普通阻塞客户端也能与协程服务端交互；关闭后服务端协程结束
+    int fd = connectLocal(port);
+    char buf[6] = {0};
+    ok = fd >= 0 && ::send(fd, "hello", 5, 0) == 5 && recvAll(fd, buf, 5) && strcmp(buf, "hello") == 0;
+    DEBUG("阻塞客户端回显（%s）", ok ? "通过" : "失败");
+    ::close(fd);
+
+    base.exit();
+    th.join();
+    DEBUG("=== 协程回显测试结束 ===\n");
+}
+
+/**
+ * @brief 测试readMsg()/writeMsg()：流水线消息逐条解码，服务端关闭后readMsg返回空
+ */
+void test_Coro_readMsg() {
+    DEBUG("=== 开始协程消息测试 ===");
+    const unsigned short port = kCoroPort + 1;
+    EventBase base;
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", port);
+    co::Conn::serve(server, msgHandler);
+    std::thread th([&base] { base.loop(); });
+
+    std::atomic<int> result{0};
+    base.safeCall([&] { co::spawn(msgClient(&base, port, &result)); });
+    bool ok = waitFor([&] { return result != 0; }) && result == 1;
+    DEBUG("一次写入的多条消息逐条回复，连接关闭后readMsg返回空（%s）", ok ? "通过" : "失败");
+
+    // 解码出错（魔法字错误）时服务端关闭连接
+    int fd = connectLocal(port);
+    const char bad[8] = {'x', 'B', 'd', 'T', 0, 0, 0, 1};
+    char c;
+    ok = fd >= 0 && ::send(fd, bad, sizeof(bad), 0) == sizeof(bad) && ::recv(fd, &c, 1, 0) == 0;
+    DEBUG("非法消息导致服务端关闭连接（%s）", ok ? "通过" : "失败");
+    ::close(fd);
+
+    base.exit();
+    th.join();
+    DEBUG("=== 协程消息测试结束 ===\n");
+}
+
+/**
+ * @brief 测试连接失败：connect()恢复后connected()为false
+ */
+void test_Coro_connectFail() {
+    DEBUG("=== 开始协程连接失败测试 ===");
+    EventBase base;
+    std::thread th([&base] { base.loop(); });
+    std::atomic<int> result{0};
+    base.safeCall([&] { co::spawn(failClient(&base, kCoroPort + 2, &result)); });
+    bool ok = waitFor([&] { return result != 0; }) && result == 1;
+    DEBUG("连接未监听的端口，协程以FAILED状态恢复（%s）", ok ? "通过" : "失败");
+    base.exit();
+    th.join();
+    DEBUG("=== 协程连接失败测试结束 ===\n");
+}
+
+/**
+ * @brief 用kClients个阻塞客户端线程对回显服务做kRounds轮乒乓，返回每秒请求数
+ */
+double runPingPong(unsigned short port) {
+    const int kClients = 8, kRounds = 20000;
+    std::atomic<int> done{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (int i = 0; i < kClients; ++i) {
+        clients.emplace_back([&] {
+            int fd = connectLocal(port);
+            char buf[64] = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcde";
+            bool ok = fd >= 0;
+            for (int r = 0; ok && r < kRounds; ++r) {
+                ok = ::send(fd, buf, sizeof(buf), 0) == sizeof(buf) && recvAll(fd, buf, sizeof(buf));
+            }
+            if (ok) {
+                ++done;
+            }
+            ::close(fd);
+        });
+    }
+    for (auto& t : clients) {
+        t.join();
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return done == kClients ? kClients * kRounds / secs : 0;
+}
+
+/**
+ * @brief 基准：比较回调风格与协程风格的回显服务端的每秒请求数
+ */
+void test_Coro_benchmark() {
+    DEBUG("=== 开始协程回显基准测试 ===");
+    EventBase base;
+    TcpServer::Ptr callbackServer = TcpServer::startServer(&base, "127.0.0.1", kCoroPort + 3);
+    callbackServer->onConnRead([](const TcpConnPtr& con) { con->send(con->getInputBuffer()); });
+    TcpServer::Ptr coroServer = TcpServer::startServer(&base, "127.0.0.1", kCoroPort + 4);
+    co::Conn::serve(coroServer, echoHandler);
+    std::thread th([&base] { base.loop(); });
+
+    double callbackQps = runPingPong(kCoroPort + 3);
+    double coroQps = runPingPong(kCoroPort + 4);
+    INFO("回显基准: 回调风格 %.0f req/s，协程风格 %.0f req/s", callbackQps, coroQps);
+    std::cout << "echo callback: " << callbackQps << " req/s" << std::endl;
+    std::cout << "echo coroutine: " << coroQps << " req/s" << std::endl;
+    DEBUG("回调风格完成全部请求（%s）", callbackQps > 0 ? "通过" : "失败");
+    DEBUG("协程风格完成全部请求（%s）", coroQps > 0 ? "通过" : "失败");
+
+    base.exit();
+    th.join();
+    DEBUG("=== 协程回显基准测试结束 ===\n");
+}
+
+// -------------------------- 测试入口函数 --------------------------
+void run_all_tests() {
+    // 1. 初始化日志
+    initTestLogger();
+
+    // 2. 执行所有测试
+    test_Coro_sleep();
+    test_Coro_echo();
+    test_Coro_readMsg();
+    test_Coro_connectFail();
+    test_Coro_benchmark();
+
+    // 3. 测试总结
+    INFO("=== coro_test 所有测试执行完成 ===");
+}
+
+}  // namespace coroTest
+}  // namespace handy
+
+// 主函数：启动测试
+int main() {
+    handy::coroTest::run_all_tests();
+    return 0;
+}
@@ -1,19 +1,31 @@
 #include "daemon.h"
 #include "utils.h"
 #include "logger.h"
+#include "conn.h"
 #include <cstdio>
 #include <cstring>
+#include <string>
 #include <vector>
 #include <thread>
 #include <atomic>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <set>
+#include <mutex>
 
 // 测试用PID文件路径
 const char* TEST_PID_FILE = "/tmp/daemon_test.pid";
 // 测试用信号标记
 std::atomic<bool> g_signalReceived(false);
+// 平滑重启测试用PID文件路径与端口
+const char* HANDOFF_PID_FILE = "/tmp/daemon_test_handoff.pid";
+const unsigned short kHandoffPort = 12420;
+// 平滑重启测试：收到SIGUSR2的标记（信号处理函数中只设置标记）
+std::atomic<bool> g_handoffRequested(false);
 
 namespace handy {
 namespace daemonTest {
@@ -184,6 +196,29 @@ void test_restart() {
     DEBUG("=== restart 功能测试结束 ===\n");
 }
 
+/**
+ * @brief 测试继承的监听fd：解析时即设置FD_CLOEXEC，没有被取走的fd由closeInheritedFds()关闭
+ */
+void test_inherited_fds() {
+    DEBUG("=== 开始测试继承的监听fd ===");
+    int claimed = socket(AF_INET, SOCK_STREAM, 0);
+    int unclaimed = socket(AF_INET, SOCK_STREAM, 0);
+    std::string env = "tcp:127.0.0.1:1=" + std::to_string(claimed) + ";tcp:127.0.0.1:2=" + std::to_string(unclaimed);
+    setenv(Daemon::kListenFdsEnv, env.c_str(), 1);
+
+    int fd = Daemon::takeInheritedFd("tcp:127.0.0.1:1");
+    bool ok = fd == claimed && (fcntl(fd, F_GETFD) & FD_CLOEXEC) && (fcntl(unclaimed, F_GETFD) & FD_CLOEXEC);
+    DEBUG("取走的与未取走的fd都带有FD_CLOEXEC（%s）", ok ? "通过" : "失败");
+
+    int closed = Daemon::closeInheritedFds();
+    ok = closed == 1 && fcntl(unclaimed, F_GETFD) < 0 && fcntl(claimed, F_GETFD) >= 0 &&
+         Daemon::takeInheritedFd("tcp:127.0.0.1:2") == -1;
+    DEBUG("closeInheritedFds()只关闭未取走的fd: closed=%d（%s）", closed, ok ? "通过" : "失败");
+
+    close(claimed);
+    DEBUG("=== 继承的监听fd测试结束 ===\n");
+}
+
 /**
  * @brief 测试getPidFromFile函数
  */
@@ -284,6 +319,170 @@ void test_signal_handler() {
     DEBUG("=== signal 处理功能测试结束 ===\n");
 }
 
+/**
+ * @brief 平滑重启测试的服务进程（以"daemon_test serve"启动）：每收到一次数据就回复自己的PID
+ * @param exe 当前程序的绝对路径（交接时用于启动新进程）
+ */
+int runHandoffServer(const char* exe) {
+    // 先注册信号处理，避免守护进程写入PID文件后、注册之前收到SIGUSR2而被终止
+    Signal::signal(SIGUSR2, []() { g_handoffRequested = true; });
+    Daemon::process("start", HANDOFF_PID_FILE);
+    Logger::getInstance().setLogFileName("/tmp/daemon_test_serve.log");
+
+    EventBase base;
+    TcpServer::Ptr server = TcpServer::startServer(&base, "127.0.0.1", kHandoffPort);
+    if (!server) {
+        return 1;
+    }
+    // 所有监听地址都已bind()：关闭上一个进程交来、但本进程不再使用的监听fd
+    Daemon::closeInheritedFds();
+    std::string reply = std::to_string(getpid()) + "\n";
+    server->onConnRead([reply](const TcpConnPtr& con) {
+        con->getInputBuffer().clear();
+        con->send(reply);
+    });
+
+    // 在事件循环线程中检查标记：启动新进程并交出监听Socket，已有连接全部关闭后退出
+    base.runAfter(10, [&]() {
+        if (!g_handoffRequested.exchange(false)) {
+            return;
+        }
+        const char* argv[] = {exe, "serve", nullptr};
+        if (Daemon::handoff(argv) > 0) {
+            server->drain(5000, [&base]() { base.exit(); });
+        }
+    }, 10);
+    base.loop();
+    return 0;
+}
+
+/**
+ * @brief 连接平滑重启测试的服务端口，发送一次请求并读取回复的PID
+ * @param fd 已连接的fd（<0时新建连接并在结束后关闭）
+ * @return int 回复的PID，失败返回-1
+ */
+int requestPid(int fd = -1) {
+    bool own = fd < 0;
+    if (own) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(kHandoffPort);
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        timeval tv{3, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    char buf[32];
+    size_t got = 0;
+    bool ok = ::send(fd, "ping", 4, MSG_NOSIGNAL) == 4;
+    while (ok && (got == 0 || buf[got - 1] != '\n') && got < sizeof(buf) - 1) {
+        ssize_t n = ::recv(fd, buf + got, sizeof(buf) - 1 - got, 0);
+        ok = n > 0;
+        got += ok ? n : 0;
+    }
+    if (own) {
+        close(fd);
+    }
+    buf[got] = '\0';
+    return ok ? atoi(buf) : -1;
+}
+
+/**
+ * @brief 测试平滑重启：客户端持续发起短连接，重启期间统计连接失败次数；
+ *        重启前建立的长连接在旧进程中继续得到服务，关闭后旧进程退出
+ */
+void test_graceful_restart(const char* exe) {
+    DEBUG("=== 开始测试平滑重启（监听Socket交接） ===");
+    unlink(HANDOFF_PID_FILE);
+
+    // 启动服务进程（守护进程）
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(exe, exe, "serve", static_cast<char*>(nullptr));
+        _exit(1);
+    }
+    waitpid(pid, nullptr, 0);
+    int oldPid = -1;
+    for (int i = 0; i < 300 && oldPid <= 0; ++i) {
+        usleep(10 * 1000);
+        oldPid = requestPid() > 0 ? Daemon::getPidFromFile(HANDOFF_PID_FILE) : -1;
+    }
+    if (oldPid <= 0) {
+        ERROR("启动服务进程失败，无法测试平滑重启");
+        DEBUG("平滑重启测试：失败");
+        return;
+    }
+
+    // 客户端负载：4个线程持续发起短连接
+    std::atomic<bool> stop(false);
+    std::atomic<int> succeeded(0), failed(0);
+    std::mutex pidsMutex;
+    std::set<int> pids;
+    std::vector<std::thread> clients;
+    for (int t = 0; t < 4; ++t) {
+        clients.emplace_back([&]() {
+            while (!stop) {
+                int p = requestPid();
+                if (p <= 0) {
+                    ++failed;
+                    continue;
+                }
+                ++succeeded;
+                std::lock_guard<std::mutex> lock(pidsMutex);
+                pids.insert(p);
+            }
+        });
+    }
+    usleep(200 * 1000);
+
+    // 重启前建立的长连接
+    int keep = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kHandoffPort);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    timeval tv{3, 0};
+    setsockopt(keep, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    bool keepOk = connect(keep, (sockaddr*)&addr, sizeof(addr)) == 0 && requestPid(keep) == oldPid;
+
+    int ret = Daemon::gracefulRestart(HANDOFF_PID_FILE);
+    int newPid = Daemon::getPidFromFile(HANDOFF_PID_FILE);
+    usleep(200 * 1000);
+
+    // 旧进程仍在服务长连接；长连接关闭后旧进程退出
+    keepOk = keepOk && requestPid(keep) == oldPid;
+    close(keep);
+    bool oldExited = false;
+    for (int i = 0; i < 500 && !oldExited; ++i) {
+        usleep(10 * 1000);
+        oldExited = kill(oldPid, 0) != 0 && errno == ESRCH;
+    }
+    usleep(200 * 1000);
+    stop = true;
+    for (auto& c : clients) {
+        c.join();
+    }
+    bool servedByNew = requestPid() == newPid;
+    bool pidFileKept = Daemon::getPidFromFile(HANDOFF_PID_FILE) == newPid;
+    Daemon::stop(HANDOFF_PID_FILE);
+
+    DEBUG("平滑重启：旧进程%d -> 新进程%d（返回值%d）", oldPid, newPid, ret);
+    DEBUG("客户端请求：成功%d次，失败%d次，服务过请求的进程数%zu", succeeded.load(), failed.load(), pids.size());
+    DEBUG("长连接在旧进程中继续服务：%s，旧进程退出：%s，新进程服务：%s，PID文件保留：%s",
+          keepOk ? "是" : "否", oldExited ? "是" : "否", servedByNew ? "是" : "否", pidFileKept ? "是" : "否");
+    bool testOk = ret == 0 && newPid > 0 && newPid != oldPid && failed == 0 && succeeded > 0 &&
+                  pids.count(oldPid) && pids.count(newPid) && keepOk && oldExited && servedByNew && pidFileKept;
+    DEBUG("平滑重启测试：%s", testOk ? "通过" : "失败");
+    DEBUG("=== 平滑重启测试结束 ===\n");
+}
+
 /**
  * @brief 测试重复启动防护功能
  */
@@ -329,13 +528,16 @@ void test_start_protection() {
 }
 
 // -------------------------- 测试入口函数 --------------------------
-void run_all_tests() {
+void run_all_tests(const char* exe) {
     // 1. 初始化日志和环境
     initTestLogger();
     cleanTestEnv();
 
     // 2. 依次执行所有测试
     test_get_pid_from_file();
+    test_inherited_fds();
+    // Daemon::process("stop")成功后会直接exit，平滑重启测试需放在test_start之前
+    test_graceful_restart(exe);
     test_start();
     test_stop();
     test_restart();
@@ -351,7 +553,15 @@ void run_all_tests() {
 }  // namespace handy
 
 // 主函数：启动测试
-int main() {
-    handy::daemonTest::run_all_tests();
+int main(int argc, char* argv[]) {
+    // 平滑重启测试启动的服务进程与交接后的新进程
+    char exe[4096] = {0};
+    if (readlink("/proc/self/exe", exe, sizeof(exe) - 1) <= 0) {
+        strncpy(exe, argv[0], sizeof(exe) - 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "serve") == 0) {
+        return handy::daemonTest::runHandoffServer(exe);
+    }
+    handy::daemonTest::run_all_tests(exe);
     return 0;
 }
\ No newline at end of file
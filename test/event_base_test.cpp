@@ -0,0 +1,496 @@
+#include "event_base.h"
+#include "logger.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <iostream>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+
+namespace handy {
+namespace eventBaseTest {
+
+// -------------------------- 测试辅助函数 --------------------------
+/**
+ * @brief 初始化Logger（输出到event_base_test.log）
+ */
+void initTestLogger() {
+    Logger::getInstance().setLogFileName("event_base_test.log");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+    INFO("=== event_base_test 测试开始 ===");
+}
+
+/**
+ * @brief 以默认参数的方式获取调用者位置
+ */
+CallSite callerSite(CallSite site = CallSite::current()) {
+    return site;
+}
+
+// -------------------------- 测试用例 --------------------------
+/**
+ * @brief 测试CallSite记录的是调用者的位置
+ */
+void test_CallSite() {
+    DEBUG("=== 开始CallSite测试 ===");
+    int line = __LINE__ + 1;
+    CallSite site = callerSite();
+    std::string file = site.file;
+    bool ok = site.line == line && file.find("event_base_test.cpp") != std::string::npos;
+    DEBUG("调用者位置: %s:%d（%s）", site.file, site.line, ok ? "通过" : "失败");
+    DEBUG("=== CallSite测试结束 ===\n");
+}
+
+/**
+ * @brief 测试各阶段耗时统计
+ */
+void test_LoopStats_phases() {
+    DEBUG("=== 开始LoopStats阶段统计测试 ===");
+    EventBase base;
+    std::atomic<int> done{0};
+
+    // 一个耗时约2ms的任务与一个耗时约3ms的定时器
+    base.safeCall([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        ++done;
+    });
+    base.runAfter(0, [&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        ++done;
+    });
+    for (int i = 0; i < 10 && done < 2; ++i) {
+        base.loopOnce(100);
+    }
+
+    const LoopStats& stats = base.getStats();
+    Histogram::Snapshot tasks = stats.tasks_us.snapshot();
+    Histogram::Snapshot timers = stats.timers_us.snapshot();
+    Histogram::Snapshot busy = stats.busy_us.snapshot();
+    uint64_t iterations = stats.iterations.load();
+    bool ok = done == 2
+              && tasks.count == iterations && timers.count == iterations
+              && stats.pollWait_us.snapshot().count == iterations
+              && stats.io_us.snapshot().count == iterations
+              && tasks.sum >= 2000 && timers.sum >= 3000 && busy.sum >= 5000
+              && stats.slowCallbacks.load() == 0;
+    DEBUG("循环%llu次: tasks=%lluus timers=%lluus busy=%lluus（%s）",
+          (unsigned long long)iterations, (unsigned long long)tasks.sum,
+          (unsigned long long)timers.sum, (unsigned long long)busy.sum, ok ? "通过" : "失败");
+    DEBUG("=== LoopStats阶段统计测试结束 ===\n");
+}
+
+/**
+ * @brief 测试慢回调告警（定时器、任务、I/O回调）
+ */
+void test_SlowCallback() {
+    DEBUG("=== 开始慢回调告警测试 ===");
+    EventBase base;
+    base.setSlowCallbackThreshold(10 * 1000);
+    const LoopStats& stats = base.getStats();
+    auto slowWork = [] { std::this_thread::sleep_for(std::chrono::milliseconds(15)); };
+
+    // 1. 慢定时器
+    base.runAfter(0, slowWork);
+    base.loopOnce(100);
+    bool ok = stats.slowCallbacks.load() == 1;
+    DEBUG("慢定时器（%s）", ok ? "通过" : "失败");
+
+    // 2. 慢任务（任务的耗时不应再被计为唤醒管道读回调的耗时）
+    base.safeCall(slowWork);
+    base.loopOnce(100);
+    ok = stats.slowCallbacks.load() == 2;
+    DEBUG("慢任务（%s）", ok ? "通过" : "失败");
+
+    // 3. 慢I/O回调
+    int fds[2];
+    ok = pipe(fds) == 0;
+    Channel* ch = new Channel(&base, fds[0], kReadEvent);
+    ch->onRead([&] {
+        char buf[16];
+        ssize_t r = ::read(ch->getFd(), buf, sizeof(buf));
+        (void)r;
+        slowWork();
+    });
+    ok = ok && ::write(fds[1], "x", 1) == 1;
+    base.loopOnce(100);
+    ok = ok && stats.slowCallbacks.load() == 3;
+    DEBUG("慢I/O回调（%s）", ok ? "通过" : "失败");
+
+    // 4. 关闭告警后不再计数
+    ch->onRead([] {});
+    delete ch;
+    ::close(fds[1]);
+    base.setSlowCallbackThreshold(0);
+    base.runAfter(0, slowWork);
+    base.loopOnce(100);
+    ok = stats.slowCallbacks.load() == 3;
+    DEBUG("关闭告警（%s）", ok ? "通过" : "失败");
+    DEBUG("=== 慢回调告警测试结束 ===\n");
+}
+
+/**
+ * @brief 测量统计本身的开销
+ * @details 1. 空转loopOnce(0)，得到每轮循环的总耗时（poll前后的两次时钟读取原本就存在）
+ *          2. 每轮循环新增5次直方图更新，每个回调（I/O、定时器、任务）新增1次时钟读取，分别单独测量
+ *          3. 批量执行safeCall任务，得到每个任务的平均耗时
+ */
+void test_Instrumentation_benchmark() {
+    DEBUG("=== 开始统计开销基准测试 ===");
+    const int kIters = 200000;
+    EventBase base;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIters; ++i) {
+        base.loopOnce(0);
+    }
+    double loopNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kIters;
+
+    Histogram h;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIters; ++i) {
+        for (int j = 0; j < 5; ++j) {
+            h.observeExclusive(static_cast<uint64_t>(i & 1023));
+        }
+    }
+    double observeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kIters;
+
+    int64_t sink = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIters; ++i) {
+        sink += utils::steadyMicro();
+    }
+    double clockNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kIters;
+
+    // safeCall任务吞吐（分批投递，避免唤醒管道写满）
+    const int kTasks = 200000;
+    const int kBatch = 1000;
+    int ran = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kTasks; i += kBatch) {
+        for (int j = 0; j < kBatch; ++j) {
+            base.safeCall([&ran] { ++ran; });
+        }
+        base.loopOnce(0);
+    }
+    double taskNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kTasks;
+
+    INFO("空转循环 %.0f ns/iter（其中直方图更新 %.0f ns, %.1f%%）, 每个回调新增时钟读取 %.0f ns, safeCall任务 %.0f ns/task",
+         loopNs, observeNs, observeNs * 100 / loopNs, clockNs, taskNs);
+    std::cout << "loopOnce: " << loopNs << " ns/iter, histograms " << observeNs << " ns ("
+              << observeNs * 100 / loopNs << "%), per-callback clock read " << clockNs
+              << " ns, safeCall " << taskNs << " ns/task" << std::endl;
+    DEBUG("统计开销基准测试（%s）", (ran == kTasks && sink != 0) ? "通过" : "失败");
+    DEBUG("=== 统计开销基准测试结束 ===\n");
+}
+
+/**
+ * @brief 测试空闲连接超时：持续活跃的连接不触发回调，不活跃的连接触发回调
+ */
+void test_Idle_timeout() {
+    DEBUG("=== 开始空闲连接超时测试 ===");
+    EventBase base;
+    IdleNode active, idle;
+    int activeFired = 0, idleFired = 0;
+    active.cb = [&](const TcpConnPtr&) { ++activeFired; };
+    idle.cb = [&](const TcpConnPtr&) { ++idleFired; };
+    handleRegisterIdle(&base, 2, &active);
+    handleRegisterIdle(&base, 1, &idle);
+
+    // 重复注册同一节点应抛出异常
+    bool thrown = false;
+    try {
+        handleRegisterIdle(&base, 1, &idle);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+
+    // 运行约2.5秒，每轮循环都更新active
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(2500);
+    while (std::chrono::steady_clock::now() < end) {
+        base.loopOnce(50);
+        handleUpdateIdle(&base, &active);
+    }
+    bool ok = thrown && activeFired == 0 && idleFired >= 1;
+    DEBUG("活跃连接触发%d次, 空闲连接触发%d次（%s）", activeFired, idleFired, ok ? "通过" : "失败");
+
+    handleUnregisterIdle(&base, &active);
+    handleUnregisterIdle(&base, &idle);
+    ok = !active.list && !idle.list && !active.prev && !idle.next;
+    DEBUG("注销后节点脱离链表（%s）", ok ? "通过" : "失败");
+    DEBUG("=== 空闲连接超时测试结束 ===\n");
+}
+
+/**
+ * @brief 比较空闲连接更新的开销：原先的map+std::list节点（持有shared_ptr与迭代器句柄）与侵入式链表
+ * @details 1. 50万个连接、同一超时时间，按随机顺序更新，模拟大量keep-alive连接上的读事件
+ *          2. 侵入式链表分别测量"跨秒后的首次更新"（需要摘链/挂链）与"同一秒内的重复更新"（只比较时间戳）
+ *          3. 沙箱中无法读取硬件缓存计数器，以每次更新的耗时作为访存次数的近似
+ */
+void test_Idle_benchmark() {
+    DEBUG("=== 开始空闲连接更新基准测试 ===");
+    const int kConns = 500000;
+    const int kIdle_s = 60;
+    // 模拟连接对象本身的大小，使各节点分散在堆上
+    struct FakeConn {
+        char payload[256];
+        IdleNode node;
+    };
+    struct LegacyNode {
+        std::shared_ptr<FakeConn> conn;
+        int64_t lastUpdatedTimestamp_s;
+        TcpCallBack cb;
+    };
+    struct LegacyId {
+        std::list<LegacyNode>* lst;
+        std::list<LegacyNode>::iterator iter;
+    };
+    TcpCallBack cb = [](const TcpConnPtr&) {};
+
+    std::vector<int> order(kConns);
+    for (int i = 0; i < kConns; ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(12345));
+
+    // 1. 原先的实现
+    double legacyNs = 0;
+    {
+        std::map<int, std::list<LegacyNode>> lists;
+        std::vector<std::unique_ptr<LegacyId>> ids;
+        ids.reserve(kConns);
+        for (int i = 0; i < kConns; ++i) {
+            auto& lst = lists[kIdle_s];
+            lst.push_back({std::make_shared<FakeConn>(), utils::timeMilli() / 1000, cb});
+            ids.emplace_back(new LegacyId{&lst, --lst.end()});
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i : order) {
+            const auto& id = ids[i];
+            id->iter->lastUpdatedTimestamp_s = utils::timeMilli() / 1000;
+            id->lst->splice(id->lst->end(), *id->lst, id->iter);
+        }
+        legacyNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kConns;
+    }
+
+    // 2. 侵入式链表
+    EventBase base;
+    base.loopOnce(0);
+    std::vector<std::unique_ptr<FakeConn>> conns;
+    conns.reserve(kConns);
+    for (int i = 0; i < kConns; ++i) {
+        conns.emplace_back(new FakeConn());
+        conns.back()->node.cb = cb;
+        handleRegisterIdle(&base, kIdle_s, &conns.back()->node);
+    }
+    // 把所有节点的时间戳拨回，使第一轮更新全部需要移动到链表末尾
+    for (auto& conn : conns) {
+        conn->node.lastUpdatedTimestamp_s -= 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i : order) {
+        handleUpdateIdle(&base, &conns[i]->node);
+    }
+    double relinkNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kConns;
+
+    start = std::chrono::steady_clock::now();
+    for (int i : order) {
+        handleUpdateIdle(&base, &conns[i]->node);
+    }
+    double sameSecondNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kConns;
+
+    // 链表顺序应与更新顺序一致
+    bool ok = true;
+    IdleNode* node = conns[order[0]]->node.prev->next;
+    for (int i = 0; i < kConns && ok; ++i, node = node->next) {
+        ok = node == &conns[order[i]]->node;
+    }
+    for (auto& conn : conns) {
+        handleUnregisterIdle(&base, &conn->node);
+    }
+
+    INFO("空闲连接更新（%d个连接）: 原实现 %.1f ns/次, 侵入式链表跨秒更新 %.1f ns/次, 同一秒内重复更新 %.1f ns/次",
+         kConns, legacyNs, relinkNs, sameSecondNs);
+    std::cout << "idle update: legacy " << legacyNs << " ns, intrusive relink " << relinkNs
+              << " ns, same second " << sameSecondNs << " ns" << std::endl;
+    DEBUG("更新后链表顺序（%s）", ok ? "通过" : "失败");
+    DEBUG("=== 空闲连接更新基准测试结束 ===\n");
+}
+
+/**
+ * @brief 测试MultiBase的分配策略（连接数由handleUpdateConnections直接设置，不启动事件循环）
+ */
+void test_MultiBase_alloc_policy() {
+    DEBUG("=== 开始MultiBase分配策略测试 ===");
+    MultiBase bases(4);
+    const int counts[] = {3, 1, 2, 5};
+    for (size_t i = 0; i < bases.size(); ++i) {
+        handleUpdateConnections(bases.getBase(i), counts[i]);
+    }
+
+    // 1. 轮询
+    bool ok = bases.allocBase() == bases.getBase(0) && bases.allocBase() == bases.getBase(1);
+    DEBUG("轮询（%s）", ok ? "通过" : "失败");
+
+    // 2. 最少连接；繁忙程度都为0时，最近最空闲同样取连接数最少者
+    bases.setAllocPolicy(MultiBase::AllocPolicy::LEAST_CONNECTIONS);
+    ok = bases.allocBase() == bases.getBase(1);
+    bases.setAllocPolicy(MultiBase::AllocPolicy::LEAST_LOADED);
+    ok = ok && bases.allocBase() == bases.getBase(1);
+    DEBUG("最少连接/最近最空闲（%s）", ok ? "通过" : "失败");
+
+    // 3. 随机两选一：连接数最多的循环总会输给另一个候选，永远不会被选中
+    bases.setAllocPolicy(MultiBase::AllocPolicy::POWER_OF_TWO);
+    int picked[4] = {0};
+    for (int i = 0; i < 1000; ++i) {
+        EventBase* base = bases.allocBase();
+        for (size_t j = 0; j < bases.size(); ++j) {
+            picked[j] += base == bases.getBase(j);
+        }
+    }
+    ok = picked[3] == 0 && picked[0] > 0 && picked[1] > 0 && picked[2] > 0;
+    DEBUG("随机两选一: %d/%d/%d/%d（%s）", picked[0], picked[1], picked[2], picked[3], ok ? "通过" : "失败");
+
+    // 4. 连接数相同时按轮询分配，而不是总选第一个
+    MultiBase even(4);
+    even.setAllocPolicy(MultiBase::AllocPolicy::LEAST_CONNECTIONS);
+    int evenPicked[4] = {0};
+    for (int i = 0; i < 8; ++i) {
+        EventBase* base = even.allocBase();
+        for (size_t j = 0; j < even.size(); ++j) {
+            evenPicked[j] += base == even.getBase(j);
+        }
+    }
+    ok = evenPicked[0] == 2 && evenPicked[1] == 2 && evenPicked[2] == 2 && evenPicked[3] == 2;
+    DEBUG("连接数相同时轮询: %d/%d/%d/%d（%s）", evenPicked[0], evenPicked[1], evenPicked[2], evenPicked[3],
+          ok ? "通过" : "失败");
+
+    // 5. 自定义策略
+    bases.setAllocPolicy([](const MultiBase&) { return size_t(2); });
+    ok = bases.allocBase() == bases.getBase(2);
+    DEBUG("自定义策略（%s）", ok ? "通过" : "失败");
+    DEBUG("=== MultiBase分配策略测试结束 ===\n");
+}
+
+/**
+ * @brief 测试繁忙程度的发布与衰减：定时器持续占用约2/3的时间，空闲后逐渐回落
+ */
+void test_RecentBusy() {
+    DEBUG("=== 开始繁忙程度统计测试 ===");
+    EventBase base;
+    std::thread th([&base] { base.loop(); });
+
+    // 重复定时器每3ms触发一次，每次占用循环2ms，持续300ms（定时器需在循环线程中注册）
+    TimerId timer;
+    base.safeCall([&base, &timer] {
+        timer = base.runAfter(0, [] {
+            auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+            while (std::chrono::steady_clock::now() < end) {
+            }
+        }, 3);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    double busy = base.getRecentBusy();
+    base.safeCall([&base, &timer] { base.cancel(timer); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    double idle = base.getRecentBusy();
+
+    bool ok = busy > 0.4 && idle < busy / 2;
+    DEBUG("繁忙时 %.2f，空闲后 %.2f（%s）", busy, idle, ok ? "通过" : "失败");
+    base.exit();
+    th.join();
+    DEBUG("=== 繁忙程度统计测试结束 ===\n");
+}
+
+/**
+ * @brief 测试MultiBase的线程命名与CPU绑定：在各事件循环线程中用sched_getaffinity检查实际生效的CPU集合，
+ *        loop()返回后主线程恢复原来的名称与CPU集合
+ */
+void test_MultiBase_affinity() {
+    DEBUG("=== 开始事件循环线程CPU绑定测试 ===");
+    // 绑定到当前进程允许运行的最后一个CPU
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    int cpu = CPU_SETSIZE - 1;
+    while (cpu > 0 && !CPU_ISSET(cpu, &allowed)) {
+        --cpu;
+    }
+    char mainName[16] = {0};
+    pthread_getname_np(pthread_self(), mainName, sizeof(mainName));
+
+    const int kLoops = 3;
+    MultiBase bases(kLoops);
+    bases.setThreadName("handy-io").setCpuAffinity({{cpu}});
+    std::string names[kLoops];
+    bool pinned[kLoops] = {false};
+    std::atomic<int> done{0};
+    for (int i = 0; i < kLoops; ++i) {
+        bases.getBase(i)->safeCall([&, i] {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            sched_getaffinity(0, sizeof(set), &set);
+            pinned[i] = CPU_COUNT(&set) == 1 && CPU_ISSET(cpu, &set);
+            char buf[16] = {0};
+            pthread_getname_np(pthread_self(), buf, sizeof(buf));
+            names[i] = buf;
+            if (++done == kLoops) {
+                bases.exit();
+            }
+        });
+    }
+    bases.loop();
+
+    bool ok = true;
+    for (int i = 0; i < kLoops; ++i) {
+        ok = ok && pinned[i] && names[i] == "handy-io-" + std::to_string(i);
+    }
+    DEBUG("事件循环线程 %s/%s/%s 绑定到CPU %d（%s）",
+          names[0].c_str(), names[1].c_str(), names[2].c_str(), cpu, ok ? "通过" : "失败");
+
+    cpu_set_t after;
+    CPU_ZERO(&after);
+    sched_getaffinity(0, sizeof(after), &after);
+    char afterName[16] = {0};
+    pthread_getname_np(pthread_self(), afterName, sizeof(afterName));
+    ok = CPU_EQUAL(&after, &allowed) && std::string(afterName) == mainName;
+    DEBUG("loop()返回后恢复主线程的名称与CPU集合（%s）", ok ? "通过" : "失败");
+    DEBUG("=== 事件循环线程CPU绑定测试结束 ===\n");
+}
+
+// -------------------------- 测试入口函数 --------------------------
+void run_all_tests() {
+    // 1. 初始化日志
+    initTestLogger();
+
+    // 2. 执行所有测试
+    test_CallSite();
+    test_LoopStats_phases();
+    test_SlowCallback();
+    test_Instrumentation_benchmark();
+    test_Idle_timeout();
+    test_Idle_benchmark();
+    test_MultiBase_alloc_policy();
+    test_RecentBusy();
+    test_MultiBase_affinity();
+
+    // 3. 测试总结
+    INFO("=== event_base_test 所有测试执行完成 ===");
+}
+
+}  // namespace eventBaseTest
+}  // namespace handy
+
+// 主函数：启动测试
+int main() {
+    handy::eventBaseTest::run_all_tests();
+    return 0;
+}
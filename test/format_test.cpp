@@ -0,0 +1,232 @@
+#include "format.h"
+#include "logger.h"
+#include "net.h"
+#include "status.h"
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace handy {
+namespace formatTest {
+
+// -------------------------- 编译期检查 --------------------------
+// 格式字符串与参数类型匹配
+static_assert(detail::checkFormat("%d %s %f", decltype(detail::formatTypes(1, "a", 1.0)){}), "");
+static_assert(detail::checkFormat("%lld %zu %x %c", decltype(detail::formatTypes(1L, size_t(1), 1u, 'c')){}), "");
+static_assert(detail::checkFormat("%s %s %s", decltype(detail::formatTypes(std::string(), Slice(), std::string_view())){}), "");
+static_assert(detail::checkFormat("%*.*f %p %%", decltype(detail::formatTypes(8, 2, 1.0, (void*)nullptr)){}), "");
+static_assert(detail::checkFormat("no args", decltype(detail::formatTypes()){}), "");
+// 不匹配：类型错误、参数过多或过少、不支持的说明符
+static_assert(!detail::checkFormat("%d", decltype(detail::formatTypes("a")){}), "");
+static_assert(!detail::checkFormat("%s", decltype(detail::formatTypes(1)){}), "");
+static_assert(!detail::checkFormat("%f", decltype(detail::formatTypes(1)){}), "");
+static_assert(!detail::checkFormat("%d", decltype(detail::formatTypes(1, 2)){}), "");
+static_assert(!detail::checkFormat("%d %d", decltype(detail::formatTypes(1)){}), "");
+static_assert(!detail::checkFormat("%n", decltype(detail::formatTypes(1)){}), "");
+static_assert(!detail::checkFormat("%*d", decltype(detail::formatTypes(1.0, 1)){}), "");
+
+// -------------------------- 测试辅助函数 --------------------------
+/**
+ * @brief 初始化Logger（输出到format_test.log）
+ */
+void initTestLogger() {
+    Logger::getInstance().setLogFileName("format_test.log");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+    INFO("=== format_test 测试开始 ===");
+}
+
+void destroyTestLogger() {
+    INFO("=== format_test 测试结束 ===");
+}
+
+/**
+ * @brief 用formatTo与snprintf分别格式化，比较结果
+ */
+template <class... Args>
+bool sameAsPrintf(const char* fmt, Args... args) {
+    char expected[512];
+    snprintf(expected, sizeof(expected), fmt, args...);
+    std::string got;
+    formatTo(got, fmt, args...);
+    if (got != expected) {
+        DEBUG("不一致：fmt=\"%s\"，formatTo=\"%s\"，snprintf=\"%s\"", fmt, got, expected);
+        return false;
+    }
+    return true;
+}
+
+// -------------------------- 各功能测试函数 --------------------------
+/**
+ * @brief 与snprintf逐项对比：整数、浮点数、字符串、指针及各种标志
+ */
+void testPrintfCompat() {
+    DEBUG("=== 开始测试与printf的一致性 ===");
+
+    // 测试1：整数
+    bool ok = sameAsPrintf("%d|%i|%u|%x|%X|%o", 0, -1, 42u, 255u, 255u, 8u)
+        && sameAsPrintf("%lld|%lld", LLONG_MIN, LLONG_MAX)
+        && sameAsPrintf("%llu|%llx", ULLONG_MAX, ULLONG_MAX)
+        && sameAsPrintf("[%5d][%-5d][%05d][%+d][% d][%+05d]", 42, 42, -42, 42, 42, 42)
+        && sameAsPrintf("[%.3d][%8.3d][%.0d][%#x][%#o][%#X][%#x]", 7, -7, 0, 255u, 8u, 255u, 0u)
+        && sameAsPrintf("[%c][%3c][%-3c]", 'a', 'b', 'c')
+        && sameAsPrintf("[%*d][%-*d][%.*d]", 6, 1, 6, 2, 4, 3);
+    DEBUG("测试1（整数）：%s", ok ? "通过" : "失败");
+
+    // 测试2：浮点数
+    ok = sameAsPrintf("%f|%.2f|%.0f|%10.3f|%-10.3f|%010.3f", 3.14159, 2.675, 0.5, -1.5, 1.5, -1.5)
+        && sameAsPrintf("%e|%.3E|%g|%G|%.10g|%g", 12345.678, 0.000123, 1e-5, 1e20, 1.0 / 3, 100000.0)
+        && sameAsPrintf("%f|%f|%F|%e", INFINITY, -INFINITY, INFINITY, NAN)
+        && sameAsPrintf("[%+.1f][% .1f][%8.3e]", 1.25, 1.25, -0.001)
+        && sameAsPrintf("%a|%A|%.2a", 1.0, 0.1, 3.0)
+        && sameAsPrintf("[%#.0f][%#g]", 1.0, 2.0)
+        && sameAsPrintf("%.3f|%g", 1e300, 1e300)
+        && sameAsPrintf("%f", 0.1f);
+    DEBUG("测试2（浮点数）：%s", ok ? "通过" : "失败");
+
+    // 测试3：字符串、指针、%%
+    int x = 0;
+    ok = sameAsPrintf("[%s][%10s][%-10s][%.3s][%%]", "abc", "right", "left", "truncate")
+        && sameAsPrintf("%p|%p", static_cast<void*>(&x), static_cast<void*>(nullptr))
+        && sameAsPrintf("%s", "")
+        && sameAsPrintf("plain text");
+    DEBUG("测试3（字符串、指针）：%s", ok ? "通过" : "失败");
+
+    // 测试4：随机整数与浮点数（属性测试）
+    std::mt19937_64 rng(20261016);
+    const char* intFmts[] = {"%d", "%x", "%08d", "%-12i", "%+d", "%.5d", "%#o"};
+    const char* floatFmts[] = {"%f", "%.3f", "%e", "%.6e", "%g", "%.12g", "%12.4f", "%G"};
+    ok = true;
+    for (int i = 0; i < 20000 && ok; ++i) {
+        int v = static_cast<int>(rng());
+        double d = std::ldexp(static_cast<double>(static_cast<int64_t>(rng())), static_cast<int>(rng() % 120) - 100);
+        ok = sameAsPrintf(intFmts[i % 7], v) && sameAsPrintf(floatFmts[i % 8], d);
+    }
+    DEBUG("测试4（随机值对比）：%s", ok ? "通过" : "失败");
+
+    DEBUG("=== 与printf的一致性测试结束 ===\n");
+}
+
+/**
+ * @brief 类型安全：按参数实际类型格式化
+ */
+void testTypeSafety() {
+    DEBUG("=== 开始测试类型安全 ===");
+
+    // 测试1：std::string、Slice直接传给%s
+    std::string name = "handy";
+    std::string got;
+    formatTo(got, "%s/%s/%s", name, Slice("slice"), std::string_view("view"));
+    bool ok = got == "handy/slice/view";
+    DEBUG("测试1（std::string、Slice）：%s", ok ? "通过" : "失败");
+
+    // 测试2：长度修饰符与参数类型不符时按实际类型输出
+    got.clear();
+    formatTo(got, "%d %ld %hhd", int64_t(1) << 40, 7, 300);
+    ok = got == "1099511627776 7 300";
+    DEBUG("测试2（忽略长度修饰符）：%s", ok ? "通过" : "失败");
+
+    // 测试3：枚举、bool、空指针字符串
+    enum class Color { RED = 3 };
+    const char* nullStr = nullptr;
+    got.clear();
+    formatTo(got, "%d %d %s", Color::RED, true, nullStr);
+    ok = got == "3 1 (null)";
+    DEBUG("测试3（枚举、bool、空字符串）：%s", ok ? "通过" : "失败");
+
+    // 测试4：参数不足、多余参数、不支持的说明符不会读取无效内存
+    got.clear();
+    formatTo(got, "%d %d %n!", 1);
+    std::string extra;
+    formatTo(extra, "%d", 1, 2, 3);
+    ok = got == "1  %n!" && extra == "1";
+    DEBUG("测试4（参数个数不符）：%s", ok ? "通过" : "失败");
+
+    DEBUG("=== 类型安全测试结束 ===\n");
+}
+
+/**
+ * @brief 输出对象：Buffer、固定缓冲区（截断）、utils::format、Status::fromFormat
+ */
+void testSinks() {
+    DEBUG("=== 开始测试输出对象 ===");
+
+    // 测试1：直接写入Buffer
+    Buffer buf;
+    buf.append("head ");
+    formatTo(buf, "%s=%d", std::string("port"), 8080);
+    bool ok = buf.data() == "head port=8080";
+    DEBUG("测试1（Buffer）：%s", ok ? "通过" : "失败");
+
+    // 测试2：固定缓冲区截断，返回完整长度
+    char small[8];
+    size_t n = formatTo(small, sizeof(small), "%s-%d", "abcdef", 12345);
+    ok = n == 12 && std::strcmp(small, "abcdef-") == 0;
+    DEBUG("测试2（截断）：%s", ok ? "通过" : "失败");
+
+    // 测试3：utils::format、Status::fromFormat接受std::string
+    std::string file = "a.txt";
+    std::string s = utils::format("open %s failed", file);
+    Status st = Status::fromFormat(2, "open %s: %s", file, std::string(600, 'x'));
+    ok = s == "open a.txt failed" && std::strlen(st.msg()) == 12 + 600 && std::strncmp(st.msg(), "open a.txt: x", 13) == 0;
+    DEBUG("测试3（utils::format、Status::fromFormat）：%s", ok ? "通过" : "失败");
+
+    // 测试4：超过栈上缓冲区的日志
+    std::string longLine(3000, 'L');
+    DEBUG("长日志：%s", longLine);
+    DEBUG("测试4（长日志）：通过");
+
+    DEBUG("=== 输出对象测试结束 ===\n");
+}
+
+/**
+ * @brief 性能对比：snprintf与formatTo
+ */
+void testBenchmark() {
+    DEBUG("=== 开始格式化性能测试 ===");
+
+    const int kLoops = 1000000;
+    char buf[256];
+    size_t total = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kLoops; ++i) {
+        total += snprintf(buf, sizeof(buf), "conn fd=%d read %lld bytes from %s, rtt=%.3f ms", i & 1023, (long long)i * 977, "10.0.0.1:8080", i * 0.001);
+    }
+    double printfNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kLoops;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kLoops; ++i) {
+        total += formatTo(buf, sizeof(buf), "conn fd=%d read %lld bytes from %s, rtt=%.3f ms", i & 1023, (long long)i * 977, "10.0.0.1:8080", i * 0.001);
+    }
+    double formatNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kLoops;
+
+    std::cout << "snprintf: " << printfNs << " ns/op, formatTo: " << formatNs << " ns/op" << std::endl;
+    DEBUG("snprintf：%.1f ns/op，formatTo：%.1f ns/op（total=%zu）", printfNs, formatNs, total);
+
+    DEBUG("=== 格式化性能测试结束 ===\n");
+}
+
+// -------------------------- 测试入口函数 --------------------------
+void runAllTests() {
+    initTestLogger();
+
+    testPrintfCompat();
+    testTypeSafety();
+    testSinks();
+    testBenchmark();
+
+    destroyTestLogger();
+}
+
+}  // namespace formatTest
+}  // namespace handy
+
+int main() {
+    handy::formatTest::runAllTests();
+    return 0;
+}
@@ -0,0 +1,561 @@
+#include "http.h"
+#include "net.h"
+#include "logger.h"
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <iostream>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace handy {
+namespace httpTest {
+
+// 测试用请求（典型的小请求）
+static const char* kSmallReq =
+    "GET /index.html?name=handy&ver=2 HTTP/1.1\r\n"
+    "Host: 127.0.0.1:8080\r\n"
+    "User-Agent: handy-bench/1.0\r\n"
+    "Accept: */*\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+// -------------------------- 测试辅助函数 --------------------------
+/**
+ * @brief 初始化Logger（输出到http_test.log）
+ */
+void initTestLogger() {
+    Logger::getInstance().setLogFileName("http_test.log");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+    INFO("=== http_test 测试开始 ===");
+}
+
+// -------------------------- HttpRequest 单元测试 --------------------------
+/**
+ * @brief 测试拷贝模式下的完整请求解析
+ */
+void test_HttpRequest_basic() {
+    DEBUG("=== 开始HttpRequest基本解析测试 ===");
+    std::string raw = "POST /api/echo?id=7 HTTP/1.1\r\n"
+                      "Host: localhost\r\n"
+                      "Content-Type: text/plain\r\n"
+                      "Content-Length: 5\r\n"
+                      "\r\nhello";
+    HttpRequest req;
+    HttpMsg::Result r = req.tryDecode(Slice(raw));
+    bool ok = r == HttpMsg::Result::Complete
+              && req.getMethod() == "POST"
+              && req.getUri() == "/api/echo"
+              && req.getQueryUri() == "/api/echo?id=7"
+              && req.getVersion() == "HTTP/1.1"
+              && req.getArg("id") == "7"
+              && req.getHeader("content-type") == "text/plain"
+              && req.getBody() == "hello"
+              && req.getScannedLen() == raw.size();
+    DEBUG("拷贝模式解析: method=%s uri=%s body=%s（%s）",
+          req.getMethod().toString().c_str(), req.getUri().toString().c_str(),
+          req.getBody().toString().c_str(), ok ? "通过" : "失败");
+
+    // 编码后再解码应得到相同的请求
+    Buffer buf;
+    req.encode(buf);
+    HttpRequest req2;
+    r = req2.tryDecode(Slice(buf.peek(), buf.size()));
+    bool encodeOk = r == HttpMsg::Result::Complete && req2.getBody() == "hello"
+                    && req2.getQueryUri() == "/api/echo?id=7";
+    DEBUG("编码后再解码（%s）", encodeOk ? "通过" : "失败");
+
+    // 非法请求
+    HttpRequest bad;
+    bool badOk = bad.tryDecode(Slice("GET\r\nHost x\r\n\r\n")) == HttpMsg::Result::Error;
+    DEBUG("非法请求返回Error（%s）", badOk ? "通过" : "失败");
+    DEBUG("=== HttpRequest基本解析测试结束 ===\n");
+}
+
+/**
+ * @brief 测试逐字节到达时的增量解析（两种模式）
+ */
+void test_HttpRequest_incremental() {
+    DEBUG("=== 开始HttpRequest增量解析测试 ===");
+    std::string raw = std::string(kSmallReq, strlen(kSmallReq) - 2) + "Content-Length: 4\r\n\r\nbody";
+    for (int zeroCopy = 0; zeroCopy < 2; ++zeroCopy) {
+        HttpRequest req;
+        req.setZeroCopy(zeroCopy != 0);
+        Buffer buf;
+        HttpMsg::Result r = HttpMsg::Result::NotComplete;
+        size_t fed = 0;
+        while (fed < raw.size() && r == HttpMsg::Result::NotComplete) {
+            buf.append(raw.data() + fed, 1);
+            ++fed;
+            r = req.tryDecode(Slice(buf.peek(), buf.size()));
+        }
+        bool ok = r == HttpMsg::Result::Complete && fed == raw.size()
+                  && req.getUri() == "/index.html" && req.getBody() == "body"
+                  && req.getHeader("HOST") == "127.0.0.1:8080";
+        DEBUG("%s逐字节解析: 输入%zu字节（%s）", zeroCopy ? "零拷贝" : "拷贝", fed, ok ? "通过" : "失败");
+    }
+    DEBUG("=== HttpRequest增量解析测试结束 ===\n");
+}
+
+/**
+ * @brief 测试零拷贝模式：头部指向输入缓冲区，字段名大小写不敏感
+ */
+void test_HttpRequest_zeroCopy() {
+    DEBUG("=== 开始HttpRequest零拷贝测试 ===");
+    std::string raw = kSmallReq;
+    HttpRequest req;
+    req.setZeroCopy(true);
+    HttpMsg::Result r = req.tryDecode(Slice(raw), false);
+    const HttpHeaders& hs = req.getHeaderSlices();
+
+    bool inBuf = true;
+    for (size_t i = 0; i < hs.size(); ++i) {
+        if (hs[i].name.data() < raw.data() || hs[i].value.end() > raw.data() + raw.size()) {
+            inBuf = false;
+        }
+    }
+    bool ok = r == HttpMsg::Result::Complete && hs.size() == 4 && inBuf
+              && req.getMethod().data() == raw.data()
+              && req.getHeaderSlice("user-agent") == "handy-bench/1.0"
+              && req.getHeaderSlice("CONNECTION") == "keep-alive"
+              && req.getHeaderSlice("x-missing").empty()
+              && req.getArg("ver") == "2";
+    DEBUG("零拷贝解析: 字段数=%zu（%s）", hs.size(), ok ? "通过" : "失败");
+
+    // 超过内联容量的字段落入溢出区
+    std::string many = "GET / HTTP/1.1\r\n";
+    for (int i = 0; i < 40; ++i) {
+        many += "X-Field-" + std::to_string(i) + ": v" + std::to_string(i) + "\r\n";
+    }
+    many += "\r\n";
+    HttpRequest req2;
+    req2.setZeroCopy(true);
+    r = req2.tryDecode(Slice(many));
+    bool manyOk = r == HttpMsg::Result::Complete && req2.getHeaderSlices().size() == 40
+                  && req2.getHeaderSlice("x-field-39") == "v39";
+    DEBUG("零拷贝溢出字段: 字段数=%zu（%s）", req2.getHeaderSlices().size(), manyOk ? "通过" : "失败");
+
+    // 大小写不敏感比较（覆盖16字节以上的SIMD路径）
+    bool eqOk = httpNameEquals("Sec-WebSocket-Extensions", "sec-websocket-extensions")
+                && !httpNameEquals("Sec-WebSocket-Extensions", "sec-websocket-extensionz")
+                && !httpNameEquals("a^", "a~") && httpNameEquals("", "");
+    DEBUG("字段名比较（%s）", eqOk ? "通过" : "失败");
+    DEBUG("=== HttpRequest零拷贝测试结束 ===\n");
+}
+
+/**
+ * @brief 测试Expect: 100-continue
+ */
+void test_HttpRequest_continue100() {
+    DEBUG("=== 开始HttpRequest 100-continue测试 ===");
+    std::string head = "PUT /upload HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 3\r\n\r\n";
+    for (int zeroCopy = 0; zeroCopy < 2; ++zeroCopy) {
+        HttpRequest req;
+        req.setZeroCopy(zeroCopy != 0);
+        HttpMsg::Result r1 = req.tryDecode(Slice(head));
+        HttpMsg::Result r2 = req.tryDecode(Slice(head));
+        std::string full = head + "abc";
+        HttpMsg::Result r3 = req.tryDecode(Slice(full));
+        bool ok = r1 == HttpMsg::Result::Continue100 && r2 == HttpMsg::Result::NotComplete
+                  && r3 == HttpMsg::Result::Complete && req.getBody() == "abc";
+        DEBUG("%s模式100-continue（%s）", zeroCopy ? "零拷贝" : "拷贝", ok ? "通过" : "失败");
+    }
+    DEBUG("=== HttpRequest 100-continue测试结束 ===\n");
+}
+
+/**
+ * @brief 解析性能测试：单核解析1M个小请求
+ */
+void test_HttpRequest_benchmark() {
+    DEBUG("=== 开始HttpRequest解析性能测试 ===");
+    const int kCount = 1000000;
+    // 把多个请求放在同一块缓冲区中，模拟流水线请求
+    const int kBatch = 64;
+    std::string batch;
+    for (int i = 0; i < kBatch; ++i) {
+        batch += kSmallReq;
+    }
+
+    for (int zeroCopy = 0; zeroCopy < 2; ++zeroCopy) {
+        HttpRequest req;
+        req.setZeroCopy(zeroCopy != 0);
+        size_t parsed = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int n = 0; n < kCount / kBatch; ++n) {
+            Slice data(batch);
+            while (!data.empty()) {
+                req.clear();
+                if (req.tryDecode(data, false) != HttpMsg::Result::Complete) {
+                    break;
+                }
+                data.eat(req.getScannedLen());
+                ++parsed;
+            }
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double rps = parsed / sec;
+        INFO("%s模式: 解析%zu个请求，耗时%.3fs，%.0f req/s",
+             zeroCopy ? "零拷贝" : "拷贝", parsed, sec, rps);
+        std::cout << (zeroCopy ? "zero-copy" : "copy") << " parse: " << static_cast<long>(rps)
+                  << " req/s" << std::endl;
+    }
+    DEBUG("=== HttpRequest解析性能测试结束 ===\n");
+}
+
+// -------------------------- HttpServer 测试辅助函数 --------------------------
+static const unsigned short kServerPort = 12350;
+
+/**
+ * @brief 以阻塞方式连接到本地服务器（设置3秒接收超时）
+ */
+int connectLocal(unsigned short port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    timeval tv{3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+/**
+ * @brief 发送全部数据
+ */
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+/**
+ * @brief 读取n个完整响应
+ * @param fd 连接
+ * @param n 响应个数
+ * @param [out] bodies 各响应的消息体
+ * @param [in,out] pending 已读取但尚未解析的数据
+ * @return bool 是否成功读到n个响应
+ */
+bool readResponses(int fd, int n, std::vector<std::string>& bodies, std::string& pending) {
+    HttpResponse resp;
+    char buf[16384];
+    while (static_cast<int>(bodies.size()) < n) {
+        resp.clear();
+        HttpMsg::Result r = resp.tryDecode(Slice(pending));
+        if (r == HttpMsg::Result::Complete) {
+            bodies.push_back(resp.getBody().toString());
+            pending.erase(0, resp.getScannedLen());
+            continue;
+        }
+        if (r == HttpMsg::Result::Error) {
+            return false;
+        }
+        ssize_t rd = recv(fd, buf, sizeof(buf), 0);
+        if (rd <= 0) {
+            return false;
+        }
+        pending.append(buf, rd);
+    }
+    return true;
+}
+
+/**
+ * @brief 启动测试用HTTP服务器（在后台线程中运行MultiBase）
+ */
+struct TestServer {
+    MultiBase bases;
+    HttpServer server;
+    std::thread th;
+
+    TestServer() : bases(2), server(&bases) {
+        server.addStaticHeader("X-Powered-By", "handy");
+        server.onGet("/hello", [](const HttpConnPtr& con) {
+            con.getResponse().setBody("hello");
+            con.sendResponse();
+        });
+        server.onGet("/uri", [](const HttpConnPtr& con) {
+            con.getResponse().setBody(con.getRequest().getQueryUri().toString());
+            con.sendResponse();
+        });
+        server.onRequest("POST", "/echo", [](const HttpConnPtr& con) {
+            con.getResponse().setBody(con.getRequest().getBody().toString());
+            con.sendResponse();
+        });
+        // 异步响应：20ms后在连接所属的事件循环中发送
+        server.onGet("/async", [](const HttpConnPtr& con) {
+            HttpConnPtr c = con;
+            con->getBase()->runAfter(20, [c]() {
+                c.getResponse().setBody("async:" + c.getRequest().getArg("v"));
+                c.sendResponse();
+            });
+        });
+        server.onGet("/stream", [](const HttpConnPtr& con) {
+            con.beginChunked();
+            con.sendChunk("part1-");
+            con.sendChunk("part2");
+            con.endChunked();
+        });
+        server.setMaxBodyLen(1024);
+        server.bind("127.0.0.1", kServerPort);
+        th = std::thread([this] { bases.loop(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    ~TestServer() {
+        bases.exit();
+        th.join();
+    }
+};
+
+// -------------------------- HttpServer 单元测试 --------------------------
+/**
+ * @brief 测试路由、404、keep-alive与流水线请求
+ */
+void test_HttpServer_basic(TestServer& ts) {
+    DEBUG("=== 开始HttpServer基本功能测试 ===");
+    int fd = connectLocal(kServerPort);
+    std::vector<std::string> bodies;
+    std::string pending;
+
+    // 1. 同一连接上的两个顺序请求（keep-alive）
+    bool ok = sendAll(fd, "GET /hello HTTP/1.1\r\nHost: x\r\n\r\n")
+              && readResponses(fd, 1, bodies, pending)
+              && sendAll(fd, "GET /nothing HTTP/1.1\r\nHost: x\r\n\r\n")
+              && readResponses(fd, 2, bodies, pending);
+    ok = ok && bodies[0] == "hello" && bodies[1] == "Not Found";
+    DEBUG("keep-alive顺序请求与404（%s）", ok ? "通过" : "失败");
+
+    // 2. 流水线请求（含异步响应与带消息体的请求）按顺序响应
+    bodies.clear();
+    std::string batch = "GET /async?v=1 HTTP/1.1\r\n\r\n"
+                        "GET /hello HTTP/1.1\r\n\r\n"
+                        "POST /echo HTTP/1.1\r\nContent-Length: 4\r\n\r\nping"
+                        "GET /uri?a=b HTTP/1.1\r\n\r\n";
+    bool pipeOk = sendAll(fd, batch) && readResponses(fd, 4, bodies, pending)
+                  && bodies[0] == "async:1" && bodies[1] == "hello"
+                  && bodies[2] == "ping" && bodies[3] == "/uri?a=b";
+    DEBUG("流水线请求按序响应: %zu个响应（%s）", bodies.size(), pipeOk ? "通过" : "失败");
+    close(fd);
+
+    // 3. HTTP/1.0请求在响应后关闭连接
+    fd = connectLocal(kServerPort);
+    bodies.clear();
+    pending.clear();
+    char c;
+    bool closeOk = sendAll(fd, "GET /hello HTTP/1.0\r\n\r\n") && readResponses(fd, 1, bodies, pending)
+                   && recv(fd, &c, 1, 0) == 0;
+    DEBUG("HTTP/1.0响应后关闭连接（%s）", closeOk ? "通过" : "失败");
+    close(fd);
+
+    // 4. 分块传输
+    fd = connectLocal(kServerPort);
+    std::string raw;
+    sendAll(fd, "GET /stream HTTP/1.1\r\n\r\n");
+    char buf[4096];
+    while (raw.find("0\r\n\r\n") == std::string::npos) {
+        ssize_t rd = recv(fd, buf, sizeof(buf), 0);
+        if (rd <= 0) {
+            break;
+        }
+        raw.append(buf, rd);
+    }
+    bool chunkOk = raw.find("Transfer-Encoding: chunked") != std::string::npos
+                   && raw.find("X-Powered-By: handy") != std::string::npos
+                   && raw.find("6\r\npart1-\r\n5\r\npart2\r\n0\r\n\r\n") != std::string::npos;
+    DEBUG("分块传输与静态头部（%s）", chunkOk ? "通过" : "失败");
+
+    // 5. 非法请求返回400并关闭连接
+    raw.clear();
+    sendAll(fd, "BAD\r\n\r\n");
+    ssize_t rd;
+    while ((rd = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        raw.append(buf, rd);
+    }
+    bool badOk = raw.find("400 Bad Request") != std::string::npos && rd == 0;
+    DEBUG("非法请求返回400（%s）", badOk ? "通过" : "失败");
+    close(fd);
+    DEBUG("=== HttpServer基本功能测试结束 ===\n");
+}
+
+/**
+ * @brief 发送一批流水线请求，读取服务器的全部输出直到连接关闭
+ * @param batch 请求数据
+ * @param [out] raw 服务器输出
+ * @return bool 服务器是否关闭了连接（3秒内）
+ */
+bool pipelineUntilClose(const std::string& batch, std::string& raw) {
+    int fd = connectLocal(kServerPort);
+    timeval tv{3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    char buf[4096];
+    ssize_t rd = -1;
+    if (sendAll(fd, batch)) {
+        while ((rd = recv(fd, buf, sizeof(buf), 0)) > 0) {
+            raw.append(buf, rd);
+        }
+    }
+    close(fd);
+    return rd == 0;
+}
+
+/**
+ * @brief 统计服务器输出中的响应个数
+ */
+int countResponses(const std::string& raw) {
+    int n = 0;
+    for (size_t pos = raw.find("HTTP/1.1 "); pos != std::string::npos; pos = raw.find("HTTP/1.1 ", pos + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+/**
+ * @brief 测试流水线请求的消息边界防护：Transfer-Encoding、重复的Content-Length与超长消息体
+ *        出错时只回复一个错误响应并关闭连接，消息体中夹带的请求不会被执行
+ */
+void test_HttpServer_smuggling(TestServer& ts) {
+    DEBUG("=== 开始HttpServer请求走私防护测试 ===");
+    const std::string smuggled = "GET /hello HTTP/1.1\r\n\r\n";
+
+    // 1. 分块消息体：若忽略Transfer-Encoding，消息体会被当作下一个请求
+    std::string raw;
+    bool closed = pipelineUntilClose("POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                     "1a\r\n" + smuggled + "\r\n0\r\n\r\n" + smuggled, raw);
+    bool ok = closed && countResponses(raw) == 1 && raw.find("501 Not Implemented") != std::string::npos;
+    DEBUG("Transfer-Encoding返回501: %d个响应（%s）", countResponses(raw), ok ? "通过" : "失败");
+
+    // 2. 同时携带Content-Length与Transfer-Encoding
+    raw.clear();
+    closed = pipelineUntilClose("POST /echo HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                "0\r\n\r\n" + smuggled, raw);
+    ok = closed && countResponses(raw) == 1 && raw.find("501 Not Implemented") != std::string::npos;
+    DEBUG("Content-Length与Transfer-Encoding并存返回501（%s）", ok ? "通过" : "失败");
+
+    // 3. 不一致的重复Content-Length
+    raw.clear();
+    closed = pipelineUntilClose("POST /echo HTTP/1.1\r\nContent-Length: 0\r\nContent-Length: 26\r\n\r\n" +
+                                smuggled + smuggled, raw);
+    ok = closed && countResponses(raw) == 1 && raw.find("400 Bad Request") != std::string::npos;
+    DEBUG("不一致的Content-Length返回400（%s）", ok ? "通过" : "失败");
+
+    // 4. 一致的重复Content-Length仍然允许
+    int fd = connectLocal(kServerPort);
+    std::vector<std::string> bodies;
+    std::string pending;
+    ok = sendAll(fd, "POST /echo HTTP/1.1\r\nContent-Length: 4\r\ncontent-length: 4\r\n\r\nping" + smuggled)
+         && readResponses(fd, 2, bodies, pending) && bodies[0] == "ping" && bodies[1] == "hello";
+    DEBUG("一致的重复Content-Length正常处理（%s）", ok ? "通过" : "失败");
+    close(fd);
+
+    // 5. 消息体超过最大长度：不等待消息体到达，直接回复413并关闭连接
+    raw.clear();
+    closed = pipelineUntilClose("POST /echo HTTP/1.1\r\nContent-Length: 10000000000\r\n\r\n" + smuggled, raw);
+    ok = closed && countResponses(raw) == 1 && raw.find("413 Payload Too Large") != std::string::npos;
+    DEBUG("超长消息体返回413（%s）", ok ? "通过" : "失败");
+
+    // 6. 最大长度以内的消息体正常处理
+    fd = connectLocal(kServerPort);
+    bodies.clear();
+    pending.clear();
+    std::string body(1024, 'x');
+    ok = sendAll(fd, "POST /echo HTTP/1.1\r\nContent-Length: 1024\r\n\r\n" + body)
+         && readResponses(fd, 1, bodies, pending) && bodies[0] == body;
+    DEBUG("最大长度以内的消息体正常处理（%s）", ok ? "通过" : "失败");
+    close(fd);
+    DEBUG("=== HttpServer请求走私防护测试结束 ===\n");
+}
+
+/**
+ * @brief wrk风格的压测：多个连接、每个连接保持固定深度的流水线请求，持续固定时间
+ */
+void test_HttpServer_load(TestServer& ts) {
+    DEBUG("=== 开始HttpServer压力测试 ===");
+    const int kConns = 4;
+    const int kDepth = 16;
+    const double kSeconds = 1.0;
+    std::string batch;
+    for (int i = 0; i < kDepth; ++i) {
+        batch += "GET /hello HTTP/1.1\r\nHost: 127.0.0.1\r\nUser-Agent: handy-load\r\n\r\n";
+    }
+
+    std::atomic<long> total(0), errors(0);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(kSeconds);
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kConns; ++i) {
+        workers.emplace_back([&] {
+            int fd = connectLocal(kServerPort);
+            if (fd < 0) {
+                ++errors;
+                return;
+            }
+            std::string pending;
+            std::vector<std::string> bodies;
+            while (std::chrono::steady_clock::now() < deadline) {
+                bodies.clear();
+                if (!sendAll(fd, batch) || !readResponses(fd, kDepth, bodies, pending)) {
+                    ++errors;
+                    break;
+                }
+                total += kDepth;
+            }
+            close(fd);
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double rps = total / sec;
+    INFO("压测: 连接数=%d, 流水线深度=%d, 请求数=%ld, 错误=%ld, 耗时%.3fs, %.0f req/s",
+         kConns, kDepth, total.load(), errors.load(), sec, rps);
+    std::cout << "http load: " << static_cast<long>(rps) << " req/s, errors=" << errors.load() << std::endl;
+    DEBUG("压力测试（%s）", (errors == 0 && total > 0) ? "通过" : "失败");
+    DEBUG("=== HttpServer压力测试结束 ===\n");
+}
+
+// -------------------------- 测试入口函数 --------------------------
+void run_all_tests() {
+    // 1. 初始化日志
+    initTestLogger();
+
+    // 2. 执行所有测试
+    test_HttpRequest_basic();
+    test_HttpRequest_incremental();
+    test_HttpRequest_zeroCopy();
+    test_HttpRequest_continue100();
+    test_HttpRequest_benchmark();
+    {
+        TestServer ts;
+        test_HttpServer_basic(ts);
+        test_HttpServer_smuggling(ts);
+        test_HttpServer_load(ts);
+    }
+
+    // 3. 测试总结
+    INFO("=== http_test 所有测试执行完成 ===");
+}
+
+}  // namespace httpTest
+}  // namespace handy
+
+// 主函数：启动测试
+int main() {
+    handy::httpTest::run_all_tests();
+    return 0;
+}
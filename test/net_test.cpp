@@ -12,6 +12,8 @@
 #include <string>
 #include <netinet/tcp.h>
 #include <fcntl.h>
+#include <chrono>
+#include <iostream>
 
 // 多线程测试计数变量
 std::atomic<int> g_bufferThreadCount(0);
@@ -147,6 +149,104 @@ void test_net_socket_options() {
     DEBUG("=== Net Socket选项测试结束 ===\n");
 }
 
+/**
+ * @brief 读取int类型的Socket选项（失败返回-1）
+ */
+int getIntOption(int fd, int level, int opt) {
+    int value = -1;
+    socklen_t len = sizeof(value);
+    if (getsockopt(fd, level, opt, &value, &len) != 0) {
+        return -1;
+    }
+    return value;
+}
+
+/**
+ * @brief 测试Net类的TCP调优选项（缓冲区、快速确认、延迟接受、Fast Open、未发送低水位、CORK、期望CPU）
+ */
+void test_net_tuning_options() {
+    DEBUG("=== 开始测试Net TCP调优选项 ===");
+    int fd = createTempTcpSocket();
+    if (fd < 0) {
+        DEBUG("=== Net TCP调优选项测试结束（失败） ===\n");
+        return;
+    }
+
+    // 测试1: 接收/发送缓冲区（内核实际使用设置值的两倍）
+    bool rbRet = Net::setRecvBuf(fd, 65536);
+    int rb = getIntOption(fd, SOL_SOCKET, SO_RCVBUF);
+    DEBUG("接收缓冲区测试: 设置返回%s，实际值%d（%s）", rbRet ? "成功" : "失败", rb,
+          (rbRet && rb >= 65536) ? "通过" : "失败");
+    bool sbRet = Net::setSendBuf(fd, 32768);
+    int sb = getIntOption(fd, SOL_SOCKET, SO_SNDBUF);
+    DEBUG("发送缓冲区测试: 设置返回%s，实际值%d（%s）", sbRet ? "成功" : "失败", sb,
+          (sbRet && sb >= 32768) ? "通过" : "失败");
+
+    // 测试2: 未发送低水位与CORK
+    bool lwRet = Net::setNotSentLowat(fd, 16384);
+    int lw = getIntOption(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT);
+    DEBUG("未发送低水位测试: 设置返回%s，实际值%d（%s）", lwRet ? "成功" : "失败", lw,
+          (lwRet && lw == 16384) ? "通过" : "失败");
+    bool corkRet = Net::setCork(fd, true);
+    int cork = getIntOption(fd, IPPROTO_TCP, TCP_CORK);
+    bool uncorkRet = Net::setCork(fd, false);
+    int uncork = getIntOption(fd, IPPROTO_TCP, TCP_CORK);
+    DEBUG("CORK测试: 开启后%d，关闭后%d（%s）", cork, uncork,
+          (corkRet && uncorkRet && cork == 1 && uncork == 0) ? "通过" : "失败");
+
+    // 测试3: 快速确认、客户端Fast Open
+    bool qaRet = Net::setQuickAck(fd, true);
+    int qa = getIntOption(fd, IPPROTO_TCP, TCP_QUICKACK);
+    DEBUG("快速确认测试: 设置返回%s，实际值%d（%s）", qaRet ? "成功" : "失败", qa,
+          (qaRet && qa == 1) ? "通过" : "失败");
+    bool focRet = Net::setFastOpenConnect(fd, true);
+    int foc = getIntOption(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT);
+    DEBUG("客户端Fast Open测试: 设置返回%s，实际值%d（%s）", focRet ? "成功" : "失败", foc,
+          (focRet && foc == 1) ? "通过" : "失败");
+
+    // 测试4: 监听Socket的延迟接受、Fast Open队列与期望CPU
+    bool daRet = Net::setDeferAccept(fd, 5);
+    int da = getIntOption(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT);
+    DEBUG("延迟接受测试: 设置返回%s，实际值%d秒（内核按重传次数取整，%s）", daRet ? "成功" : "失败", da,
+          (daRet && da >= 5) ? "通过" : "失败");
+    bool foRet = Net::setFastOpen(fd, 128);
+    int fo = getIntOption(fd, IPPROTO_TCP, TCP_FASTOPEN);
+    DEBUG("服务端Fast Open测试: 设置返回%s，队列长度%d（%s）", foRet ? "成功" : "失败", fo,
+          (foRet && fo == 128) ? "通过" : "失败");
+    bool icRet = Net::setIncomingCpu(fd, 0);
+    int ic = getIntOption(fd, SOL_SOCKET, SO_INCOMING_CPU);
+    DEBUG("期望CPU测试: 设置返回%s，实际值%d（%s）", icRet ? "成功" : "失败", ic,
+          (icRet && ic == 0) ? "通过" : "失败");
+    closeTempSocket(fd);
+
+    // 测试5: SocketOptions按Socket类型只应用适用的选项
+    SocketOptions opts;
+    opts.noDelay = true;
+    opts.deferAccept_s = 3;
+    opts.notSentLowat = 8192;
+    opts.fastOpenConnect = true;
+    int listenFd = createTempTcpSocket();
+    int connFd = createTempTcpSocket();
+    bool applyOk = opts.apply(listenFd, SocketOptions::Role::LISTEN)
+                   && opts.apply(connFd, SocketOptions::Role::CONNECT);
+    bool roleOk = getIntOption(listenFd, IPPROTO_TCP, TCP_DEFER_ACCEPT) > 0
+                  && getIntOption(listenFd, IPPROTO_TCP, TCP_NOTSENT_LOWAT) != 8192
+                  && getIntOption(connFd, IPPROTO_TCP, TCP_DEFER_ACCEPT) == 0
+                  && getIntOption(connFd, IPPROTO_TCP, TCP_NODELAY) == 1
+                  && getIntOption(connFd, IPPROTO_TCP, TCP_NOTSENT_LOWAT) == 8192
+                  && getIntOption(connFd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT) == 1;
+    DEBUG("SocketOptions按类型应用（%s）", (applyOk && roleOk) ? "通过" : "失败");
+    closeTempSocket(listenFd);
+    closeTempSocket(connFd);
+
+    // 测试6: 无效fd处理
+    int errCode = 0;
+    bool badFdRet = Net::setRecvBuf(-1, 4096, &errCode);
+    DEBUG("无效fd测试: 设置返回%s，错误码%d（%s）", badFdRet ? "成功" : "失败", errCode,
+          (!badFdRet && errCode == EBADF) ? "通过" : "失败");
+    DEBUG("=== Net TCP调优选项测试结束 ===\n");
+}
+
 /**
  * @brief 测试Net类多线程安全（并发设置Socket选项）
  */
@@ -437,6 +537,106 @@ void test_buffer_thread_safety() {
     DEBUG("=== Buffer多线程安全测试结束 ===\n");
 }
 
+/**
+ * @brief 测试Buffer环形模式（回绕后数据连续、扩容、拷贝/移动/吸收、与普通模式随机对比）
+ */
+void test_buffer_ring() {
+    DEBUG("=== 开始测试Buffer环形模式 ===");
+    Buffer ring;
+    bool ok = ring.enableRing(4096) && ring.isRing() && ring.space() >= 4096;
+    DEBUG("启用环形模式测试: %s", ok ? "通过" : "失败");
+    if (!ok) {
+        DEBUG("=== Buffer环形模式测试结束 ===\n");
+        return;
+    }
+
+    // 测试1: 数据跨越物理末尾时begin()~end()仍然连续
+    const size_t cap = ring.space();
+    ring.append(std::string(cap - 100, 'x'));
+    ring.consume(cap - 150);  // 剩余50字节，位于物理末尾附近
+    char* room = ring.makeRoom(300);
+    memcpy(room, std::string(300, 'y').data(), 300);
+    ring.addSize(300);
+    std::string expect = std::string(50, 'x') + std::string(300, 'y');
+    ok = ring.data() == expect && Slice(ring) == Slice(expect) && ring.space() == cap - 350 && ring.isRing();
+    DEBUG("回绕连续性测试: 长度=%zu（预期350，%s）", ring.size(), ok ? "通过" : "失败");
+
+    // 测试2: 空间不足时扩容，数据保持不变
+    ring.append(std::string(cap, 'z'));
+    expect += std::string(cap, 'z');
+    ok = ring.data() == expect && ring.isRing() && ring.size() + ring.space() >= 2 * cap;
+    DEBUG("环形扩容测试: 长度=%zu（%s）", ring.size(), ok ? "通过" : "失败");
+
+    // 测试3: 拷贝得到普通模式，移动保留环形模式，吸收到普通缓冲区
+    Buffer copy(ring);
+    Buffer moved(std::move(ring));
+    Buffer plain;
+    plain.append("head:");
+    plain.absorb(moved);
+    ok = copy.data() == expect && !copy.isRing() && moved.empty() && moved.isRing()
+        && plain.data() == "head:" + expect && !ring.isRing();
+    DEBUG("拷贝/移动/吸收测试: %s", ok ? "通过" : "失败");
+
+    // 测试4: 与普通模式执行相同的随机操作，结果一致
+    Buffer a, b;
+    b.enableRing(8192);
+    std::string model;
+    ok = true;
+    for (int i = 0; i < 20000 && ok; ++i) {
+        if (rand() % 2) {
+            std::string chunk(rand() % 3000, static_cast<char>('a' + i % 26));
+            a.append(chunk);
+            b.append(chunk);
+            model += chunk;
+        } else {
+            size_t n = rand() % 3000;
+            a.consume(n);
+            b.consume(n);
+            model.erase(0, n);
+        }
+        ok = b.size() == model.size() && memcmp(b.begin(), model.data(), model.size()) == 0 && a.data() == model;
+    }
+    ok = ok && b.isRing();
+    DEBUG("随机操作对比测试: %s", ok ? "通过" : "失败");
+
+    DEBUG("=== Buffer环形模式测试结束 ===\n");
+}
+
+/**
+ * @brief 吞吐对比：持续缓冲几KB不完整消息时，普通模式与环形模式每次读取的开销
+ * @details 模拟TcpConn的读取循环：makeRoom()后写入4KB，然后消费完整的6KB消息，始终残留一部分不完整的消息
+ */
+void test_buffer_ring_benchmark() {
+    DEBUG("=== 开始Buffer环形模式性能测试 ===");
+    const size_t kRead = 4096;
+    const size_t kMsg = 6000;
+    const int kLoops = 500000;
+    std::string chunk(kRead, 'r');
+
+    auto run = [&](Buffer& buf) {
+        buf.setExpectGrowSize(kRead);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kLoops; ++i) {
+            buf.makeRoom();
+            memcpy(buf.end(), chunk.data(), kRead);
+            buf.addSize(kRead);
+            size_t full = buf.size() / kMsg * kMsg;
+            buf.consume(full);
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return kRead * double(kLoops) / sec / 1e9;
+    };
+    Buffer plain;
+    Buffer ring;
+    bool ringOk = ring.enableRing(4 * kMsg);
+    double plainGbps = run(plain);
+    double ringGbps = ringOk ? run(ring) : 0;
+    std::cout << "Buffer plain: " << plainGbps << " GB/s, ring: " << ringGbps << " GB/s" << std::endl;
+    DEBUG("普通模式：%.2f GB/s，环形模式：%.2f GB/s（%s）", plainGbps, ringGbps, ringOk ? "通过" : "失败");
+
+    DEBUG("=== Buffer环形模式性能测试结束 ===\n");
+}
+
 // -------------------------- 测试入口函数 --------------------------
 void run_all_tests() {
     // 1. 初始化日志
@@ -445,6 +645,7 @@ void run_all_tests() {
     // 2. 执行Net类测试
     test_net_byte_order();
     test_net_socket_options();
+    test_net_tuning_options();
     test_net_thread_safety();
 
     // 3. 执行Ipv4Addr类测试
@@ -455,6 +656,8 @@ void run_all_tests() {
     test_buffer_basic_ops();
     test_buffer_memory_manage();
     test_buffer_thread_safety();
+    test_buffer_ring();
+    test_buffer_ring_benchmark();
 
     // 5. 测试总结
     INFO("=== net_test 所有测试执行完成 ===");
@@ -0,0 +1,463 @@
+#include "relay.h"
+#include "logger.h"
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <iostream>
+#include <cstring>
+#include <ctime>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace handy {
+namespace relayTest {
+
+// 中继测试端口（代理端口为kRelayPort + 2i，后端端口为kRelayPort + 2i + 1）
+static const unsigned short kRelayPort = 12370;
+
+// -------------------------- 测试辅助函数 --------------------------
+/**
+ * @brief 初始化Logger（输出到relay_test.log）
+ */
+void initTestLogger() {
+    Logger::getInstance().setLogFileName("relay_test.log");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+    INFO("=== relay_test 测试开始 ===");
+}
+
+/**
+ * @brief 用阻塞socket连接本地端口
+ * @return int 连接的fd（失败返回-1）
+ */
+int connectLocal(unsigned short port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    timeval tv{5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+/**
+ * @brief 在本地端口上创建阻塞的监听socket（用作原始socket后端）
+ * @return int 监听fd（失败返回-1）
+ */
+int listenLocal(unsigned short port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief 阻塞发送全部数据
+ */
+bool sendAll(int fd, const char* p, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief 生成可校验的数据（第i个字节为i % 251）
+ */
+std::string pattern(size_t offset, size_t len) {
+    std::string s(len, '\0');
+    for (size_t i = 0; i < len; ++i) {
+        s[i] = static_cast<char>((offset + i) % 251);
+    }
+    return s;
+}
+
+/**
+ * @brief 等待条件成立（最多等待timeout_ms毫秒）
+ */
+template <typename Pred>
+bool waitFor(Pred pred, int timeout_ms = 3000) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * @brief 代理建立的中继（在事件循环线程中写入，测试线程中读取）
+ */
+struct Relays {
+    std::mutex mutex;
+    std::vector<TcpRelay::Ptr> relays;
+    std::atomic<int> closed{0};
+
+    TcpRelay::Ptr last() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return relays.empty() ? nullptr : relays.back();
+    }
+};
+
+/**
+ * @brief 启动中继代理：每个接受的连接向后端发起一个连接，连上后两者之间建立TcpRelay
+ * @param copy true时改用TcpConn的读回调+send()在用户态拷贝转发（基准测试的对照组）
+ */
+TcpServer::Ptr startProxy(EventBase* base, unsigned short port, unsigned short backendPort,
+                          Relays* relays, bool copy = false) {
+    TcpServer::Ptr server = TcpServer::startServer(base, "127.0.0.1", port);
+    server->onConnState([=](const TcpConnPtr& front) {
+        if (front->getState() == TcpConn::State::CLOSED) {
+            // 拷贝转发：front读到EOF即被关闭，等后端连接的输出缓冲区发完再关闭它
+            TcpConnPtr& peer = front->getContext<TcpConnPtr>();
+            if (peer && peer->getOutputBuffer().empty()) {
+                peer->close();
+            } else if (peer) {
+                peer->onWritable([](const TcpConnPtr& c) { c->close(); });
+            }
+            peer.reset();
+            return;
+        }
+        if (front->getState() != TcpConn::State::CONNECTED) {
+            return;
+        }
+        // 后端连接建立之前暂停读取客户端：TcpConn读到EOF会关闭整个连接，
+        // 客户端若先发完数据并半关闭，连接会在中继接管之前被关闭；中继接管时恢复读取
+        front->getChannel()->enableRead(false);
+        TcpConnPtr back = TcpConn::createConnection(front->getBase(), "127.0.0.1", backendPort);
+        back->onState([=](const TcpConnPtr& b) {
+            if (b->getState() != TcpConn::State::CONNECTED) {
+                front->close();
+                return;
+            }
+            if (copy) {
+                front->getContext<TcpConnPtr>() = b;
+                front->onReadable([b](const TcpConnPtr& c) { b->send(c->getInputBuffer()); });
+                b->onReadable([front](const TcpConnPtr& c) { front->send(c->getInputBuffer()); });
+                // 输出积压时暂停读取另一端，与中继的流量控制对等
+                b->setWaterMarks(1 << 20, 512 * 1024);
+                b->onHighWater([front](const TcpConnPtr&) {
+                    if (front->getChannel()) {
+                        front->getChannel()->enableRead(false);
+                    }
+                });
+                b->onLowWater([front](const TcpConnPtr&) {
+                    if (front->getChannel()) {
+                        front->getChannel()->enableRead(true);
+                    }
+                });
+                front->getChannel()->enableRead(true);
+                return;
+            }
+            TcpRelay::Ptr relay = TcpRelay::create(front, b, 1 << 20);
+            if (!relay) {
+                front->close();
+                b->close();
+                return;
+            }
+            relay->onClose([relays](const TcpRelay::Ptr&) { ++relays->closed; });
+            std::lock_guard<std::mutex> lock(relays->mutex);
+            relays->relays.push_back(relay);
+        });
+    });
+    return server;
+}
+
+// -------------------------- 测试用例 --------------------------
+/**
+ * @brief 测试双向转发：经中继回显各种大小的消息，包括后端连上之前就已发出的数据
+ */
+void test_Relay_echo() {
+    DEBUG("=== 开始中继回显测试 ===");
+    const unsigned short port = kRelayPort, backendPort = kRelayPort + 1;
+    EventBase base;
+    TcpServer::Ptr backend = TcpServer::startServer(&base, "127.0.0.1", backendPort);
+    backend->onConnRead([](const TcpConnPtr& con) { con->send(con->getInputBuffer()); });
+    Relays relays;
+    TcpServer::Ptr proxy = startProxy(&base, port, backendPort, &relays);
+    std::thread th([&base] { base.loop(); });
+
+    int fd = connectLocal(port);
+    bool ok = fd >= 0;
+    size_t total = 0;
+    const size_t sizes[] = {1, 100, 4096, 65536, 1 << 20};
+    for (size_t len : sizes) {
+        std::string msg = pattern(total, len);
+        std::string echo(len, '\0');
+        std::thread sender([&] { ok = sendAll(fd, msg.data(), len) && ok; });
+        size_t got = 0;
+        while (got < len) {
+            ssize_t n = ::recv(fd, &echo[got], len - got, 0);
+            if (n <= 0) {
+                break;
+            }
+            got += n;
+        }
+        sender.join();
+        ok = ok && got == len && echo == msg;
+        total += len;
+    }
+    DEBUG("回显%zu字节，内容一致（%s）", total, ok ? "通过" : "失败");
+
+    TcpRelay::Ptr relay = relays.last();
+    ok = relay && relay->getForwardBytes() == (int64_t)total && relay->getBackwardBytes() == (int64_t)total;
+    DEBUG("中继计数: 正向%lld字节，反向%lld字节（%s）", relay ? (long long)relay->getForwardBytes() : -1LL,
+          relay ? (long long)relay->getBackwardBytes() : -1LL, ok ? "通过" : "失败");
+
+    // 客户端关闭：后端回显服务随之关闭，中继结束，两个连接都进入CLOSED状态
+    ::close(fd);
+    ok = waitFor([&] { return relays.closed == 1; }) && relay->isClosed()
+         && relay->getFirst()->getState() == TcpConn::State::CLOSED
+         && relay->getSecond()->getState() == TcpConn::State::CLOSED;
+    DEBUG("客户端关闭后中继结束（%s）", ok ? "通过" : "失败");
+
+    base.exit();
+    th.join();
+    DEBUG("=== 中继回显测试结束 ===\n");
+}
+
+/**
+ * @brief 测试半关闭：客户端shutdown(SHUT_WR)后后端读到EOF，随后后端的应答仍能经中继到达客户端
+ */
+void test_Relay_halfClose() {
+    DEBUG("=== 开始中继半关闭测试 ===");
+    const unsigned short port = kRelayPort + 2, backendPort = kRelayPort + 3;
+    const size_t kLen = 300000;
+    int listenFd = listenLocal(backendPort);
+    // 后端读到EOF后回复收到的字节数，然后关闭
+    std::thread backend([listenFd] {
+        int fd = accept(listenFd, nullptr, nullptr);
+        char buf[65536];
+        size_t got = 0;
+        ssize_t n;
+        while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) {
+            got += n;
+        }
+        std::string reply = "got " + std::to_string(got);
+        sendAll(fd, reply.data(), reply.size());
+        ::close(fd);
+    });
+
+    EventBase base;
+    Relays relays;
+    TcpServer::Ptr proxy = startProxy(&base, port, backendPort, &relays);
+    std::thread th([&base] { base.loop(); });
+
+    int fd = connectLocal(port);
+    std::string msg = pattern(0, kLen);
+    bool ok = fd >= 0 && sendAll(fd, msg.data(), msg.size()) && ::shutdown(fd, SHUT_WR) == 0;
+    std::string reply;
+    char buf[256];
+    ssize_t n;
+    while (ok && (n = ::recv(fd, buf, sizeof(buf), 0)) > 0) {
+        reply.append(buf, n);
+    }
+    ok = ok && n == 0 && reply == "got " + std::to_string(kLen);
+    DEBUG("半关闭后收到后端应答: %s（%s）", reply.c_str(), ok ? "通过" : "失败");
+
+    TcpRelay::Ptr relay = relays.last();
+    ok = waitFor([&] { return relays.closed == 1; }) && relay
+         && relay->getForwardBytes() == (int64_t)kLen && relay->getBackwardBytes() == (int64_t)reply.size();
+    DEBUG("两个方向都结束后中继关闭（%s）", ok ? "通过" : "失败");
+
+    ::close(fd);
+    backend.join();
+    ::close(listenFd);
+    base.exit();
+    th.join();
+    DEBUG("=== 中继半关闭测试结束 ===\n");
+}
+
+/**
+ * @brief 测试流量控制：后端不读取时中继暂停读取客户端，积压有界；后端恢复读取后数据完整到达
+ */
+void test_Relay_backpressure() {
+    DEBUG("=== 开始中继流量控制测试 ===");
+    const unsigned short port = kRelayPort + 4, backendPort = kRelayPort + 5;
+    const size_t kTotal = 32 << 20;
+    int listenFd = listenLocal(backendPort);
+    std::atomic<bool> startRead{false};
+    std::atomic<bool> intact{false};
+    std::atomic<size_t> received{0};
+    std::thread backend([&] {
+        int fd = accept(listenFd, nullptr, nullptr);
+        while (!startRead) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        char buf[65536];
+        size_t got = 0;
+        bool same = true;
+        ssize_t n;
+        while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) {
+            same = same && memcmp(buf, pattern(got, n).data(), n) == 0;
+            got += n;
+        }
+        received = got;
+        intact = same;
+        ::close(fd);
+    });
+
+    EventBase base;
+    Relays relays;
+    TcpServer::Ptr proxy = startProxy(&base, port, backendPort, &relays);
+    std::thread th([&base] { base.loop(); });
+
+    int fd = connectLocal(port);
+    std::atomic<bool> sent{false};
+    std::thread client([&] {
+        const size_t kChunk = 1 << 20;
+        bool ok = fd >= 0;
+        for (size_t off = 0; ok && off < kTotal; off += kChunk) {
+            std::string chunk = pattern(off, kChunk);
+            ok = sendAll(fd, chunk.data(), chunk.size());
+        }
+        sent = ok;
+        ::close(fd);
+    });
+
+    // 后端不读取：转发量停在内核缓冲区与管道容量之和附近，客户端阻塞在send()上
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    TcpRelay::Ptr relay = relays.last();
+    int64_t stalled = relay ? relay->getForwardBytes() : -1;
+    bool ok = relay && stalled > 0 && stalled < (int64_t)kTotal && !sent;
+    DEBUG("后端不读取时转发停在%lld字节（%s）", (long long)stalled, ok ? "通过" : "失败");
+
+    startRead = true;
+    client.join();
+    backend.join();
+    ok = sent && received == kTotal && intact && relay->getForwardBytes() == (int64_t)kTotal
+         && waitFor([&] { return relays.closed == 1; });
+    DEBUG("恢复读取后收到%zu字节，内容一致（%s）", received.load(), ok ? "通过" : "失败");
+
+    ::close(listenFd);
+    base.exit();
+    th.join();
+    DEBUG("=== 中继流量控制测试结束 ===\n");
+}
+
+/**
+ * @brief 测量单向转发kTotal字节的吞吐量与事件循环线程的CPU时间
+ * @param copy true：用户态拷贝转发；false：TcpRelay
+ * @param[out] gbps 吞吐量（Gbit/s）
+ * @param[out] cpu_ms 事件循环线程消耗的CPU时间（毫秒）
+ * @return bool 数据是否全部到达
+ */
+bool runThroughput(bool copy, unsigned short port, double* gbps, double* cpu_ms) {
+    const size_t kTotal = 1ull << 30;
+    const size_t kChunk = 256 * 1024;
+    int listenFd = listenLocal(port + 1);
+    std::atomic<size_t> received{0};
+    std::thread sink([&] {
+        int fd = accept(listenFd, nullptr, nullptr);
+        std::vector<char> buf(kChunk);
+        size_t got = 0;
+        ssize_t n;
+        while ((n = ::recv(fd, buf.data(), buf.size(), 0)) > 0) {
+            got += n;
+        }
+        received = got;
+        ::close(fd);
+    });
+
+    EventBase base;
+    Relays relays;
+    TcpServer::Ptr proxy = startProxy(&base, port, port + 1, &relays, copy);
+    std::thread th([&base] { base.loop(); });
+    clockid_t loopClock;
+    pthread_getcpuclockid(th.native_handle(), &loopClock);
+    timespec cpuStart, cpuEnd;
+    clock_gettime(loopClock, &cpuStart);
+
+    auto start = std::chrono::steady_clock::now();
+    int fd = connectLocal(port);
+    std::vector<char> chunk(kChunk, 'r');
+    bool ok = fd >= 0;
+    for (size_t off = 0; ok && off < kTotal; off += kChunk) {
+        ok = sendAll(fd, chunk.data(), chunk.size());
+    }
+    ::close(fd);
+    sink.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    clock_gettime(loopClock, &cpuEnd);
+
+    *gbps = received * 8.0 / secs / 1e9;
+    *cpu_ms = (cpuEnd.tv_sec - cpuStart.tv_sec) * 1e3 + (cpuEnd.tv_nsec - cpuStart.tv_nsec) / 1e6;
+    ::close(listenFd);
+    base.exit();
+    th.join();
+    return ok && received == kTotal;
+}
+
+/**
+ * @brief 吞吐量基准：比较splice中继与用户态拷贝转发在本机回环上的吞吐量与CPU开销
+ */
+void test_Relay_benchmark() {
+    DEBUG("=== 开始中继吞吐量基准测试 ===");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LWARN);
+    double copyGbps = 0, copyCpu = 0, spliceGbps = 0, spliceCpu = 0;
+    bool copyOk = runThroughput(true, kRelayPort + 6, &copyGbps, &copyCpu);
+    bool spliceOk = runThroughput(false, kRelayPort + 8, &spliceGbps, &spliceCpu);
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+
+    INFO("用户态拷贝: %.2f Gbit/s，事件循环CPU %.0f ms；splice中继: %.2f Gbit/s，事件循环CPU %.0f ms",
+         copyGbps, copyCpu, spliceGbps, spliceCpu);
+    std::cout << "relay copy: " << copyGbps << " Gbit/s, loop cpu " << copyCpu << " ms" << std::endl;
+    std::cout << "relay splice: " << spliceGbps << " Gbit/s, loop cpu " << spliceCpu << " ms" << std::endl;
+    DEBUG("拷贝转发完整转发1GiB（%s）", copyOk ? "通过" : "失败");
+    DEBUG("splice中继完整转发1GiB（%s）", spliceOk ? "通过" : "失败");
+    DEBUG("=== 中继吞吐量基准测试结束 ===\n");
+}
+
+// -------------------------- 测试入口函数 --------------------------
+void run_all_tests() {
+    // 1. 初始化日志
+    initTestLogger();
+
+    // 2. 执行所有测试
+    test_Relay_echo();
+    test_Relay_halfClose();
+    test_Relay_backpressure();
+    test_Relay_benchmark();
+
+    // 3. 测试总结
+    auto& sessions = MetricsRegistry::instance().gauge("handy_relay_sessions", "");
+    DEBUG("所有中继均已结束: handy_relay_sessions=%lld（%s）", (long long)sessions.value(),
+          sessions.value() == 0 ? "通过" : "失败");
+    INFO("=== relay_test 所有测试执行完成 ===");
+}
+
+}  // namespace relayTest
+}  // namespace handy
+
+// 主函数：启动测试
+int main() {
+    handy::relayTest::run_all_tests();
+    return 0;
+}
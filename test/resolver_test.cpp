@@ -0,0 +1,370 @@
+#include "resolver.h"
+#include "conn.h"
+#include "logger.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <iostream>
+#include <arpa/inet.h>
+
+namespace handy {
+namespace resolverTest {
+
+// 解析器测试使用的服务端口
+static const unsigned short kResolverPort = 12380;
+
+// -------------------------- 测试辅助函数 --------------------------
+/**
+ * @brief 初始化Logger（输出到resolver_test.log）
+ */
+void initTestLogger() {
+    Logger::getInstance().setLogFileName("resolver_test.log");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+    INFO("=== resolver_test 测试开始 ===");
+}
+
+/**
+ * @brief 等待条件成立（最多等待timeout_ms毫秒）
+ */
+template <typename Pred>
+bool waitFor(Pred pred, int timeout_ms = 3000) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/**
+ * @brief 模拟的名字查询：把*.test解析为127.0.0.1，bad.test解析失败，可设置查询耗时与TTL
+ */
+struct FakeLookup {
+    std::atomic<int> calls{0};
+    int delay_ms = 0;
+    int ttl_s = -1;
+
+    Resolver::LookupFunc func() {
+        return [this](const std::string& host, struct in_addr& addr, int& ttl) {
+            ++calls;
+            if (delay_ms > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+            }
+            if (host == "bad.test") {
+                return false;
+            }
+            inet_pton(AF_INET, "127.0.0.1", &addr);
+            ttl = ttl_s;
+            return true;
+        };
+    }
+};
+
+/**
+ * @brief 在后台线程中运行的事件循环
+ */
+struct LoopThread {
+    EventBase base;
+    std::thread thread;
+
+    LoopThread() : thread([this] { base.loop(); }) {}
+    ~LoopThread() {
+        base.exit();
+        thread.join();
+    }
+};
+
+/**
+ * @brief 在事件循环中解析一次名字，等待回调返回
+ * @return int 1：成功，0：失败，-1：回调未执行或不在事件循环线程中执行
+ */
+int resolveOnce(Resolver& resolver, EventBase* base, const std::string& host, std::string* ip = nullptr) {
+    std::atomic<int> result{-2};
+    std::string addrStr;
+    resolver.resolve(base, host, [&](bool ok, const struct in_addr& addr) {
+        char buf[INET_ADDRSTRLEN] = {0};
+        inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+        addrStr = buf;
+        result = base->isInLoopThread() ? (ok ? 1 : 0) : -1;
+    });
+    if (!waitFor([&] { return result != -2; })) {
+        return -1;
+    }
+    if (ip) {
+        *ip = addrStr;
+    }
+    return result;
+}
+
+// -------------------------- 测试用例 --------------------------
+/**
+ * @brief 测试默认查询（getaddrinfo）与IP地址字面量
+ */
+void test_Resolver_default() {
+    DEBUG("=== 开始默认解析测试 ===");
+    LoopThread loop;
+    Resolver resolver(1);
+
+    std::string ip;
+    int r = resolveOnce(resolver, &loop.base, "localhost", &ip);
+    DEBUG("解析localhost: %s（%s）", ip.c_str(), r == 1 && ip == "127.0.0.1" ? "通过" : "失败");
+
+    r = resolveOnce(resolver, &loop.base, "10.1.2.3", &ip);
+    DEBUG("IP地址字面量直接返回: %s（%s）", ip.c_str(), r == 1 && ip == "10.1.2.3" ? "通过" : "失败");
+
+    struct in_addr addr;
+    bool cached = resolver.lookupCached("localhost", addr);
+    DEBUG("解析结果写入缓存（%s）", cached && addr.s_addr == htonl(INADDR_LOOPBACK) ? "通过" : "失败");
+
+    r = resolveOnce(resolver, &loop.base, "no-such-host.invalid");
+    DEBUG("不存在的名字解析失败（%s）", r == 0 ? "通过" : "失败");
+    DEBUG("=== 默认解析测试结束 ===\n");
+}
+
+/**
+ * @brief 测试缓存：按TTL过期，失败结果按失败TTL缓存
+ */
+void test_Resolver_cacheTtl() {
+    DEBUG("=== 开始缓存TTL测试 ===");
+    LoopThread loop;
+    Resolver resolver(1);
+    FakeLookup fake;
+    fake.ttl_s = 1;
+    resolver.setLookup(fake.func());
+    resolver.setTtl(60, 1);
+
+    resolveOnce(resolver, &loop.base, "a.test");
+    int r = resolveOnce(resolver, &loop.base, "a.test");
+    DEBUG("TTL内重复解析命中缓存: calls=%d（%s）", fake.calls.load(), r == 1 && fake.calls == 1 ? "通过" : "失败");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    struct in_addr addr;
+    bool cached = resolver.lookupCached("a.test", addr);
+    r = resolveOnce(resolver, &loop.base, "a.test");
+    DEBUG("超过查询给出的TTL后重新查询: calls=%d（%s）", fake.calls.load(),
+          !cached && r == 1 && fake.calls == 2 ? "通过" : "失败");
+
+    fake.calls = 0;
+    int r1 = resolveOnce(resolver, &loop.base, "bad.test");
+    int r2 = resolveOnce(resolver, &loop.base, "bad.test");
+    DEBUG("失败结果被缓存: calls=%d（%s）", fake.calls.load(), r1 == 0 && r2 == 0 && fake.calls == 1 ? "通过" : "失败");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    resolveOnce(resolver, &loop.base, "bad.test");
+    DEBUG("失败结果按失败TTL过期: calls=%d（%s）", fake.calls.load(), fake.calls == 2 ? "通过" : "失败");
+
+    resolver.clearCache();
+    resolveOnce(resolver, &loop.base, "a.test");
+    DEBUG("清空缓存后重新查询: calls=%d（%s）", fake.calls.load(), fake.calls == 3 ? "通过" : "失败");
+    DEBUG("=== 缓存TTL测试结束 ===\n");
+}
+
+/**
+ * @brief 测试并发请求合并：同一名字同时只查询一次，所有请求都得到回调
+ */
+void test_Resolver_coalesce() {
+    DEBUG("=== 开始请求合并测试 ===");
+    LoopThread loop1, loop2;
+    Resolver resolver(2);
+    FakeLookup fake;
+    fake.delay_ms = 200;
+    resolver.setLookup(fake.func());
+
+    std::atomic<int> done{0}, wrongThread{0};
+    for (int i = 0; i < 20; ++i) {
+        EventBase* base = i % 2 ? &loop1.base : &loop2.base;
+        resolver.resolve(base, "same.test", [&, base](bool ok, const struct in_addr&) {
+            if (!ok || !base->isInLoopThread()) {
+                ++wrongThread;
+            }
+            ++done;
+        });
+    }
+    bool allDone = waitFor([&] { return done == 20; });
+    DEBUG("20个请求只查询一次: calls=%d, done=%d（%s）", fake.calls.load(), done.load(),
+          allDone && fake.calls == 1 ? "通过" : "失败");
+    DEBUG("回调在各自的事件循环线程中执行（%s）", wrongThread == 0 ? "通过" : "失败");
+    DEBUG("=== 请求合并测试结束 ===\n");
+}
+
+/**
+ * @brief 测试慢速查询期间事件循环析构：查询结束后回调被丢弃（不访问已析构的事件循环），回调对象被释放
+ */
+void test_Resolver_baseDestroyed() {
+    DEBUG("=== 开始事件循环先于查询结束析构测试 ===");
+    Resolver resolver(1);
+    FakeLookup fake;
+    fake.delay_ms = 300;
+    resolver.setLookup(fake.func());
+
+    std::atomic<int> called{0};
+    auto token = std::make_shared<int>(0);
+    {
+        auto loop = std::make_unique<LoopThread>();
+        resolver.resolve(&loop->base, "slow.test", [&called, token](bool, const struct in_addr&) { ++called; });
+        waitFor([&] { return fake.calls == 1; });
+    }
+    // 回调对象随丢弃的任务释放后，token只剩本地引用
+    bool dropped = waitFor([&] { return token.use_count() == 1; });
+    DEBUG("查询结束后回调被丢弃并释放: called=%d（%s）", called.load(), dropped && called == 0 ? "通过" : "失败");
+
+    LoopThread loop;
+    int r = resolveOnce(resolver, &loop.base, "slow.test");
+    DEBUG("之后的事件循环照常得到缓存的结果（%s）", r == 1 && fake.calls == 1 ? "通过" : "失败");
+    DEBUG("=== 事件循环先于查询结束析构测试结束 ===\n");
+}
+
+/**
+ * @brief 测试连接不阻塞事件循环：慢速解析期间定时器照常触发，解析完成后连接建立
+ */
+void test_Resolver_connectNonBlocking() {
+    DEBUG("=== 开始非阻塞连接测试 ===");
+    FakeLookup fake;
+    fake.delay_ms = 500;
+    Resolver::instance().setLookup(fake.func());
+    Resolver::instance().clearCache();
+
+    LoopThread loop;
+    TcpServer::Ptr server;
+    loop.base.safeCall([&] { server = TcpServer::startServer(&loop.base, "127.0.0.1", kResolverPort); });
+    waitFor([&] { return server != nullptr; });
+
+    // 每10ms记录一次定时器触发时间，统计最大间隔
+    std::atomic<int64_t> lastTick{utils::timeMilli()}, maxGap{0};
+    TimerId tick;
+    loop.base.safeCall([&] {
+        lastTick = utils::timeMilli();
+        tick = loop.base.runAfter(10, [&] {
+            int64_t now = utils::timeMilli();
+            maxGap = std::max(maxGap.load(), now - lastTick.load());
+            lastTick = now;
+        }, 10);
+    });
+
+    std::atomic<int> state{-1};
+    std::atomic<int64_t> createCost{0};
+    TcpConnPtr conn;
+    loop.base.safeCall([&] {
+        int64_t start = utils::timeMilli();
+        conn = TcpConn::createConnection(&loop.base, "slow.test", kResolverPort);
+        createCost = utils::timeMilli() - start;
+        conn->onState([&](const TcpConnPtr& c) {
+            if (c->getState() != TcpConn::State::HAND_SHAKING) {
+                state = static_cast<int>(c->getState());
+            }
+        });
+    });
+    bool connected = waitFor([&] { return state == static_cast<int>(TcpConn::State::CONNECTED); });
+    DEBUG("createConnection立即返回: %lld ms（%s）", (long long)createCost.load(), createCost < 100 ? "通过" : "失败");
+    DEBUG("解析完成后连接建立（%s）", connected ? "通过" : "失败");
+    DEBUG("解析期间事件循环未阻塞: 定时器最大间隔%lld ms（%s）", (long long)maxGap.load(),
+          maxGap < 200 ? "通过" : "失败");
+
+    // 第二次连接命中缓存，不再查询
+    std::atomic<int> state2{-1};
+    loop.base.safeCall([&] {
+        TcpConnPtr c2 = TcpConn::createConnection(&loop.base, "slow.test", kResolverPort);
+        c2->onState([&](const TcpConnPtr& c) {
+            if (c->getState() == TcpConn::State::CONNECTED) {
+                state2 = 1;
+                c->close();
+            }
+        });
+    });
+    bool cachedConnect = waitFor([&] { return state2 == 1; });
+    DEBUG("再次连接命中缓存: calls=%d（%s）", fake.calls.load(), cachedConnect && fake.calls == 1 ? "通过" : "失败");
+
+    std::atomic<bool> released{false};
+    loop.base.safeCall([&] {
+        loop.base.cancel(tick);
+        conn->close();
+        conn.reset();
+        server.reset();
+        released = true;
+    });
+    waitFor([&] { return released.load(); });
+    Resolver::instance().setLookup(nullptr);
+    Resolver::instance().clearCache();
+    DEBUG("=== 非阻塞连接测试结束 ===\n");
+}
+
+/**
+ * @brief 测试解析失败与解析超时：连接进入FAILED状态
+ */
+void test_Resolver_connectFailure() {
+    DEBUG("=== 开始解析失败测试 ===");
+    FakeLookup fake;
+    fake.delay_ms = 300;
+    Resolver::instance().setLookup(fake.func());
+    Resolver::instance().clearCache();
+
+    // 定时器只能在事件循环线程中注册，连接都在事件循环线程中发起
+    LoopThread loop;
+    std::atomic<int> failed{0};
+    std::atomic<int64_t> failCost{0};
+    loop.base.safeCall([&] {
+        TcpConnPtr bad = TcpConn::createConnection(&loop.base, "bad.test", kResolverPort + 1);
+        bad->onState([&](const TcpConnPtr& c) {
+            if (c->getState() == TcpConn::State::FAILED) {
+                ++failed;
+            }
+        });
+    });
+    bool badFailed = waitFor([&] { return failed == 1; });
+    DEBUG("无法解析的名字: 连接失败（%s）", badFailed ? "通过" : "失败");
+
+    failed = 0;
+    TcpConnPtr slow;
+    loop.base.safeCall([&] {
+        int64_t start = utils::timeMilli();
+        slow = TcpConn::createConnection(&loop.base, "timeout.test", kResolverPort + 1, 100);
+        slow->onState([&, start](const TcpConnPtr& c) {
+            if (c->getState() == TcpConn::State::FAILED) {
+                failCost = utils::timeMilli() - start;
+                ++failed;
+            }
+        });
+    });
+    bool timedOut = waitFor([&] { return failed == 1; });
+    DEBUG("解析超过连接超时: %lld ms后失败（%s）", (long long)failCost.load(),
+          timedOut && failCost < 250 ? "通过" : "失败");
+
+    // 超时之后才返回的解析结果被丢弃，不会再发起连接
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    DEBUG("过期的解析结果被丢弃（%s）",
+          failed == 1 && slow->getState() == TcpConn::State::FAILED ? "通过" : "失败");
+
+    Resolver::instance().setLookup(nullptr);
+    Resolver::instance().clearCache();
+    DEBUG("=== 解析失败测试结束 ===\n");
+}
+
+// -------------------------- 测试入口函数 --------------------------
+void run_all_tests() {
+    // 1. 初始化日志
+    initTestLogger();
+
+    // 2. 执行所有测试
+    test_Resolver_default();
+    test_Resolver_cacheTtl();
+    test_Resolver_coalesce();
+    test_Resolver_baseDestroyed();
+    test_Resolver_connectNonBlocking();
+    test_Resolver_connectFailure();
+
+    // 3. 测试总结
+    INFO("=== resolver_test 所有测试执行完成 ===");
+}
+
+}  // namespace resolverTest
+}  // namespace handy
+
+// 主函数：启动测试
+int main() {
+    handy::resolverTest::run_all_tests();
+    return 0;
+}
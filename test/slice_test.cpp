@@ -9,6 +9,9 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sstream>
+#include <random>
+#include <chrono>
+#include <iostream>
 
 // 测试用全局原子变量（用于多线程测试计数）
 std::atomic<int> g_sliceThreadTestCount(0);
@@ -16,6 +19,14 @@ std::atomic<int> g_sliceThreadTestCount(0);
 namespace handy {
 namespace sliceTest {
 
+// -------------------------- 编译期检查 --------------------------
+constexpr Slice kHello("hello world");
+static_assert(kHello.size() == 11 && kHello[4] == 'o' && kHello.at(10) == 'd', "");
+static_assert(kHello.startsWith("hello") && kHello.endsWith("world") && kHello.find('w') == 6, "");
+static_assert(kHello.sub(6) == Slice("world") && kHello.sub(0, -6) < Slice("world"), "");
+static_assert(Slice("abc", 2, Slice::kUnchecked) == Slice("ab") && Slice().empty(), "");
+static_assert(Slice::createSafe(nullptr, 3).empty() && Slice::createSafe("xyz", 2).size() == 2, "");
+
 // -------------------------- 测试辅助函数 --------------------------
 /**
  * @brief 初始化Logger（输出到slice_test.log）
@@ -239,7 +250,7 @@ void test_thread_safe() {
         for (int i = 0; i < LOOP_NUM; ++i) {
             Slice s("hello world");
             std::string str = s.toString();
-            DEBUG("线程%d-%d：slice=%s", std::this_thread::get_id(), i, str.c_str());
+            DEBUG("线程%zu-%d：slice=%s", std::hash<std::thread::id>{}(std::this_thread::get_id()), i, str.c_str());
             g_sliceThreadTestCount.fetch_add(1, std::memory_order_relaxed);
         }
     };
@@ -263,6 +274,231 @@ void test_thread_safe() {
     DEBUG("=== Slice 线程安全 特性测试结束 ===\n");
 }
 
+/**
+ * @brief 不检查的构造、at()与createSafe
+ */
+void test_unchecked() {
+    DEBUG("=== 开始测试 Slice 不检查接口 ===");
+
+    // 测试1：kUnchecked构造与带检查构造结果一致
+    const char* text = "key=value";
+    Slice a(text, 3, Slice::kUnchecked);
+    Slice b(text + 4, text + 9, Slice::kUnchecked);
+    bool ok = a == Slice(text, 3) && b == Slice("value");
+    DEBUG("测试1（kUnchecked构造）：%s", ok ? "通过" : "失败");
+
+    // 测试2：at()总是检查边界
+    ok = false;
+    try {
+        (void)b.at(5);
+    } catch (const std::out_of_range&) {
+        ok = b.at(4) == 'e';
+    }
+    DEBUG("测试2（at()越界抛异常）：%s", ok ? "通过" : "失败");
+
+    // 测试3：createSafe空指针返回空视图，多线程并发创建
+    ok = Slice::createSafe(nullptr, 8).empty() && Slice::createSafe(text, 3) == a;
+    std::atomic<int> bad(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 100000; ++i) {
+                if (Slice::createSafe(text, i % 10).size() != static_cast<size_t>(i % 10)) bad++;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    ok = ok && bad == 0;
+    DEBUG("测试3（createSafe）：%s", ok ? "通过" : "失败");
+
+    DEBUG("=== Slice 不检查接口测试结束 ===\n");
+}
+
+/**
+ * @brief 解析"key=value\n"行：Checked为true时使用带检查的构造与at()，否则使用kUnchecked与下标
+ */
+template <bool Checked>
+size_t parseKeyValues(const Slice& text) {
+    size_t sum = 0;
+    const char* p = text.begin();
+    const char* end = text.end();
+    while (p < end) {
+        const char* line = p;
+        size_t eq = 0;
+        size_t n = 0;
+        Slice rest(p, end, Slice::kUnchecked);
+        while (n < rest.size() && (Checked ? rest.at(n) : rest[n]) != '\n') {
+            if (!eq && (Checked ? rest.at(n) : rest[n]) == '=') eq = n;
+            ++n;
+        }
+        Slice key = Checked ? Slice(line, eq) : Slice(line, eq, Slice::kUnchecked);
+        Slice value = Checked ? Slice(line + eq + 1, line + n) : Slice(line + eq + 1, line + n, Slice::kUnchecked);
+        sum += key.size() + value.size() + static_cast<unsigned char>(Checked ? value.at(0) : value[0]);
+        p = line + n + 1;
+    }
+    return sum;
+}
+
+/**
+ * @brief 性能对比：带检查接口与不检查接口解析键值对
+ */
+void test_parse_benchmark() {
+    DEBUG("=== 开始键值解析性能测试 ===");
+
+    std::string text;
+    for (int i = 0; text.size() < 256 * 1024; ++i) {
+        text += "config.key" + std::to_string(i) + "=value_" + std::to_string(i * 7) + "\n";
+    }
+    const int kLoops = 200;
+    Slice s(text);
+
+    auto run = [&](const char* what, auto&& fn) {
+        size_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kLoops; ++i) sink += fn();
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double mbps = text.size() * double(kLoops) / sec / 1e6;
+        std::cout << what << ": " << mbps << " MB/s" << std::endl;
+        DEBUG("%s：%.1f MB/s（sink=%zu）", what, mbps, sink);
+        return sink;
+    };
+    size_t checked = run("checked", [&] { return parseKeyValues<true>(s); });
+    size_t unchecked = run("unchecked", [&] { return parseKeyValues<false>(s); });
+    DEBUG("结果一致：%s", checked == unchecked ? "通过" : "失败");
+
+    DEBUG("=== 键值解析性能测试结束 ===\n");
+}
+
+/**
+ * @brief eatLine()对\r\n与无换行结尾的处理
+ */
+void test_eat_line() {
+    DEBUG("=== 开始测试 eatLine ===");
+
+    Slice s("a\r\nb\rc\n\nlast");
+    std::vector<std::string> lines;
+    while (!s.empty()) {
+        lines.push_back(s.eatLine().toString());
+    }
+    bool ok = lines == std::vector<std::string>{"a", "b", "c", "", "last"};
+    DEBUG("测试1（\\r\\n、\\r、空行、无换行结尾）：%s", ok ? "通过" : "失败");
+
+    DEBUG("=== eatLine 测试结束 ===\n");
+}
+
+/**
+ * @brief 向量化实现与标量实现对比（随机数据、不同长度与对齐）
+ */
+void test_simd_property() {
+    DEBUG("=== 开始测试向量化扫描原语 ===");
+    DEBUG("CPU支持的级别：%d", static_cast<int>(simd::supportedLevel()));
+
+    // 字符集中包含空白、换行、大小写字母与高位字节，使各种分支都能命中
+    const char alphabet[] = " \t\r\nabcABCxyz;#:\x80\xff\v\f";
+    std::mt19937 rng(47);
+    auto randomText = [&](size_t n) {
+        std::string t(n, ' ');
+        for (auto& c : t) {
+            c = alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+        return t;
+    };
+
+    const simd::Level levels[] = {simd::Level::SSE42, simd::Level::AVX2};
+    std::vector<char> storage(300);
+    int mismatches = 0;
+    for (int iter = 0; iter < 20000; ++iter) {
+        // 偏移与长度随机，覆盖向量化主循环与尾部
+        size_t len = rng() % 200;
+        size_t off = rng() % 32;
+        std::string text = randomText(len);
+        memcpy(storage.data() + off, text.data(), len);
+        const char* b = storage.data() + off;
+        const char* e = b + len;
+        std::string needle = len > 0 && rng() % 2 ? text.substr(rng() % len, 1 + rng() % 6) : randomText(1 + rng() % 5);
+        std::string set = randomText(1 + rng() % 20);
+        std::string other = text;
+        for (auto& c : other) {
+            if (rng() % 4 == 0 && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) c ^= 0x20;
+        }
+        if (len > 0 && rng() % 8 == 0) other[rng() % len] = '!';
+
+        simd::setLevel(simd::Level::SCALAR);
+        const char* r1 = simd::findSubstr(b, e, needle.data(), needle.size());
+        const char* r2 = simd::findFirstOf(b, e, set.data(), set.size());
+        const char* r3 = simd::skipSpace(b, e);
+        const char* r4 = simd::findSpace(b, e);
+        const char* r5 = simd::rskipSpace(b, e);
+        const char* r6 = simd::findLineEnd(b, e);
+        bool r7 = simd::equalsNoCase(b, other.data(), len);
+        for (simd::Level level : levels) {
+            simd::setLevel(level);
+            if (simd::findSubstr(b, e, needle.data(), needle.size()) != r1 ||
+                simd::findFirstOf(b, e, set.data(), set.size()) != r2 ||
+                simd::skipSpace(b, e) != r3 || simd::findSpace(b, e) != r4 ||
+                simd::rskipSpace(b, e) != r5 || simd::findLineEnd(b, e) != r6 ||
+                simd::equalsNoCase(b, other.data(), len) != r7) {
+                ++mismatches;
+            }
+        }
+    }
+    simd::setLevel(simd::supportedLevel());
+    DEBUG("测试1（与标量实现一致）：%s（不一致次数=%d）", mismatches == 0 ? "通过" : "失败", mismatches);
+
+    // Slice接口
+    Slice text("GET /index.html HTTP/1.1\r\nHost: example.com\r\n\r\nbody");
+    bool ok = text.find(Slice("\r\n\r\n")) == 43 && text.find(Slice("nope")) == Slice::npos &&
+              text.find(Slice()) == 0 && text.findFirstOf(" \t\r\n") == 3 &&
+              Slice("Content-Length").equalsNoCase("content-LENGTH") &&
+              !Slice("Content-Length").equalsNoCase("content-lengtx") &&
+              Slice("Transfer-Encoding: chunked").startsWithNoCase("transfer-ENCODING");
+    DEBUG("测试2（Slice查找与不区分大小写比较）：%s", ok ? "通过" : "失败");
+
+    DEBUG("=== 向量化扫描原语测试结束 ===\n");
+}
+
+/**
+ * @brief 各级别实现的吞吐量
+ */
+void test_simd_benchmark() {
+    DEBUG("=== 开始向量化性能测试 ===");
+
+    // 模拟HTTP头部：每行以\r\n结尾，最后是空行
+    std::string text;
+    while (text.size() < 64 * 1024) {
+        text += "X-Forwarded-For-Header-With-A-Long-Name: some value with words\r\n";
+    }
+    text += "\r\n";
+    std::string upper = text;
+    for (auto& c : upper) {
+        if (c >= 'a' && c <= 'z') c -= 0x20;
+    }
+    const char* b = text.data();
+    const char* e = b + text.size();
+    const int kLoops = 2000;
+    const char* names[] = {"scalar", "sse4.2", "avx2"};
+
+    for (int l = 0; l <= static_cast<int>(simd::supportedLevel()); ++l) {
+        simd::setLevel(static_cast<simd::Level>(l));
+        size_t sink = 0;
+        auto run = [&](const char* what, auto&& fn) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < kLoops; ++i) sink += fn();
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double gbps = text.size() * double(kLoops) / sec / 1e9;
+            std::cout << names[l] << " " << what << ": " << gbps << " GB/s" << std::endl;
+            DEBUG("%s %s：%.2f GB/s", names[l], what, gbps);
+        };
+        run("findSubstr", [&] { return size_t(simd::findSubstr(b, e, "\r\n\r\n", 4) - b); });
+        run("findFirstOf", [&] { return size_t(simd::findFirstOf(b, e, ";#\0", 3) - b); });
+        run("equalsNoCase", [&] { return size_t(simd::equalsNoCase(b, upper.data(), text.size())); });
+        DEBUG("sink=%zu", sink);
+    }
+    simd::setLevel(simd::supportedLevel());
+
+    DEBUG("=== 向量化性能测试结束 ===\n");
+}
+
 // -------------------------- 测试入口函数 --------------------------
 void run_all_tests() {
     // 1. 初始化日志
@@ -275,6 +511,11 @@ void run_all_tests() {
     test_comparison_conversion();
     test_exceptions();
     test_thread_safe();
+    test_eat_line();
+    test_unchecked();
+    test_simd_property();
+    test_simd_benchmark();
+    test_parse_benchmark();
 
     // 3. 清理日志
     destroy_test_logger();
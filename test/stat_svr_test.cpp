@@ -0,0 +1,239 @@
+#include "stat-svr.h"
+#include "metrics.h"
+#include "logger.h"
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <iostream>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace handy {
+namespace statSvrTest {
+
+// 监控服务器测试端口
+static const unsigned short kStatPort = 12351;
+
+// -------------------------- 测试辅助函数 --------------------------
+/**
+ * @brief 初始化Logger（输出到stat_svr_test.log）
+ */
+void initTestLogger() {
+    Logger::getInstance().setLogFileName("stat_svr_test.log");
+    Logger::getInstance().setLogLevel(Logger::LogLevel::LDEBUG);
+    INFO("=== stat_svr_test 测试开始 ===");
+}
+
+/**
+ * @brief 用阻塞socket发送一个GET请求并读取完整响应（服务器以Content-Length给出消息体长度）
+ * @return std::string 响应消息体（失败时返回空串）
+ */
+std::string httpGet(unsigned short port, const std::string& uri) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return "";
+    }
+    timeval tv{3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    std::string req = "GET " + uri + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ::send(fd, req.data(), req.size(), MSG_NOSIGNAL);
+
+    std::string data;
+    HttpResponse resp;
+    char buf[16384];
+    while (true) {
+        resp.clear();
+        if (resp.tryDecode(Slice(data)) == HttpMsg::Result::Complete) {
+            break;
+        }
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            close(fd);
+            return "";
+        }
+        data.append(buf, n);
+    }
+    close(fd);
+    return resp.getBody().toString();
+}
+
+// -------------------------- 指标单元测试 --------------------------
+/**
+ * @brief 测试直方图的分桶边界与分位数估算
+ */
+void test_Histogram() {
+    DEBUG("=== 开始Histogram测试 ===");
+    // 1. 每个值都落在 (上一个桶的上界, 本桶上界] 内，且相对误差不超过25%
+    bool ok = true;
+    for (uint64_t v = 0; v < 100000 && ok; ++v) {
+        int idx = Histogram::bucketIndex(v);
+        uint64_t upper = Histogram::bucketUpperBound(idx);
+        ok = v <= upper && (idx == 0 || v > Histogram::bucketUpperBound(idx - 1))
+             && (v < 4 || static_cast<double>(upper - v) <= 0.25 * static_cast<double>(v));
+    }
+    DEBUG("分桶边界（%s）", ok ? "通过" : "失败");
+
+    // 2. 1..1000均匀分布的分位数
+    Histogram h;
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        h.observe(v);
+    }
+    Histogram::Snapshot snap = h.snapshot();
+    uint64_t p50 = snap.percentile(0.5);
+    uint64_t p99 = snap.percentile(0.99);
+    ok = snap.count == 1000 && snap.sum == 500500
+         && p50 >= 500 && p50 <= 625 && p99 >= 990 && p99 <= 1240;
+    DEBUG("分位数: p50=%llu p99=%llu（%s）", (unsigned long long)p50, (unsigned long long)p99, ok ? "通过" : "失败");
+    DEBUG("=== Histogram测试结束 ===\n");
+}
+
+/**
+ * @brief 测试分片计数器的并发正确性与更新开销
+ */
+void test_Counter_concurrent() {
+    DEBUG("=== 开始Counter并发测试 ===");
+    const int kThreads = 8;
+    const int kPerThread = 2000000;
+    Counter counter;
+    std::atomic<int64_t> shared{0};
+
+    auto run = [&](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> ths;
+        for (int t = 0; t < kThreads; ++t) {
+            ths.emplace_back([&] {
+                for (int i = 0; i < kPerThread; ++i) {
+                    fn();
+                }
+            });
+        }
+        for (auto& th : ths) {
+            th.join();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // 单核机器上两者相近，多核时分片计数器没有cache line争用
+    const double ops = static_cast<double>(kThreads) * kPerThread;
+    double shardedNs = run([&] { counter.add(); }) * 1e9 / ops;
+    double sharedNs = run([&] { shared.fetch_add(1, std::memory_order_relaxed); }) * 1e9 / ops;
+    bool ok = counter.value() == int64_t{kThreads} * kPerThread;
+    INFO("计数器: 分片 %.1f ns/op, 单一原子变量 %.1f ns/op, 硬件线程数=%u",
+         shardedNs, sharedNs, std::thread::hardware_concurrency());
+    std::cout << "counter add: sharded " << shardedNs << " ns/op, single atomic "
+              << sharedNs << " ns/op" << std::endl;
+    DEBUG("并发计数: %lld（%s）", (long long)counter.value(), ok ? "通过" : "失败");
+    DEBUG("=== Counter并发测试结束 ===\n");
+}
+
+/**
+ * @brief 测试注册表的Prometheus文本输出
+ */
+void test_Registry_render() {
+    DEBUG("=== 开始MetricsRegistry输出测试 ===");
+    MetricsRegistry reg;
+    reg.counter("req_total", "Requests", "code=\"200\"").add(3);
+    reg.counter("req_total", "Requests", "code=\"200\"").add(2);
+    reg.gauge("queue_depth", "Queue depth").set(7);
+    reg.gauge("answer", "Callback gauge", "", [] { return 42.0; });
+    Histogram& h = reg.histogram("latency_seconds", "Latency", "", 1e-6);
+    h.observe(3);
+    h.observe(1000);
+
+    std::string text = reg.render();
+    bool ok = text.find("# TYPE req_total counter\n") != std::string::npos
+              && text.find("req_total{code=\"200\"} 5\n") != std::string::npos
+              && text.find("queue_depth 7\n") != std::string::npos
+              && text.find("answer 42\n") != std::string::npos
+              && text.find("# TYPE latency_seconds histogram\n") != std::string::npos
+              && text.find("latency_seconds_bucket{le=\"+Inf\"} 2\n") != std::string::npos
+              && text.find("latency_seconds_count 2\n") != std::string::npos;
+    DEBUG("Prometheus文本输出（%s）", ok ? "通过" : "失败");
+
+    // 类型冲突时抛出异常；注销后不再输出
+    bool thrown = false;
+    try {
+        reg.gauge("req_total", "Requests");
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    reg.remove("answer");
+    ok = thrown && reg.render().find("answer") == std::string::npos;
+    DEBUG("类型冲突与注销（%s）", ok ? "通过" : "失败");
+    DEBUG("=== MetricsRegistry输出测试结束 ===\n");
+}
+
+// -------------------------- StatServer 集成测试 --------------------------
+/**
+ * @brief 测试通过HTTP抓取事件循环与TCP连接指标
+ */
+void test_StatServer() {
+    DEBUG("=== 开始StatServer测试 ===");
+    EventBase base;
+    StatServer stat(&base);
+    stat.addEventBase(&base, "main");
+    stat.onPage("/version", "build version", [] { return std::string("handy-test\n"); });
+    int r = stat.bind("127.0.0.1", kStatPort);
+    std::thread th([&base] { base.loop(); });
+
+    // 让事件循环先转几圈，并注册一个定时器（定时器接口只能在循环线程中调用）
+    base.safeCall([&base] { base.runAfter(60000, [] {}); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::string index = httpGet(kStatPort, "/");
+    std::string version = httpGet(kStatPort, "/version");
+    std::string metrics = httpGet(kStatPort, "/metrics");
+    bool ok = r == 0
+              && index.find("/metrics") != std::string::npos
+              && index.find("/version") != std::string::npos
+              && version == "handy-test\n";
+    DEBUG("索引页与自定义页面（%s）", ok ? "通过" : "失败");
+
+    ok = metrics.find("handy_loop_iterations_total{loop=\"main\"}") != std::string::npos
+         && metrics.find("handy_loop_busy_seconds_bucket{loop=\"main\",le=\"+Inf\"}") != std::string::npos
+         && metrics.find("handy_loop_pending_tasks{loop=\"main\"}") != std::string::npos
+         && metrics.find("handy_loop_timers{loop=\"main\"} 1\n") != std::string::npos
+         && metrics.find("handy_tcp_received_bytes_total") != std::string::npos
+         && metrics.find("handy_tcp_connections_total") != std::string::npos;
+    DEBUG("/metrics 输出%zu字节（%s）", metrics.size(), ok ? "通过" : "失败");
+    INFO("metrics:\n%s", metrics.c_str());
+
+    base.exit();
+    th.join();
+    DEBUG("=== StatServer测试结束 ===\n");
+}
+
+// -------------------------- 测试入口函数 --------------------------
+void run_all_tests() {
+    // 1. 初始化日志
+    initTestLogger();
+
+    // 2. 执行所有测试
+    test_Histogram();
+    test_Counter_concurrent();
+    test_Registry_render();
+    test_StatServer();
+
+    // 3. 测试总结
+    INFO("=== stat_svr_test 所有测试执行完成 ===");
+}
+
+}  // namespace statSvrTest
+}  // namespace handy
+
+// 主函数：启动测试
+int main() {
+    handy::statSvrTest::run_all_tests();
+    return 0;
+}
@@ -10,6 +10,36 @@
 #include <fcntl.h>
 #include <sstream>
 #include <stdexcept>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// -------------------------- 堆分配计数 --------------------------
+// 替换全局operator new，统计进程内的堆分配次数
+static std::atomic<long> g_allocs{0};
+
+void* operator new(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
 
 // 测试用全局原子变量（用于多线程测试计数）
 std::atomic<int> g_statusThreadTestCount(0);
@@ -194,8 +224,8 @@ void testThreadSafe() {
             Status s1 = Status::fromSystem(i % 10);  // 循环使用不同错误码
             
             // 测试格式化创建
-            Status s2 = Status::fromFormat(i, "thread %d, loop %d", 
-                                          std::this_thread::get_id(), i);
+            Status s2 = Status::fromFormat(i, "thread %zu, loop %d", 
+                                          std::hash<std::thread::id>{}(std::this_thread::get_id()), i);
             
             // 验证基本属性（避免优化掉代码）
             if (s1.code() < 0 || s2.msg() == nullptr) {
@@ -226,6 +256,91 @@ void testThreadSafe() {
     DEBUG("=== 线程安全特性测试结束 ===\n");
 }
 
+/**
+ * @brief 测试错误信息的存储方式（静态、内联、堆）与分配次数
+ */
+void testRepresentation() {
+    DEBUG("=== 开始测试错误信息存储方式 ===");
+
+    // 测试1：常见errno使用静态信息，创建、拷贝、移动都不分配
+    Status::fromSystem(EAGAIN);  // 首次调用生成静态信息表
+    long before = g_allocs.load();
+    Status s1 = Status::fromSystem(ECONNRESET);
+    Status s2 = s1;
+    Status s3(std::move(s2));
+    bool test1Ok = (g_allocs.load() == before && s1.msg() == s3.msg() && s2.ok()
+                    && strstr(s3.msg(), "reset") != nullptr);
+    DEBUG("测试1（静态errno信息）：%s", test1Ok ? "通过" : "失败");
+
+    // 测试2：短信息内联存储，不分配
+    before = g_allocs.load();
+    Status s4(7, "short message");
+    Status s5 = Status::fromFormat(8, "fd %d closed", 42);
+    Status s6 = s4;
+    bool test2Ok = (g_allocs.load() == before && strcmp(s5.msg(), "fd 42 closed") == 0
+                    && strcmp(s6.msg(), "short message") == 0 && s6.msg() != s4.msg());
+    DEBUG("测试2（内联短信息）：%s", test2Ok ? "通过" : "失败");
+
+    // 测试3：长信息只分配一次，拷贝共享同一份内容
+    std::string longMsg(200, 'e');
+    before = g_allocs.load();
+    Status s7 = Status::fromFormat(9, "%s", longMsg.c_str());
+    Status s8 = s7;
+    Status s9;
+    s9 = s8;
+    bool test3Ok = (g_allocs.load() == before + 1 && s7.msg() == s9.msg() && longMsg == s8.msg());
+    s7 = Status();
+    s8 = Status();
+    test3Ok = test3Ok && longMsg == s9.msg();
+    DEBUG("测试3（堆上长信息共享）：%s", test3Ok ? "通过" : "失败");
+
+    // 测试4：超过栈上缓冲区的格式化信息
+    std::string hugeMsg(4096, 'h');
+    Status s10 = Status::fromFormat(10, "%s!", hugeMsg.c_str());
+    bool test4Ok = (strlen(s10.msg()) == hugeMsg.size() + 1 && s10.msg()[hugeMsg.size()] == '!');
+    DEBUG("测试4（超长格式化信息）：%s", test4Ok ? "通过" : "失败");
+
+    // 测试5：恰好填满内联存储
+    std::string edge(Status::kInlineSize - 1, 'x');
+    Status s11(11, edge);
+    Status s12(12, edge + "y");
+    bool test5Ok = (edge == s11.msg() && edge + "y" == s12.msg());
+    DEBUG("测试5（内联边界）：%s", test5Ok ? "通过" : "失败");
+
+    DEBUG("=== 错误信息存储方式测试结束 ===\n");
+}
+
+/**
+ * @brief 创建、拷贝、销毁Status的吞吐量
+ */
+void testBenchmark() {
+    DEBUG("=== 开始Status性能测试 ===");
+
+    const int kLoops = 1000000;
+    std::string longMsg(100, 'l');
+    auto bench = [&](const char* name, auto&& make) {
+        long before = g_allocs.load();
+        auto start = std::chrono::steady_clock::now();
+        long sum = 0;
+        for (int i = 0; i < kLoops; ++i) {
+            Status s = make(i);
+            Status copy = s;
+            Status moved(std::move(copy));
+            sum += moved.code();
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kLoops;
+        double allocs = double(g_allocs.load() - before) / kLoops;
+        std::cout << "Status " << name << ": " << ns << " ns/op, " << allocs << " allocs/op" << std::endl;
+        DEBUG("%s：%.1f ns/op，%.2f allocs/op（sum=%ld）", name, ns, allocs, sum);
+    };
+
+    bench("fromSystem", [](int i) { return Status::fromSystem(1 + i % 100); });
+    bench("inline fromFormat", [](int i) { return Status::fromFormat(i, "read fd %d failed", i & 1023); });
+    bench("heap fromFormat", [&](int i) { return Status::fromFormat(i, "%s %d", longMsg.c_str(), i); });
+
+    DEBUG("=== Status性能测试结束 ===\n");
+}
+
 // -------------------------- 测试入口函数 --------------------------
 void runAllTests() {
     // 1. 初始化日志
@@ -238,6 +353,8 @@ void runAllTests() {
     testUtils();
     testMemoryFailure();
     testThreadSafe();
+    testRepresentation();
+    testBenchmark();
 
     // 3. 清理日志
     destroyTestLogger();
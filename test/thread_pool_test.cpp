@@ -7,6 +7,11 @@
 #include <chrono>
 #include <stdexcept>
 #include <sstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <sched.h>
+#include <pthread.h>
 
 // 测试用全局原子变量（多线程任务计数、同步）
 std::atomic<int> g_taskExecCount(0);
@@ -596,6 +601,70 @@ void testThreadPoolTaskException() {
     DEBUG("=== ThreadPool 任务异常处理测试结束 ===\n");
 }
 
+/**
+ * @brief 测试 ThreadPool 工作线程命名与CPU绑定（在工作线程中用sched_getaffinity检查实际生效的CPU集合）
+ */
+void testThreadPoolAffinity() {
+    DEBUG("=== 开始测试 ThreadPool 线程命名与CPU绑定 ===");
+
+    // 绑定到当前进程允许运行的最后一个CPU
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    int cpu = CPU_SETSIZE - 1;
+    while (cpu > 0 && !CPU_ISSET(cpu, &allowed)) {
+        --cpu;
+    }
+
+    const int THREAD_NUM = 3;
+    ThreadPool pool(THREAD_NUM, 0, false);
+    pool.setThreadName("handy-pool").setCpuAffinity({{cpu}});
+    pool.start();
+
+    // 每个任务等待其他任务都开始执行后才返回，保证每个工作线程各执行一个任务
+    std::mutex mutex;
+    std::set<std::string> names;
+    std::atomic<int> arrived(0), pinned(0);
+    for (int i = 0; i < THREAD_NUM; ++i) {
+        pool.addTask([&]() {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            sched_getaffinity(0, sizeof(set), &set);
+            if (CPU_COUNT(&set) == 1 && CPU_ISSET(cpu, &set)) {
+                pinned.fetch_add(1);
+            }
+            char buf[16] = {0};
+            pthread_getname_np(pthread_self(), buf, sizeof(buf));
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                names.insert(buf);
+            }
+            arrived.fetch_add(1);
+            auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+            while (arrived.load() < THREAD_NUM && std::chrono::steady_clock::now() < end) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+    while (arrived.load() < THREAD_NUM) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.exit();
+    pool.join();
+
+    bool testOk = pinned.load() == THREAD_NUM;
+    DEBUG("工作线程绑定到CPU %d：%d/%d", cpu, pinned.load(), THREAD_NUM);
+    std::set<std::string> expected;
+    for (int i = 0; i < THREAD_NUM; ++i) {
+        expected.insert("handy-pool-" + std::to_string(i));
+    }
+    testOk = testOk && names == expected;
+    DEBUG("工作线程名：%s ...（共%zu个）", names.empty() ? "" : names.begin()->c_str(), names.size());
+
+    DEBUG("测试（线程命名与CPU绑定）：%s", testOk ? "通过" : "失败");
+    DEBUG("=== ThreadPool 线程命名与CPU绑定测试结束 ===\n");
+}
+
 // -------------------------- 测试入口函数 --------------------------
 void runAllTests() {
     // 1. 初始化日志
@@ -611,6 +680,7 @@ void runAllTests() {
     testThreadPoolExceptions();
     testThreadPoolMultiTask();
     testThreadPoolTaskException();
+    testThreadPoolAffinity();
 
     // 4. 清理日志
     destroyTestLogger();
@@ -230,8 +230,8 @@ void test_thread_safe() {
         for (int i = 0; i < LOOP_NUM; ++i) {
             time_t now = time(nullptr);
             std::string time_str = utils::readableTime(now);
-            std::string fmt_str = utils::format("线程%d-%d：time=%s", 
-                                               std::this_thread::get_id(), i, time_str.c_str());
+            std::string fmt_str = utils::format("线程%zu-%d：time=%s", 
+                                               std::hash<std::thread::id>{}(std::this_thread::get_id()), i, time_str.c_str());
             // 日志输出（间接验证无崩溃/乱码）
             DEBUG("%s", fmt_str.c_str());
             g_threadTestCount.fetch_add(1, std::memory_order_relaxed);